@@ -21,7 +21,7 @@ from types import FunctionType, MethodType
 from .utils import AsynchronousFileReader, rtlsdr_test, position_info, generate_aprs_id
 from .gps import get_ephemeris, get_almanac
 from .sonde_specific import fix_datetime, imet_unique_id
-from .fsk_demod import FSKDemodStats
+from .fsk_demod import FSKDemodStats, read_stats_records
 from .sdr_wrappers import test_sdr, get_sdr_iq_cmd, get_sdr_fm_cmd, get_sdr_name
 from .email_notification import EmailNotification
 
@@ -173,7 +173,7 @@ class SondeDecoder(object):
 
             save_decode_audio (bool): If True, save the FM-demodulated audio to disk to decode_<device_idx>.wav.
                                       Note: This may use up a lot of disk space!
-            save_decode_iq (bool): If True, save the decimated IQ stream (48 or 96k complex s16 samples) to disk to decode_IQ_<device_idx>.bin
+            save_decode_iq (bool): If True, save the decimated IQ stream (48 or 96k complex s16 samples) to disk to decode_IQ_<freq>_<type>_<device_idx>.iqr (iq_rec format)
                                       Note: This will use up a lot of disk space!
 
             exporter (function, list): Either a function, or a list of functions, which accept a single dictionary. Fields described above.
@@ -228,7 +228,7 @@ class SondeDecoder(object):
         else:
             self.raw_file_option = ""
 
-        self.save_decode_iq_path = os.path.join(autorx.logging_path, f"decode_IQ_{self.sonde_freq}_{self.sonde_type}_{str(self.rtl_device_idx)}.raw")
+        self.save_decode_iq_path = os.path.join(autorx.logging_path, f"decode_IQ_{self.sonde_freq}_{self.sonde_type}_{str(self.rtl_device_idx)}.iqr")
         self.save_decode_audio_path = os.path.join(autorx.logging_path, f"decode_audio_{self.sonde_freq}_{self.sonde_type}_{str(self.rtl_device_idx)}.wav")
 
         # iMet ID store. We latch in the first iMet ID we calculate, to avoid issues with iMet-1-RS units
@@ -399,7 +399,7 @@ class SondeDecoder(object):
             if self.save_decode_audio:
                 decode_cmd += f" tee {self.save_decode_audio_path} |"
 
-            decode_cmd += "./rs41mod --ptu2 --json --jsnsubfrm1 2>/dev/null"
+            decode_cmd += "./rs41mod --ptu2 --json --jsnsubfrm1 --allofs 2>/dev/null"
 
         elif self.sonde_type == "RS92":
             # Decoding a RS92 requires either an ephemeris or an almanac file.
@@ -550,9 +550,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save audio to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             if self.wideband_sondes:
                 _wideband = "--imet1"
@@ -580,9 +580,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save audio to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # iMet-54 Decoder
             decode_cmd += (
@@ -607,9 +607,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save audio to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # MRZ decoder
             #decode_cmd += "./mp3h1mod --auto --json --ptu 2>/dev/null"
@@ -644,9 +644,9 @@ class SondeDecoder(object):
                 fast_filter = True
             )
 
-            # Add in tee command to save audio to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # LMS6-1680 decoder
             decode_cmd += f"./mk2a1680mod --iq 0.0 --lpIQ --lpbw 160 --decFM --dc --crc --json {self.raw_file_option} - 240000 16 2>/dev/null"
@@ -705,9 +705,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # Meisei Decoder, in IQ input mode
             decode_cmd += f"./meisei100mod --IQ 0.0 --lpIQ --dc  - {_sample_rate} 16 --json --ptu --ecc 2>/dev/null"
@@ -730,9 +730,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # Meteosis MTS01 decoder
             decode_cmd += f"./mts01mod --json --IQ 0.0 --lpIQ --dc - {_sample_rate} 16 2>/dev/null"
@@ -757,9 +757,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # WXR301, via iq_dec as a FM Demod.
             decode_cmd += f"./iq_dec --FM --IFbw {_if_bw} --lpFM --wav --iq 0.0 - {_sample_rate} 16 2>/dev/null | ./weathex301d -b --json"
@@ -783,9 +783,9 @@ class SondeDecoder(object):
                 bias = self.bias
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                decode_cmd += f" tee {self.save_decode_iq_path} |"
+                decode_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # WXR301, via iq_dec as a FM Demod.
             decode_cmd += f"./iq_dec --FM --IFbw {_if_bw} --lpFM --wav --iq 0.0 - {_sample_rate} 16 2>/dev/null | ./weathex301d -b --json --pn9"
@@ -849,13 +849,13 @@ class SondeDecoder(object):
                 channel_filter = 5000 # +/- 5 kHz channel filter.
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # Use a 4800 Hz mask estimator to better avoid adjacent sonde issues.
             # Also seems to give a small performance bump.
-            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -s --mask 4800 --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -F --mask 4800 --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -926,11 +926,11 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
-            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -s --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -F --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -972,13 +972,13 @@ class SondeDecoder(object):
                 channel_filter = 5000
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # NOTE - Using inverted soft decision outputs, so DFM type detection works correctly.
             # No mask estimator - DFMs seem to decode better without it!
-            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -s -i --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -F -i --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1026,12 +1026,12 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             demod_cmd += (
-                "./fsk_demod --cs16 -b %d -u %d -s -p %d --stats=%d 2 %d %d - -"
+                "./fsk_demod --cs16 -b %d -u %d -F -p %d --stats-bin --stats=%d 2 %d %d - -"
                 % (_lower, _upper, _p, _stats_rate, _sample_rate, _baud_rate)
             )
 
@@ -1068,12 +1068,12 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             demod_cmd += (
-                "./fsk_demod --cs16 -b %d -u %d -s -p %d --stats=%d 2 %d %d - -"
+                "./fsk_demod --cs16 -b %d -u %d -F -p %d --stats-bin --stats=%d 2 %d %d - -"
                 % (_lower, _upper, _p, _stats_rate, _sample_rate, _baud_rate)
             )
 
@@ -1108,11 +1108,11 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
-            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -s --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -F --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1149,11 +1149,11 @@ class SondeDecoder(object):
                 bias = self.bias,
                 dc_block = True
             )
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
-            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -s --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -b %d -u %d -F --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1191,11 +1191,11 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
-            demod_cmd += "./fsk_demod --cs16 -s -b %d -u %d --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -F -b %d -u %d --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1237,9 +1237,9 @@ class SondeDecoder(object):
                 fast_filter = True # Don't use -F9
             )
 
-            # Add in tee command to save audio to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # LMS6-1680 decoder
             demod_cmd += f"./mk2a1680mod --iq 0.0 --lpIQ --lpbw 160 --lpFM --dc --crc --json {self.raw_file_option} - 220000 16 2>/dev/null"
@@ -1278,11 +1278,11 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
-            demod_cmd += "./fsk_demod --cs16 -s -b %d -u %d --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -F -b %d -u %d --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1320,12 +1320,12 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # Trying out using the mask estimator here to reduce issues with interference
-            demod_cmd += "./fsk_demod --cs16 -s -b %d -u %d --mask 50000 --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -F -b %d -u %d --mask 50000 --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1364,12 +1364,12 @@ class SondeDecoder(object):
                 dc_block = True
             )
 
-            # Add in tee command to save IQ to disk if debugging is enabled.
+            # Add in iq_rec (tee + chunked IQ recording) to save IQ to disk if debugging is enabled.
             if self.save_decode_iq:
-                demod_cmd += f" tee {self.save_decode_iq_path} |"
+                demod_cmd += f" ./iq_rec --fq {int(self.sonde_freq)} - {_sample_rate} 16 {self.save_decode_iq_path} |"
 
             # Trying out using the mask estimator here to reduce issues with interference
-            demod_cmd += "./fsk_demod --cs16 -s -b %d -u %d --mask 50000 --stats=%d 2 %d %d - -" % (
+            demod_cmd += "./fsk_demod --cs16 -F -b %d -u %d --mask 50000 --stats-bin --stats=%d 2 %d %d - -" % (
                 _lower,
                 _upper,
                 _stats_rate,
@@ -1389,16 +1389,13 @@ class SondeDecoder(object):
 
         return (demod_cmd, decode_cmd, demod_stats)
 
-    def stats_thread(self, asyncreader):
-        """ Process demodulator statistics from a supplied AsynchronousFileReader object (which will be hooked into stderr from fsk_demod) """
-        while (not asyncreader.eof()) and self.decoder_running:
-            for _line in asyncreader.readlines():
-                self.demod_stats.update(_line)
-            # Avoid spinlocking..
-            # Probably about time we looked at using async for this stuff...
-            time.sleep(0.2)
-
-        asyncreader.stop()
+    def stats_thread(self, stats_pipe):
+        """ Process demodulator statistics (fsk_demod --stats-bin records) from the stderr pipe of fsk_demod """
+        # read_stats_records blocks until a record is complete, and returns when fsk_demod exits.
+        for _record in read_stats_records(stats_pipe):
+            if not self.decoder_running:
+                break
+            self.demod_stats.update(_record)
 
     def decoder_thread(self):
         """ Runs the supplied decoder command(s) as a subprocess, and passes returned lines to handle_decoder_line. """
@@ -1442,13 +1439,9 @@ class SondeDecoder(object):
                 preexec_fn=os.setsid,
             )
 
-            self.demod_reader = AsynchronousFileReader(
-                self.demod_process.stderr, autostart=True
-            )
-
             # Start thread to process demodulator stats.
             self.demod_stats_thread = Thread(
-                target=self.stats_thread, args=(self.demod_reader,)
+                target=self.stats_thread, args=(self.demod_process.stderr,)
             )
             self.demod_stats_thread.start()
 
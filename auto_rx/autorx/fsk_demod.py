@@ -7,10 +7,83 @@
 #
 import json
 import logging
+import struct
 import time
 import numpy as np
 
 
+# fsk_demod --stats-bin record header (see utils/fsk_stats.h)
+FSK_STATS_BIN_MAGIC = b"FSKT"
+FSK_STATS_BIN_HDR = struct.Struct("<4sBBHIIff4fBBBBHH")
+
+
+def parse_stats_record(buf):
+    """
+    Parse one fsk_demod --stats-bin record into a dict with the same fields
+    as the JSON stats (plus "channel"). The eye diagram is only included if
+    fsk_demod was run with --stats-eye.
+    """
+    (_magic, _ver, _channel, _len, _secs, _samples, _snr, _ppm,
+        _f1, _f2, _f3, _f4, _M, _neyetr, _neyesamp, _fft_dec, _nfft, _res) = FSK_STATS_BIN_HDR.unpack_from(buf, 0)
+
+    _ofs = FSK_STATS_BIN_HDR.size
+    _fft = list(struct.unpack_from("<%df" % _nfft, buf, _ofs))
+    _ofs += 4*_nfft
+
+    _data = {
+        "channel": _channel,
+        "secs": _secs,
+        "samples": _samples,
+        "EbNodB": _snr,
+        "ppm": _ppm,
+        "f1_est": _f1,
+        "f2_est": _f2,
+        "samp_fft": _fft,
+    }
+    if _M == 4:
+        _data["f3_est"] = _f3
+        _data["f4_est"] = _f4
+    if _neyetr > 0:
+        _eye = buf[_ofs:_ofs + _neyetr*_neyesamp]
+        _data["eye_diagram"] = [
+            [_b/255.0 for _b in _eye[_i*_neyesamp:(_i+1)*_neyesamp]] for _i in range(_neyetr)
+        ]
+
+    return _data
+
+
+def read_stats_records(f):
+    """
+    Generator over the --stats-bin records in a binary file object (e.g. the
+    stderr pipe of fsk_demod). Anything between records (e.g. text messages)
+    is skipped by searching for the record magic.
+    """
+    _buf = b""
+    while True:
+        _chunk = f.read1(4096) if hasattr(f, "read1") else f.read(4096)
+        if not _chunk:
+            return
+        _buf += _chunk
+
+        while True:
+            _i = _buf.find(FSK_STATS_BIN_MAGIC)
+            if _i < 0:
+                _buf = _buf[-3:]
+                break
+            _buf = _buf[_i:]
+            if len(_buf) < FSK_STATS_BIN_HDR.size:
+                break
+            _len = struct.unpack_from("<H", _buf, 6)[0]
+            if _len < FSK_STATS_BIN_HDR.size:
+                # Not a record, resync.
+                _buf = _buf[1:]
+                continue
+            if len(_buf) < _len:
+                break
+            yield parse_stats_record(_buf[:_len])
+            _buf = _buf[_len:]
+
+
 class FSKDemodStats(object):
     """
     Process modem statistics produced by fsk_demod and provide access to
@@ -22,19 +95,21 @@ class FSKDemodStats(object):
 
     FSK_STATS_FIELDS = ["EbNodB", "ppm", "f1_est", "f2_est", "samp_fft"]
 
-    def __init__(self, averaging_time=5.0, peak_hold=False, decoder_id=""):
+    def __init__(self, averaging_time=5.0, peak_hold=False, decoder_id="", channel=None):
         """
 
         Required Fields:
             averaging_time (float): Use the last X seconds of data in calculations.
             peak_hold (bool): If true, use a peak-hold SNR metric instead of a mean.
             decoder_id (str): A unique ID for this object (suggest use of the SDR device ID)
+            channel (int): Only use stats of this channel of a multi-channel fsk_demod (--channels)
             
         """
 
         self.averaging_time = float(averaging_time)
         self.peak_hold = peak_hold
         self.decoder_id = str(decoder_id)
+        self.channel = channel
 
         # Input data stores.
         self.in_times = np.array([])
@@ -72,6 +147,10 @@ class FSKDemodStats(object):
                 # self.log_error("FSK Demod Stats - %s" % str(e))
                 return
 
+        # Multi-channel fsk_demod: skip other channels
+        if self.channel is not None and _data.get("channel", 0) != self.channel:
+            return
+
         # Check for required fields in incoming dictionary.
         for _field in self.FSK_STATS_FIELDS:
             if _field not in _data:
@@ -131,19 +210,27 @@ if __name__ == "__main__":
 
     _filename = sys.argv[1]
 
-    _f = open(_filename, "r")
-
     stats = FSKDemodStats(averaging_time=2.0, peak_hold=True)
 
     rate = 10.0
     updaterate = 10
     count = 0
 
-    for _line in _f:
-        try:
-            _line = json.loads(_line)
-        except:
-            continue
+    # fsk_demod --stats output, JSON lines or --stats-bin records
+    with open(_filename, "rb") as _f:
+        _binary = FSK_STATS_BIN_MAGIC in _f.read(4096)
+
+    if _binary:
+        _records = read_stats_records(open(_filename, "rb"))
+    else:
+        _records = open(_filename, "r")
+
+    for _line in _records:
+        if not _binary:
+            try:
+                _line = json.loads(_line)
+            except:
+                continue
 
         stats.update(_line)
 
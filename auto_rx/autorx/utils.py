@@ -44,6 +44,7 @@ REQUIRED_RS_UTILS = [
     "imet4iq",
     "mts01mod",
     "iq_dec",
+    "iq_rec",
     "weathex301d"
 ]
 
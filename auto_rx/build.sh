@@ -40,6 +40,7 @@ mv ../demod/mod/imet54mod .
 mv ../demod/mod/mp3h1mod .
 mv ../demod/mod/mts01mod .
 mv ../demod/mod/iq_dec .
+mv ../demod/mod/iq_rec .
 mv ../weathex/weathex301d .
 
 echo "Done!"
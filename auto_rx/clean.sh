@@ -25,6 +25,7 @@ rm mp3h1mod
 rm imet54mod
 rm mts01mod
 rm iq_dec
+rm iq_rec
 
 
 echo "Done!"
@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+#
+#   Scan/decode throughput benchmark over the test sample corpus.
+#
+#   Runs dft_detect and the demod/mod (and imet/mk2a) decoders directly on the
+#   96k float IQ samples in ./generated (see generate_lowsnr.py), using the
+#   decoders' own IQ front ends (no csdr/tsrc needed), and reports per run:
+#     samples/sec (CPU time), x realtime, decoded frames, CPU per decoded frame,
+#     peak RSS, time to first output and (dft_detect) detection latency.
+#   With --profile the demod/mod decoders also report CPU time per stage
+#   (read, decim, lpIQ, demod, lpFM, corrDFT, softbit, ecc, output; see demod_mod.c).
+#
+#   Output is one JSON object per line (stdout or --out), a summary goes to stderr.
+#
+#   Released under GNU GPL v3 or later
+#
+#   Usage:
+#   $ python3 benchmark.py                      # all of ./generated/*.bin
+#   $ python3 benchmark.py --snr 10,12,15 --tools dft_detect,rs41mod
+#   $ python3 benchmark.py -f "./samples/*.bin" --out results/bench.jsonl
+#   $ python3 benchmark.py --tools imet54mod --profile
+#   or from the top level:  make bench BENCH_ARGS="--snr 12"
+#
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+
+# sample file prefix -> decoder name, decoder options (input appended: - <sr> 32 <file>)
+DECODERS = {
+    'rs41':      ['rs41mod',      "--ptu2 --json --IQ 0.0 --lpIQ --dc"],
+    'rs92':      ['rs92mod',      "-vx -v --crc --ecc --vel --json --IQ 0.0 --lpIQ --dc"],
+    'rsngp':     ['rs92mod',      "-vx -v --crc --ecc --vel --json --ngp --IQ 0.0 --lpIQ --dc"],
+    'dfm09':     ['dfm09mod',     "-vv --ecc --json --dist --auto --IQ 0.0 --lpIQ --dc"],
+    'm10':       ['m10mod',       "--json --ptu -vvv --IQ 0.0 --lpIQ --dc"],
+    'm20':       ['m20mod',       "--json --ptu -vvv --IQ 0.0 --lpIQ --dc"],
+    'lms6-400':  ['lms6Xmod',     "--json --IQ 0.0 --lpIQ --dc"],
+    'imet54':    ['imet54mod',    "--ecc --json --ptu --IQ 0.0 --lpIQ --dc"],
+    'imet4':     ['imet4iq',      "--iq 0.0 --lpIQ --dc --json"],
+    'mrz':       ['mp3h1mod',     "--json --ptu --IQ 0.0 --lpIQ --dc"],
+    'mts01':     ['mts01mod',     "--json --IQ 0.0 --lpIQ --dc"],
+    'meisei':    ['meisei100mod', "--json --ptu --ecc --IQ 0.0 --lpIQ --dc"],
+    'lms6-1680': ['mk2a1680mod',  "--iq 0.0 --lpIQ --lpbw 160 --lpFM --dc --crc --json"],
+}
+
+# alternative decoders run on the same samples, for comparison
+ALT_DECODERS = {
+    'm10':       [['m10',         "-b --json --IQ 0.0 --lpIQ --dc"]],  # C++ decoder in m10/
+}
+
+# decoders with --profile[=json] (demod/mod)
+PROFILE_TOOLS = ['rs41mod', 'rs92mod', 'dfm09mod', 'm10mod', 'm20mod', 'lms6Xmod',
+                 'imet54mod', 'mp3h1mod', 'mts01mod', 'meisei100mod']
+
+DETECT_OPTS = "-v -c --IQ 0.0 --dc"  # -v: "IF: <sr>", then "sample: <pos>" (at IF rate) per hit
+
+# where the binaries may live: auto_rx/ (after build.sh) or the build tree
+BIN_DIRS = ['..', '../../scan', '../../demod/mod', '../../imet', '../../mk2a', '../../m10']
+
+
+def find_binary(name, bin_dir=None):
+    _dirs = [bin_dir] if bin_dir else BIN_DIRS
+    for _d in _dirs:
+        _path = os.path.join(_d, name)
+        if os.path.isfile(_path) and os.access(_path, os.X_OK):
+            return _path
+    return None
+
+
+def sample_info(filename):
+    """ Sample type, sample rate and Eb/No from e.g. rs41_96k_float_12.5dB.bin """
+    _base = os.path.basename(filename)
+
+    _type = None
+    for _prefix in sorted(DECODERS.keys(), key=len, reverse=True):
+        if _base.startswith(_prefix + '_'):
+            _type = _prefix
+            break
+
+    _m = re.search(r'_(\d+)k_', _base)
+    _sr = int(_m.group(1))*1000 if _m else 96000
+
+    _m = re.search(r'_(-?\d+\.?\d*)dB\.bin$', _base)
+    _snr = float(_m.group(1)) if _m else None
+
+    return (_type, _sr, _snr)
+
+
+def read_hwm(pid):
+    """ VmHWM / kB of a running process (Linux) """
+    try:
+        with open("/proc/%d/status" % pid) as _f:
+            for _line in _f:
+                if _line.startswith("VmHWM:"):
+                    return int(_line.split()[1])
+    except (IOError, ValueError):
+        pass
+    return 0
+
+
+def read_profile(errfile):
+    """ Stage seconds from the last '--profile=json' record on stderr """
+    _stages = None
+    errfile.seek(0)
+    for _line in errfile:
+        _line = _line.decode('ascii', 'ignore').strip()
+        if _line.startswith('{') and '"profile"' in _line:
+            try:
+                _stages = json.loads(_line)['stages']
+            except (ValueError, KeyError):
+                pass
+    if _stages is None:
+        return None
+    return {_k: _v['sec'] for (_k, _v) in _stages.items() if _v['sec'] > 0}
+
+
+def run_one(cmd, profile=False):
+    """ Run cmd (list), return stdout lines with arrival time, wall/cpu time, peak RSS """
+    _start = time.time()
+    # stderr to a file, a pipe could fill up while stdout is read
+    _errfile = tempfile.TemporaryFile() if profile else subprocess.DEVNULL
+    _proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=_errfile)
+
+    # ru_maxrss of a child forked from this interpreter includes the pre-exec
+    # (python) memory, so the peak RSS is sampled from /proc while it runs.
+    _hwm = [0]
+    _done = threading.Event()
+    def _poll():
+        while not _done.is_set():
+            _hwm[0] = max(_hwm[0], read_hwm(_proc.pid))
+            _done.wait(0.005)
+    _poller = threading.Thread(target=_poll)
+    _poller.start()
+
+    _lines = []
+    for _line in _proc.stdout:
+        _lines.append((time.time() - _start, _line.decode('ascii', 'ignore').strip()))
+    _proc.stdout.close()
+
+    # sample once more before reaping
+    _hwm[0] = max(_hwm[0], read_hwm(_proc.pid))
+    (_pid, _status, _ru) = os.wait4(_proc.pid, 0)
+    _done.set()
+    _poller.join()
+    _proc.returncode = os.waitstatus_to_exitcode(_status) if hasattr(os, 'waitstatus_to_exitcode') else (_status >> 8)
+    _wall = time.time() - _start
+
+    _stages = None
+    if profile:
+        _stages = read_profile(_errfile)
+        _errfile.close()
+
+    return {
+        'lines': _lines,
+        'wall_s': _wall,
+        'cpu_s': _ru.ru_utime + _ru.ru_stime,
+        'maxrss_kb': _hwm[0],
+        'rc': _proc.returncode,
+        'stages': _stages,
+    }
+
+
+def bench(tool, cmd, filename, sr, runs=1, profile=False):
+    _samples = os.path.getsize(filename) // 8  # complex float32
+
+    _best = None
+    for _i in range(runs):
+        _r = run_one(cmd, profile=profile)
+        if _best is None or _r['cpu_s'] < _best['cpu_s']:
+            _best = _r
+
+    _res = {
+        'tool': tool,
+        'file': os.path.basename(filename),
+        'sample_rate': sr,
+        'samples': _samples,
+        'wall_s': round(_best['wall_s'], 4),
+        'cpu_s': round(_best['cpu_s'], 4),
+        'samples_per_s': round(_samples/_best['cpu_s'], 1) if _best['cpu_s'] > 0 else None,
+        'realtime': round(_samples/float(sr)/_best['cpu_s'], 2) if _best['cpu_s'] > 0 else None,
+        'maxrss_kb': _best['maxrss_kb'],
+        'rc': _best['rc'],
+    }
+    _out = [_t for (_t, _line) in _best['lines'] if not _line.startswith('IF:')]
+    _res['first_out_s'] = round(_out[0], 4) if _out else None
+
+    if tool == 'dft_detect':
+        # -v -c: "IF: <sr>" (--IQ decimates to the next divisor of sr above 48k),
+        # then "sample: <pos>" followed by "TYPE: score , ofs" for each hit
+        _pos = None
+        _if_sr = sr
+        _hits = []
+        for (_t, _line) in _best['lines']:
+            if _line.startswith('IF:'):
+                _if_sr = int(_line.split(':')[1])
+            elif _line.startswith('sample:'):
+                if _pos is None:
+                    _pos = int(_line.split(':')[1])
+            elif ':' in _line:
+                _hits.append(_line.split(':')[0])
+        _res['frames'] = len(_hits)
+        _res['detected'] = max(set(_hits), key=_hits.count) if _hits else None
+        _res['if_rate'] = _if_sr
+        _res['latency_s'] = round(_pos/float(_if_sr), 3) if _pos is not None else None
+    else:
+        _res['frames'] = len([_l for (_t, _l) in _best['lines'] if _l.startswith('{')])
+
+    _res['cpu_per_frame_ms'] = round(1e3*_best['cpu_s']/_res['frames'], 3) if _res['frames'] > 0 else None
+
+    if _best['stages'] is not None:
+        _res['stages_s'] = {_k: round(_v, 4) for (_k, _v) in _best['stages'].items()}
+
+    return _res
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-f", "--files", type=str, default="./generated/*.bin", help="Glob-path to files to run over.")
+    parser.add_argument("--snr", type=str, default=None, help="Comma separated list of Eb/No values to use, e.g. 10,12.5,15 (default: all)")
+    parser.add_argument("--tools", type=str, default=None, help="Comma separated list of tools to run (default: dft_detect and all decoders)")
+    parser.add_argument("--bin", type=str, default=None, help="Directory containing the binaries (default: ../ then the build tree)")
+    parser.add_argument("--runs", type=int, default=1, help="Runs per file, best CPU time is reported.")
+    parser.add_argument("-t", "--time", type=int, default=0, help="dft_detect time limit / sec (default: whole file)")
+    parser.add_argument("-o", "--out", type=str, default=None, help="Append JSON lines to file (default: stdout)")
+    parser.add_argument("--profile", action="store_true", default=False, help="Per-stage CPU time of the demod/mod decoders (--profile=json)")
+    args = parser.parse_args()
+
+    _snrs = [float(_s) for _s in args.snr.split(',')] if args.snr else None
+    _tools = args.tools.split(',') if args.tools else None
+
+    _file_list = sorted(glob.glob(args.files))
+    if len(_file_list) == 0:
+        print("No files found matching supplied path.", file=sys.stderr)
+        sys.exit(1)
+
+    _out = open(args.out, 'a') if args.out else sys.stdout
+
+    for _file in _file_list:
+        (_type, _sr, _snr) = sample_info(_file)
+        if _snrs is not None and _snr not in _snrs:
+            continue
+
+        _jobs = [('dft_detect', DETECT_OPTS + (" -t %d" % args.time if args.time > 0 else ""))]
+        if _type is not None:
+            _jobs.append(tuple(DECODERS[_type]))
+            _jobs += [tuple(_d) for _d in ALT_DECODERS.get(_type, [])]
+
+        for (_tool, _opts) in _jobs:
+            if _tools is not None and _tool not in _tools:
+                continue
+            _binary = find_binary(_tool, args.bin)
+            if _binary is None:
+                print("Skipping %s: binary not found." % _tool, file=sys.stderr)
+                continue
+
+            _profile = args.profile and _tool in PROFILE_TOOLS
+            if _profile:
+                _opts += " --profile=json"
+
+            _cmd = [_binary] + _opts.split() + ['-', str(_sr), '32', _file]
+            _res = bench(_tool, _cmd, _file, _sr, runs=args.runs, profile=_profile)
+            _res['type'] = _type
+            _res['snr'] = _snr
+
+            _out.write(json.dumps(_res) + "\n")
+            _out.flush()
+
+            print("%-12s %-32s %8.1f ksps %6.1fx rt  frames %4d  %8s ms/frame  rss %6d kB  latency %s" % (
+                _tool, _res['file'], (_res['samples_per_s'] or 0)/1e3, _res['realtime'] or 0, _res['frames'],
+                _res['cpu_per_frame_ms'], _res['maxrss_kb'],
+                _res.get('latency_s', _res['first_out_s'])), file=sys.stderr)
+            if 'stages_s' in _res:
+                print("%-12s %s" % ('', "  ".join("%s %.3fs" % (_k, _v) for (_k, _v) in _res['stages_s'].items())), file=sys.stderr)
+
+    if args.out:
+        _out.close()
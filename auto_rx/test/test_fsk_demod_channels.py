@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+#
+#   fsk_demod multi-channel test: two interleaved cs16 2FSK channels, one with a drifting
+#   symbol clock. Checks that fsk_demod -C 2 runs through, and that each channel's output
+#   is identical to a single-channel run on that channel.
+#
+#   Usage: python3 test_fsk_demod_channels.py [--fsk_demod ../fsk_demod] [--seconds 30] [--ppm 1000]
+#
+#   Released under GNU GPL v3 or later
+#
+import argparse
+import math
+import os
+import random
+import struct
+import subprocess
+import sys
+import tempfile
+
+
+FS = 48000
+RS = 4800
+TONE_SPACING = 4800
+
+
+def generate_channel(seconds, ppm, seed):
+    """ cs16 samples (list of (i,q)) of a random 2FSK bit stream, symbol clock offset by ppm """
+    rng = random.Random(seed)
+    _rs = RS * (1.0 + ppm * 1e-6)
+    _n = int(seconds * FS)
+    _samples = []
+    _phase = 0.0
+    _bit = 0
+    _sym = -1
+    for _i in range(_n):
+        _s = int(_i * _rs / FS)
+        if _s != _sym:
+            _sym = _s
+            _bit = rng.getrandbits(1)
+        _f = (TONE_SPACING / 2) * (1 if _bit else -1)
+        _phase += 2 * math.pi * _f / FS
+        _i_val = 8000 * math.cos(_phase) + rng.gauss(0, 800)
+        _q_val = 8000 * math.sin(_phase) + rng.gauss(0, 800)
+        _samples.append((int(_i_val), int(_q_val)))
+    return _samples
+
+
+def write_cs16(filename, channels):
+    with open(filename, "wb") as _f:
+        for _frame in zip(*channels):
+            for _iq in _frame:
+                _f.write(struct.pack("<hh", *_iq))
+
+
+def run_fsk_demod(fsk_demod, nch, infile, outfile):
+    _cmd = [fsk_demod, "--cs16", "-s"]
+    if nch > 1:
+        _cmd += ["-C", str(nch)]
+    _cmd += ["2", str(FS), str(RS), infile, outfile]
+    return subprocess.call(_cmd, stderr=subprocess.DEVNULL)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--fsk_demod", type=str, default="../fsk_demod", help="fsk_demod binary")
+    parser.add_argument("--seconds", type=float, default=30.0, help="Test signal length (s)")
+    parser.add_argument("--ppm", type=float, default=1000.0, help="Symbol clock offset of channel 1 (ppm)")
+    args = parser.parse_args()
+
+    _tmp = tempfile.mkdtemp()
+    _chans = [generate_channel(args.seconds, 0.0, 1), generate_channel(args.seconds, args.ppm, 2)]
+
+    _multi = os.path.join(_tmp, "multi.cs16")
+    write_cs16(_multi, _chans)
+    _rc = run_fsk_demod(args.fsk_demod, 2, _multi, os.path.join(_tmp, "multi_%d.bin"))
+    if _rc != 0:
+        print(f"FAIL: fsk_demod -C 2 exited with {_rc}")
+        sys.exit(1)
+
+    _ok = True
+    for _ch in range(2):
+        _single = os.path.join(_tmp, f"single_{_ch}.cs16")
+        write_cs16(_single, [_chans[_ch]])
+        _rc = run_fsk_demod(args.fsk_demod, 1, _single, os.path.join(_tmp, f"single_{_ch}.bin"))
+        _a = open(os.path.join(_tmp, f"multi_{_ch}.bin"), "rb").read()
+        _b = open(os.path.join(_tmp, f"single_{_ch}.bin"), "rb").read()
+        if _rc != 0 or _a != _b or len(_a) == 0:
+            print(f"FAIL: channel {_ch}: {len(_a)} bytes multi-channel, {len(_b)} bytes single-channel (rc {_rc})")
+            _ok = False
+        else:
+            print(f"OK: channel {_ch}: {len(_a)} bytes")
+
+    for _f in os.listdir(_tmp):
+        os.remove(os.path.join(_tmp, _f))
+    os.rmdir(_tmp)
+
+    sys.exit(0 if _ok else 1)
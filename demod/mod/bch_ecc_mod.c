@@ -1011,3 +1011,84 @@ int rs_decode_bch_gf2t2(RS_t *RS, ui8_t cw[], ui8_t *err_pos, ui8_t *err_val) {
     return errors;
 }
 
+
+/* --------------------------------------------------------------------------------------------- */
+/*
+ * bin.BCH(63,51), t=2, bit-packed
+ *   all 1+63+63*62/2 patterns of weight <= 2 have different syndromes,
+ *   so the syndrome table decodes the same as rs_decode_bch_gf2t2().
+ */
+
+static ui32_t bch63_syndrome(BCH63_t *bch, ui64_t cw) {
+    ui32_t r = 0;
+    int k;
+    for (k = 56; k >= 0; k -= 8) {  // r = (r X^8 + byte) mod g
+        r = (((r & 0xF) << 8) | ((cw >> k) & 0xFF)) ^ bch->red[r >> 4];
+    }
+    return r;
+}
+
+INCSTAT
+int bch63_init(BCH63_t *bch) {
+    ui32_t r, s, s1[63];
+    int i, j, k;
+
+    for (k = 0; k < 256; k++) {
+        r = (ui32_t)k << 12;
+        for (i = 19; i >= 12; i--) {
+            if (r & (1u << i)) r ^= BCH63_G << (i-12);
+        }
+        bch->red[k] = r;
+    }
+
+    for (s = 0; s < 4096; s++) bch->err[s] = BCH63_NOCORR;
+    bch->err[0] = 0;
+    for (i = 0; i < 63; i++) {
+        s1[i] = bch63_syndrome(bch, 1ULL << i);
+        bch->err[s1[i]] = i | (1 << 12);
+    }
+    for (i = 0; i < 63; i++) {
+        for (j = i+1; j < 63; j++) {
+            s = s1[i] ^ s1[j];
+            if (bch->err[s] != BCH63_NOCORR) return -1;
+            bch->err[s] = i | (j << 6) | (2 << 12);
+        }
+    }
+
+    return 0;
+}
+
+INCSTAT
+int bch63_encode(BCH63_t *bch, ui64_t *cw) {
+    *cw &= ~0xFFFULL;
+    *cw |= bch63_syndrome(bch, *cw);
+    return 0;
+}
+
+// errors: 0..2 corrected, -1 uncorrectable
+INCSTAT
+int bch63_decode(BCH63_t *bch, ui64_t *cw, ui8_t *err_pos) {
+    ui32_t e = bch->err[bch63_syndrome(bch, *cw)];
+    int errors;
+
+    if (e == BCH63_NOCORR) return -1;
+
+    errors = e >> 12;
+    if (errors > 0) { err_pos[0] = e & 0x3F;        *cw ^= 1ULL << err_pos[0]; }
+    if (errors > 1) { err_pos[1] = (e >> 6) & 0x3F; *cw ^= 1ULL << err_pos[1]; }
+
+    return errors;
+}
+
+// decode n codewords in place, returns the number of uncorrectable blocks
+INCSTAT
+int bch63_decode_blocks(BCH63_t *bch, ui64_t cw[], int n, int errors[]) {
+    ui8_t err_pos[2];
+    int i, fails = 0;
+
+    for (i = 0; i < n; i++) {
+        errors[i] = bch63_decode(bch, cw+i, err_pos);
+        fails += (errors[i] < 0);
+    }
+    return fails;
+}
@@ -14,7 +14,9 @@
     #define INCSTAT static
 #else
     typedef unsigned char  ui8_t;
+    typedef unsigned short ui16_t;
     typedef unsigned int  ui32_t;
+    typedef unsigned long long ui64_t;
     #define INCSTAT
 #endif
 
@@ -81,6 +83,17 @@ static RS_t BCH64 = {  63,  2, 12,  51, 1, 1, 1, {0}, {0} };
 static RS_t RS16ccsds = { 15, 2, 4, 11, 6, 1, 1, {0}, {0} };
 
 
+// bin.BCH(63,51), t=2, bit-packed: bit i of ui64_t = coefficient of X^i,
+// parity in bits 0..11 (systematic), syndrome = cw mod g(X)
+#define BCH63_G     0x1539  // g(X)=X^12+X^10+X^8+X^5+X^4+X^3+1
+#define BCH63_NOCORR 0xFFFF
+
+typedef struct {
+    ui16_t red[256];    // (k X^12) mod g(X)
+    ui16_t err[4096];   // syndrome -> pos1 | pos2<<6 | #errors<<12, BCH63_NOCORR
+} BCH63_t;
+
+
 #ifndef INCLUDESTATIC
 
 int rs_init_RS255(RS_t *RS);
@@ -93,5 +106,10 @@ int rs_decode(RS_t *RS, ui8_t cw[], ui8_t *err_pos, ui8_t *err_val);
 int rs_decode_ErrEra(RS_t *RS, ui8_t cw[], int nera, ui8_t era_pos[], ui8_t *err_pos, ui8_t *err_val);
 int rs_decode_bch_gf2t2(RS_t *RS, ui8_t cw[], ui8_t *err_pos, ui8_t *err_val);
 
+int bch63_init(BCH63_t *bch);
+int bch63_encode(BCH63_t *bch, ui64_t *cw);
+int bch63_decode(BCH63_t *bch, ui64_t *cw, ui8_t *err_pos);
+int bch63_decode_blocks(BCH63_t *bch, ui64_t cw[], int n, int errors[]);
+
 #endif
 
@@ -0,0 +1,160 @@
+/*
+ *  packed bits
+ *    bit n of a stream in byte n/8, msb first (bit order as received)
+ *    raw chips (2 chips per bit: Manchester, biphase) in ui64_t words, msb first
+ */
+
+
+#ifndef BITS_MOD_H
+#define BITS_MOD_H
+
+#ifndef INTTYPES
+#define INTTYPES
+typedef unsigned char  ui8_t;
+typedef unsigned short ui16_t;
+typedef unsigned int   ui32_t;
+typedef unsigned long long ui64_t;
+typedef char  i8_t;
+typedef short i16_t;
+typedef int   i32_t;
+#endif
+
+
+// bits[pos..pos+len-1] -> value, first bit = msb ; len <= 57
+static inline ui64_t bits_get(const ui8_t *bits, int pos, int len) {
+    int i;
+    int nb = ((pos & 7) + len + 7) >> 3;
+    ui64_t val = 0;
+
+    bits += pos >> 3;
+    for (i = 0; i < nb; i++) val = (val << 8) | bits[i];
+    val >>= 8*nb - (pos & 7) - len;
+    if (len < 64) val &= (1ULL << len) - 1;
+    return val;
+}
+
+// value -> bits[pos..pos+len-1] ; len <= 57
+static inline void bits_put(ui8_t *bits, int pos, int len, ui64_t val) {
+    int i;
+    int nb = ((pos & 7) + len + 7) >> 3;
+    int sh = 8*nb - (pos & 7) - len;
+    ui64_t msk = ((len < 64) ? (1ULL << len) - 1 : ~0ULL) << sh;
+    ui64_t w = 0;
+
+    bits += pos >> 3;
+    for (i = 0; i < nb; i++) w = (w << 8) | bits[i];
+    w = (w & ~msk) | ((val << sh) & msk);
+    for (i = nb-1; i >= 0; i--) { bits[i] = w & 0xFF; w >>= 8; }
+}
+
+// bits[pos] = bit
+static inline void bits_set(ui8_t *bits, int pos, int bit) {
+    ui8_t m = 0x80 >> (pos & 7);
+    if (bit & 1) bits[pos >> 3] |=  m;
+    else         bits[pos >> 3] &= ~m;
+}
+
+static inline int bits_bit(const ui8_t *bits, int pos) {
+    return (bits[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+
+static inline int bits_popc64(ui64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Hamming distance a[apos..apos+len-1] <-> b[bpos..bpos+len-1]
+static inline int bits_hdist(const ui8_t *a, int apos, const ui8_t *b, int bpos, int len) {
+    int d = 0;
+    while (len > 0) {
+        int n = len < 56 ? len : 56;
+        d += bits_popc64(bits_get(a, apos, n) ^ bits_get(b, bpos, n));
+        apos += n; bpos += n; len -= n;
+    }
+    return d;
+}
+
+static inline ui8_t bits_rev8(ui8_t b) {
+    b = (b >> 4) | (b << 4);
+    b = ((b >> 2) & 0x33) | ((b & 0x33) << 2);
+    b = ((b >> 1) & 0x55) | ((b & 0x55) << 1);
+    return b;
+}
+
+// bits[pos..pos+8n-1] -> n bytes, first bit = msb (big endian)
+static inline void bits2bytes_msb(const ui8_t *bits, int pos, ui8_t *bytes, int n) {
+    int i;
+    if ((pos & 7) == 0) {
+        for (i = 0; i < n; i++) bytes[i] = bits[(pos >> 3) + i];
+    }
+    else {
+        for (i = 0; i < n; i++) bytes[i] = bits_get(bits, pos + 8*i, 8);
+    }
+}
+
+// bits[pos..pos+8n-1] -> n bytes, first bit = lsb (little endian)
+static inline void bits2bytes_lsb(const ui8_t *bits, int pos, ui8_t *bytes, int n) {
+    int i;
+    bits2bytes_msb(bits, pos, bytes, n);
+    for (i = 0; i < n; i++) bytes[i] = bits_rev8(bytes[i]);
+}
+
+// ASCII '0'/'1' string -> bits[pos..], returns number of bits
+static inline int bits_from_str(ui8_t *bits, int pos, const char *str) {
+    int n = 0;
+    while (str[n]) { bits_set(bits, pos+n, str[n] & 1); n++; }
+    return n;
+}
+
+// append chip/bit at position pos (ui64_t words, msb first)
+static inline void chips_put(ui64_t *chips, int pos, int bit) {
+    if ((pos & 63) == 0) chips[pos >> 6] = 0;
+    chips[pos >> 6] |= (ui64_t)(bit & 1) << (63 - (pos & 63));
+}
+
+// even bits of x (bit 2k -> bit k)
+static inline ui32_t bits_even64(ui64_t x) {
+    x &= 0x5555555555555555ULL;
+    x = (x | (x >>  1)) & 0x3333333333333333ULL;
+    x = (x | (x >>  2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >>  4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >>  8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return (ui32_t)x;
+}
+
+// biphase-S (Meisei): 64 chips -> 32 bits, 1: no transition in the bit (chips equal), 0: transition
+static inline ui32_t biphase_s64(ui64_t chips) {
+    return bits_even64(~(chips ^ (chips >> 1)));
+}
+
+// Manchester1 (1->10, 0->01): 64 chips -> 32 bits (first chip),
+// *err: bits with equal chips (no valid symbol)
+static inline ui32_t manchester64(ui64_t chips, ui32_t *err) {
+    if (err) *err = bits_even64(~(chips ^ (chips >> 1)));
+    return bits_even64(chips >> 1);
+}
+
+// biphase-S: nchips raw chips -> nchips/2 bits at bits[pos..]
+static inline int biphase_s_dec(const ui64_t *chips, int nchips, ui8_t *bits, int pos) {
+    int n;
+    int nw = nchips / 64;
+    int r  = nchips % 64;
+
+    for (n = 0; n < nw; n++) {
+        bits_put(bits, pos+32*n, 32, biphase_s64(chips[n]));
+    }
+    if (r/2 > 0) {
+        bits_put(bits, pos+32*nw, r/2, biphase_s64(chips[nw]) >> (32 - r/2));
+    }
+    return nchips/2;
+}
+
+#endif
+
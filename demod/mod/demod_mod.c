@@ -16,72 +16,179 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <assert.h>
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 #define FM_GAIN (0.8)
 
 /* ------------------------------------------------------------------------------------ */
 
+// --profile: time per stage (CLOCK_MONOTONIC), stack of nested stages;
+// periodic report to stderr (text or json line), final report at exit.
+// Each segment between two clock reads is charged the measured hook cost prf.c.
+// f32buf_sample() runs for every sample and is timed for 1 of PRF_SMP samples only,
+// alternating between the whole call (time per sample) and its stages (read, decim,
+// lpIQ, demod, lpFM: shares). The time of the untimed samples is moved out of the
+// enclosing stages (e.g. softbit) in prf_report().
 
-#ifndef EXT_FSK
+#define PRF_DEPTH 8
+#define PRF_SMP  32
 
-static void raw_dft(dft_t *dft, float complex *Z) {
-    int s, l, l2, i, j, k;
-    float complex  w1, w2, T;
+typedef struct {
+    int on;
+    int jsn;
+    double intv;
+    double t0;
+    double t;
+    double t_rep;
+    double c;             // hook cost per segment
+    int sp;
+    int stack[PRF_DEPTH];
+    double sec[PRF_N];
+    ui32_t cnt[PRF_N];
+    // f32buf_sample()
+    int smp;              // 1: timed call, 2: timed stages
+    ui32_t n_smp;
+    ui32_t smp_n;         // timed calls
+    ui32_t smp_n2;        // timed stages
+    double smp_t;
+    double smp_sec[PRF_N];
+    ui32_t smp_cnt[PRF_N];
+    ui32_t smp_skip[PRF_N];  // untimed calls per enclosing stage
+} prf_t;
+static prf_t prf;
+
+static char *prf_name[PRF_N] = { "other", "read", "decim", "lpIQ", "demod", "lpFM", "corrDFT", "softbit", "ecc", "output" };
+
+static double prf_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
 
-    j = 1;
-    for (i = 1; i < dft->N; i++) {
-        if (i < j) {
-            T = Z[j-1];
-            Z[j-1] = Z[i-1];
-            Z[i-1] = T;
-        }
-        k = dft->N/2;
-        while (k < j) {
-            j = j - k;
-            k = k/2;
+// close the current segment
+static void prf_seg(double now) {
+    int stg = prf.stack[prf.sp];
+    if (prf.smp == 2) prf.smp_sec[stg] += now - prf.t - prf.c;
+    else              prf.sec[stg]     += now - prf.t - prf.c;
+    prf.t = now;
+}
+
+static void prf_report(double now) {
+    int j;
+    double T = now - prf.t0;
+    double cpu = clock()/(double)CLOCKS_PER_SEC;
+    double sec[PRF_N];
+    ui32_t cnt[PRF_N];
+    double t_smp = 0.0, t_stg = 0.0;
+    ui32_t n = 0;
+
+    if (T <= 0.0) return;
+
+    // samples: n * time per call, split by the stage shares
+    for (j = 0; j < PRF_N; j++) { n += prf.smp_skip[j]; t_stg += prf.smp_sec[j]; }
+    n += prf.smp_n + prf.smp_n2;
+    if (prf.smp_n > 0) t_smp = prf.smp_t / prf.smp_n;
+    for (j = 0; j < PRF_N; j++) {
+        sec[j] = prf.sec[j] - prf.smp_skip[j]*t_smp;
+        if (t_stg > 0.0) sec[j] += n*t_smp * prf.smp_sec[j]/t_stg;
+        if (sec[j] < 0.0) sec[j] = 0.0;
+        cnt[j] = prf.cnt[j];
+        if (prf.smp_n2 > 0) cnt[j] += prf.smp_cnt[j] * (double)n/prf.smp_n2 + 0.5;
+    }
+
+    if (prf.jsn) {
+        fprintf(stderr, "{ \"type\": \"profile\", \"time\": %.3f, \"cpu\": %.3f, \"stages\": {", T, cpu);
+        for (j = 0; j < PRF_N; j++) {
+            fprintf(stderr, "%s \"%s\": { \"sec\": %.4f, \"calls\": %u }", j ? "," : "", prf_name[j], sec[j], cnt[j]);
         }
-        j = j + k;
+        fprintf(stderr, " } }\n");
     }
-
-    for (s = 0; s < dft->LOG2N; s++) {
-        l2 = 1 << s;
-        l  = l2 << 1;
-        w1 = (float complex)1.0;
-        w2 = dft->ew[s]; // cexp(-I*M_PI/(float)l2)
-        for (j = 1; j <= l2; j++) {
-            for (i = j; i <= dft->N; i += l) {
-                k = i + l2;
-                T = Z[k-1] * w1;
-                Z[k-1] = Z[i-1] - T;
-                Z[i-1] = Z[i-1] + T;
-            }
-            w1 = w1 * w2;
+    else {
+        fprintf(stderr, "profile: %.1fs (cpu %.1fs)", T, cpu);
+        for (j = 0; j < PRF_N; j++) {
+            if (sec[j] > 0.0) fprintf(stderr, "  %s %.1f%%", prf_name[j], 100.0*sec[j]/T);
         }
+        fprintf(stderr, "\n");
     }
+    prf.t_rep = now;
 }
 
-static void cdft(dft_t *dft, float complex *z, float complex *Z) {
-    int i;
-    for (i = 0; i < dft->N; i++)  Z[i] = z[i];
-    raw_dft(dft, Z);
+static void prf_exit(void) {
+    prf_seg(prf_now());
+    prf_report(prf.t);
 }
 
-static void rdft(dft_t *dft, float *x, float complex *Z) {
+int prf_init(int jsn, float intv) {
     int i;
-    for (i = 0; i < dft->N; i++)  Z[i] = (float complex)x[i];
-    raw_dft(dft, Z);
+    double t;
+    memset(&prf, 0, sizeof(prf));
+    prf.jsn = jsn;
+    prf.intv = intv > 0 ? intv : 10.0;
+    prf.stack[0] = PRF_OTHER;
+    prf.on = 1;
+    // hook cost: 1000 empty stages (2000 segments)
+    prf.t = prf_now();
+    prf.t_rep = prf.t;
+    t = prf.t;
+    for (i = 0; i < 1000; i++) { prf_enter(PRF_OTHER); prf_leave(); }
+    prf.c = (prf_now() - t) / 2001.0;
+    memset(prf.sec, 0, sizeof(prf.sec));
+    memset(prf.cnt, 0, sizeof(prf.cnt));
+    prf.t0 = prf_now();
+    prf.t = prf.t0;
+    prf.t_rep = prf.t0;
+    atexit(prf_exit);
+    return 0;
 }
 
-static void Nidft(dft_t *dft, float complex *Z, float complex *z) {
-    int i;
-    for (i = 0; i < dft->N; i++)  z[i] = conj(Z[i]);
-    raw_dft(dft, z);
-    // idft():
-    // for (i = 0; i < dft->N; i++)  z[i] = conj(z[i])/(float)dft->N; // hier: z reell
+static void prf_push(int stg) {
+    assert(prf.sp < PRF_DEPTH-1);
+    prf_seg(prf_now());
+    prf.sp += 1;
+    prf.stack[prf.sp] = stg;
 }
 
+static void prf_pop(void) {
+    assert(prf.sp > 0);
+    prf_seg(prf_now());
+    prf.sp -= 1;
+}
+
+void prf_enter(int stg) {
+    if (!prf.on) return;
+    prf_push(stg);
+    prf.cnt[stg] += 1;
+}
+
+void prf_leave(void) {
+    if (!prf.on) return;
+    prf_pop();
+    if (prf.t - prf.t_rep >= prf.intv) prf_report(prf.t);
+}
+
+// stages inside f32buf_sample()
+static void prf_enter_smp(int stg) {
+    if (prf.smp == 2) {
+        prf_push(stg);
+        prf.smp_cnt[stg] += 1;
+    }
+}
+static void prf_leave_smp(void) {
+    if (prf.smp == 2) prf_pop();
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+
+#ifndef EXT_FSK
+
+
+
 static float bin2freq0(dft_t *dft, int k) {
     float fq = dft->sr * k / /*(float)*/dft->N;
     if (fq >= dft->sr/2.0) fq -= dft->sr;
@@ -113,34 +220,6 @@ static int max_bin(dft_t *dft, float complex *Z) {
     return kmax;
 }
 
-static int dft_window(dft_t *dft, int w) {
-    int n;
-
-    if (w < 0 || w > 3) return -1;
-
-    for (n = 0; n < dft->N2; n++) {
-        switch (w)
-        {
-            case 0: // (boxcar)
-                    dft->win[n] = 1.0;
-                    break;
-            case 1: // Hann
-                    dft->win[n] = 0.5 * ( 1.0 - cos(_2PI*n/(float)(dft->N2-1)) );
-                    break ;
-            case 2: // Hamming
-                    dft->win[n] = 25/46.0 - (1.0 - 25/46.0)*cos(_2PI*n / (float)(dft->N2-1));
-                    break ;
-            case 3: // Blackmann
-                    dft->win[n] =  7938/18608.0
-                                 - 9240/18608.0*cos(_2PI*n / (float)(dft->N2-1))
-                                 + 1430/18608.0*cos(4*M_PI*n / (float)(dft->N2-1));
-                    break ;
-        }
-    }
-    while (n < dft->N) dft->win[n++] = 0.0;
-
-    return 0;
-}
 
 
 /* ------------------------------------------------------------------------------------ */
@@ -302,210 +381,7 @@ static int getCorrDFT(dsp_t *dsp, float thres) {
 
 /* ------------------------------------------------------------------------------------ */
 
-static int findstr(char *buff, char *str, int pos) {
-    int i;
-    for (i = 0; i < 4; i++) {
-        if (buff[(pos+i)%4] != str[i]) break;
-    }
-    return i;
-}
-
-int read_wav_header(pcm_t *pcm, FILE *fp) {
-    char txt[4+1] = "\0\0\0\0";
-    unsigned char dat[4];
-    int byte, p=0;
-    int sample_rate = 0, bits_sample = 0, channels = 0;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "RIFF", 4) && strncmp(txt, "RF64", 4)) return -1;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    // pos_WAVE = 8L
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "WAVE", 4))  return -1;
-
-    // pos_fmt = 12L
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "fmt ", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    channels = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    //byte = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    bits_sample = dat[0] + (dat[1] << 8);
-
-    // pos_dat = 36L + info
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "data", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-
-
-    fprintf(stderr, "sample_rate: %d\n", sample_rate);
-    fprintf(stderr, "bits       : %d\n", bits_sample);
-    fprintf(stderr, "channels   : %d\n", channels);
-
-    if (pcm->sel_ch < 0  ||  pcm->sel_ch >= channels) pcm->sel_ch = 0; // default channel: 0
-    //fprintf(stderr, "channel-In : %d\n", pcm->sel_ch+1); // nur wenn nicht IQ
-
-    if (bits_sample != 8 && bits_sample != 16 && bits_sample != 32) return -1;
-
-    if (sample_rate == 900001) sample_rate -= 1;
-
-    pcm->sr  = sample_rate;
-    pcm->bps = bits_sample;
-    pcm->nch = channels;
-
-    return 0;
-}
-
-
-static int f32read_sample(dsp_t *dsp, float *s) {
-    int i;
-    unsigned int word = 0;
-    short *b = (short*)&word;
-    float *f = (float*)&word;
-
-    for (i = 0; i < dsp->nch; i++) {
-
-        if (fread( &word, dsp->bps/8, 1, dsp->fp) != 1) return EOF;
-
-        if (i == dsp->ch) {  // i = 0: links bzw. mono
-            //if (bits_sample ==  8)  sint = b-128;   // 8bit: 00..FF, centerpoint 0x80=128
-            //if (bits_sample == 16)  sint = (short)b;
-
-            if (dsp->bps == 32) {
-                *s = *f;
-            }
-            else {
-                if (dsp->bps ==  8) { *b -= 128; }
-                *s = *b/128.0;
-                if (dsp->bps == 16) { *s /= 256.0; }
-            }
-        }
-    }
-
-    return 0;
-}
-
-typedef struct {
-    double sumIQx;
-    double sumIQy;
-    float avgIQx;
-    float avgIQy;
-    float complex avgIQ;
-    ui32_t cnt;
-    ui32_t maxcnt;
-    ui32_t maxlim;
-} iq_dc_t;
-static iq_dc_t IQdc;
-
-static int f32read_csample(dsp_t *dsp, float complex *z) {
-
-    float x, y;
-
-    if (dsp->bps == 32) { //float32
-        float f[2];
-        if (fread( f, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = f[0];
-        y = f[1];
-    }
-    else if (dsp->bps == 16) { //int16
-        short b[2];
-        if (fread( b, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = b[0]/32768.0;
-        y = b[1]/32768.0;
-    }
-    else {  // dsp->bps == 8   //uint8
-        ui8_t u[2];
-        if (fread( u, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = (u[0]-128)/128.0;
-        y = (u[1]-128)/128.0;
-    }
 
-    *z = x + I*y;
-
-    // IQ-dc removal optional
-    if (dsp->opt_iqdc) {
-        *z -= IQdc.avgIQ;
-
-        IQdc.sumIQx += x;
-        IQdc.sumIQy += y;
-        IQdc.cnt += 1;
-        if (IQdc.cnt == IQdc.maxcnt) {
-            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
-            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
-            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
-            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
-            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
-        }
-    }
-
-    return 0;
-}
-
-static int f32read_cblock(dsp_t *dsp) {
-
-    int n;
-    int len;
-    float x, y;
-    ui8_t s[4*2*dsp->decM]; //uin8,int16,float32
-    ui8_t *u = (ui8_t*)s;
-    short *b = (short*)s;
-    float *f = (float*)s;
-
-
-    len = fread( s, dsp->bps/8, 2*dsp->decM, dsp->fp) / 2;
-
-    //for (n = 0; n < len; n++) dsp->decMbuf[n] = (u[2*n]-128)/128.0 + I*(u[2*n+1]-128)/128.0;
-    // u8: 0..255, 128 -> 0V
-    for (n = 0; n < len; n++) {
-        if (dsp->bps == 8) { //uint8
-            x = (u[2*n  ]-128)/128.0;
-            y = (u[2*n+1]-128)/128.0;
-        }
-        else if (dsp->bps == 16) { //int16
-            x = b[2*n  ]/32768.0;
-            y = b[2*n+1]/32768.0;
-        }
-        else { // dsp->bps == 32   //float32
-            x = f[2*n];
-            y = f[2*n+1];
-        }
-
-        // baseband: IQ-dc removal mandatory
-        dsp->decMbuf[n] = (x-IQdc.avgIQx) + I*(y-IQdc.avgIQy);
-
-        IQdc.sumIQx += x;
-        IQdc.sumIQy += y;
-        IQdc.cnt += 1;
-        if (IQdc.cnt == IQdc.maxcnt) {
-            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
-            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
-            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
-            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
-            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
-        }
-    }
-
-    return len;
-}
 
 /*
 static int get_SNR_rs41(dsp_t *dsp) {
@@ -545,181 +421,9 @@ static int get_SNR_rs41(dsp_t *dsp) {
 // decimate lowpass
 static float *ws_dec;
 
-static double sinc(double x) {
-    double y;
-    if (x == 0) y = 1;
-    else y = sin(M_PI*x)/(M_PI*x);
-    return y;
-}
-
-static int lowpass_init(float f, int taps, float **pws) {
-    double *h, *w;
-    double norm = 0;
-    int n;
-    float *ws = NULL;
-
-    if (taps % 2 == 0) taps++; // odd/symmetric
 
-    if ( taps < 1 ) taps = 1;
-
-    h = (double*)calloc( taps+1, sizeof(double)); if (h == NULL) return -1;
-    w = (double*)calloc( taps+1, sizeof(double)); if (w == NULL) return -1;
-    ws = (float*)calloc( 2*taps+1, sizeof(float)); if (ws == NULL) return -1;
-
-    for (n = 0; n < taps; n++) {
-        w[n] = 7938/18608.0 - 9240/18608.0*cos(_2PI*n/(taps-1)) + 1430/18608.0*cos(4*M_PI*n/(taps-1)); // Blackmann
-        h[n] = 2*f*sinc(2*f*(n-(taps-1)/2));
-        ws[n] = w[n]*h[n];
-        norm += ws[n]; // 1-norm
-    }
-    for (n = 0; n < taps; n++) {
-        ws[n] /= norm; // 1-norm
-    }
-
-    for (n = 0; n < taps; n++) ws[taps+n] = ws[n]; // duplicate/unwrap
-
-    *pws = ws;
-
-    free(h); h = NULL;
-    free(w); w = NULL;
-
-    return taps;
-}
 
-
-static int lowpass_update(float f, int taps, float *ws) {
-    double *h, *w;
-    double norm = 0;
-    int n;
-
-    if (taps % 2 == 0) taps++; // odd/symmetric
-
-    if ( taps < 1 ) taps = 1;
-
-    h = (double*)calloc( taps+1, sizeof(double)); if (h == NULL) return -1;
-    w = (double*)calloc( taps+1, sizeof(double)); if (w == NULL) return -1;
-
-    for (n = 0; n < taps; n++) {
-        w[n] = 7938/18608.0 - 9240/18608.0*cos(_2PI*n/(taps-1)) + 1430/18608.0*cos(4*M_PI*n/(taps-1)); // Blackmann
-        h[n] = 2*f*sinc(2*f*(n-(taps-1)/2));
-        ws[n] = w[n]*h[n];
-        norm += ws[n]; // 1-norm
-    }
-    for (n = 0; n < taps; n++) {
-        ws[n] /= norm; // 1-norm
-    }
-
-    for (n = 0; n < taps; n++) ws[taps+n] = ws[n];
-
-    free(h); h = NULL;
-    free(w); w = NULL;
-
-    return taps;
-}
-
-static float complex lowpass0(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    ui32_t n;            // sample: oldest_sample
-    double complex w = 0;
-    for (n = 0; n < taps; n++) {
-        w += buffer[(sample+n)%taps]*ws[taps-1-n];
-    }
-    return (float complex)w;
-}
-static float complex lowpass1a(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    double complex w = 0;
-    ui32_t n;
-    ui32_t S = taps-1 + (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S-n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return (float complex)w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-//static __attribute__((optimize("-ffast-math"))) float complex lowpass()
-static float complex lowpass(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;
-    int n; // -Ofast
-    int S = taps - (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-static float complex lowpass2(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;
-    int n; // -Ofast
-    int s = sample % taps;
-    int S1 = s;
-    int S1N = S1-taps;
-    int n0 = taps-s;
-    for (n = 0; n < n0; n++) {
-        w += buffer[S1+n]*ws[n];
-    }
-    for (n = n0; n < taps; n++) {
-        w += buffer[S1N+n]*ws[n];
-    }
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-static float complex lowpass0_sym(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    ui32_t n;
-    double complex w = buffer[(sample+(taps-1)/2) % taps]*ws[(taps-1)/2]; // (N+1)/2 = (N-1)/2 + 1
-    for (n = 0; n < (taps-1)/2; n++) {
-        w += (buffer[(sample+n)%taps]+buffer[(sample+taps-n-1)%taps])*ws[n];
-    }
-    return (float complex)w;
-}
-static float complex lowpass2_sym(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;
-    int n;
-    int s = sample % taps; // lpIQ
-    int SW = (taps-1)/2;
-    int B1 = s + SW;
-    int n1 = SW - s;
-    int n0 = 0;
-
-    if (s > SW) {
-        B1 -= taps;
-        n1 = -n1 - 1;
-        n0 = B1+n1+1;
-    }
-
-    w = buffer[B1]*ws[SW];
-
-    for (n = 1; n < n1+1; n++) {
-        w += (buffer[B1 + n] + buffer[B1 - n]) * ws[SW+n];
-    }
-
-    for (n = 0; n < SW-n1; n++) {
-        w += (buffer[s + n] + buffer[s-1 - n]) * ws[SW+SW-n];
-    }
-
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-
-
-static float re_lowpass0(float buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    ui32_t n;
-    double w = 0;
-    for (n = 0; n < taps; n++) {
-        w += buffer[(sample+n)%taps]*ws[taps-1-n];
-    }
-    return (float)w;
-}
-static float re_lowpass(float buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float w = 0;
-    int n;
-    int S = taps - (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return w;
-}
-
-
-int f32buf_sample(dsp_t *dsp, int inv) {
+static int _f32buf_sample(dsp_t *dsp, int inv) {
     float s = 0.0;
     float s_fm = s;
     float xneu, xalt;
@@ -732,8 +436,12 @@ int f32buf_sample(dsp_t *dsp, int inv) {
     if (dsp->opt_iq)
     {
         if (dsp->opt_iq == 5) {
-            int j;
-            if ( f32read_cblock(dsp) < dsp->decM ) return EOF;
+            int j, len;
+            prf_enter_smp(PRF_READ);
+            len = f32read_cblock(dsp);
+            prf_leave_smp();
+            if ( len < dsp->decM ) return EOF;
+            prf_enter_smp(PRF_DEC);
             for (j = 0; j < dsp->decM; j++) {
                 if (dsp->opt_nolut) {
                     double _s_base = (double)(dsp->sample_in*dsp->decM+j); // dsp->sample_dec
@@ -752,8 +460,15 @@ int f32buf_sample(dsp_t *dsp, int inv) {
             {
                 z = lowpass(dsp->decXbuffer, dsp->sample_decX, dsp->dectaps, ws_dec); // oldest sample: dsp->sample_decX
             }
+            prf_leave_smp();
+        }
+        else {
+            int ret;
+            prf_enter_smp(PRF_READ);
+            ret = f32read_csample(dsp, &z);
+            prf_leave_smp();
+            if ( ret == EOF ) return EOF;
         }
-        else if ( f32read_csample(dsp, &z) == EOF ) return EOF;
 
         if (dsp->opt_dc && !dsp->opt_nolut)
         {
@@ -763,8 +478,10 @@ int f32buf_sample(dsp_t *dsp, int inv) {
 
         // IF-lowpass
         if (dsp->opt_lp & LP_IQ) {
+            prf_enter_smp(PRF_LPIQ);
             dsp->lpIQ_buf[dsp->sample_in % dsp->lpIQtaps] = z;
             z = lowpass(dsp->lpIQ_buf, dsp->sample_in+1, dsp->lpIQtaps, dsp->ws_lpIQ);
+            prf_leave_smp();
         }
 
 
@@ -835,15 +552,21 @@ int f32buf_sample(dsp_t *dsp, int inv) {
         }
     }
     else {
-        if (f32read_sample(dsp, &s) == EOF) return EOF;
+        int ret;
+        prf_enter_smp(PRF_READ);
+        ret = f32read_sample(dsp, &s);
+        prf_leave_smp();
+        if (ret == EOF) return EOF;
         s_fm = s;
     }
 
     // FM-lowpass
     if (dsp->opt_lp & LP_FM) {
+        prf_enter_smp(PRF_LPFM);
         dsp->lpFM_buf[dsp->sample_in % dsp->lpFMtaps] = s_fm;
         s_fm = re_lowpass(dsp->lpFM_buf, dsp->sample_in+1, dsp->lpFMtaps, dsp->ws_lpFM);
         if (dsp->opt_iq < 2) s = s_fm;
+        prf_leave_smp();
     }
 
     dsp->fm_buffer[dsp->sample_in % dsp->M] = s_fm;
@@ -867,7 +590,33 @@ int f32buf_sample(dsp_t *dsp, int inv) {
     return 0;
 }
 
-static int read_bufbit(dsp_t *dsp, int symlen, char *bits, ui32_t mvp, int pos) {
+int f32buf_sample(dsp_t *dsp, int inv) {
+    int ret;
+    double t;
+
+    if (!prf.on) return _f32buf_sample(dsp, inv);
+
+    prf.cnt[PRF_DEMOD] += 1;
+    if (prf.n_smp++ % PRF_SMP) {
+        prf.smp_skip[prf.stack[prf.sp]] += 1;
+        return _f32buf_sample(dsp, inv);
+    }
+
+    prf_push(PRF_DEMOD);
+    prf.smp = (prf.n_smp / PRF_SMP) % 2 + 1;
+    t = prf.t;
+    ret = _f32buf_sample(dsp, inv);
+    prf_pop();
+    if (prf.smp == 1) {
+        prf.smp_t += prf.t - t - prf.c;
+        prf.smp_n += 1;
+    }
+    else prf.smp_n2 += 1;
+    prf.smp = 0;
+    return ret;
+}
+
+static int read_bufbit(dsp_t *dsp, int symlen, ui32_t mvp, int pos) {
 // symlen==2: manchester2 0->10,1->01->1: 2.bit
 
     double rbitgrenze = pos*symlen*dsp->sps;
@@ -895,51 +644,33 @@ static int read_bufbit(dsp_t *dsp, int symlen, char *bits, ui32_t mvp, int pos)
         } while (rcount < rbitgrenze);  // n < dsp->sps
     }
 
-
-    if (symlen != 2) {
-        if (sum >= 0) *bits = '1';
-        else          *bits = '0';
-    }
-    else {
-        if (sum >= 0) strncpy(bits, "10", 2);
-        else          strncpy(bits, "01", 2);
-    }
-
-    return 0;
+    return (sum >= 0);  // symlen=2: 1 -> "10", 0 -> "01"
 }
 
+// received header vs. dsp->hdr: Hamming distance (XOR/popcount on packed bits)
 static int headcmp(dsp_t *dsp, int opt_dc) {
-    int errs = 0;
     int pos;
-    int step = 1;
-    char sign = 0;
+    int bit;
     int len = dsp->hdrlen/dsp->symhd;
     int inv = dsp->mv < 0;
 
     //if (opt_dc == 0 || dsp->opt_iq > 1) dsp->dc = 0;
 
-    if (dsp->symhd != 1) step = 2; // step == symhd
-    if (inv) sign=1;
-
     for (pos = 0; pos < len; pos++) {                  // L = dsp->hdrlen * dsp->sps + 0.5;
-        //read_bufbit(dsp, dsp->symhd, dsp->rawbits+pos*step, mvp+1-(int)(len*dsp->sps), pos);
-        read_bufbit(dsp, dsp->symhd, dsp->rawbits+pos*step, dsp->mv_pos+1-dsp->L, pos);
-    }
-
-    pos = len*step; // == hdrlen
-    dsp->rawbits[pos] = '\0';
-
-    while (pos > 0) {
-        if ((dsp->rawbits[pos-1]^sign) != dsp->hdr[pos-1]) errs += 1;
-        pos--;
+        bit = read_bufbit(dsp, dsp->symhd, dsp->mv_pos+1-dsp->L, pos) ^ inv;
+        if (dsp->symhd != 1) {
+            bits_set(dsp->rawbits, 2*pos,   bit);
+            bits_set(dsp->rawbits, 2*pos+1, bit ^ 1);
+        }
+        else bits_set(dsp->rawbits, pos, bit);
     }
 
-    return errs;
+    return bits_hdist(dsp->rawbits, 0, dsp->hdrbits, 0, dsp->symhd != 1 ? 2*len : len);
 }
 
 /* -------------------------------------------------------------------------- */
 
-int read_slbit(dsp_t *dsp, int *bit, int inv, int ofs, int pos, float l, int spike) {
+static int _read_slbit(dsp_t *dsp, int *bit, int inv, int ofs, int pos, float l, int spike) {
 // symlen==2: manchester2 10->0,01->1: 2.bit
 
     float sample;
@@ -1009,7 +740,15 @@ int read_slbit(dsp_t *dsp, int *bit, int inv, int ofs, int pos, float l, int spi
     return 0;
 }
 
-int read_softbit(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike) {
+int read_slbit(dsp_t *dsp, int *bit, int inv, int ofs, int pos, float l, int spike) {
+    int ret;
+    prf_enter(PRF_BITS);
+    ret = _read_slbit(dsp, bit, inv, ofs, pos, l, spike);
+    prf_leave();
+    return ret;
+}
+
+static int _read_softbit(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike) {
 // symlen==2: manchester2 10->0,01->1: 2.bit
 
     float sample;
@@ -1084,7 +823,15 @@ int read_softbit(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, i
     return 0;
 }
 
-int read_softbit2p(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike, hsbit_t *shb1) {
+int read_softbit(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike) {
+    int ret;
+    prf_enter(PRF_BITS);
+    ret = _read_softbit(dsp, shb, inv, ofs, pos, l, spike);
+    prf_leave();
+    return ret;
+}
+
+static int _read_softbit2p(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike, hsbit_t *shb1) {
 // symlen==2: manchester2 10->0,01->1: 2.bit
 
     float sample, sample1;
@@ -1174,6 +921,75 @@ int read_softbit2p(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l,
     return 0;
 }
 
+int read_softbit2p(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike, hsbit_t *shb1) {
+    int ret;
+    prf_enter(PRF_BITS);
+    ret = _read_softbit2p(dsp, shb, inv, ofs, pos, l, spike, shb1);
+    prf_leave();
+    return ret;
+}
+
+// soft bits shb[k] at sample offsets ofs0+k, k=0..nofs-1 (nofs <= NOFS_MAX),
+// one pass over the samples (parallel bitofs)
+static int _read_softbitN(dsp_t *dsp, hsbit_t *shb, int nofs, int inv, int ofs0, int pos, float l) {
+
+    double sum[NOFS_MAX];
+    double mid;
+    double bg = pos*dsp->symlen*dsp->sps;
+    double dc = 0.0;
+    float sign = -1.0;
+    float *b;
+    int k;
+    int n;
+
+    if (nofs > NOFS_MAX) nofs = NOFS_MAX;
+    for (k = 0; k < nofs; k++) sum[k] = 0.0;
+
+    if (dsp->opt_dc && dsp->opt_iq < 2) dc = dsp->dc;
+
+    if (pos == 0) {
+        bg = 0;
+        dsp->sc = 0;
+    }
+
+    if (dsp->symlen != 2) sign = 1.0;  // symlen==2: manchester2 10->0,01->1: 2.bit
+
+    for (n = (dsp->symlen == 2) ? 0 : 1; n < 2; n++) {
+        mid = bg + (dsp->sps-1)/2.0;
+        bg += dsp->sps;
+        do {
+            if (dsp->buffered > 0) dsp->buffered -= 1;
+            else if (f32buf_sample(dsp, inv) == EOF) return EOF;
+
+            if (l < 0 || (mid-l < dsp->sc && dsp->sc < mid+l)) {
+                ui32_t i0 = dsp->sample_out-dsp->buffered + ofs0 + dsp->M;
+                b = dsp->bufs;
+                for (k = 0; k < nofs; k++) {
+                    sum[k] += sign * (b[(i0+k) % dsp->M] - dc);
+                }
+            }
+
+            dsp->sc++;
+        } while (dsp->sc < bg);  // n < dsp->sps
+        sign = 1.0;
+    }
+
+    for (k = 0; k < nofs; k++) {
+        shb[k].hb = (sum[k] >= 0);
+        shb[k].sb = (float)sum[k];
+    }
+
+    return 0;
+}
+
+int read_softbitN(dsp_t *dsp, hsbit_t *shb, int nofs, int inv, int ofs0, int pos, float l) {
+    int ret;
+    prf_enter(PRF_BITS);
+    ret = _read_softbitN(dsp, shb, nofs, inv, ofs0, pos, l);
+    prf_leave();
+    return ret;
+}
+
 /* -------------------------------------------------------------------------- */
 
 #define IF_SAMPLE_RATE      48000
@@ -1229,6 +1045,7 @@ int init_buffers(dsp_t *dsp) {
         int taps; // dec_lowpass: taps
 
         if (dsp->opt_IFmin) IF_sr = IF_SAMPLE_RATE_MIN;
+        if (dsp->IF_sr > 0) IF_sr = dsp->IF_sr; // wideband signals
         if (IF_sr > sr_base) IF_sr = sr_base;
         if (IF_sr < sr_base) {
             while (sr_base % IF_sr) IF_sr += 1;
@@ -1259,40 +1076,8 @@ int init_buffers(dsp_t *dsp) {
     }
     if (dsp->opt_iq == 5)
     {
-        if (!dsp->opt_nolut)
-        {
-            // look up table, exp-rotation
-            int W = 2*8; // 16 Hz window
-            int d = 1; // 1..W , groesster Teiler d <= W von sr_base
-            int freq = (int)( dsp->xlt_fq * (double)dsp->sr_base + 0.5);
-            int freq0 = freq; // init
-            double f0 = freq0 / (double)dsp->sr_base; // init
-
-            for (d = W; d > 0; d--) { // groesster Teiler d <= W von sr
-                if (dsp->sr_base % d == 0) break;
-            }
-            if (d == 0) d = 1; // d >= 1 ?
-
-            for (k = 0; k < W/2; k++) {
-                if ((freq+k) % d == 0) {
-                    freq0 = freq + k;
-                    break;
-                }
-                if ((freq-k) % d == 0) {
-                    freq0 = freq - k;
-                    break;
-                }
-            }
-
-            dsp->lut_len = dsp->sr_base / d;
-            f0 = freq0 / (double)dsp->sr_base;
-
-            dsp->ex = calloc(dsp->lut_len+1, sizeof(float complex));
-            if (dsp->ex == NULL) return -1;
-            for (n = 0; n < dsp->lut_len; n++) {
-                t = f0*(double)n;
-                dsp->ex[n] = cexp(t*_2PI*I);
-            }
+        if (!dsp->opt_nolut) {
+            if (exlut_init(dsp) < 0) return -1;
         }
 
         dsp->decXbuffer = calloc( dsp->dectaps+1, sizeof(float complex));
@@ -1348,13 +1133,7 @@ int init_buffers(dsp_t *dsp) {
     }
 
 
-    memset(&IQdc, 0, sizeof(IQdc));
-    IQdc.maxlim = dsp->sr;
-    IQdc.maxcnt = IQdc.maxlim/32; // 32,16,8,4,2,1
-    if (dsp->decM > 1) {
-        IQdc.maxlim *= dsp->decM;
-        IQdc.maxcnt *= dsp->decM;
-    }
+    iq_dc_init(dsp);
 
 
     L = dsp->hdrlen * dsp->sps + 0.5;
@@ -1389,7 +1168,9 @@ int init_buffers(dsp_t *dsp) {
     dsp->xs = (float *)calloc( M+1, sizeof(float)); if (dsp->xs == NULL) return -100;
     dsp->qs = (float *)calloc( M+1, sizeof(float)); if (dsp->qs == NULL) return -100;
 
-    dsp->rawbits = (char *)calloc( 2*dsp->hdrlen+1, sizeof(char)); if (dsp->rawbits == NULL) return -100;
+    dsp->rawbits = (ui8_t *)calloc( (2*dsp->hdrlen+7)/8+8, 1); if (dsp->rawbits == NULL) return -100;
+    dsp->hdrbits = (ui8_t *)calloc( (dsp->hdrlen+7)/8+8, 1); if (dsp->hdrbits == NULL) return -100;
+    for (i = 0; i < dsp->hdrlen; i++) bits_set(dsp->hdrbits, i, dsp->hdr[i] & 1);
 
 
     for (i = 0; i < M; i++) dsp->bufs[i] = 0.0;
@@ -1475,11 +1256,14 @@ int init_buffers(dsp_t *dsp) {
 
 int free_buffers(dsp_t *dsp) {
 
+    f32read_free(dsp);  // input buffer/mapping
+
     if (dsp->match) { free(dsp->match); dsp->match = NULL; }
     if (dsp->bufs)  { free(dsp->bufs);  dsp->bufs  = NULL; }
     if (dsp->xs)  { free(dsp->xs);  dsp->xs  = NULL; }
     if (dsp->qs)  { free(dsp->qs);  dsp->qs  = NULL; }
     if (dsp->rawbits) { free(dsp->rawbits); dsp->rawbits = NULL; }
+    if (dsp->hdrbits) { free(dsp->hdrbits); dsp->hdrbits = NULL; }
 
     if (dsp->DFT.xn) { free(dsp->DFT.xn); dsp->DFT.xn = NULL; }
     if (dsp->DFT.ew) { free(dsp->DFT.ew); dsp->DFT.ew = NULL; }
@@ -1542,7 +1326,9 @@ int find_header(dsp_t *dsp, float thres, int hdmax, int bitofs, int opt_dc) {
         k += 1;
         if (k >= dsp->K-4) {
             mvpos0 = dsp->mv_pos;
+            prf_enter(PRF_CORR);
             mp = getCorrDFT(dsp, thres); // correlation score -> dsp->mv
+            prf_leave();
             //if (option_auto == 0 && dsp->mv < 0) mv = 0;
             k = 0;
         }
@@ -1622,11 +1408,11 @@ int find_header(dsp_t *dsp, float thres, int hdmax, int bitofs, int opt_dc) {
 #else
 // external FSK demod: read float32 soft symbols
 
-int read_wav_header(pcm_t *pcm, FILE *fp) {}
 int f32buf_sample(dsp_t *dsp, int inv) {}
 int read_slbit(dsp_t *dsp, int *bit, int inv, int ofs, int pos, float l, int spike) {}
 int read_softbit(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike) {}
 int read_softbit2p(dsp_t *dsp, hsbit_t *shb, int inv, int ofs, int pos, float l, int spike, hsbit_t *shb1) {}
+int read_softbitN(dsp_t *dsp, hsbit_t *shb, int nofs, int inv, int ofs0, int pos, float l) {}
 
 int init_buffers(dsp_t *dsp) {}
 int free_buffers(dsp_t *dsp) {}
@@ -1636,27 +1422,56 @@ int find_header(dsp_t *dsp, float thres, int hdmax, int bitofs, int opt_dc) {}
 #endif
 
 
-static float cmp_hdb(hdb_t *hdb) { // bit-errors?
-    int i, j;
+// hdb->hreg: last hdb->len received bits (hdb->buf[] ring buffer as shift register),
+// header compare by XOR/popcount, both polarities
+static void init_hdb(hdb_t *hdb) {
+    int i;
     int headlen = hdb->len;
-    int berrs1 = 0, berrs2 = 0;
 
-    i = 0;
-    j = hdb->bufpos;
-    while (i < headlen) {
-        if (j < 0) j = headlen-1;
-        if (hdb->buf[j] != hdb->hdr[headlen-1-i]) berrs1 += 1;
-        j--;
-        i++;
+    if (headlen > 64*HDB_NW) headlen = hdb->len = 64*HDB_NW;
+    hdb->nw = (headlen+63)/64;
+    hdb->nfill = 0;
+    memset(hdb->hreg, 0, sizeof(hdb->hreg));
+    memset(hdb->hpat, 0, sizeof(hdb->hpat));
+    memset(hdb->hmsk, 0, sizeof(hdb->hmsk));
+    for (i = 0; i < headlen; i++) {
+        hdb->hpat[i/64] |= (ui64_t)(hdb->hdr[headlen-1-i] & 0x1) << (i%64);
+        hdb->hmsk[i/64] |= 1ULL << (i%64);
+        hdb->ypat[i] = 2.0*(hdb->hdr[i]&0x1) - 1.0;
     }
+}
+
+static void push_hdb(hdb_t *hdb, int bit) {
+    int k;
+    for (k = hdb->nw-1; k > 0; k--) {
+        hdb->hreg[k] = (hdb->hreg[k] << 1) | (hdb->hreg[k-1] >> 63);
+    }
+    hdb->hreg[0] = (hdb->hreg[0] << 1) | (bit & 1);
+    if (hdb->nfill < hdb->len) hdb->nfill += 1;
+}
+
+static float cmp_hdb(hdb_t *hdb) { // bit-errors?
+    int k, n;
+    int headlen = hdb->len;
+    int berrs1 = 0, berrs2 = 0;
+    ui64_t msk;
 
-    i = 0;
-    j = hdb->bufpos;
-    while (i < headlen) {
-        if (j < 0) j = headlen-1;
-        if ((hdb->buf[j]^0x01) != hdb->hdr[headlen-1-i]) berrs2 += 1;
-        j--;
-        i++;
+    if (hdb->nfill == headlen) {
+        for (k = 0; k < hdb->nw; k++) {
+            berrs1 += bits_popc64((hdb->hreg[k] ^ hdb->hpat[k]) & hdb->hmsk[k]);
+        }
+        berrs2 = headlen - berrs1;
+    }
+    else { // not yet received: error for both polarities
+        for (k = 0; k < hdb->nw; k++) {
+            n = hdb->nfill - 64*k;
+            if (n <= 0) break;
+            msk = (n < 64) ? (1ULL << n) - 1 : ~0ULL;
+            berrs1 += bits_popc64( (hdb->hreg[k] ^ hdb->hpat[k]) & msk);
+            berrs2 += bits_popc64(~(hdb->hreg[k] ^ hdb->hpat[k]) & msk);
+        }
+        berrs1 += headlen - hdb->nfill;
+        berrs2 += headlen - hdb->nfill;
     }
 
     if (berrs2 < berrs1) return (-headlen+berrs2)/(float)headlen;
@@ -1667,17 +1482,21 @@ static float cmp_hdb(hdb_t *hdb) { // bit-errors?
 
 int find_binhead(FILE *fp, hdb_t *hdb, float *score) {
     int bit;
-    int headlen = hdb->len;
+    int headlen;
     float mv;
 
     //*score = 0.0;
 
+    if (hdb->nw == 0) init_hdb(hdb);
+    headlen = hdb->len;
+
     while ( (bit = fgetc(fp)) != EOF )
     {
         bit &= 1;
 
         hdb->bufpos = (hdb->bufpos+1) % headlen;
         hdb->buf[hdb->bufpos] = 0x30 | bit;  // Ascii
+        push_hdb(hdb, bit);
 
         mv = cmp_hdb(hdb);
         if ( fabs(mv) > hdb->thb ) {
@@ -1689,40 +1508,142 @@ int find_binhead(FILE *fp, hdb_t *hdb, float *score) {
     return EOF;
 }
 
+// x[0..n-1].y[0..n-1], x.x ; 4 lanes (SIMD)
+static void dot_hdb(const float *x, const float *y, int n, double *sxy, double *sxx) {
+    int i, k;
+    double s[4] = {0}, q[4] = {0};
+    float xy[4], xx[4];
+
+    for (i = 0; i+4 <= n; i += 4) {
+        for (k = 0; k < 4; k++) {
+            xy[k] = x[i+k]*y[i+k];
+            xx[k] = x[i+k]*x[i+k];
+        }
+        for (k = 0; k < 4; k++) {
+            s[k] += xy[k];
+            q[k] += xx[k];
+        }
+    }
+    for ( ; i < n; i++) {
+        s[0] += x[i]*y[i];
+        q[0] += x[i]*x[i];
+    }
+    *sxy += (s[0]+s[1]) + (s[2]+s[3]);
+    *sxx += (q[0]+q[1]) + (q[2]+q[3]);
+}
+
 static float corr_softhdb(hdb_t *hdb) { // max score in window probably not needed
-    int i, j;
     int headlen = hdb->len;
+    int n1 = headlen-1 - hdb->bufpos;  // oldest: sbuf[bufpos+1..headlen-1]
     double sum = 0.0;
-    double normx = 0.0,
-           normy = 0.0;
-    float x, y;
-
-    i = 0;
-    j = hdb->bufpos + 1;
-
-    while (i < headlen) {
-        if (j >= headlen) j = 0;
-        x = hdb->sbuf[j];
-        y = 2.0*(hdb->hdr[i]&0x1) - 1.0;
-        sum += y * hdb->sbuf[j];
-        normx += x*x;
-        normy += y*y;
-        j++;
-        i++;
-    }
-    sum /= sqrt(normx*normy);
+    double normx = 0.0;
+
+    dot_hdb(hdb->sbuf+hdb->bufpos+1, hdb->ypat,    n1,         &sum, &normx);
+    dot_hdb(hdb->sbuf,               hdb->ypat+n1, headlen-n1, &sum, &normx);
+    sum /= sqrt(normx*headlen);  // normy = headlen
 
     return sum;
 }
 
+// soft input: raw float32 stream or framed (softhdr_t + nsym floats),
+// the format is detected from the first 4 bytes
+static struct {
+    int mode;       // 0: unknown, 1: raw, 2: framed
+    ui32_t left;    // soft symbols left in current frame
+    softhdr_t hdr;
+    float br;       // decoder symbol rate (f32soft_br())
+    int warned;
+} sfin;
+
+// modem frame header vs. decoder symbol rate, warn once
+static void softhdr_chk(softhdr_t *hdr) {
+    if (hdr == NULL || sfin.br <= 0 || sfin.warned) return;
+
+    if (fabs(hdr->rs - sfin.br) > 0.01*sfin.br) {
+        fprintf(stderr, "warning: soft input symbol rate %u, expected %.0f\n", hdr->rs, sfin.br);
+        sfin.warned = 1;
+    }
+    else if (hdr->nsym == 0 || hdr->nsym > hdr->rs) {  // fsk_demod: Nsym symbols per frame
+        fprintf(stderr, "warning: soft input frame of %u symbols at %u baud\n", hdr->nsym, hdr->rs);
+        sfin.warned = 1;
+    }
+}
+
+// header after magic
+static int softhdr_rest(FILE *fp) {
+    ui8_t *h = (ui8_t*)&sfin.hdr;
+    int c;
+
+    if (fread(h+4, SOFTHDR_LEN-4, 1, fp) != 1) return EOF;
+    for (c = SOFTHDR_LEN; c < sfin.hdr.len; c++) {  // newer (longer) header
+        if (fgetc(fp) == EOF) return EOF;
+    }
+    sfin.left = sfin.hdr.nsym;
+    softhdr_chk(&sfin.hdr);
+
+    return 0;
+}
+
+static int softhdr_read(FILE *fp) {
+    ui8_t *h = (ui8_t*)&sfin.hdr;
+    int c;
+
+    // (re)sync to magic
+    if (fread(h, 4, 1, fp) != 1) return EOF;
+    while (memcmp(h, SOFTHDR_MAGIC, 4) != 0) {
+        if ((c = fgetc(fp)) == EOF) return EOF;
+        memmove(h, h+1, 3);
+        h[3] = c;
+    }
+
+    return softhdr_rest(fp);
+}
+
+softhdr_t *f32soft_hdr(void) {
+    if (fskin_active()) return fskin_hdr();
+    return sfin.mode == 2 ? &sfin.hdr : NULL;
+}
+
+void f32soft_br(float br) {
+    sfin.br = br;
+    sfin.warned = 0;
+    if (fskin_active()) softhdr_chk(fskin_hdr());
+}
+
 int f32soft_read(FILE *fp, float *s, int inv) {
     unsigned int word = 0;
     short *b = (short*)&word;
     float *f = (float*)&word;
     int bps = 32;
 
+    if (fskin_active()) {  // --fsk: in-process modem
+        if (fskin_read(fp, s) == EOF) return EOF;
+        if (inv) *s = -*s;
+        return 0;
+    }
+
+    if (sfin.mode == 0) {
+        if (fread( &word, bps/8, 1, fp) != 1) return EOF;
+        if (memcmp(&word, SOFTHDR_MAGIC, 4) == 0) {
+            memcpy(sfin.hdr.magic, &word, 4);
+            if (softhdr_rest(fp) == EOF) return EOF;
+            sfin.mode = 2;
+        }
+        else {
+            sfin.mode = 1;
+            goto conv;
+        }
+    }
+    if (sfin.mode == 2) {
+        while (sfin.left == 0) {
+            if (softhdr_read(fp) == EOF) return EOF;
+        }
+        sfin.left--;
+    }
+
     if (fread( &word, bps/8, 1, fp) != 1) return EOF;
 
+conv:
     if (bps == 32) {
         *s = *f;
     }
@@ -1738,12 +1659,15 @@ int f32soft_read(FILE *fp, float *s, int inv) {
 }
 
 int find_softbinhead(FILE *fp, hdb_t *hdb, float *score, int inv) {
-    int headlen = hdb->len;
+    int headlen;
     float sbit;
     float mv;
 
     //*score = 0.0;
 
+    if (hdb->nw == 0) init_hdb(hdb);
+    headlen = hdb->len;
+
     while ( f32soft_read(fp, &sbit, inv) != EOF )
     {
         hdb->bufpos = (hdb->bufpos+1) % headlen;
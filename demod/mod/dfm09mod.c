@@ -32,6 +32,7 @@
 
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
 
 
 enum dfmtyp_keys_t {
@@ -905,6 +906,8 @@ static void print_gpx(gpx_t *gpx) {
     int start = 0;
     int repeat_gps = 0;
 
+    prf_enter(PRF_OUT);
+
     if (gpx->frnr > 0) start = 0x1000;
 
     output |= start;
@@ -1128,6 +1131,9 @@ static void print_gpx(gpx_t *gpx) {
             if (gpx->jsn_freq > 0) {
                 printf(", \"freq\": %d", gpx->jsn_freq);
             }
+            if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+            }
 
             // Reference time/position
             printf(", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
@@ -1148,6 +1154,8 @@ static void print_gpx(gpx_t *gpx) {
     }
 
     for (i = 0; i < 9; i++) gpx->pck[i].ec = -1;
+
+    prf_leave();
 }
 
 static int print_frame(gpx_t *gpx) {
@@ -1169,9 +1177,11 @@ static int print_frame(gpx_t *gpx) {
     deinterleave(gpx->frame+DAT1, 13, hamming_dat1);
     deinterleave(gpx->frame+DAT2, 13, hamming_dat2);
 
+    prf_enter(PRF_ECC);
     ret0 = hamming(gpx->option.ecc, hamming_conf,  7, block_conf);
     ret1 = hamming(gpx->option.ecc, hamming_dat1, 13, block_dat1);
     ret2 = hamming(gpx->option.ecc, hamming_dat2, 13, block_dat2);
+    prf_leave();
     ret = ret0 | ret1 | ret2;
 
     if (gpx->option.raw == 9) {
@@ -1378,7 +1388,14 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--bin") == 0) { option_bin = 1; }  // bit/byte binary input
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--dist") == 0) { option_dist = 1; option_ecc = 1; }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) { option_json = 1; option_ecc = 1; }
         else if   (strcmp(*argv, "--jsn_cfq") == 0) {
             int frq = -1;  // center frequency / Hz
@@ -1603,6 +1620,7 @@ int main(int argc, char **argv) {
         }
         else {
             if (option_bin && option_softin) option_bin = 0;
+            if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = dfm_rawheader;
             hdb.len = strlen(dfm_rawheader);
@@ -0,0 +1,635 @@
+/*
+ *  shared DSP front end: wav/IQ input, IQ-dc, FIR lowpass, DFT
+ *  used by demod_mod.c, iq_dec.c, ../../imet/imet4iq.c, ../../mk2a/mk2a1680mod.c,
+ *  ../../scan/detect_mod.c (libdsp.a)
+ *  compile:
+ *      gcc -Ofast -c dsp_mod.c
+ *
+ *  author: zilog80
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #define RD_MMAP
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "dsp_mod.h"
+
+/* ------------------------------------------------------------------------------------ */
+
+void raw_dft(dft_t *dft, float complex *Z) {
+    int s, l, l2, i, j, k;
+    float complex  w1, w2, T;
+
+    j = 1;
+    for (i = 1; i < dft->N; i++) {
+        if (i < j) {
+            T = Z[j-1];
+            Z[j-1] = Z[i-1];
+            Z[i-1] = T;
+        }
+        k = dft->N/2;
+        while (k < j) {
+            j = j - k;
+            k = k/2;
+        }
+        j = j + k;
+    }
+
+    for (s = 0; s < dft->LOG2N; s++) {
+        l2 = 1 << s;
+        l  = l2 << 1;
+        w1 = (float complex)1.0;
+        w2 = dft->ew[s]; // cexp(-I*M_PI/(float)l2)
+        for (j = 1; j <= l2; j++) {
+            for (i = j; i <= dft->N; i += l) {
+                k = i + l2;
+                T = Z[k-1] * w1;
+                Z[k-1] = Z[i-1] - T;
+                Z[i-1] = Z[i-1] + T;
+            }
+            w1 = w1 * w2;
+        }
+    }
+}
+
+void cdft(dft_t *dft, float complex *z, float complex *Z) {
+    int i;
+    for (i = 0; i < dft->N; i++)  Z[i] = z[i];
+    raw_dft(dft, Z);
+}
+
+void rdft(dft_t *dft, float *x, float complex *Z) {
+    int i;
+    for (i = 0; i < dft->N; i++)  Z[i] = (float complex)x[i];
+    raw_dft(dft, Z);
+}
+
+void Nidft(dft_t *dft, float complex *Z, float complex *z) {
+    int i;
+    for (i = 0; i < dft->N; i++)  z[i] = conj(Z[i]);
+    raw_dft(dft, z);
+    // idft():
+    // for (i = 0; i < dft->N; i++)  z[i] = conj(z[i])/(float)dft->N; // hier: z reell
+}
+
+int dft_window(dft_t *dft, int w) {
+    int n;
+
+    if (w < 0 || w > 3) return -1;
+
+    for (n = 0; n < dft->N2; n++) {
+        switch (w)
+        {
+            case 0: // (boxcar)
+                    dft->win[n] = 1.0;
+                    break;
+            case 1: // Hann
+                    dft->win[n] = 0.5 * ( 1.0 - cos(_2PI*n/(float)(dft->N2-1)) );
+                    break ;
+            case 2: // Hamming
+                    dft->win[n] = 25/46.0 - (1.0 - 25/46.0)*cos(_2PI*n / (float)(dft->N2-1));
+                    break ;
+            case 3: // Blackmann
+                    dft->win[n] =  7938/18608.0
+                                 - 9240/18608.0*cos(_2PI*n / (float)(dft->N2-1))
+                                 + 1430/18608.0*cos(4*M_PI*n / (float)(dft->N2-1));
+                    break ;
+        }
+    }
+    while (n < dft->N) dft->win[n++] = 0.0;
+
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+static int findstr(char *buff, char *str, int pos) {
+    int i;
+    for (i = 0; i < 4; i++) {
+        if (buff[(pos+i)%4] != str[i]) break;
+    }
+    return i;
+}
+
+int read_wav_header(pcm_t *pcm, FILE *fp) {
+    char txt[4+1] = "\0\0\0\0";
+    unsigned char dat[4];
+    int byte, p=0;
+    int sample_rate = 0, bits_sample = 0, channels = 0;
+
+    if (fread(txt, 1, 4, fp) < 4) return -1;
+    if (strncmp(txt, "RIFF", 4) && strncmp(txt, "RF64", 4)) return -1;
+
+    if (fread(txt, 1, 4, fp) < 4) return -1;
+    // pos_WAVE = 8L
+    if (fread(txt, 1, 4, fp) < 4) return -1;
+    if (strncmp(txt, "WAVE", 4))  return -1;
+
+    // pos_fmt = 12L
+    for ( ; ; ) {
+        if ( (byte=fgetc(fp)) == EOF ) return -1;
+        txt[p % 4] = byte;
+        p++; if (p==4) p=0;
+        if (findstr(txt, "fmt ", p) == 4) break;
+    }
+    if (fread(dat, 1, 4, fp) < 4) return -1;
+    if (fread(dat, 1, 2, fp) < 2) return -1;
+
+    if (fread(dat, 1, 2, fp) < 2) return -1;
+    channels = dat[0] + (dat[1] << 8);
+
+    if (fread(dat, 1, 4, fp) < 4) return -1;
+    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
+
+    if (fread(dat, 1, 4, fp) < 4) return -1;
+    if (fread(dat, 1, 2, fp) < 2) return -1;
+    //byte = dat[0] + (dat[1] << 8);
+
+    if (fread(dat, 1, 2, fp) < 2) return -1;
+    bits_sample = dat[0] + (dat[1] << 8);
+
+    // pos_dat = 36L + info
+    for ( ; ; ) {
+        if ( (byte=fgetc(fp)) == EOF ) return -1;
+        txt[p % 4] = byte;
+        p++; if (p==4) p=0;
+        if (findstr(txt, "data", p) == 4) break;
+    }
+    if (fread(dat, 1, 4, fp) < 4) return -1;
+
+
+    fprintf(stderr, "sample_rate: %d\n", sample_rate);
+    fprintf(stderr, "bits       : %d\n", bits_sample);
+    fprintf(stderr, "channels   : %d\n", channels);
+
+    if (pcm->sel_ch < 0  ||  pcm->sel_ch >= channels) pcm->sel_ch = 0; // default channel: 0
+    //fprintf(stderr, "channel-In : %d\n", pcm->sel_ch+1); // nur wenn nicht IQ
+
+    if (bits_sample != 8 && bits_sample != 16 && bits_sample != 32) return -1;
+
+    if (sample_rate == 900001) sample_rate -= 1;
+
+    pcm->sr  = sample_rate;
+    pcm->bps = bits_sample;
+    pcm->nch = channels;
+
+    return 0;
+}
+
+
+// buffered input: one fread() per block of frames (f32read_sample, f32read_csample);
+// regular files: samples straight from a read-only mapping of the whole file.
+// The state is in dsp_t and belongs to dsp->fp; it is set up on the first read
+// after read_wav_header() (and again if dsp->fp changes), f32read_free() releases it.
+#define RD_BUFLEN  (1<<13)
+
+int f32read_free(dsp_t *dsp) {
+#ifdef RD_MMAP
+    if (dsp->map_base) munmap(dsp->map_base, dsp->map_len);
+#endif
+    if (dsp->rdbuf) free(dsp->rdbuf);
+    dsp->map_base = NULL;
+    dsp->map_len = 0;
+    dsp->map_pos = 0;
+    dsp->rdbuf = NULL;
+    dsp->rd_len = 0;
+    dsp->rd_pos = 0;
+    dsp->rd_map = 0;
+    dsp->rd_fp = NULL;
+    return 0;
+}
+
+static void f32read_map(dsp_t *dsp) {
+#ifdef RD_MMAP
+    struct stat st;
+    long ofs;
+    void *p;
+    int fd = fileno(dsp->fp);
+
+    dsp->rd_map = -1;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return;
+    ofs = ftell(dsp->fp);  // stdio position after the wav header
+    if (ofs < 0 || (size_t)ofs >= (size_t)st.st_size) return;
+
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return;
+  #ifdef MADV_SEQUENTIAL
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+  #endif
+    dsp->map_base = p;
+    dsp->map_len = st.st_size;
+    dsp->map_pos = ofs;
+    dsp->rd_map = 1;
+#else
+    dsp->rd_map = -1;
+#endif
+}
+
+static void f32read_init(dsp_t *dsp) {
+    if (dsp->rd_fp != dsp->fp) {  // first read, or another stream
+        f32read_free(dsp);
+        dsp->rd_fp = dsp->fp;
+    }
+    if (dsp->rd_map == 0) f32read_map(dsp);
+}
+
+// next n bytes of the mapped file (or NULL at EOF)
+static ui8_t *f32read_mapped(dsp_t *dsp, size_t n) {
+    ui8_t *p;
+    if (dsp->map_pos + n > dsp->map_len) return NULL;
+    p = dsp->map_base + dsp->map_pos;
+    dsp->map_pos += n;
+    return p;
+}
+
+static ui8_t *f32read_frame(dsp_t *dsp) {
+    int framelen = dsp->nch * (dsp->bps/8);
+
+    f32read_init(dsp);
+    if (dsp->rd_map > 0) {
+        if (framelen < 1) return NULL;
+        return f32read_mapped(dsp, framelen);
+    }
+
+    if (dsp->rd_pos >= dsp->rd_len) {
+        if (framelen < 1 || framelen > RD_BUFLEN) return NULL;
+        if (dsp->rdbuf == NULL) {
+            dsp->rdbuf = (ui8_t*)malloc(RD_BUFLEN);
+            if (dsp->rdbuf == NULL) return NULL;
+        }
+        dsp->rd_len = fread(dsp->rdbuf, framelen, RD_BUFLEN/framelen, dsp->fp);
+        dsp->rd_pos = 0;
+        if (dsp->rd_len <= 0) return NULL;
+    }
+
+    return dsp->rdbuf + framelen*(dsp->rd_pos++);
+}
+
+int f32read_sample(dsp_t *dsp, float *s) {
+    ui8_t *frame = f32read_frame(dsp);
+
+    if (frame == NULL) return EOF;
+    frame += dsp->ch * (dsp->bps/8);  // i = 0: links bzw. mono
+
+    if (dsp->bps == 32) {
+        float f;
+        memcpy(&f, frame, 4);
+        *s = f;
+    }
+    else if (dsp->bps == 16) {
+        short b;
+        memcpy(&b, frame, 2);
+        *s = b/32768.0;
+    }
+    else {  // 8bit: 00..FF, centerpoint 0x80=128
+        *s = (frame[0]-128)/128.0;
+    }
+
+    return 0;
+}
+
+typedef struct {
+    double sumIQx;
+    double sumIQy;
+    float avgIQx;
+    float avgIQy;
+    float complex avgIQ;
+    ui32_t cnt;
+    ui32_t maxcnt;
+    ui32_t maxlim;
+} iq_dc_t;
+static iq_dc_t IQdc;
+
+int iq_dc_init(dsp_t *dsp) {
+    memset(&IQdc, 0, sizeof(IQdc));
+    IQdc.maxlim = dsp->sr;
+    IQdc.maxcnt = IQdc.maxlim/32; // 32,16,8,4,2,1
+    if (dsp->decM > 1) {
+        IQdc.maxlim *= dsp->decM;
+        IQdc.maxcnt *= dsp->decM;
+    }
+    return 0;
+}
+
+int f32read_csample(dsp_t *dsp, float complex *z) {
+
+    float x, y;
+    ui8_t *frame = f32read_frame(dsp);
+
+    if (frame == NULL) return EOF;
+
+    if (dsp->bps == 32) { //float32
+        float f[2];
+        memcpy(f, frame, 8);
+        x = f[0];
+        y = f[1];
+    }
+    else if (dsp->bps == 16) { //int16
+        short b[2];
+        memcpy(b, frame, 4);
+        x = b[0]/32768.0;
+        y = b[1]/32768.0;
+    }
+    else {  // dsp->bps == 8   //uint8
+        x = (frame[0]-128)/128.0;
+        y = (frame[1]-128)/128.0;
+    }
+
+    *z = x + I*y;
+
+    // IQ-dc removal optional
+    if (dsp->opt_iqdc) {
+        *z -= IQdc.avgIQ;
+
+        IQdc.sumIQx += x;
+        IQdc.sumIQy += y;
+        IQdc.cnt += 1;
+        if (IQdc.cnt == IQdc.maxcnt) {
+            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
+            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
+            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
+            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
+            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
+        }
+    }
+
+    return 0;
+}
+
+int f32read_cblock(dsp_t *dsp) {
+
+    int n;
+    int len;
+    float x, y;
+    ui8_t s[4*2*dsp->decM]; //uin8,int16,float32
+    ui8_t *u = (ui8_t*)s;
+    short *b = (short*)s;
+    float *f = (float*)s;
+
+
+    f32read_init(dsp);
+    if (dsp->rd_map > 0) {
+        size_t nb = (dsp->map_len - dsp->map_pos) / (dsp->bps/8);  // samples left
+        len = 2*dsp->decM;
+        if (nb < (size_t)len) len = nb;
+        if (len > 0) memcpy(s, f32read_mapped(dsp, len*(dsp->bps/8)), len*(dsp->bps/8));
+        len /= 2;
+    }
+    else {
+        len = fread( s, dsp->bps/8, 2*dsp->decM, dsp->fp) / 2;
+    }
+
+    //for (n = 0; n < len; n++) dsp->decMbuf[n] = (u[2*n]-128)/128.0 + I*(u[2*n+1]-128)/128.0;
+    // u8: 0..255, 128 -> 0V
+    for (n = 0; n < len; n++) {
+        if (dsp->bps == 8) { //uint8
+            x = (u[2*n  ]-128)/128.0;
+            y = (u[2*n+1]-128)/128.0;
+        }
+        else if (dsp->bps == 16) { //int16
+            x = b[2*n  ]/32768.0;
+            y = b[2*n+1]/32768.0;
+        }
+        else { // dsp->bps == 32   //float32
+            x = f[2*n];
+            y = f[2*n+1];
+        }
+
+        // baseband: IQ-dc removal mandatory
+        dsp->decMbuf[n] = (x-IQdc.avgIQx) + I*(y-IQdc.avgIQy);
+
+        IQdc.sumIQx += x;
+        IQdc.sumIQy += y;
+        IQdc.cnt += 1;
+        if (IQdc.cnt == IQdc.maxcnt) {
+            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
+            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
+            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
+            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
+            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
+        }
+    }
+
+    return len;
+}
+
+// exp-rotation look up table for --IQ <fq>, dsp->xlt_fq rounded to a divisor of sr_base
+int exlut_init(dsp_t *dsp) {
+    int k, n;
+    // look up table, exp-rotation
+    int W = 2*8; // 16 Hz window
+    int d = 1; // 1..W , groesster Teiler d <= W von sr_base
+    int freq = (int)( dsp->xlt_fq * (double)dsp->sr_base + 0.5);
+    int freq0 = freq; // init
+    double f0 = freq0 / (double)dsp->sr_base; // init
+
+    for (d = W; d > 0; d--) { // groesster Teiler d <= W von sr
+        if (dsp->sr_base % d == 0) break;
+    }
+    if (d == 0) d = 1; // d >= 1 ?
+
+    for (k = 0; k < W/2; k++) {
+        if ((freq+k) % d == 0) {
+            freq0 = freq + k;
+            break;
+        }
+        if ((freq-k) % d == 0) {
+            freq0 = freq - k;
+            break;
+        }
+    }
+
+    dsp->lut_len = dsp->sr_base / d;
+    f0 = freq0 / (double)dsp->sr_base;
+
+    dsp->ex = calloc(dsp->lut_len+1, sizeof(float complex));
+    if (dsp->ex == NULL) return -1;
+    for (n = 0; n < dsp->lut_len; n++) {
+        double t = f0*(double)n;
+        dsp->ex[n] = cexp(t*_2PI*I);
+    }
+
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+static double sinc(double x) {
+    double y;
+    if (x == 0) y = 1;
+    else y = sin(M_PI*x)/(M_PI*x);
+    return y;
+}
+
+int lowpass_init(float f, int taps, float **pws) {
+    double *h, *w;
+    double norm = 0;
+    int n;
+    float *ws = NULL;
+
+    if (taps % 2 == 0) taps++; // odd/symmetric
+
+    if ( taps < 1 ) taps = 1;
+
+    h = (double*)calloc( taps+1, sizeof(double)); if (h == NULL) return -1;
+    w = (double*)calloc( taps+1, sizeof(double)); if (w == NULL) return -1;
+    ws = (float*)calloc( 2*taps+1, sizeof(float)); if (ws == NULL) return -1;
+
+    for (n = 0; n < taps; n++) {
+        w[n] = 7938/18608.0 - 9240/18608.0*cos(_2PI*n/(taps-1)) + 1430/18608.0*cos(4*M_PI*n/(taps-1)); // Blackmann
+        h[n] = 2*f*sinc(2*f*(n-(taps-1)/2));
+        ws[n] = w[n]*h[n];
+        norm += ws[n]; // 1-norm
+    }
+    for (n = 0; n < taps; n++) {
+        ws[n] /= norm; // 1-norm
+    }
+
+    for (n = 0; n < taps; n++) ws[taps+n] = ws[n]; // duplicate/unwrap
+
+    *pws = ws;
+
+    free(h); h = NULL;
+    free(w); w = NULL;
+
+    return taps;
+}
+
+
+int lowpass_update(float f, int taps, float *ws) {
+    double *h, *w;
+    double norm = 0;
+    int n;
+
+    if (taps % 2 == 0) taps++; // odd/symmetric
+
+    if ( taps < 1 ) taps = 1;
+
+    h = (double*)calloc( taps+1, sizeof(double)); if (h == NULL) return -1;
+    w = (double*)calloc( taps+1, sizeof(double)); if (w == NULL) return -1;
+
+    for (n = 0; n < taps; n++) {
+        w[n] = 7938/18608.0 - 9240/18608.0*cos(_2PI*n/(taps-1)) + 1430/18608.0*cos(4*M_PI*n/(taps-1)); // Blackmann
+        h[n] = 2*f*sinc(2*f*(n-(taps-1)/2));
+        ws[n] = w[n]*h[n];
+        norm += ws[n]; // 1-norm
+    }
+    for (n = 0; n < taps; n++) {
+        ws[n] /= norm; // 1-norm
+    }
+
+    for (n = 0; n < taps; n++) ws[taps+n] = ws[n];
+
+    free(h); h = NULL;
+    free(w); w = NULL;
+
+    return taps;
+}
+
+static float complex lowpass0(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    ui32_t n;            // sample: oldest_sample
+    double complex w = 0;
+    for (n = 0; n < taps; n++) {
+        w += buffer[(sample+n)%taps]*ws[taps-1-n];
+    }
+    return (float complex)w;
+}
+static float complex lowpass1a(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    double complex w = 0;
+    ui32_t n;
+    ui32_t S = taps-1 + (sample % taps);
+    for (n = 0; n < taps; n++) {
+        w += buffer[n]*ws[S-n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
+    }
+    return (float complex)w;
+// symmetry: ws[n] == ws[taps-1-n]
+}
+//static __attribute__((optimize("-ffast-math"))) float complex lowpass()
+float complex lowpass(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    float complex w = 0;
+    int n; // -Ofast
+    int S = taps - (sample % taps);
+    for (n = 0; n < taps; n++) {
+        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
+    }
+    return w;
+// symmetry: ws[n] == ws[taps-1-n]
+}
+float complex lowpass2(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    float complex w = 0;
+    int n; // -Ofast
+    int s = sample % taps;
+    int S1 = s;
+    int S1N = S1-taps;
+    int n0 = taps-s;
+    for (n = 0; n < n0; n++) {
+        w += buffer[S1+n]*ws[n];
+    }
+    for (n = n0; n < taps; n++) {
+        w += buffer[S1N+n]*ws[n];
+    }
+    return w;
+// symmetry: ws[n] == ws[taps-1-n]
+}
+static float complex lowpass0_sym(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    ui32_t n;
+    double complex w = buffer[(sample+(taps-1)/2) % taps]*ws[(taps-1)/2]; // (N+1)/2 = (N-1)/2 + 1
+    for (n = 0; n < (taps-1)/2; n++) {
+        w += (buffer[(sample+n)%taps]+buffer[(sample+taps-n-1)%taps])*ws[n];
+    }
+    return (float complex)w;
+}
+static float complex lowpass2_sym(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    float complex w = 0;
+    int n;
+    int s = sample % taps; // lpIQ
+    int SW = (taps-1)/2;
+    int B1 = s + SW;
+    int n1 = SW - s;
+    int n0 = 0;
+
+    if (s > SW) {
+        B1 -= taps;
+        n1 = -n1 - 1;
+        n0 = B1+n1+1;
+    }
+
+    w = buffer[B1]*ws[SW];
+
+    for (n = 1; n < n1+1; n++) {
+        w += (buffer[B1 + n] + buffer[B1 - n]) * ws[SW+n];
+    }
+
+    for (n = 0; n < SW-n1; n++) {
+        w += (buffer[s + n] + buffer[s-1 - n]) * ws[SW+SW-n];
+    }
+
+    return w;
+// symmetry: ws[n] == ws[taps-1-n]
+}
+
+
+static float re_lowpass0(float buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    ui32_t n;
+    double w = 0;
+    for (n = 0; n < taps; n++) {
+        w += buffer[(sample+n)%taps]*ws[taps-1-n];
+    }
+    return (float)w;
+}
+float re_lowpass(float buffer[], ui32_t sample, ui32_t taps, float *ws) {
+    float w = 0;
+    int n;
+    int S = taps - (sample % taps);
+    for (n = 0; n < taps; n++) {
+        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
+    }
+    return w;
+}
@@ -0,0 +1,232 @@
+/*
+ *  shared DSP front end types and functions (dsp_mod.c, libdsp.a)
+ */
+
+
+#ifndef DSP_MOD_H
+#define DSP_MOD_H
+
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+
+#ifndef M_PI
+    #define M_PI  (3.1415926535897932384626433832795)
+#endif
+#define _2PI  (6.2831853071795864769252867665590)
+
+
+#define LP_IQ    1
+#define LP_FM    2
+#define LP_IQFM  4
+
+
+#ifndef INTTYPES
+#define INTTYPES
+typedef unsigned char  ui8_t;
+typedef unsigned short ui16_t;
+typedef unsigned int   ui32_t;
+typedef unsigned long long ui64_t;
+typedef char  i8_t;
+typedef short i16_t;
+typedef int   i32_t;
+#endif
+
+
+typedef struct {
+    int sr;       // sample_rate
+    int LOG2N;
+    int N;
+    int N2;
+    float *xn;
+    float complex  *ew;
+    float complex  *Fm;
+    float complex  *X;
+    float complex  *Z;
+    float complex  *cx;
+    float complex  *win; // float real
+} dft_t;
+
+
+typedef struct {
+    FILE *fp;
+    //
+    int sr;       // sample_rate
+    int bps;      // bits/sample
+    int nch;      // channels
+    int ch;       // select channel
+    //
+    int symlen;
+    int symhd;
+    float sps;    // samples per symbol
+    float _spb;   // samples per bit
+    float br;     // baud rate
+    //
+    ui32_t sample_in;
+    ui32_t sample_out;
+    ui32_t delay;
+    ui32_t sc;
+    int buffered;
+    int L;
+    int M;
+    int K;
+    float *match;
+    float *bufs;
+    float mv;
+    ui32_t mv_pos;
+    //
+    float mv2;
+    ui32_t mv2_pos;
+    //
+    int N_norm;
+    int Nvar;
+    float xsum;
+    float qsum;
+    float *xs;
+    float *qs;
+
+    // IQ-data
+    int opt_iq;
+    int opt_iqdc;
+    int N_IQBUF;
+    float complex *rot_iqbuf;
+    float complex F1sum;
+    float complex F2sum;
+    //
+    double complex iw1;
+    double complex iw2;
+
+
+    //
+    ui8_t *rawbits;  // received header, packed
+    char *hdr;
+    int hdrlen;
+
+    //
+    float BT; // bw/time (ISI)
+    float h;  // modulation index
+
+    // DFT
+    dft_t DFT;
+
+    // dc offset
+    int opt_dc;
+    int locked;
+    double dc;
+    double Df;
+    double dDf;
+    //
+
+    ui32_t sample_posframe;
+    ui32_t sample_posnoise;
+
+    double V_noise;
+    double V_signal;
+    double SNRdB;
+
+    // decimate
+    int opt_nolut; // default: LUT
+    int opt_IFmin;
+    int decM;
+    ui32_t sr_base;
+    ui32_t dectaps;
+    ui32_t sample_decX;
+    ui32_t lut_len;
+    ui32_t sample_decM;
+    float complex *decXbuffer;
+    float complex *decMbuf;
+    float complex *ex; // exp_lut
+    double xlt_fq;
+
+    // IF: lowpass
+    int opt_lp;
+    int lpIQ_bw;
+    float lpIQ_fbw;
+    int lpIQtaps; // ui32_t
+    float *ws_lpIQ0;
+    float *ws_lpIQ1;
+    float *ws_lpIQ;
+    float complex *lpIQ_buf;
+
+    // FM: lowpass
+    int lpFM_bw;
+    int lpFMtaps; // ui32_t
+    float *ws_lpFM;
+    float *lpFM_buf;
+    float *fm_buffer;
+
+    // IQFM: lowpass (mk2a1680mod)
+    int lpIQFM_bw;
+    int lpIQFMtaps; // ui32_t
+    float *ws_lpIQFM;
+    float *lpIQFM_buf;
+
+    // FM decimation (imet4iq, mk2a1680mod, iq_dec)
+    int opt_fmdec;
+    int decFM;
+    int sr_fm;
+    ui32_t sample_fm;
+
+    // imet4iq
+    ui32_t pre_pos;
+    float complex iqbuf[2];
+    int opt_imet1;
+
+    // iq_dec
+    int bps_out;
+    int exlut;
+    int opt_fm;
+
+    // wideband signals (weathex301d)
+    int IF_sr;     // designated IF sample rate (0: IF_SAMPLE_RATE)
+
+    // headcmp(): hdr[], packed
+    ui8_t *hdrbits;
+
+    // sample input (f32read_*): block buffer, or read-only mapping of a regular file
+    FILE *rd_fp;     // stream the read state belongs to
+    ui8_t *rdbuf;
+    int rd_len;      // frames in rdbuf
+    int rd_pos;
+    int rd_map;      // 0: not checked, 1: mapped, -1: fread()
+    ui8_t *map_base;
+    size_t map_len;
+    size_t map_pos;  // byte offset of the next frame
+
+} dsp_t;
+
+
+typedef struct {
+    int sr;       // sample_rate
+    int sr_out;
+    int bps;      // bits_sample  bits/sample
+    int bps_out;
+    int nch;      // channels
+    int sel_ch;   // select wav channel
+} pcm_t;
+
+
+// wav/raw input
+int read_wav_header(pcm_t *, FILE *);
+int f32read_sample(dsp_t *, float *);
+int f32read_csample(dsp_t *, float complex *);
+int f32read_cblock(dsp_t *);
+int f32read_free(dsp_t *);
+int iq_dc_init(dsp_t *);
+int exlut_init(dsp_t *);
+
+// FIR lowpass, Blackman window; ws[] duplicated: 2*taps
+int lowpass_init(float f, int taps, float **pws);
+int lowpass_update(float f, int taps, float *ws);
+float complex lowpass(float complex buffer[], ui32_t sample, ui32_t taps, float *ws);
+float complex lowpass2(float complex buffer[], ui32_t sample, ui32_t taps, float *ws);
+float re_lowpass(float buffer[], ui32_t sample, ui32_t taps, float *ws);
+
+// radix-2 DFT, dft->N = 1<<dft->LOG2N, twiddle factors dft->ew[]
+void raw_dft(dft_t *dft, float complex *Z);
+void cdft(dft_t *dft, float complex *z, float complex *Z);
+void rdft(dft_t *dft, float *x, float complex *Z);
+void Nidft(dft_t *dft, float complex *Z, float complex *z);
+int dft_window(dft_t *dft, int w);
+
+#endif
@@ -0,0 +1,222 @@
+
+/*
+ *  codec2 FSK modem in-process (instead of fsk_demod | decoder --softin)
+ *
+ *  --fsk <Fs>,<Rs>[,<opt>...]
+ *      Fs, Rs : sample rate and symbol rate (Fs/Rs integer, as fsk_demod)
+ *      opt    : p=<P>      demod internal rate Fs/P (default 10)
+ *               lo=<Hz>    freq estimator lower limit (default -Fs/2, real input: 0)
+ *               hi=<Hz>    freq estimator upper limit (default Fs/2)
+ *               mask=<Hz>  "mask" freq estimator, tone spacing
+ *               nsym=<N>   symbols for estimators (default 50)
+ *               cu8        IQ input complex unsigned 8 bit (default: cs16)
+ *               s16        real input signed 16 bit
+ *               stats=<r>  modem statistics (fsk_demod --stats=r JSON) -> stderr
+ *               bin        binary stats records (fsk_demod --stats-bin)
+ *               eye=<n>    eye diagram: every n-th trace, 0: none (fsk_demod --stats-eye)
+ *               fft=<n>    samp_fft: peak over n bins (fsk_demod --stats-fft)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fsk.h"
+#include "codec2_fdmdv.h"
+#include "fsk_stats.h"
+#include "fskin_mod.h"
+
+#include "demod_mod.h"
+
+
+static struct {
+    struct FSK *fsk;
+    int Fs;
+    int Rs;
+    int cplx;       // 1: s16 real, 2: IQ
+    int bps;        // bytes per (real) sample
+    int stats;
+    struct FSK_STATS_CFG stats_cfg;
+    uint8_t *statsbuf;
+    int stats_loop;
+    int stats_ctr;
+    long sample_count;
+    void *raw;
+    COMP *mod;
+    float *sd;
+    int pos;
+    softhdr_t hdr;
+} fi;
+
+
+int fskin_init(char *spec) {
+    int Fs = 0, Rs = 0, P = 10, nsym = FSK_DEFAULT_NSYM;
+    int lo = 0, hi = 0, user_lo = 0, user_hi = 0;
+    int mask = 0, tone_sep = 100;
+    int eye = -1;
+    char *buf, *tok;
+    int n = 0;
+
+    memset(&fi, 0, sizeof(fi));
+    fi.cplx = 2;
+    fi.bps = 2;
+
+    buf = strdup(spec);
+    if (buf == NULL) return -1;
+    for (tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ","), n++) {
+        if      (n == 0) Fs = atoi(tok);
+        else if (n == 1) Rs = atoi(tok);
+        else if (strncmp(tok, "p=", 2) == 0)     P = atoi(tok+2);
+        else if (strncmp(tok, "lo=", 3) == 0)  { lo = atoi(tok+3); user_lo = 1; }
+        else if (strncmp(tok, "hi=", 3) == 0)  { hi = atoi(tok+3); user_hi = 1; }
+        else if (strncmp(tok, "mask=", 5) == 0) { mask = 1; tone_sep = atoi(tok+5); }
+        else if (strncmp(tok, "nsym=", 5) == 0)  nsym = atoi(tok+5);
+        else if (strncmp(tok, "stats=", 6) == 0) fi.stats = atoi(tok+6);
+        else if (strcmp(tok, "bin") == 0)         fi.stats_cfg.bin = 1;
+        else if (strncmp(tok, "eye=", 4) == 0)    eye = atoi(tok+4);
+        else if (strncmp(tok, "fft=", 4) == 0)    fi.stats_cfg.fft = atoi(tok+4);
+        else if (strcmp(tok, "cu8") == 0)      { fi.cplx = 2; fi.bps = 1; }
+        else if (strcmp(tok, "s16") == 0)      { fi.cplx = 1; fi.bps = 2; }
+        else {
+            fprintf(stderr, "error: --fsk option %s\n", tok);
+            free(buf);
+            return -1;
+        }
+    }
+    free(buf);
+
+    if (Fs <= 0 || Rs <= 0 || P <= 0 || nsym <= 0 || Fs % Rs != 0 || (Fs/Rs) % P != 0) {
+        fprintf(stderr, "error: --fsk <Fs>,<Rs>: Fs/Rs, Fs/Rs/P integer\n");
+        return -1;
+    }
+
+    fi.Fs = Fs;
+    fi.Rs = Rs;
+    fi.fsk = fsk_create_hbr(Fs, Rs, 2, P, nsym, 1000, tone_sep);
+    if (fi.fsk == NULL) return -1;
+
+    if (!user_lo) lo = (fi.cplx == 1) ? 0 : -Fs/2;
+    if (!user_hi) hi = Fs/2;
+    fsk_set_freq_est_limits(fi.fsk, lo, hi);
+    fsk_set_freq_est_alg(fi.fsk, mask);
+    if (fi.cplx == 1) fsk_set_real_input(fi.fsk, 1);
+
+    if (fi.stats > 0) {
+        float loop_time = (float)fsk_nin(fi.fsk)/(float)Fs;
+        fi.stats_loop = (int)(1/(fi.stats*loop_time));
+        fi.stats_ctr = 0;
+        // defaults as fsk_demod: eye diagram in JSON only
+        if (eye < 0) eye = fi.stats_cfg.bin ? 0 : 1;
+        fi.stats_cfg.eye = eye;
+        if (fi.stats_cfg.fft < 1) fi.stats_cfg.fft = 1;
+        if (fi.stats_cfg.bin) {
+            fi.statsbuf = malloc(STATSBIN_MAX(fi.fsk));
+            if (fi.statsbuf == NULL) {
+                fskin_free();
+                return -1;
+            }
+        }
+    }
+
+    fi.raw = malloc(fi.bps*fi.cplx*(fi.fsk->N+fi.fsk->Ts*2));
+    fi.mod = (COMP*)malloc(sizeof(COMP)*(fi.fsk->N+fi.fsk->Ts*2));
+    fi.sd  = (float*)malloc(sizeof(float)*fi.fsk->Nbits);
+    if (fi.raw == NULL || fi.mod == NULL || fi.sd == NULL) {
+        fskin_free();
+        return -1;
+    }
+    fi.pos = fi.fsk->Nbits;
+
+    memcpy(fi.hdr.magic, SOFTHDR_MAGIC, 4);
+    fi.hdr.ver = SOFTHDR_VER;
+    fi.hdr.len = SOFTHDR_LEN;
+    fi.hdr.nsym = fi.fsk->Nbits;
+    fi.hdr.rs = Rs;
+
+    return 0;
+}
+
+int fskin_active(void) {
+    return fi.fsk != NULL;
+}
+
+// next modem frame (Nbits soft decisions)
+static int fskin_frame(FILE *fp) {
+    struct FSK *fsk = fi.fsk;
+    int nin = fsk_nin(fsk);
+    float *f_est;
+    int i;
+
+    prf_enter(PRF_READ);
+    i = fread(fi.raw, fi.bps*fi.cplx, nin, fp);
+    prf_leave();
+    if (i != nin) return EOF;
+
+    prf_enter(PRF_DEMOD);
+    if (fi.cplx == 1) {
+        short *b = (short*)fi.raw;
+        for (i = 0; i < nin; i++) {
+            fi.mod[i].real = b[i]/(float)FDMDV_SCALE;
+            fi.mod[i].imag = 0.0;
+        }
+    }
+    else if (fi.bps == 1) {
+        unsigned char *u = (unsigned char*)fi.raw;
+        for (i = 0; i < nin; i++) {
+            fi.mod[i].real = (u[2*i  ]-127.0)/128.0;
+            fi.mod[i].imag = (u[2*i+1]-127.0)/128.0;
+        }
+    }
+    else {
+        short *b = (short*)fi.raw;
+        for (i = 0; i < nin; i++) {
+            fi.mod[i].real = b[2*i  ]/(float)FDMDV_SCALE;
+            fi.mod[i].imag = b[2*i+1]/(float)FDMDV_SCALE;
+        }
+    }
+    if (fi.sample_count > 0) fi.hdr.seq++;
+    fi.sample_count += nin;
+
+    fsk_demod_sd(fsk, fi.sd, fi.mod);
+    prf_leave();
+
+    f_est = fsk->freq_est_type ? fsk->f2_est : fsk->f_est;
+    fi.hdr.snr = fsk->stats->snr_est;
+    fi.hdr.ppm = fsk->ppm;
+    fi.hdr.foff = 0.5*(f_est[0]+f_est[fsk->mode-1]);
+    fi.hdr.timing = fsk->stats->rx_timing;
+
+    if (fi.stats > 0) {
+        if (fi.stats_ctr < 0) {
+            if (fi.stats_cfg.bin) fsk_stats_bin(stderr, fsk, &fi.stats_cfg, 0, fi.sample_count, fi.statsbuf);
+            else                  fsk_stats_json(stderr, fsk, &fi.stats_cfg, -1, fi.sample_count, NULL);
+            fi.stats_ctr = fi.stats_loop;
+        }
+        fi.stats_ctr--;
+    }
+
+    fi.pos = 0;
+    return 0;
+}
+
+int fskin_read(FILE *fp, float *s) {
+    if (fi.pos >= fi.fsk->Nbits) {
+        if (fskin_frame(fp) == EOF) return EOF;
+    }
+    *s = fi.sd[fi.pos++];
+    return 0;
+}
+
+softhdr_t *fskin_hdr(void) {
+    return &fi.hdr;
+}
+
+void fskin_free(void) {
+    if (fi.fsk) fsk_destroy(fi.fsk);
+    free(fi.raw);
+    free(fi.mod);
+    free(fi.sd);
+    free(fi.statsbuf);
+    memset(&fi, 0, sizeof(fi));
+}
+
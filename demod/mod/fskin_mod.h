@@ -0,0 +1,21 @@
+
+/*
+ *  codec2 FSK modem (utils/fsk.c) as in-process soft symbol source
+ *  for the --softin decoders:
+ *      --fsk <Fs>,<Rs>[,<opt>...]
+ *  input: raw IQ cs16 (default), cu8 or real s16, as fsk_demod
+ */
+
+#ifndef FSKIN_MOD_H
+#define FSKIN_MOD_H
+
+#include "../../utils/softhdr.h"
+
+int  fskin_init(char *spec);
+int  fskin_active(void);
+int  fskin_read(FILE *fp, float *s);
+softhdr_t *fskin_hdr(void);  // modem state of the current frame, as fsk_demod -F
+void fskin_free(void);
+
+#endif
+
@@ -38,6 +38,7 @@
 //typedef int   i32_t;
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
 
 
 typedef struct {
@@ -104,32 +105,35 @@ static char imet54_header[] = //"0000000001""0101010101""0000000001""0101010101"
 
 /* ------------------------------------------------------------------------------------ */
 
-static int de8n1(ui8_t *in, ui8_t *out, int len) {
-    int n = 0;
+// 8N1: data bits 1..8 of each 10bit symbol -> byte (bit j = j-th data bit)
+static int de8n1(ui8_t *in, ui8_t *out, int nbytes) {
+    int n, k;
 
-    for (n = 0; n < len; n++) {
-        if (n % 10 > 0 && n % 10 < 9) {
-            *out = in[n];
-            out++;
-        }
+    for (n = 0; n < nbytes; n++) {
+        ui8_t byt = 0;
+        for (k = 0; k < 8; k++) byt |= (in[10*n+1+k] & 1) << k;
+        out[n] = byt;
     }
 
     return 0;
 }
 
-static int deinter64(ui8_t *in, ui8_t *out, int len) {
-    int i, j;
-    int n = 0;
-    unsigned char bits64[8][8];
+// 64bit blocks: out[8j+i] = in[8i+j], i.e. 8x8 bit matrix transpose (row i = byte i)
+static int deinter64(ui8_t *in, ui8_t *out, int nblk) {
+    int i, n;
+    ui64_t x, t;
 
-    while (n+64 <= len)
-    {
-        for (i = 0; i < 8; i++) {
-            for (j = 0; j < 8; j++) out[n + 8*j+i] = in[n + 8*i+j];
-        }
-        n += 64;
+    for (n = 0; n < nblk; n++) {
+        x = 0;
+        for (i = 0; i < 8; i++) x |= (ui64_t)in[8*n+i] << (8*i);
+
+        t = (x ^ (x >>  7)) & 0x00AA00AA00AA00AAULL;  x ^= t ^ (t <<  7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;  x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;  x ^= t ^ (t << 28);
+
+        for (i = 0; i < 8; i++) out[8*n+i] = (x >> (8*i)) & 0xFF;
     }
-    return len - n;
+    return 0;
 }
 
 static ui8_t G[8][4] =  // Generator
@@ -198,83 +202,104 @@ static ui8_t ham_lut[16] = { 0x00, 0x87, 0x99, 0x1E, 0xAA, 0x2D, 0x33, 0xB4,
                              0x4B, 0xCC, 0xD2, 0x55, 0xE1, 0x66, 0x78, 0xFF };
 // c=(c0,...,c7) <-> m=(m0,..,m3) ; c=Gm, m=Rc
 // m0=c2, m1=c4, m2=c5, m3=c6
-static ui8_t hamming(int opt_ecc, ui8_t *cwb, ui8_t *sym) {
-    int j;
-    int ecc = 0;
+// Hamming(8,4) byte tables: codeword byte (bit j = c_j) -> nibble, ecc status
+static ui8_t ham_sym[2][256];  // [opt_ecc][cw]: m=(m0,..,m3), 16: no codeword
+static ui8_t ham_ecc[2][256];  // [opt_ecc][cw]: { 0, 1, 0xF0 }
+
+static void ham_init(void) {
+    int opt_ecc, cw, j;
+    int ecc;
+    ui8_t cwb[8];
     ui8_t byt = 0;
     ui8_t nib = 0;
-    ui8_t ret = 0;
 
-    if (opt_ecc) {
-        ecc = check(cwb);
-    }
+    for (opt_ecc = 0; opt_ecc < 2; opt_ecc++) {
+        for (cw = 0; cw < 256; cw++) {
+            for (j = 0; j < 8; j++) cwb[j] = (cw >> j) & 1;
+
+            ecc = 0;
+            if (opt_ecc) {
+                ecc = check(cwb);
+            }
+
+            byt = 0;
+            for (j = 0; j < 8; j++) {
+                byt |= (cwb[j]&1) << j;
+            }
+
+            for (nib = 0; nib < 16; nib++) {
+                if (byt == ham_lut[nib]) break;
+            }
+            ham_sym[opt_ecc][cw] = nib;
 
-    byt = 0;
-    for (j = 0; j < 8; j++) {
-        byt |= (cwb[j]&1) << j;
+            if (ecc < 0 || nib >= 16) ham_ecc[opt_ecc][cw] = 0xF0;
+            else if (ecc > 0)         ham_ecc[opt_ecc][cw] = 1;
+            else                      ham_ecc[opt_ecc][cw] = 0;
+        }
     }
+}
+
+// std frame CRC:
+// the register (c0,c1) is stepped once per bit, over words 26..0 (bytes ascending, bits lsb first),
+// and XORed into the crc for each data bit set. Linear in the data, hence evaluated backwards,
+// one byte per step (Horner): crc = A^8*crc ^ V[byte], A: one register step,
+// V[b] = sum_j b_j * A^j*(c0,c1)_init ; state (c0:16bit, c1:32bit) in 48 bits
+static ui64_t crc_V[256];
+static ui64_t crc_A8[6][256];
+
+static ui64_t crc_step(ui64_t st) {
+    ui32_t poly0 = 0x0EDB;
+    ui32_t poly1 = 0x8260;
+    ui32_t c0 = st & 0xFFFF;
+    ui32_t c1 = (st >> 16) & 0xFFFFFFFF;
+    ui32_t nx_c0 = c0;
+    ui32_t nx_c1 = c1;
 
-    for (nib = 0; nib < 16; nib++) {
-        if (byt == ham_lut[nib]) break;
+    if (c1 & 0x8000) {
+        nx_c0 ^= poly0;
+        nx_c1 ^= poly1;
     }
-    *sym = nib;
+    nx_c0 <<= 1;
+    nx_c1 <<= 1;
+    if ( c1     & 0x8000) nx_c0 |= 1;
+    if ((c1^c0) & 0x8000) nx_c1 |= 1;
+    nx_c0 &= 0xFFFF;
 
-    if (ecc < 0 || nib >= 16) ret = 0xF0;
-    else if (ecc > 0)         ret = 1;
-    else                      ret = 0;
+    return nx_c0 | ((ui64_t)nx_c1 << 16);
+}
 
-    return ret; // { 0, 1, 0xF0 }
+static ui64_t crc_A8x(ui64_t st) {
+    return crc_A8[0][ st      & 0xFF] ^ crc_A8[1][(st >>  8) & 0xFF] ^ crc_A8[2][(st >> 16) & 0xFF]
+         ^ crc_A8[3][(st >> 24) & 0xFF] ^ crc_A8[4][(st >> 32) & 0xFF] ^ crc_A8[5][(st >> 40) & 0xFF];
 }
 
 static int crc32ok(ui8_t *bytes, int len) {
-    ui32_t poly0 = 0x0EDB;
-    ui32_t poly1 = 0x8260;
     //[105 , 7, 0x8EDB, 0x8260] // CRC32 802-3 (Ethernet) reversed reciprocal
     //[104 , 0, 0x48EB, 0x1ACA]
     //[102 , 0, 0x1DB7, 0x04C1] // CRC32 802-3 (Ethernet) normal
-    int n = 104;
-    int b = 0;
-    ui32_t c0 = 0x48EB;
-    ui32_t c1 = 0x1ACA;
-    ui32_t nx_c0 = c0;
-    ui32_t nx_c1 = c1;
+    int n, w, i;
+    ui64_t crc = 0;
 
-    ui32_t data_c0 = (bytes[100]<<8) | bytes[101];
-    ui32_t data_c1 = (bytes[106]<<8) | bytes[107];
+    ui32_t data_c0;
+    ui32_t data_c1;
 
     ui32_t crc0 = 0;
     ui32_t crc1 = 0;
 
     if (len < 108) return 0;  // FRMBYTE_STD=108
 
-    while (n >= 0) {
+    data_c0 = (bytes[100]<<8) | bytes[101];
+    data_c1 = (bytes[106]<<8) | bytes[107];
 
-        if (n < 100 || (n > 101 && n < 106)) {
-            if ((bytes[n]>>b) & 1) {
-                crc0 ^= c0;
-                crc1 ^= c1;
-            }
-        }
-
-        if (c1 & 0x8000) {
-            nx_c0 ^= poly0;
-            nx_c1 ^= poly1;
-        }
-        nx_c0 <<= 1;
-        nx_c1 <<= 1;
-        if ( c1     & 0x8000) nx_c0 |= 1;
-        if ((c1^c0) & 0x8000) nx_c1 |= 1;
-        nx_c0 &= 0xFFFF;
-        c0 = nx_c0;
-        c1 = nx_c1;
-
-        if (b < 7) b += 1;
-        else {
-            b = 0;
-            if (n % 4 == 3) n -= 7;
-            else            n += 1;
+    for (w = 0; w < 27; w++) {
+        for (i = 3; i >= 0; i--) {
+            n = 4*w + i;
+            crc = crc_A8x(crc);
+            if (n < 100 || (n > 101 && n < 106)) crc ^= crc_V[bytes[n]];
         }
     }
+    crc0 = crc & 0xFFFF;
+    crc1 = (crc >> 16) & 0xFFFFFFFF;
 
     crc0 ^= data_c0^0x5000;
     crc1 ^= data_c1^0x1DAD;
@@ -283,24 +308,69 @@ static int crc32ok(ui8_t *bytes, int len) {
     return 0;
 }
 
-static ui32_t crc32_802(ui8_t *msg, int len) {
-    ui32_t poly32 = 0x04C11DB7;  // CRC32 802-3 (Ethernet) normal
-    ui32_t rem = 0x0;
-    ui32_t out = 0x63D60875;
-    ui32_t crc = 0;
-    int i, j;
-    for (i = 0; i < len; i++) {
-        rem ^= (msg[i] << 24);
+// CRC32 802-3 (Ethernet) normal, msb first, slicing-by-8
+static ui32_t crc32_T[8][256];
+
+static void crc_init(void) {
+    ui32_t poly32 = 0x04C11DB7;
+    ui32_t rem;
+    ui64_t st;
+    int i, j, k;
+
+    for (i = 0; i < 256; i++) {
+        rem = (ui32_t)i << 24;
         for (j = 0; j < 8; j++) {
-            if (rem & (1 << 31)) {
-                rem = (rem << 1) ^ poly32;
-            }
-            else {
-                rem <<= 1;
-            }
+            if (rem & (1 << 31)) rem = (rem << 1) ^ poly32;
+            else                 rem <<= 1;
+        }
+        crc32_T[0][i] = rem;
+    }
+    for (k = 1; k < 8; k++) {
+        for (i = 0; i < 256; i++) {
+            rem = crc32_T[k-1][i];
+            crc32_T[k][i] = (rem << 8) ^ crc32_T[0][rem >> 24];
+        }
+    }
+
+    // std frame CRC
+    for (i = 0; i < 256; i++) {
+        crc_V[i] = 0;
+        st = 0x48EB | ((ui64_t)0x1ACA << 16);
+        for (j = 0; j < 8; j++) {
+            if ((i >> j) & 1) crc_V[i] ^= st;
+            st = crc_step(st);
+        }
+    }
+    for (k = 0; k < 6; k++) {
+        for (i = 0; i < 256; i++) {
+            st = (ui64_t)i << (8*k);
+            for (j = 0; j < 8; j++) st = crc_step(st);
+            crc_A8[k][i] = st;
         }
     }
-    return rem ^ out;
+}
+
+// rem: remainder so far (0: start), crc32_802() = rem ^ out
+static ui32_t crc32_802_upd(ui32_t rem, ui8_t *msg, int len) {
+    ui32_t hi, lo;
+
+    while (len >= 8) {
+        hi = rem ^ ((ui32_t)msg[0]<<24 | msg[1]<<16 | msg[2]<<8 | msg[3]);
+        lo =        (ui32_t)msg[4]<<24 | msg[5]<<16 | msg[6]<<8 | msg[7];
+        rem = crc32_T[7][hi >> 24] ^ crc32_T[6][(hi >> 16) & 0xFF] ^ crc32_T[5][(hi >> 8) & 0xFF] ^ crc32_T[4][hi & 0xFF]
+            ^ crc32_T[3][lo >> 24] ^ crc32_T[2][(lo >> 16) & 0xFF] ^ crc32_T[1][(lo >> 8) & 0xFF] ^ crc32_T[0][lo & 0xFF];
+        msg += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        rem = (rem << 8) ^ crc32_T[0][(rem >> 24) ^ *msg++];
+    }
+    return rem;
+}
+
+static ui32_t crc32_802(ui8_t *msg, int len) {
+    ui32_t out = 0x63D60875;
+    return crc32_802_upd(0, msg, len) ^ out;
 }
 
 /* ------------------------------------------------------------------------------------ */
@@ -599,6 +669,9 @@ static int print_position(gpx_t *gpx, int len, int ecc_frm, int ecc_tlm, int ecc
         if (gpx->jsn_freq > 0) {
             fprintf(stdout, ", \"freq\": %d", gpx->jsn_freq );
         }
+        if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+            fprintf(stdout, ", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+        }
 
         // Reference time/position
         fprintf(stdout, ", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
@@ -619,8 +692,9 @@ static void print_frame(gpx_t *gpx, int len, int b2B) {
     int i, j;
     int ecc_frm = 0, ecc_gps = 0, ecc_std = 0;
     int ecc_tlm = 0;
-    ui8_t bits8n1[BITFRAME_LEN+10]; // (RAW)BITFRAME_LEN
-    ui8_t bits[BITFRAME_LEN]; // 8/10 (RAW)BITFRAME_LEN
+    int ecc = gpx->option.ecc != 0;  // ham_sym[], ham_ecc[]: [opt_ecc]
+    ui8_t bytes8n1[FRAME_LEN]; // 8/10 (RAW)BITFRAME_LEN
+    ui8_t cw[FRAME_LEN];
     ui8_t nib[FRAME_LEN];
     ui8_t ec[FRAME_LEN];
     ui32_t ofs = 3*8; // (0x24 0x24) 0x24 0x24 0x42 : 3*8
@@ -630,17 +704,21 @@ static void print_frame(gpx_t *gpx, int len, int b2B) {
     {
         for (i = len; i < BITFRAME_LEN; i++) gpx->frame_bits[i] = 0;
 
-        memset(bits8n1, 0, BITFRAME_LEN+10);
-        memset(bits, 0, BITFRAME_LEN);
-
-        de8n1(gpx->frame_bits, bits8n1, len);
         len = (8*len)/10;
 
         len -= ofs;
-        j = deinter64(bits8n1+ofs, bits, len);
-        len -= j;
+        if (len < 0) len = 0;
+        len -= len % 64;
 
-        for (j = 0; j < len/8; j++) ec[j] = hamming(gpx->option.ecc, bits+8*j, nib+j);
+        de8n1(gpx->frame_bits, bytes8n1, (ofs+len)/8);
+
+        prf_enter(PRF_ECC);
+        deinter64(bytes8n1+ofs/8, cw, len/64);
+        for (j = 0; j < len/8; j++) {
+            nib[j] = ham_sym[ecc][cw[j]];
+            ec[j]  = ham_ecc[ecc][cw[j]];
+        }
+        prf_leave();
 
         for (j = 0; j < len/16; j++) gpx->frame[j] = (nib[2*j]<<4) | (nib[2*j+1] & 0xF);
 
@@ -696,12 +774,16 @@ static void print_frame(gpx_t *gpx, int len, int b2B) {
         fprintf(stdout, "\n");
 
         if (gpx->option.slt /*&& gpx->option.jsn*/) {
+            prf_enter(PRF_OUT);
             print_position(gpx, len/16, ecc_frm, ecc_tlm, ecc_std);
+            prf_leave();
         }
     }
     else
     {
+        prf_enter(PRF_OUT);
         print_position(gpx, len/16, ecc_frm, ecc_tlm, ecc_std);
+        prf_leave();
     }
 }
 
@@ -796,6 +878,11 @@ int main(int argc, char *argv[]) {
         else if   (strcmp(*argv, "--auto") == 0) { gpx.option.aut = 1; }
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
             if (*argv) {
@@ -849,6 +936,8 @@ int main(int argc, char *argv[]) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) {
             gpx.option.jsn = 1;
             gpx.option.ecc = 1;
@@ -909,6 +998,9 @@ int main(int argc, char *argv[]) {
     }
     #endif
 
+    ham_init();
+    crc_init();
+
     if (!rawhex) {
 
         if (!option_softin) {
@@ -982,6 +1074,7 @@ int main(int argc, char *argv[]) {
             bitofs += shift;
         }
         else {
+            if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = imet54_header;
             hdb.len = strlen(imet54_header);
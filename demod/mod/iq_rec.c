@@ -0,0 +1,766 @@
+
+/*
+ *  compile:
+ *
+ *      gcc -O2 iq_rec.c -o iq_rec
+ *
+ *
+ *  usage:
+ *
+ *      ... | ./iq_rec [--fq <Hz>] [--chunk <s>] [--split <s>] [--raw] - <sr> <bs> <out.iqr> | ...
+ *               record raw IQ (u8/s16) from stdin, pass through to stdout (like tee)
+ *               --fq <Hz>    : center frequency (header only)
+ *               --chunk <s>  : chunk length in seconds (default: 1.0), seek resolution
+ *               --split <s>  : start a new file out_NNNN.iqr every <s> seconds
+ *               --raw        : no compression
+ *               --notee      : no output to stdout
+ *               an error on the recording (open, disk full) stops the recording only,
+ *               stdin is still passed through to stdout until EOF
+ *
+ *      ./iq_rec -x [--seek <s> | --at <n>] [--len <s>] <in.iqr> | ./iq_dec ... - <sr> <bs>
+ *               replay raw IQ, starting at <s> seconds/frame <n> of the recording
+ *
+ *      ./iq_rec -i [-v] <in.iqr>
+ *               header, chunk summary
+ *
+ *
+ *  file format (little endian):
+ *
+ *      file header (64 bytes):
+ *           0  "IQR1"
+ *           4  u16  header size
+ *           6  u8   bits per sample (8: u8, 16: s16)
+ *           7  u8   channels (2: IQ)
+ *           8  u32  sample rate
+ *          12  u32  chunk frames
+ *          16  u64  center frequency / Hz
+ *          24  i64  start time / us (UTC, unix epoch) of the first frame in the file
+ *          32  u64  first frame (frame count since start of recording)
+ *          40  ...  reserved (0)
+ *
+ *      chunk (24 bytes + payload), independently decodable:
+ *           0  "IQCK"
+ *           4  u8   codec (0: raw samples, 1: delta/bitpack)
+ *           8  u32  frames
+ *          12  u32  payload bytes
+ *          16  u64  first frame
+ *
+ *      seek index <out.iqr>.idx, one entry (16 bytes) per chunk, written with the chunk:
+ *           0  u64  first frame
+ *           8  u64  file offset of chunk header
+ *
+ *      codec 1: blocks of 32 frames (64 values, I/Q interleaved), prediction per channel
+ *      (order 0/1/2, selected per block), zigzag residuals bitpacked msb first;
+ *      block: 1 byte (order<<5 | width), 8*width bytes.
+ *      Chunks where the packed data is not smaller are stored as codec 0.
+ *
+ *  author: zilog80
+ */
+
+
+/* ------------------------------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+
+#ifdef CYGWIN
+  #include <fcntl.h>  // cygwin: _setmode()
+  #include <io.h>
+#endif
+
+#include "bits_mod.h"
+
+
+#define HDR_LEN   64
+#define CHK_LEN   24
+#define IDX_LEN   16
+
+#define BLK_VALS  64     // values per codec block (32 IQ frames)
+#define BLK_MAX   (1 + 8*20)
+#define RD_FRAMES 1024   // stdin -> stdout pass-through granularity
+
+typedef long long i64_t;
+
+typedef struct {
+    int    bps;
+    int    nch;
+    ui32_t sr;
+    ui32_t chunk;
+    ui64_t fq;
+    i64_t  t0_us;
+    ui64_t frame0;
+} iqr_hdr_t;
+
+typedef struct {
+    int    codec;
+    ui32_t frames;
+    ui32_t size;
+    ui64_t frame0;
+} iqr_chk_t;
+
+static volatile int sig_stop = 0;
+
+static void sig_handler(int signo) {
+    sig_stop = 1;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+static void put_le(ui8_t *p, ui64_t val, int n) {
+    int i;
+    for (i = 0; i < n; i++) { p[i] = val & 0xFF; val >>= 8; }
+}
+
+static ui64_t get_le(const ui8_t *p, int n) {
+    int i;
+    ui64_t val = 0;
+    for (i = n-1; i >= 0; i--) val = (val << 8) | p[i];
+    return val;
+}
+
+static int write_hdr(FILE *fp, iqr_hdr_t *hdr) {
+    ui8_t b[HDR_LEN];
+    memset(b, 0, HDR_LEN);
+    memcpy(b, "IQR1", 4);
+    put_le(b+ 4, HDR_LEN, 2);
+    b[6] = hdr->bps;
+    b[7] = hdr->nch;
+    put_le(b+ 8, hdr->sr, 4);
+    put_le(b+12, hdr->chunk, 4);
+    put_le(b+16, hdr->fq, 8);
+    put_le(b+24, (ui64_t)hdr->t0_us, 8);
+    put_le(b+32, hdr->frame0, 8);
+    return fwrite(b, HDR_LEN, 1, fp) == 1 ? 0 : -1;
+}
+
+static int read_hdr(FILE *fp, iqr_hdr_t *hdr) {
+    ui8_t b[HDR_LEN];
+    int len;
+    if (fread(b, 8, 1, fp) != 1) return -1;
+    if (memcmp(b, "IQR1", 4) != 0) return -1;
+    len = get_le(b+4, 2);
+    if (len < 40 || len > HDR_LEN) return -1;
+    if (fread(b+8, len-8, 1, fp) != 1) return -1;
+    hdr->bps    = b[6];
+    hdr->nch    = b[7];
+    hdr->sr     = get_le(b+ 8, 4);
+    hdr->chunk  = get_le(b+12, 4);
+    hdr->fq     = get_le(b+16, 8);
+    hdr->t0_us  = (i64_t)get_le(b+24, 8);
+    hdr->frame0 = get_le(b+32, 8);
+    if ((hdr->bps != 8 && hdr->bps != 16) || hdr->nch != 2) return -1;
+    return len;
+}
+
+static int read_chk(FILE *fp, iqr_chk_t *chk) {
+    ui8_t b[CHK_LEN];
+    if (fread(b, CHK_LEN, 1, fp) != 1) return -1;
+    if (memcmp(b, "IQCK", 4) != 0) return -1;
+    chk->codec  = b[4];
+    chk->frames = get_le(b+ 8, 4);
+    chk->size   = get_le(b+12, 4);
+    chk->frame0 = get_le(b+16, 8);
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+// samples <-> int values (u8: centered)
+static void smp2val(const ui8_t *s, int bps, int *x, int n) {
+    int i;
+    if (bps == 8) { for (i = 0; i < n; i++) x[i] = s[i] - 128; }
+    else          { for (i = 0; i < n; i++) x[i] = ((short*)s)[i]; }
+}
+
+static void val2smp(const int *x, int bps, ui8_t *s, int n) {
+    int i;
+    if (bps == 8) { for (i = 0; i < n; i++) s[i] = x[i] + 128; }
+    else          { for (i = 0; i < n; i++) ((short*)s)[i] = x[i]; }
+}
+
+// prediction order k from channel history h[0]=x[-1], h[1]=x[-2]
+static int pred(int k, const int *h) {
+    if (k == 0) return 0;
+    if (k == 1) return h[0];
+    return 2*h[0] - h[1];
+}
+
+static int bitwidth(ui32_t z) {
+    int w = 0;
+    while (z) { w++; z >>= 1; }
+    return w;
+}
+
+// n values (I/Q interleaved, n <= BLK_VALS) -> block, h[4]: I/Q history
+static int enc_block(const int *x, int n, int *h, ui8_t *blk) {
+    int i, k, w;
+    int kmin = 0, wmin = 32;
+    ui32_t z;
+
+    for (k = 0; k < 3; k++) {
+        int g[4];
+        ui32_t zor = 0;
+        memcpy(g, h, sizeof(g));
+        for (i = 0; i < n; i++) {
+            int *gc = g + 2*(i & 1);
+            int r = x[i] - pred(k, gc);
+            zor |= ((ui32_t)r << 1) ^ (ui32_t)(r >> 31);
+            gc[1] = gc[0]; gc[0] = x[i];
+        }
+        w = bitwidth(zor);
+        if (w < wmin) { wmin = w; kmin = k; }
+    }
+
+    blk[0] = (kmin << 5) | wmin;
+    memset(blk+1, 0, 8*wmin);
+    for (i = 0; i < n; i++) {
+        int *hc = h + 2*(i & 1);
+        int r = x[i] - pred(kmin, hc);
+        z = ((ui32_t)r << 1) ^ (ui32_t)(r >> 31);
+        if (wmin) bits_put(blk+1, i*wmin, wmin, z);
+        hc[1] = hc[0]; hc[0] = x[i];
+    }
+
+    return 1 + 8*wmin;
+}
+
+static int dec_block(const ui8_t *blk, int n, int *h, int *x) {
+    int i;
+    int k = blk[0] >> 5;
+    int w = blk[0] & 0x1F;
+    ui32_t z = 0;
+
+    if (k > 2 || w > 20) return -1;
+    for (i = 0; i < n; i++) {
+        int *hc = h + 2*(i & 1);
+        if (w) z = bits_get(blk+1, i*w, w);
+        x[i] = (int)((z >> 1) ^ -(z & 1)) + pred(k, hc);
+        hc[1] = hc[0]; hc[0] = x[i];
+    }
+
+    return 1 + 8*w;
+}
+
+// frames -> chunk payload, returns codec
+static int enc_chunk(const ui8_t *smp, int bps, ui32_t frames, ui8_t *out, ui32_t *size) {
+    int h[4] = {0};
+    int x[BLK_VALS];
+    ui32_t raw = frames*2*(bps/8);
+    ui32_t nv = 2*frames;
+    ui32_t i, len = 0;
+
+    if (bps == 8 || bps == 16) {
+        for (i = 0; i < nv && len < raw; i += BLK_VALS) {
+            int n = nv-i < BLK_VALS ? nv-i : BLK_VALS;
+            smp2val(smp + i*(bps/8), bps, x, n);
+            len += enc_block(x, n, h, out+len);
+        }
+        if (len < raw) { *size = len; return 1; }
+    }
+    memcpy(out, smp, raw);
+    *size = raw;
+    return 0;
+}
+
+static int dec_chunk(const ui8_t *in, ui32_t size, int codec, int bps, ui32_t frames, ui8_t *smp) {
+    int h[4] = {0};
+    int x[BLK_VALS];
+    ui32_t raw = frames*2*(bps/8);
+    ui32_t nv = 2*frames;
+    ui32_t i, len = 0;
+
+    if (codec == 0) {
+        if (size != raw) return -1;
+        memcpy(smp, in, raw);
+        return 0;
+    }
+    if (codec != 1) return -1;
+
+    for (i = 0; i < nv; i += BLK_VALS) {
+        int n = nv-i < BLK_VALS ? nv-i : BLK_VALS;
+        int l;
+        if (len >= size || len + 1 + 8*(in[len] & 0x1F) > size) return -1;
+        l = dec_block(in+len, n, h, x);
+        if (l < 0) return -1;
+        val2smp(x, bps, smp + i*(bps/8), n);
+        len += l;
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+typedef struct {
+    iqr_hdr_t hdr;
+    int opt_raw;
+    int opt_tee;
+    double split;
+    char *name;
+    int fcnt;
+    FILE *fp;
+    FILE *fpidx;
+    ui64_t ofs;
+    ui64_t frames;      // frames in current file
+    ui64_t frame_cnt;   // frames since start of recording
+    i64_t  t_start;     // us, first frame of recording
+    ui32_t nbuf;
+    ui8_t *buf;
+    ui8_t *cbuf;
+} iqr_rec_t;
+
+static void rec_close(iqr_rec_t *rec) {
+    if (rec->fp) fclose(rec->fp);
+    if (rec->fpidx) fclose(rec->fpidx);
+    rec->fp = NULL;
+    rec->fpidx = NULL;
+}
+
+static int rec_open(iqr_rec_t *rec) {
+    char *fname = rec->name;
+    char *idxname = NULL;
+    int len = strlen(rec->name);
+    int ret = 0;
+
+    if (rec->split > 0) {
+        char *ext = strrchr(rec->name, '.');
+        char *sl = strrchr(rec->name, '/');
+        int pos = (ext && ext != rec->name && (sl == NULL || ext > sl+1)) ? ext - rec->name : len;
+        fname = calloc(len+8, 1);
+        if (fname == NULL) return -1;
+        sprintf(fname, "%.*s_%04d%s", pos, rec->name, rec->fcnt, rec->name+pos);
+    }
+    idxname = calloc(strlen(fname)+8, 1);
+    if (idxname == NULL) {
+        if (fname != rec->name) free(fname);
+        return -1;
+    }
+    sprintf(idxname, "%s.idx", fname);
+
+    rec->fp = fopen(fname, "wb");
+    rec->fpidx = fopen(idxname, "wb");
+    if (rec->fp == NULL || rec->fpidx == NULL) {
+        fprintf(stderr, "error: open %s, recording stopped\n", rec->fp == NULL ? fname : idxname);
+        ret = -1;
+    }
+    else {
+        rec->hdr.frame0 = rec->frame_cnt;
+        if (write_hdr(rec->fp, &rec->hdr) < 0 || fflush(rec->fp) != 0) {
+            fprintf(stderr, "error: write %s, recording stopped\n", fname);
+            ret = -1;
+        }
+    }
+    if (fname != rec->name) free(fname);
+    free(idxname);
+    if (ret < 0) {
+        rec_close(rec);
+        return -1;
+    }
+
+    rec->ofs = HDR_LEN;
+    rec->frames = 0;
+    rec->fcnt += 1;
+
+    return 0;
+}
+
+// write error/no open file: message from rec_open() or here, the caller stops recording
+static int rec_chunk(iqr_rec_t *rec) {
+    ui8_t b[CHK_LEN];
+    ui32_t size = 0;
+    int codec;
+
+    if (rec->nbuf == 0) return 0;
+
+    if (rec->split > 0 && rec->frames >= (ui64_t)(rec->split * rec->hdr.sr)) {
+        rec_close(rec);
+    }
+    if (rec->fp == NULL) {
+        // start time of the first frame in the file, sample accurate
+        rec->hdr.t0_us = rec->t_start + (i64_t)(rec->frame_cnt * 1000000ULL / rec->hdr.sr);
+        if (rec_open(rec) < 0) return -1;
+    }
+
+    if (rec->opt_raw) {
+        size = rec->nbuf*2*(rec->hdr.bps/8);
+        memcpy(rec->cbuf, rec->buf, size);
+        codec = 0;
+    }
+    else codec = enc_chunk(rec->buf, rec->hdr.bps, rec->nbuf, rec->cbuf, &size);
+
+    memset(b, 0, CHK_LEN);
+    memcpy(b, "IQCK", 4);
+    b[4] = codec;
+    put_le(b+ 8, rec->nbuf, 4);
+    put_le(b+12, size, 4);
+    put_le(b+16, rec->frame_cnt, 8);
+    if (fwrite(b, CHK_LEN, 1, rec->fp) != 1
+     || fwrite(rec->cbuf, size, 1, rec->fp) != 1
+     || fflush(rec->fp) != 0) goto werr;
+
+    put_le(b, rec->frame_cnt, 8);
+    put_le(b+8, rec->ofs, 8);
+    if (fwrite(b, IDX_LEN, 1, rec->fpidx) != 1
+     || fflush(rec->fpidx) != 0) goto werr;
+
+    rec->ofs += CHK_LEN + size;
+    rec->frames += rec->nbuf;
+    rec->frame_cnt += rec->nbuf;
+    rec->nbuf = 0;
+
+    return 0;
+
+werr:
+    fprintf(stderr, "error: write %s, recording stopped\n", rec->name);
+    return -1;
+}
+
+static int record(iqr_rec_t *rec) {
+    iqr_hdr_t *hdr = &rec->hdr;
+    int fsz = 2*(hdr->bps/8);
+    ui32_t n, len;
+    ui8_t *rbuf = NULL;
+    struct timeval tv;
+    int rec_on = 1;  // 0: recording stopped (error), stdin -> stdout only, like tee
+    int ret = 0;
+
+    rbuf = calloc(RD_FRAMES, fsz);
+    if (rbuf == NULL) {
+        fprintf(stderr, "error: init buffers\n");
+        return -1;
+    }
+    rec->buf  = calloc(hdr->chunk, fsz);
+    rec->cbuf = calloc((hdr->chunk*2/BLK_VALS+1)*BLK_MAX + hdr->chunk*fsz, 1);
+    if (rec->buf == NULL || rec->cbuf == NULL) {
+        fprintf(stderr, "error: init buffers\n");
+        rec_on = 0;
+        ret = -1;
+    }
+
+    while ( !sig_stop && (rec_on || rec->opt_tee) && (len = fread(rbuf, fsz, RD_FRAMES, stdin)) > 0 ) {
+
+        if (rec->frame_cnt == 0 && rec->nbuf == 0) {
+            gettimeofday(&tv, NULL);
+            rec->t_start = (i64_t)tv.tv_sec*1000000 + tv.tv_usec - (i64_t)len*1000000/hdr->sr;
+        }
+
+        if (rec->opt_tee) {
+            if (fwrite(rbuf, fsz, len, stdout) != len || fflush(stdout) != 0) sig_stop = 1;
+        }
+
+        n = 0;
+        while (rec_on && n < len) {
+            ui32_t m = hdr->chunk - rec->nbuf;
+            if (m > len - n) m = len - n;
+            memcpy(rec->buf + rec->nbuf*fsz, rbuf + n*fsz, m*fsz);
+            rec->nbuf += m;
+            n += m;
+            if (rec->nbuf == hdr->chunk && rec_chunk(rec) < 0) {
+                rec_close(rec);
+                rec_on = 0;
+                ret = -1;
+            }
+        }
+    }
+    if (rec_on && rec_chunk(rec) < 0) ret = -1;  // last partial chunk
+
+    rec_close(rec);
+    free(rbuf);
+    free(rec->buf);
+    free(rec->cbuf);
+
+    return ret;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+typedef struct {
+    ui64_t frame0;
+    ui64_t ofs;
+} iqr_idx_t;
+
+// seek index from <name>.idx, or scan chunk headers (no/incomplete index)
+static int load_index(FILE *fp, const char *name, iqr_idx_t **pidx) {
+    char *idxname = NULL;
+    FILE *fpidx = NULL;
+    iqr_idx_t *idx = NULL;
+    int n = 0, max = 0;
+    ui8_t b[IDX_LEN];
+    iqr_chk_t chk;
+    long pos = 0, fsize = 0;
+
+    fseek(fp, 0, SEEK_END);
+    fsize = ftell(fp);
+
+    idxname = calloc(strlen(name)+8, 1);
+    if (idxname) {
+        sprintf(idxname, "%s.idx", name);
+        fpidx = fopen(idxname, "rb");
+        free(idxname);
+    }
+    if (fpidx) {
+        while (fread(b, IDX_LEN, 1, fpidx) == 1) {
+            if (n == max) {
+                max += 1024;
+                idx = realloc(idx, max*sizeof(iqr_idx_t));
+                if (idx == NULL) { fclose(fpidx); return -1; }
+            }
+            idx[n].frame0 = get_le(b, 8);
+            idx[n].ofs = get_le(b+8, 8);
+            if (idx[n].ofs + CHK_LEN > (ui64_t)fsize) break;  // chunk not written
+            n++;
+        }
+        fclose(fpidx);
+    }
+
+    // chunks after the last (complete) index entry
+    while (n > 0) {
+        fseek(fp, idx[n-1].ofs, SEEK_SET);
+        if (read_chk(fp, &chk) < 0 || chk.frame0 != idx[n-1].frame0) { n = 0; break; }  // stale index
+        if (idx[n-1].ofs + CHK_LEN + chk.size <= (ui64_t)fsize) { fseek(fp, chk.size, SEEK_CUR); break; }
+        n--;  // chunk not fully written (disk full, killed)
+    }
+    if (n == 0) fseek(fp, HDR_LEN, SEEK_SET);
+    for (;;) {
+        pos = ftell(fp);
+        if (read_chk(fp, &chk) < 0) break;
+        if (pos + CHK_LEN + (long)chk.size > fsize) break;  // chunk not fully written
+        if (n == max) {
+            max += 1024;
+            idx = realloc(idx, max*sizeof(iqr_idx_t));
+            if (idx == NULL) return -1;
+        }
+        idx[n].frame0 = chk.frame0;
+        idx[n].ofs = pos;
+        n++;
+        if (fseek(fp, chk.size, SEEK_CUR) != 0) break;
+    }
+
+    *pidx = idx;
+    return n;
+}
+
+static int replay(FILE *fp, const char *name, iqr_hdr_t *hdr, ui64_t at, ui64_t len) {
+    iqr_idx_t *idx = NULL;
+    iqr_chk_t chk;
+    ui8_t *in = NULL, *smp = NULL;
+    int fsz = 2*(hdr->bps/8);
+    int n, j, lo, hi;
+    ui64_t frame;
+
+    n = load_index(fp, name, &idx);
+    if (n <= 0) return -1;
+
+    // last chunk with frame0 <= at
+    lo = 0; hi = n-1;
+    while (lo < hi) {
+        int m = (lo + hi + 1) / 2;
+        if (idx[m].frame0 <= at) lo = m; else hi = m-1;
+    }
+
+    for (j = lo; j < n && len > 0; j++) {
+        ui64_t skip = 0, out;
+        fseek(fp, idx[j].ofs, SEEK_SET);
+        if (read_chk(fp, &chk) < 0) break;
+        in = realloc(in, chk.size+1);
+        smp = realloc(smp, (size_t)chk.frames*fsz+1);
+        if (in == NULL || smp == NULL) break;
+        if (fread(in, 1, chk.size, fp) != chk.size) break;
+        if (dec_chunk(in, chk.size, chk.codec, hdr->bps, chk.frames, smp) < 0) {
+            fprintf(stderr, "error: chunk %d\n", j);
+            break;
+        }
+        frame = chk.frame0;
+        if (at > frame) skip = at - frame;
+        if (skip >= chk.frames) continue;
+        out = chk.frames - skip;
+        if (out > len) out = len;
+        if (fwrite(smp + skip*fsz, fsz, out, stdout) != out) break;
+        len -= out;
+    }
+
+    free(idx);
+    free(in);
+    free(smp);
+    return 0;
+}
+
+static int info(FILE *fp, const char *name, iqr_hdr_t *hdr, int verbose) {
+    iqr_idx_t *idx = NULL;
+    iqr_chk_t chk;
+    int n, j;
+    ui64_t frames = 0, bytes = 0;
+    int fsz = 2*(hdr->bps/8);
+    time_t t = hdr->t0_us / 1000000;
+    char tstr[32];
+
+    strftime(tstr, sizeof(tstr), "%Y-%m-%dT%H:%M:%S", gmtime(&t));
+    fprintf(stdout, "fq: %llu Hz\n", hdr->fq);
+    fprintf(stdout, "sr: %u\n", hdr->sr);
+    fprintf(stdout, "bs: %d (%s)\n", hdr->bps, hdr->bps == 8 ? "u8" : "s16");
+    fprintf(stdout, "start: %s.%06dZ (frame %llu)\n", tstr, (int)(hdr->t0_us % 1000000), hdr->frame0);
+
+    n = load_index(fp, name, &idx);
+    for (j = 0; j < n; j++) {
+        fseek(fp, idx[j].ofs, SEEK_SET);
+        if (read_chk(fp, &chk) < 0) break;
+        if (verbose) fprintf(stdout, "  chunk %5d: frame %llu  +%u  codec %d  %u bytes\n",
+                             j, chk.frame0, chk.frames, chk.codec, chk.size);
+        frames += chk.frames;
+        bytes += chk.size;
+    }
+    fprintf(stdout, "chunks: %d\n", n);
+    fprintf(stdout, "frames: %llu (%.3f s)\n", frames, hdr->sr ? frames/(double)hdr->sr : 0.0);
+    if (frames) fprintf(stdout, "ratio: %.3f\n", bytes/(double)(frames*fsz));
+
+    free(idx);
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+
+int main(int argc, char **argv) {
+
+    FILE *fp = NULL;
+    char *fpname = NULL;
+    char *fname = NULL;
+    iqr_rec_t rec = {0};
+    iqr_hdr_t hdr = {0};
+    int option_extract = 0,
+        option_info = 0,
+        option_verbose = 0;
+    double chunk_sec = 1.0;
+    double seek_sec = -1.0, len_sec = -1.0;
+    ui64_t seek_at = 0;
+    int ret = 0;
+
+
+#ifdef CYGWIN
+    _setmode(fileno(stdin), _O_BINARY);  // _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(fileno(stdout), _O_BINARY);
+#endif
+
+    rec.opt_tee = 1;
+
+    fpname = argv[0];
+    ++argv;
+    while (*argv) {
+        if      ( (strcmp(*argv, "-h") == 0) || (strcmp(*argv, "--help") == 0) ) {
+            fprintf(stderr, "%s [options] - <sr> <bs> <out.iqr>\n", fpname);
+            fprintf(stderr, "  record stdin (raw IQ, u8/s16) -> stdout\n");
+            fprintf(stderr, "       --fq <Hz>     (center frequency)\n");
+            fprintf(stderr, "       --chunk <s>   (chunk length, default 1.0s)\n");
+            fprintf(stderr, "       --split <s>   (new file every <s> seconds)\n");
+            fprintf(stderr, "       --raw         (no compression)\n");
+            fprintf(stderr, "       --notee       (no stdout)\n");
+            fprintf(stderr, "%s -x [--seek <s> | --at <n>] [--len <s>] <in.iqr>\n", fpname);
+            fprintf(stderr, "  replay raw IQ -> stdout\n");
+            fprintf(stderr, "%s -i [-v] <in.iqr>\n", fpname);
+            return 0;
+        }
+        else if ( (strcmp(*argv, "-v") == 0) || (strcmp(*argv, "--verbose") == 0) ) {
+            option_verbose = 1;
+        }
+        else if ( (strcmp(*argv, "-x") == 0) ) { option_extract = 1; }
+        else if ( (strcmp(*argv, "-i") == 0) || (strcmp(*argv, "--info") == 0) ) { option_info = 1; }
+        else if ( (strcmp(*argv, "--raw") == 0) ) { rec.opt_raw = 1; }
+        else if ( (strcmp(*argv, "--notee") == 0) ) { rec.opt_tee = 0; }
+        else if ( (strcmp(*argv, "--fq") == 0) ) {
+            ++argv;
+            if (*argv) hdr.fq = (ui64_t)(atof(*argv) + 0.5); else return -1;
+        }
+        else if ( (strcmp(*argv, "--chunk") == 0) ) {
+            ++argv;
+            if (*argv) chunk_sec = atof(*argv); else return -1;
+        }
+        else if ( (strcmp(*argv, "--split") == 0) ) {
+            ++argv;
+            if (*argv) rec.split = atof(*argv); else return -1;
+        }
+        else if ( (strcmp(*argv, "--seek") == 0) ) {
+            ++argv;
+            if (*argv) seek_sec = atof(*argv); else return -1;
+        }
+        else if ( (strcmp(*argv, "--at") == 0) ) {
+            ++argv;
+            if (*argv) seek_at = strtoull(*argv, NULL, 10); else return -1;
+        }
+        else if ( (strcmp(*argv, "--len") == 0) ) {
+            ++argv;
+            if (*argv) len_sec = atof(*argv); else return -1;
+        }
+        else if (strcmp(*argv, "-") == 0) {
+            ++argv;
+            if (*argv) hdr.sr = atoi(*argv); else return -1;
+            ++argv;
+            if (*argv) hdr.bps = atoi(*argv); else return -1;
+            if (hdr.sr < 1 || (hdr.bps != 8 && hdr.bps != 16)) {
+                fprintf(stderr, "- <sr> <bs>  (bs=8,16)\n");
+                return -1;
+            }
+        }
+        else {
+            fname = *argv;
+        }
+        ++argv;
+    }
+    if (fname == NULL) {
+        fprintf(stderr, "error: no file\n");
+        return -1;
+    }
+
+
+    if (option_extract || option_info) {
+        fp = fopen(fname, "rb");
+        if (fp == NULL) {
+            fprintf(stderr, "error: open %s\n", fname);
+            return -1;
+        }
+        if (read_hdr(fp, &hdr) < 0) {
+            fprintf(stderr, "error: header %s\n", fname);
+            fclose(fp);
+            return -1;
+        }
+        if (option_info) ret = info(fp, fname, &hdr, option_verbose);
+        else {
+            ui64_t at = hdr.frame0;  // --at: frames since start of recording
+            ui64_t len = ~0ULL;      // --seek: seconds from start of file
+            if (seek_at > at) at = seek_at;
+            if (seek_sec > 0) at = hdr.frame0 + (ui64_t)(seek_sec * hdr.sr + 0.5);
+            if (len_sec >= 0) len = (ui64_t)(len_sec * hdr.sr + 0.5);
+            ret = replay(fp, fname, &hdr, at, len);
+        }
+        fclose(fp);
+        return ret;
+    }
+
+
+    if (hdr.sr == 0) {
+        fprintf(stderr, "error: - <sr> <bs>\n");
+        return -1;
+    }
+    hdr.nch = 2;
+    if (chunk_sec < 0.01) chunk_sec = 0.01;
+    hdr.chunk = (ui32_t)(chunk_sec * hdr.sr);
+    if (hdr.chunk < BLK_VALS) hdr.chunk = BLK_VALS;
+    rec.hdr = hdr;
+    rec.name = fname;
+
+    signal(SIGTERM, sig_handler);
+    signal(SIGINT,  sig_handler);
+#ifdef SIGPIPE
+    signal(SIGPIPE, SIG_IGN);  // write error on stdout: close last chunk, exit
+#endif
+#ifdef SIGXFSZ
+    signal(SIGXFSZ, SIG_IGN);  // file size limit: write error, recording stopped, stdin -> stdout
+#endif
+
+    ret = record(&rec);
+
+    return ret;
+}
+
@@ -51,6 +51,8 @@
 //typedef unsigned int   ui32_t;
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 //#define  INCLUDESTATIC 1
 #ifdef INCLUDESTATIC
@@ -342,35 +344,40 @@ static int viterbi(VIT_t *vit, hsbit_t *rc) {
 
 // ------------------------------------------------------------------------
 
-static int deconv(hsbit_t *rawbits, char *bits) {
+static int deconv(hsbit_t *rawbits, ui8_t *bits, int *nbits) {
 
-    int j, n, bitA, bitB;
+    int j, n, bit, bitA, bitB;
     hsbit_t *p;
     int len;
     int errors = 0;
     int m = L-1;
+    ui32_t mskA = 0, mskB = 0;
+    ui32_t reg = 0;  // bits[n..n+m-1], bits[n+m-1] = lsb
 
+    for (j = 0; j < m; j++) {
+        mskA = (mskA << 1) | (polyA[j]&1);
+        mskB = (mskB << 1) | (polyB[j]&1);
+        bits_set(bits, j, 0);
+    }
     len = hbstr_len(rawbits);
-    for (j = 0; j < m; j++) bits[j] = '0';
     n = 0;
     while ( 2*(m+n) < len ) {
         p = rawbits+2*(m+n);
-        bitA = bitB = 0;
-        for (j = 0; j < m; j++) {
-            bitA ^= (bits[n+j]&1) & (polyA[j]&1);
-            bitB ^= (bits[n+j]&1) & (polyB[j]&1);
-        }
-        if      ( (bitA^(p[0].hb&1))==(polyA[m]&1)  &&  (bitB^(p[1].hb&1))==(polyB[m]&1) ) bits[n+m] = '1';
-        else if ( (bitA^(p[0].hb&1))==0             &&  (bitB^(p[1].hb&1))==0            ) bits[n+m] = '0';
+        bitA = bits_popc64(reg & mskA) & 1;
+        bitB = bits_popc64(reg & mskB) & 1;
+        bitA ^= p[0].hb&1;
+        bitB ^= p[1].hb&1;
+        if      ( bitA==(polyA[m]&1)  &&  bitB==(polyB[m]&1) ) bit = 1;
+        else if ( bitA==0             &&  bitB==0            ) bit = 0;
         else {
-            if ( (bitA^(p[0].hb&1))!=(polyA[m]&1) && (bitB^(p[1].hb&1))==(polyB[m]&1) ) bits[n+m] = 0x39;
-            else bits[n+m] = 0x38;
             errors = n;
             break;
         }
+        bits_set(bits, n+m, bit);
+        reg = ((reg << 1) | bit) & ((1<<m)-1);
         n += 1;
     }
-    bits[n+m] = '\0';
+    *nbits = n+m;
 
     return errors;
 }
@@ -412,34 +419,6 @@ static int check_CRC(ui8_t frame[]) {
 
 // ------------------------------------------------------------------------
 
-static int bits2bytes(char *bitstr, ui8_t *bytes) {
-    int i, bit, d, byteval;
-    int len = strlen(bitstr)/8;
-    int bitpos, bytepos;
-
-    bitpos = 0;
-    bytepos = 0;
-
-    while (bytepos < len) {
-
-        byteval = 0;
-        d = 1;
-        for (i = 0; i < BITS; i++) {
-            bit=*(bitstr+bitpos+i);   /* little endian */
-            //bit=*(bitstr+bitpos+7-i);  /* big endian */
-            if        ((bit == '1') || (bit == '9'))    byteval += d;
-            else /*if ((bit == '0') || (bit == '8'))*/  byteval += 0;
-            d <<= 1;
-        }
-        bitpos += BITS;
-        bytes[bytepos++] = byteval & 0xFF;
-    }
-
-    //while (bytepos < FRAME_LEN+OVERLAP) bytes[bytepos++] = 0;
-
-    return bytepos;
-}
-
 /* -------------------------------------------------------------------------- */
 
 
@@ -778,6 +757,9 @@ static void print_frame(gpx_t *gpx, int crc_err, int len) {
                     if (gpx->jsn_freq > 0) {
                         printf(", \"freq\": %d", gpx->jsn_freq);
                     }
+                    if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                        printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                    }
 
                     // Reference time/position
                     printf(", \"ref_datetime\": \"%s\"", "GPS" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
@@ -843,13 +825,13 @@ static void proc_frame(gpx_t *gpx, int len) {
     int blk_pos = SYNC_LEN;
     ui8_t block_bytes[FRAME_LEN+8];
     ui8_t rs_cw[rs_N];
-    char  frame_bits[BITFRAME_LEN+OVERLAP*BITS +8];  // init L-1 bits mit 0
+    ui8_t frame_bits[(BITFRAME_LEN+OVERLAP*BITS)/8 +8];  // packed, init L-1 bits mit 0
     hsbit_t *rawbits = NULL;
     int i, j;
     int err = 0;
     int errs = 0;
     int crc_err = 0;
-    int flen, blen;
+    int flen, blen, nbits;
 
 
     if ((len % 8) > 4) {
@@ -864,17 +846,20 @@ static void proc_frame(gpx_t *gpx, int len) {
     flen = len / (2*BITS);
 
     if (gpx->option.vit) {
+        prf_enter(PRF_ECC);
         viterbi(gpx->vit, gpx->blk_rawbits);
+        prf_leave();
         rawbits = gpx->vit->rawbits;
     }
     else rawbits = gpx->blk_rawbits;
 
-    err = deconv(rawbits, frame_bits);
+    err = deconv(rawbits, frame_bits, &nbits);
 
-    if (err) { for (i=err; i < RAWBITBLOCK_LEN/2; i++) frame_bits[i] = 0; }
+    if (err && err < RAWBITBLOCK_LEN/2) nbits = err;
 
 
-    blen = bits2bytes(frame_bits, block_bytes);
+    blen = nbits / BITS;
+    bits2bytes_lsb(frame_bits, 0, block_bytes, blen);
     for (j = blen; j < FRAME_LEN+8; j++) block_bytes[j] = 0;
 
 
@@ -884,7 +869,9 @@ static void proc_frame(gpx_t *gpx, int len) {
     {
         if (gpx->option.ecc) {
             for (j = 0; j < rs_N; j++) rs_cw[rs_N-1-j] = block_bytes[SYNC_LEN+j];
+            prf_enter(PRF_ECC);
             errs = lms6_ecc(gpx, rs_cw);
+            prf_leave();
             for (j = 0; j < rs_N; j++) block_bytes[SYNC_LEN+j] = rs_cw[rs_N-1-j];
         }
 
@@ -919,7 +906,11 @@ static void proc_frame(gpx_t *gpx, int len) {
                     printf("\n");
                 }
 
-                if (gpx->option.raw == 0) print_frame(gpx, crc_err, len);
+                if (gpx->option.raw == 0) {
+                    prf_enter(PRF_OUT);
+                    print_frame(gpx, crc_err, len);
+                    prf_leave();
+                }
 
                 gpx->frm_pos = 0;
                 gpx->sf6 = 0;
@@ -968,7 +959,9 @@ static void proc_frame(gpx_t *gpx, int len) {
         {
             if (blen > 100 && gpx->option.ecc) {
                 for (j = 0; j < rs_N; j++) rs_cw[rs_N-1-j] = block_bytes[blk_pos+j];
+                prf_enter(PRF_ECC);
                 errs = lms6_ecc(gpx, rs_cw);
+                prf_leave();
                 for (j = 0; j < rs_N; j++) block_bytes[blk_pos+j] = rs_cw[rs_N-1-j];
             }
 
@@ -982,7 +975,11 @@ static void proc_frame(gpx_t *gpx, int len) {
                 printf("\n");
             }
 
-            if (gpx->option.raw == 0) print_frame(gpx, crc_err, len);
+            if (gpx->option.raw == 0) {
+                prf_enter(PRF_OUT);
+                print_frame(gpx, crc_err, len);
+                prf_leave();
+            }
         }
     }
 
@@ -1105,6 +1102,11 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
             if (*argv) {
@@ -1150,6 +1152,8 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) {
             gpx->option.jsn = 1;
             gpx->option.ecc = 1;
@@ -1295,6 +1299,7 @@ int main(int argc, char **argv) {
         }
     }
     else {
+        if (option_softin) f32soft_br(BAUD_RATE6);  // check fsk_demod -F / --fsk symbol rate
         // init circular header bit buffer
         hdb.hdr = rawheader;
         hdb.len = strlen(rawheader);
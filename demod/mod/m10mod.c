@@ -32,6 +32,8 @@
 
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 
 typedef struct {
@@ -101,8 +103,7 @@ typedef struct {
     ui8_t utc_ofs;
     char SN[12];
     ui8_t SNraw[5];
-    ui8_t frame_bytes[FRAME_LEN+AUX_LEN+4];
-    char frame_bits[BITFRAME_LEN+BITAUX_LEN+8];
+    ui8_t frame_bytes[FRAME_LEN+AUX_LEN+4];  // frame bits, packed
     int auxlen; // 0 .. 0x76-0x64
     int jsn_freq;   // freq/kHz (SDR)
     option_t option;
@@ -138,37 +139,6 @@ static void Gps2Date(long GpsWeek, long GpsSeconds, int *Year, int *Month, int *
 }
 /* -------------------------------------------------------------------------- */
 
-static int bits2bytes(char *bitstr, ui8_t *bytes) {
-    int i, bit, d, byteval;
-    int bitpos, bytepos;
-
-    bitpos = 0;
-    bytepos = 0;
-
-    while (bytepos < FRAME_LEN+AUX_LEN) {
-
-        byteval = 0;
-        d = 1;
-        for (i = 0; i < BITS; i++) {
-            //bit=*(bitstr+bitpos+i); /* little endian */
-            bit=*(bitstr+bitpos+7-i);  /* big endian */
-            // bit == 'x' ?
-            if         (bit == '1')                     byteval += d;
-            else /*if ((bit == '0') || (bit == 'x'))*/  byteval += 0;
-            d <<= 1;
-        }
-        bitpos += BITS;
-        bytes[bytepos++] = byteval & 0xFF;
-
-    }
-
-    //while (bytepos < FRAME_LEN+AUX_LEN) bytes[bytepos++] = 0;
-
-    return 0;
-}
-
-/* -------------------------------------------------------------------------- */
-
 /*
 M10 w/ trimble GPS
 
@@ -1026,6 +996,9 @@ static int print_pos(gpx_t *gpx, int csOK) {
                 if (gpx->jsn_freq > 0) {
                     fprintf(stdout, ", \"freq\": %d", gpx->jsn_freq);
                 }
+                if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                    fprintf(stdout, ", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                }
 
                 // Reference time/position       (M10 time ref UTC only for json)
                 fprintf(stdout, ", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
@@ -1046,15 +1019,12 @@ static int print_pos(gpx_t *gpx, int csOK) {
     return err;
 }
 
-static int print_frame(gpx_t *gpx, int pos, int b2B) {
+static int print_frame(gpx_t *gpx, int pos) {
     int i;
     ui8_t byte;
     int cs1, cs2;
     int flen = stdFLEN; // stdFLEN=0x64, auxFLEN=0x76
 
-    if (b2B) {
-        bits2bytes(gpx->frame_bits, gpx->frame_bytes);
-    }
     flen = gpx->frame_bytes[0];
     if (flen == stdFLEN) gpx->auxlen = 0;
     else {
@@ -1121,7 +1091,9 @@ static int print_frame(gpx_t *gpx, int pos, int b2B) {
             fprintf(stdout, "\n");
         }
         if (gpx->frame_bytes[1] != 0x49 && gpx->option.slt /*&& gpx->option.jsn*/) {
+            prf_enter(PRF_OUT);
             print_pos(gpx, cs1 == cs2);
+            prf_leave();
         }
     }
     else if (gpx->frame_bytes[1] == 0x49) {
@@ -1134,7 +1106,11 @@ static int print_frame(gpx_t *gpx, int pos, int b2B) {
             fprintf(stdout, "\n");
         }
     }
-    else print_pos(gpx, cs1 == cs2);
+    else {
+        prf_enter(PRF_OUT);
+        print_pos(gpx, cs1 == cs2);
+        prf_leave();
+    }
 
     return (gpx->frame_bytes[0]<<8)|gpx->frame_bytes[1];
 }
@@ -1234,6 +1210,11 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--silent") == 0) { gpx.option.slt = 1; }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
@@ -1280,6 +1261,8 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) { gpx.option.jsn = 1; }
         else if   (strcmp(*argv, "--jsn_cfq") == 0) {
             int frq = -1;  // center frequency / Hz
@@ -1405,6 +1388,7 @@ int main(int argc, char **argv) {
             bitofs += shift;
         }
         else {
+            if (option_softin) f32soft_br(BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = rawheader;
             hdb.len = strlen(rawheader);
@@ -1449,7 +1433,7 @@ int main(int argc, char **argv) {
                 bitpos = 0;
                 pos = 0;
                 pos /= 2;
-                bit0 = '0'; // oder: _mv[j] > 0
+                bit0 = -1; // 1st bit 0 (flen < 0x80) // oder: _mv[j] > 0
 
                 while ( pos < BITFRAME_LEN+BITAUX_LEN ) {
 
@@ -1480,13 +1464,13 @@ int main(int argc, char **argv) {
                     }
                     if ( bitQ == EOF ) { break; }
 
-                    gpx.frame_bits[pos] = 0x31 ^ (bit0 ^ bit);
+                    bits_set(gpx.frame_bytes, pos, bit0 == bit);
                     pos++;
                     bit0 = bit;
                     bitpos += 1;
                 }
-                gpx.frame_bits[pos] = '\0';
-                print_frame(&gpx, pos, 1);
+                bits_set(gpx.frame_bytes, pos, 0);
+                print_frame(&gpx, pos);
                 if (pos < BITFRAME_LEN) break;
 
                 header_found = 0;
@@ -1540,7 +1524,7 @@ int main(int argc, char **argv) {
                     // wenn ohne %hhx: sscanf(buffer_rawhex+rawhex*i, "%2x", &byte); frame[frameofs+i] = (ui8_t)byte;
                     gpx.frame_bytes[frameofs+i] = frmbyte;
                 }
-                print_frame(&gpx, len*8, 0);
+                print_frame(&gpx, len*8);
             }
         }
     }
@@ -39,6 +39,8 @@
 
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 
 typedef struct {
@@ -110,8 +112,7 @@ typedef struct {
     ui8_t fwVer;
     char SN[12+4];
     ui8_t SNraw[3];
-    ui8_t frame_bytes[FRAME_LEN+AUX_LEN+4];
-    char frame_bits[BITFRAME_LEN+BITAUX_LEN+8];
+    ui8_t frame_bytes[FRAME_LEN+AUX_LEN+4];  // frame bits, packed
     int auxlen; // ? 0 .. 0x57-0x45
     int jsn_freq;   // freq/kHz (SDR)
     option_t option;
@@ -147,37 +148,6 @@ static void Gps2Date(long GpsWeek, long GpsSeconds, int *Year, int *Month, int *
 }
 /* -------------------------------------------------------------------------- */
 
-static int bits2bytes(char *bitstr, ui8_t *bytes) {
-    int i, bit, d, byteval;
-    int bitpos, bytepos;
-
-    bitpos = 0;
-    bytepos = 0;
-
-    while (bytepos < FRAME_LEN+AUX_LEN) {
-
-        byteval = 0;
-        d = 1;
-        for (i = 0; i < BITS; i++) {
-            //bit=*(bitstr+bitpos+i); /* little endian */
-            bit=*(bitstr+bitpos+7-i);  /* big endian */
-            // bit == 'x' ?
-            if         (bit == '1')                     byteval += d;
-            else /*if ((bit == '0') || (bit == 'x'))*/  byteval += 0;
-            d <<= 1;
-        }
-        bitpos += BITS;
-        bytes[bytepos++] = byteval & 0xFF;
-
-    }
-
-    //while (bytepos < FRAME_LEN+AUX_LEN) bytes[bytepos++] = 0;
-
-    return 0;
-}
-
-/* -------------------------------------------------------------------------- */
-
 /*
 M20
 
@@ -848,6 +818,9 @@ static int print_pos(gpx_t *gpx, int bcOK, int csOK) {
                 if (gpx->jsn_freq > 0) {
                     fprintf(stdout, ", \"freq\": %d", gpx->jsn_freq);
                 }
+                if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                    fprintf(stdout, ", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                }
 
                 // Reference time/position
                 fprintf(stdout, ", \"ref_datetime\": \"%s\"", "GPS" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
@@ -867,7 +840,7 @@ static int print_pos(gpx_t *gpx, int bcOK, int csOK) {
     return err;
 }
 
-static int print_frame(gpx_t *gpx, int pos, int b2B) {
+static int print_frame(gpx_t *gpx, int pos) {
     int i;
     ui8_t byte;
     int cs1, cs2;
@@ -876,9 +849,6 @@ static int print_frame(gpx_t *gpx, int pos, int b2B) {
     int pos_fw = pos_stdFW;
     int pos_check = pos_stdCheck;
 
-    if (b2B) {
-        bits2bytes(gpx->frame_bits, gpx->frame_bytes);
-    }
     flen = gpx->frame_bytes[0];
     if (flen == stdFLEN) gpx->auxlen = 0;
     else {
@@ -974,7 +944,9 @@ static int print_frame(gpx_t *gpx, int pos, int b2B) {
             fprintf(stdout, "\n");
         }
         if (gpx->option.slt /*&& gpx->option.jsn && gpx->frame_bytes[1] != 0x49*/) {
+            prf_enter(PRF_OUT);
             print_pos(gpx, bc, cs1 == cs2);
+            prf_leave();
         }
     }
     /*
@@ -989,7 +961,11 @@ static int print_frame(gpx_t *gpx, int pos, int b2B) {
         }
     }
     */
-    else print_pos(gpx, bc, cs1 == cs2);
+    else {
+        prf_enter(PRF_OUT);
+        print_pos(gpx, bc, cs1 == cs2);
+        prf_leave();
+    }
 
     return (gpx->frame_bytes[0]<<8)|gpx->frame_bytes[1];
 }
@@ -1097,6 +1073,11 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--silent") == 0) { gpx.option.slt = 1; }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
@@ -1143,6 +1124,8 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) { gpx.option.jsn = 1; }
         else if   (strcmp(*argv, "--jsn_cfq") == 0) {
             int frq = -1;  // center frequency / Hz
@@ -1274,6 +1257,7 @@ int main(int argc, char **argv) {
             bitofs += shift;
         }
         else {
+            if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = rawheader;
             hdb.len = strlen(rawheader);
@@ -1318,7 +1302,7 @@ int main(int argc, char **argv) {
                 bitpos = 0;
                 pos = 0;
                 pos /= 2;
-                bit0 = '0'; // oder: _mv[j] > 0
+                bit0 = -1; // 1st bit 0 (flen < 0x80) // oder: _mv[j] > 0
 
                 while ( pos < BITFRAME_LEN+BITAUX_LEN ) {
 
@@ -1345,13 +1329,13 @@ int main(int argc, char **argv) {
                     }
                     if ( bitQ == EOF ) { break; }
 
-                    gpx.frame_bits[pos] = 0x31 ^ (bit0 ^ bit);
+                    bits_set(gpx.frame_bytes, pos, bit0 == bit);
                     pos++;
                     bit0 = bit;
                     bitpos += 1;
                 }
-                gpx.frame_bits[pos] = '\0';
-                print_frame(&gpx, pos, 1);
+                bits_set(gpx.frame_bytes, pos, 0);
+                print_frame(&gpx, pos);
                 if (pos < BITFRAME_LEN) break;
 
                 header_found = 0;
@@ -1406,7 +1390,7 @@ int main(int argc, char **argv) {
                     // wenn ohne %hhx: sscanf(buffer_rawhex+rawhex*i, "%2x", &byte); frame[frameofs+i] = (ui8_t)byte;
                     gpx.frame_bytes[frameofs+i] = frmbyte;
                 }
-                print_frame(&gpx, len*8, 0);
+                print_frame(&gpx, len*8);
             }
         }
     }
@@ -122,6 +122,8 @@ e.g. -b --br 2398
 //typedef short i16_t;
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 //#define  INCLUDESTATIC 1
 #ifdef INCLUDESTATIC
@@ -143,8 +145,8 @@ typedef struct {
     double vH; double vD; double vV;
     ui16_t f_ref;
     float T; float RH;
-    char frame_rawbits[RAWBITFRAME_LEN+10];
-    ui8_t frame_bits[BITFRAME_LEN+10];
+    ui64_t frame_rawbits[RAWBITFRAME_LEN/64+2];  // packed raw chips
+    ui8_t frame_bits[BITFRAME_LEN/8+8];          // packed bits
     ui32_t ecc;
     float cfg[64];
     ui64_t cfg_valid;
@@ -155,7 +157,7 @@ typedef struct {
     int frm0_count; int frm0_valid;
     int frm1_count; int frm1_valid;
     int vV_valid;
-    RS_t RS;
+    BCH63_t bch;
 } gpx_t;
 
 /* -------------------------------------------------------------------------- */
@@ -210,43 +212,14 @@ static char *rawheader = header0x049DCE;
 
 /* -------------------------------------------------------------------------- */
 
-static int biphi_s(char* frame_rawbits, ui8_t *frame_bits) {
-    int j = 0;
-    int byt;
-
-    j = 0;
-    while ((byt = frame_rawbits[2*j]) && frame_rawbits[2*j+1]) {
-        if ((byt < 0x30) || (byt > 0x31)) break;
-
-        if ( frame_rawbits[2*j] == frame_rawbits[2*j+1] ) { byt = 1; }
-        else                                              { byt = 0; }
-
-        frame_bits[j] = byt;
-        j++;
-    }
-    frame_bits[j] = 0;
-    return j;
-}
-
-/* -------------------------------------------------------------------------- */
-
-static ui32_t bits2val(ui8_t bits[], int len) {
-    int j;
-    ui8_t bit;
-    ui32_t val;
+static ui32_t bits2val(ui8_t *bits, int pos, int len) {  // big endian
     if ((len < 0) || (len > 32)) return -1;
-    val = 0;
-    for (j = 0; j < len; j++) {
-                bit = bits[j];
-                val |= (bit << (len-1-j)); // big endian
-                //val |= (bit << j);      // little endian
-    }
-    return val;
+    return bits_get(bits, pos, len);
 }
 
-static int get_w16(ui8_t *subframe_bits, int j) {
+static int get_w16(ui8_t *frame_bits, int subframe_pos, int j) {
     if (j < 0 || j > 11) return -1;
-    return bits2val(subframe_bits+HEADLEN+46*(j/2)+17*(j%2), 16);
+    return bits2val(frame_bits, subframe_pos+HEADLEN+46*(j/2)+17*(j%2), 16);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -306,7 +279,7 @@ static int sanity_check_ims100_config_temperature(gpx_t *gpx) {
 static int reset_gpx(gpx_t *gpx) {
     int j;
     for (j = 0; j < 64; j++) gpx->cfg[j] = 0.0f;
-    // DON'T RESET frame_(raw)bits and Reed-Solomon RS !
+    // DON'T RESET frame_(raw)bits and BCH tables !
     gpx->sn = -1;
     gpx->frnr = gpx->frnr1 = 0;
     gpx->jahr = gpx->monat = gpx->tag = 0;
@@ -381,7 +354,7 @@ int main(int argc, char **argv) {
     ui8_t block_err[6];
     int block;
 
-    ui8_t *subframe_bits;
+    int subframe_pos;
 
     int counter;
     ui32_t val;
@@ -470,6 +443,11 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
             if (*argv) {
@@ -515,6 +493,8 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) {
             option_jsn = 1;
             option_ecc = 1;
@@ -652,6 +632,7 @@ int main(int argc, char **argv) {
         bitofs += shift;
     }
     else {
+        if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
         // init circular header bit buffer
         hdb.hdr = rawheader;
         hdb.len = strlen(rawheader);
@@ -675,7 +656,7 @@ int main(int argc, char **argv) {
 
 
     if (option_ecc) {
-        rs_init_BCH64(&gpx.RS);
+        bch63_init(&gpx.bch);
     }
 
     gpx.sn = -1;
@@ -697,9 +678,7 @@ int main(int argc, char **argv) {
         if (header_found) {
 
             bitpos = 0;
-            for (j = 0; j < HEADLEN; j++) {
-                gpx.frame_bits[j] = header0x049DCEbits[j] - 0x30;
-            }
+            bits_put(gpx.frame_bits, 0, HEADLEN, 0x049DCE);  // header0x049DCEbits
 
 
             while (bitpos < RAWBITFRAME_LEN/2-RAWHEADLEN) {  // 2*600-48
@@ -713,14 +692,12 @@ int main(int argc, char **argv) {
                 }
                 if (bitQ == EOF) { break; }
 
-                gpx.frame_rawbits[bitpos] = 0x30 + bit;
+                chips_put(gpx.frame_rawbits, bitpos, bit);
                 bitpos++;
             }
 
             if (bitpos >= RAWBITFRAME_LEN/2-RAWHEADLEN) {  // 2*600-48
-                gpx.frame_rawbits[bitpos] = '\0';
-
-                biphi_s(gpx.frame_rawbits, gpx.frame_bits+HEADLEN);
+                biphase_s_dec(gpx.frame_rawbits, bitpos, gpx.frame_bits, HEADLEN);  // biphase-S: 64 chips -> 32 bits
 
                 gps_chk_sum = 0;
                 gps_err = 0;
@@ -729,40 +706,44 @@ int main(int argc, char **argv) {
 
                 for (subframe = 0; subframe < 2; subframe++)
                 {                                                       // option_ims100:
-                    subframe_bits = gpx.frame_bits;                     // subframe 0: 049DCE
-                    if (subframe > 0) subframe_bits += BITFRAME_LEN/4;  // subframe 1: FB6230
+                    subframe_pos = 0;                                   // subframe 0: 049DCE
+                    if (subframe > 0) subframe_pos += BITFRAME_LEN/4;   // subframe 1: FB6230
 
                     if (option_ecc) {
                         int   errors;
-                        ui8_t cw[63+1],  // BCH(63,51), t=2
-                              err_pos[4],
-                              err_val[4];
-                        int check_err;
+                        ui64_t cw[6];  // BCH(63,51), t=2
+                        int   blk_errors[6];
+                        int   check_err;
 
+                        // prepare block-codewords
                         for (block = 0; block < 6; block++) {
+                            cw[block] = bits_get(gpx.frame_bits, subframe_pos+HEADLEN + block*46, 46);
+                        }
+
+                        prf_enter(PRF_ECC);
+                        bch63_decode_blocks(&gpx.bch, cw, 6, blk_errors);
+                        prf_leave();
 
-                            // prepare block-codeword
-                            for (j =  0; j < 46; j++) cw[45-j] = subframe_bits[HEADLEN + block*46+j];
-                            for (j = 46; j < 63; j++) cw[j] = 0;
+                        for (block = 0; block < 6; block++) {
 
-                            errors = rs_decode_bch_gf2t2(&gpx.RS, cw, err_pos, err_val);
+                            errors = blk_errors[block];
 
                             // check parity,padding
                             if (errors >= 0) {
                                 int par = 0;
                                 check_err = 0;
-                                for (j = 46; j < 63; j++) { if (cw[j] != 0) check_err = 0x1; }
+                                if (cw[block] >> 46) check_err = 0x1;
                                 par = 1;
-                                for (j = 13; j < 13+16; j++) par ^= cw[j];
-                                if (cw[12] != par) check_err |= 0x100;
+                                for (j = 13; j < 13+16; j++) par ^= (cw[block] >> j) & 1;
+                                if (((cw[block] >> 12) & 1) != par) check_err |= 0x100;
                                 par = 1;
-                                for (j = 30; j < 30+16; j++) par ^= cw[j];
-                                if (cw[29] != par) check_err |= 0x10;
+                                for (j = 30; j < 30+16; j++) par ^= (cw[block] >> j) & 1;
+                                if (((cw[block] >> 29) & 1) != par) check_err |= 0x10;
                                 if (check_err) errors = -3;
                             }
                             if (errors >= 0) // errors > 0
                             {
-                                for (j = 0; j < 46; j++) subframe_bits[HEADLEN + block*46+j] = cw[45-j];
+                                bits_put(gpx.frame_bits, subframe_pos+HEADLEN + block*46, 46, cw[block]);
                             }
 
                             if (errors < 0) {
@@ -791,12 +772,12 @@ int main(int argc, char **argv) {
                             //float *fcfg = (float *)&w32;
                             float fw32;
 
-                            val = bits2val(subframe_bits+HEADLEN, 16);
+                            val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN, 16);
                             counter = val & 0xFFFF;
                             printf("[%d] ", counter);
 
                             // 0x30yy, 0x31yy
-                            val = bits2val(subframe_bits+HEADLEN+46*3+17, 16);
+                            val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*3+17, 16);
                             if ( (val & 0xFF) >= 0xC0 && err_frm == 0) {
                                 option_ims100 = 1;
                                 printf("\n");
@@ -804,8 +785,8 @@ int main(int argc, char **argv) {
                                 goto jmpIMS;
                             }
 
-                            w16[0] = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                            w16[1] = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
+                            w16[0] = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                            w16[1] = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
                             //w32 = (w16[1]<<16) | w16[0];
                             w32 =  ( (w16[1]&0xFF00)>>8 | (w16[1]&0xFF)<<8 ) << 16
                                  | ( (w16[0]&0xFF00)>>8 | (w16[0]&0xFF)<<8 );
@@ -827,7 +808,7 @@ int main(int argc, char **argv) {
 
                                 //PTU: Save reference frequency (sent in both even and odd frames)
                                 if (counter % 4 == 0) {
-                                    gpx.f_ref = bits2val(subframe_bits+HEADLEN+0*46+17, 16);
+                                    gpx.f_ref = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+0*46+17, 16);
                                 }
 
                                 if (counter % 2 == 0) {
@@ -839,7 +820,7 @@ int main(int argc, char **argv) {
                                             int U_cfg = ((gpx.cfg_valid & 0x001E000000000000LL) == 0x001E000000000000LL); // cfg[52:49]
                                             // Necessary parameters must exist and their values must meet the requirements
                                             if (T_cfg && sanity_check_rs11g_config_temperature(&gpx)) {
-                                                ui16_t t_raw = bits2val(subframe_bits+HEADLEN+2*46+17, 16);
+                                                ui16_t t_raw = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+2*46+17, 16);
                                                 float f = ((float)t_raw / (float)gpx.f_ref) * 4.0f;
                                                 if (f > 1.0f) {
                                                     // Use config coefficients to transform measured frequency to absolute resistance (kOhms)
@@ -871,7 +852,7 @@ int main(int argc, char **argv) {
                                                 else T_cfg = 0;
                                             }
                                             if (U_cfg) {
-                                                ui16_t u_raw = bits2val(subframe_bits+HEADLEN+3*46, 16);
+                                                ui16_t u_raw = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+3*46, 16);
                                                 float f = ((float)u_raw / (float)gpx.f_ref) * 4.0f;
                                                 gpx.RH = gpx.cfg[49] + gpx.cfg[50]*f + gpx.cfg[51]*f*f + gpx.cfg[52]*f*f*f;
                                                 // Limit to 0...100%
@@ -886,11 +867,11 @@ int main(int argc, char **argv) {
                             }
 
                             if (counter % 2 == 1) {
-                                t2 = bits2val(subframe_bits+HEADLEN+5*46  , 8);  // LSB
-                                t1 = bits2val(subframe_bits+HEADLEN+5*46+8, 8);
+                                t2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46  , 8);  // LSB
+                                t1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+8, 8);
                                 ms = (t1 << 8) | t2;
-                                std = bits2val(subframe_bits+HEADLEN+5*46+17, 8);
-                                min = bits2val(subframe_bits+HEADLEN+5*46+25, 8);
+                                std = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+17, 8);
+                                min = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+25, 8);
                                 if (std < 24 && min < 60 && ms < 60000) { // ui32_t ms, min, std
                                     printf("  ");
                                     printf("%02d:%02d:%06.3f ", std, min, (double)ms/1000.0);
@@ -910,6 +891,7 @@ int main(int argc, char **argv) {
                                         if (gpx.sn > 0 && gpx.sn < 1e9) {
                                             sprintf(id_str, "%.0f", gpx.sn);
                                         }
+                                        prf_enter(PRF_OUT);
                                         printf("{ \"type\": \"%s\"", "MEISEI");
                                         printf(", \"frame\": %d, \"id\": \"RS11G-%s\", \"datetime\": \"%04d-%02d-%02dT%02d:%02d:%06.3fZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.5f, \"vel_h\": %.5f, \"heading\": %.5f, \"vel_v\": %.5f",
                                                gpx.frnr, id_str, gpx.jahr, gpx.monat, gpx.tag, gpx.std, gpx.min, gpx.sek, gpx.lat, gpx.lon, gpx.alt, gpx.vH, gpx.vD, gpx.vV );
@@ -925,6 +907,9 @@ int main(int argc, char **argv) {
                                         if (gpx.jsn_freq > 0) {
                                             printf(", \"freq\": %d", gpx.jsn_freq);
                                         }
+                                        if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                                            printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                                        }
                                         if (gpx.fq > 0) { // include frequency derived from subframe information if available
                                             fprintf(stdout, ", \"tx_frequency\": %.0f", gpx.fq );
                                         }
@@ -939,6 +924,7 @@ int main(int argc, char **argv) {
                                         if (ver_jsn && *ver_jsn != '\0') printf(", \"version\": \"%s\"", ver_jsn);
                                         printf(" }\n");
                                         printf("\n");
+                                        prf_leave();
                                     }
 
                                 }
@@ -950,12 +936,12 @@ int main(int argc, char **argv) {
                             if (counter % 2 == 0) {
                                 //offset=24+16+1;
 
-                                lat1 = bits2val(subframe_bits+HEADLEN+46*0+17, 16);
-                                lat2 = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                                lon1 = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
-                                lon2 = bits2val(subframe_bits+HEADLEN+46*2   , 16);
-                                alt1 = bits2val(subframe_bits+HEADLEN+46*2+17, 16);
-                                alt2 = bits2val(subframe_bits+HEADLEN+46*3   , 16);
+                                lat1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*0+17, 16);
+                                lat2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                                lon1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
+                                lon2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*2   , 16);
+                                alt1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*2+17, 16);
+                                alt2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*3   , 16);
 
                                 lat = (lat1 << 16) | lat2;
                                 lon = (lon1 << 16) | lon2;
@@ -965,18 +951,18 @@ int main(int argc, char **argv) {
                                 printf("lat: %.5f  lon: %.5f  alt: %.2f", (double)lat/1e7, (double)lon/1e7, (double)alt/1e2);
                                 printf("  ");
 
-                                vH = bits2val(subframe_bits+HEADLEN+46*3+17, 16);
-                                vD = bits2val(subframe_bits+HEADLEN+46*4   , 16);
-                                vU = bits2val(subframe_bits+HEADLEN+46*4+17, 16);
+                                vH = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*3+17, 16);
+                                vD = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*4   , 16);
+                                vU = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*4+17, 16);
                                 velH = (double)vH/1e2;
                                 velD = (double)vD/1e2;
                                 velU = (double)vU/1e2;
                                 printf(" vH: %.2fm/s  D: %.1f  vV: %.2fm/s", velH, velD, velU);
                                 printf("  ");
 
-                                jj = bits2val(subframe_bits+HEADLEN+5*46+ 8, 8) + 0x0700;
-                                mm = bits2val(subframe_bits+HEADLEN+5*46+17, 8);
-                                tt = bits2val(subframe_bits+HEADLEN+5*46+25, 8);
+                                jj = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+ 8, 8) + 0x0700;
+                                mm = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+17, 8);
+                                tt = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+25, 8);
                                 if (jj > 1980 && mm > 0 && mm < 13 && tt > 0 && tt < 32) { // ui32_t tt, mm, jj
                                     printf(" %4d-%02d-%02d ", jj, mm, tt);
                                 }
@@ -1029,10 +1015,10 @@ int main(int argc, char **argv) {
                             float *fcfg = (float *)&w32;
 
                             // 1st subframe
-                            for (j = 10; j < 12; j++) gps_chk_sum += get_w16(subframe_bits, j);
+                            for (j = 10; j < 12; j++) gps_chk_sum += get_w16(gpx.frame_bits, subframe_pos, j);
 
                             // 0x30C1, 0x31C1
-                            val = bits2val(subframe_bits+HEADLEN+46*3+17, 16);
+                            val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*3+17, 16);
                             if ( (val & 0xFF) < 0xC0 && err_frm == 0) {
                                 option_ims100 = 0;
                                 printf("\n");
@@ -1040,13 +1026,13 @@ int main(int argc, char **argv) {
                                 goto jmpRS11;
                             }
 
-                            val = bits2val(subframe_bits+HEADLEN, 16);
+                            val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN, 16);
                             counter = val & 0xFFFF;
 
                             /*if (counter % 2 == 0)*/ printf("[%d] ", counter);
 
-                            w16[0] = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                            w16[1] = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
+                            w16[0] = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                            w16[1] = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
                             w32 = (w16[1]<<16) | w16[0];
 
                             if (option_dbg) {
@@ -1065,20 +1051,20 @@ int main(int argc, char **argv) {
 
                                 //PTU: Save reference frequency (sent in both even and odd frames)
                                 if (counter % 4 == 0) {
-                                    gpx.f_ref = bits2val(subframe_bits+HEADLEN+0*46+17, 16);
+                                    gpx.f_ref = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+0*46+17, 16);
                                 }
                                 if (counter % 4 == 3) {
-                                    gpx.f_ref = bits2val(subframe_bits+HEADLEN+3*46, 16);
+                                    gpx.f_ref = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+3*46, 16);
                                 }
                             }
 
                             if (counter % 2 == 0) {
                                 gpx.frnr = counter;
-                                t1 = bits2val(subframe_bits+HEADLEN+5*46  , 8);  // MSB
-                                t2 = bits2val(subframe_bits+HEADLEN+5*46+8, 8);
+                                t1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46  , 8);  // MSB
+                                t2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+8, 8);
                                 ms = (t1 << 8) | t2;
-                                std = bits2val(subframe_bits+HEADLEN+5*46+17, 8);
-                                min = bits2val(subframe_bits+HEADLEN+5*46+25, 8);
+                                std = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+17, 8);
+                                min = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+5*46+25, 8);
                                 gpx.sek = (float)ms/1000.0;
                                 gpx.std = std;
                                 gpx.min = min;
@@ -1094,7 +1080,7 @@ int main(int argc, char **argv) {
                                         int U_cfg = ((gpx.cfg_valid & 0x001E000000000000LL) == 0x001E000000000000LL); // cfg[52:49]
                                         // Necessary parameters must exist and their values must meet the requirements
                                         if (T_cfg && sanity_check_ims100_config_temperature(&gpx)) {
-                                            ui16_t t_raw = bits2val(subframe_bits+HEADLEN+2*46+17, 16);
+                                            ui16_t t_raw = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+2*46+17, 16);
                                             float f = ((float)t_raw / (float)gpx.f_ref) * 4.0f;
                                             if (f > 1.0f) {
                                                 // Use config coefficients to transform measured frequency to absolute resistance (kOhms)
@@ -1126,7 +1112,7 @@ int main(int argc, char **argv) {
                                             else T_cfg = 0;
                                         }
                                         if (U_cfg) {
-                                            ui16_t u_raw = bits2val(subframe_bits+HEADLEN+3*46, 16);
+                                            ui16_t u_raw = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+3*46, 16);
                                             float f = ((float)u_raw / (float)gpx.f_ref) * 4.0f;
                                             gpx.RH = gpx.cfg[49] + gpx.cfg[50]*f + gpx.cfg[51]*f*f + gpx.cfg[52]*f*f*f;
                                             // Limit to 0...100%
@@ -1143,26 +1129,26 @@ int main(int argc, char **argv) {
                         if (header_found % 2 == 0) // FB6230
                         {
                             // 2nd subframe
-                            for (j = 0; j < 11; j++) gps_chk_sum += get_w16(subframe_bits, j);
-                            gps_err =  (gps_chk_sum & 0xFFFF) != get_w16(subframe_bits, 11); // 1st+2nd subframe
+                            for (j = 0; j < 11; j++) gps_chk_sum += get_w16(gpx.frame_bits, subframe_pos, j);
+                            gps_err =  (gps_chk_sum & 0xFFFF) != get_w16(gpx.frame_bits, subframe_pos, 11); // 1st+2nd subframe
 
                             if (counter % 2 == 0) {
                                 //offset=24+16+1;
                                 int _y = 0;
 
-                                dat2 = bits2val(subframe_bits+HEADLEN, 16);
+                                dat2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN, 16);
                                 gpx.tag = dat2/1000;
                                 gpx.monat = (dat2/10)%100;
                                 _y = dat2 % 10;
                                 gpx.jahr = est_year_ims100(_y, gpx.ref_yr);
                                 printf("(%04d-%02d-%02d) ", gpx.jahr, gpx.monat, gpx.tag);
 
-                                lat1 = bits2val(subframe_bits+HEADLEN+46*0+17, 16);
-                                lat2 = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                                lon1 = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
-                                lon2 = bits2val(subframe_bits+HEADLEN+46*2   , 16);
-                                alt1 = bits2val(subframe_bits+HEADLEN+46*2+17, 16);
-                                alt2 = bits2val(subframe_bits+HEADLEN+46*3   ,  8);
+                                lat1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*0+17, 16);
+                                lat2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                                lon1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
+                                lon2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*2   , 16);
+                                alt1 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*2+17, 16);
+                                alt2 = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*3   ,  8);
 
                                 // NMEA?
                                 lat = (lat1 << 16) | lat2;
@@ -1180,8 +1166,8 @@ int main(int argc, char **argv) {
                                 printf("lat: %.5f  lon: %.5f  alt: %.2f", gpx.lat, gpx.lon, gpx.alt);
                                 printf("  ");
 
-                                vD = bits2val(subframe_bits+HEADLEN+46*4+17, 16);
-                                vH = bits2val(subframe_bits+HEADLEN+46*5   , 16);
+                                vD = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*4+17, 16);
+                                vH = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*5   , 16);
                                 velD = (double)vD/1e2;       // course, true
                                 velH = (double)vH/1.94384e2; // knots -> m/s
                                 gpx.vH = velH;
@@ -1192,7 +1178,7 @@ int main(int argc, char **argv) {
                             }
                             if (counter % 2 == 1) {
                                 // cf. DF9DQ
-                                vU = bits2val(subframe_bits+HEADLEN+46*0+17, 16);
+                                vU = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*0+17, 16);
                                 velU = (double)vU/1.94384e1; // knots -> m/s
                                 gpx.vV = velU;
                                 gpx.vV_valid = (vU != 0);
@@ -1241,6 +1227,7 @@ int main(int argc, char **argv) {
                                     if (gpx.sn > 0 && gpx.sn < 1e9) {
                                         sprintf(id_str, "%.0f", gpx.sn);
                                     }
+                                    prf_enter(PRF_OUT);
                                     printf("{ \"type\": \"%s\"", "MEISEI"); // alt: "IMS100"
                                     printf(", \"frame\": %d, \"id\": \"IMS100-%s\", \"datetime\": \"%04d-%02d-%02dT%02d:%02d:%06.3fZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.5f, \"vel_h\": %.5f, \"heading\": %.5f",
                                            gpx.frnr, id_str, gpx.jahr, gpx.monat, gpx.tag, gpx.std, gpx.min, gpx.sek, gpx.lat, gpx.lon, gpx.alt, gpx.vH, gpx.vD );
@@ -1259,6 +1246,9 @@ int main(int argc, char **argv) {
                                     if (gpx.jsn_freq > 0) { // not gpx.fq, because gpx.sn not in every frame
                                         printf(", \"freq\": %d", gpx.jsn_freq);
                                     }
+                                    if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                                        printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                                    }
                                     if (gpx.fq > 0) { // include frequency derived from subframe information if available
                                         fprintf(stdout, ", \"tx_frequency\": %.0f", gpx.fq );
                                     }
@@ -1273,6 +1263,7 @@ int main(int argc, char **argv) {
                                     if (ver_jsn && *ver_jsn != '\0') printf(", \"version\": \"%s\"", ver_jsn);
                                     printf(" }\n");
                                     printf("\n");
+                                    prf_leave();
 
                                     gpx.frm0_valid = 0;
                                 }
@@ -1283,19 +1274,19 @@ int main(int argc, char **argv) {
                     }
                     else { // raw
 
-                        val = bits2val(subframe_bits, HEADLEN);
+                        val = bits2val(gpx.frame_bits, subframe_pos, HEADLEN);
 
                         printf("%06X ", val & 0xFFFFFF);
                         //printf("  ");
                         for (j = 0; j < 6; j++) {
 
-                            val = bits2val(subframe_bits+HEADLEN+46*j   , 16);
+                            val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*j   , 16);
                             printf("%04X ", val & 0xFFFF);
 
-                            val = bits2val(subframe_bits+HEADLEN+46*j+17, 16);
+                            val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*j+17, 16);
                             printf("%04X ", val & 0xFFFF);
 
-                            //val = bits2val(subframe_bits+HEADLEN+46*j+34, 12);
+                            //val = bits2val(gpx.frame_bits, subframe_pos+HEADLEN+46*j+34, 12);
                             //printf("%03X ", val & 0xFFF);
                             //printf(" ");
                         }
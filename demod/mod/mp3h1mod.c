@@ -44,6 +44,8 @@
 //typedef int i32_t;
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 
 typedef struct {
@@ -90,7 +92,7 @@ typedef struct {
     float Tadc; float RHadc;
     float T; float RH;
     ui8_t frame[FRAME_LEN+16];
-    char frame_bits[BITFRAME_LEN+16];
+    ui8_t frame_bits[(BITFRAME_LEN+16)/8+4];  // packed
     ui32_t cfg[16];
     ui32_t snC;
     ui32_t snD;
@@ -134,55 +136,27 @@ static char mrz_header[] = "100110011001100110011001100110011001""10101010";
 
 // manchester1 1->10,0->01: 1.bit
 // manchester2 0->10,1->01: 2.bit
-static void manchester1(char* frame_rawbits, char *frame_bits, int pos) {
+static void manchester1(char* frame_rawbits, ui8_t *frame_bits, int pos) {
     int i, c, out, buf;
-    char bit, bits[2];
+    int bit;
+    char bits[2];
     c = 0;
 
     for (i = 0; i < pos/2; i++) {  // -16
         bits[0] = frame_rawbits[2*i];
         bits[1] = frame_rawbits[2*i+1];
 
-        if ((bits[0] == '0') && (bits[1] == '1')) { bit = '0'; out = 1; }
+        if ((bits[0] == '0') && (bits[1] == '1')) { bit = 0; out = 1; }
         else
-        if ((bits[0] == '1') && (bits[1] == '0')) { bit = '1'; out = 1; }
+        if ((bits[0] == '1') && (bits[1] == '0')) { bit = 1; out = 1; }
         else { //
             if (buf == 0) { c = !c; out = 0; buf = 1; }
-            else { bit = 'x'; out = 1; buf = 0; }
+            else { bit = 0; out = 1; buf = 0; } // 'x'
         }
-        if (out) frame_bits[i] = bit;
+        if (out) bits_set(frame_bits, i, bit);
     }
 }
 
-static int bits2bytes(char *bitstr, ui8_t *bytes, int len) {
-    int i, bit, d, byteval;
-    int bitpos, bytepos;
-
-    bitpos = 0;
-    bytepos = 0;
-
-    while (bytepos < len) {
-
-        byteval = 0;
-        d = 1;
-        for (i = 0; i < 8; i++) {
-            //bit = *(bitstr+bitpos+i); /* little endian */
-            bit = *(bitstr+bitpos+7-i);  /* big endian */
-            if (bit == '\0') goto frame_end;
-            if         (bit == '1')     byteval += d;
-            else /*if ((bit == '0') */  byteval += 0;
-            d <<= 1;
-        }
-        bitpos += 8;
-        bytes[bytepos++] = byteval;
-
-    }
-frame_end:
-    for (i = bytepos; i < FRAME_LEN; i++) bytes[i] = 0;
-
-    return bytepos;
-}
-
 /* ------------------------------------------------------------------------------------ */
 static int datetime2GPSweek(int yy, int mm, int dd,
                             int hr, int min, int sec,
@@ -765,6 +739,9 @@ static void print_gpx(gpx_t *gpx, int crcOK) {
                 if (gpx->jsn_freq > 0) {
                     printf(", \"freq\": %d", gpx->jsn_freq);
                 }
+                if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                    printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                }
 
                 // Reference time/position
                 printf(", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
@@ -794,7 +771,7 @@ static void print_frame(gpx_t *gpx, int pos, int b2B) {
             //printf(" :%6.1f: ", sample_count/(double)sample_rate);
             //
             for (j = 0; j < pos; j++) {
-                printf("%c", gpx->frame_bits[j]);
+                printf("%d", bits_bit(gpx->frame_bits, j));
             }
             //if (frame_count % 3 == 2)
             {
@@ -803,7 +780,9 @@ static void print_frame(gpx_t *gpx, int pos, int b2B) {
         }
         else {
             int frmlen = (pos-bits_ofs)/8;
-            bits2bytes(gpx->frame_bits+bits_ofs, gpx->frame, frmlen);
+            if (frmlen < 0) frmlen = 0;
+            bits2bytes_msb(gpx->frame_bits, bits_ofs, gpx->frame, frmlen);
+            memset(gpx->frame+frmlen, 0, FRAME_LEN-frmlen);
 
             if (u2(gpx->frame+30) == 0xFFFF) gpx->crclen = CRCLEN_LATLON;
             else gpx->crclen = CRCLEN_ECEF;
@@ -827,7 +806,11 @@ static void print_frame(gpx_t *gpx, int pos, int b2B) {
 
                 //if (frame_count % 3 == 0)
                 {
-                    if (pos/8 > pos_GPSecefV+6) print_gpx(gpx, crcOK);
+                    if (pos/8 > pos_GPSecefV+6) {
+                        prf_enter(PRF_OUT);
+                        print_gpx(gpx, crcOK);
+                        prf_leave();
+                    }
                 }
             }
         }
@@ -855,7 +838,11 @@ static void print_frame(gpx_t *gpx, int pos, int b2B) {
             printf("\n");
         }
         else {
-            if (pos > pos_GPSecefV+6) print_gpx(gpx, crcOK);
+            if (pos > pos_GPSecefV+6) {
+                prf_enter(PRF_OUT);
+                print_gpx(gpx, crcOK);
+                prf_leave();
+            }
         }
     }
 
@@ -969,6 +956,11 @@ int main(int argc, char **argv) {
         else if (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if (strcmp(*argv, "-d") == 0) {
             ++argv;
             if (*argv) {
@@ -1007,6 +999,8 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if (strcmp(*argv, "--json") == 0) {
             gpx.option.jsn = 1;
         }
@@ -1148,6 +1142,7 @@ int main(int argc, char **argv) {
             bitofs += shift;
         }
         else {
+            if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = mrz_header;
             hdb.len = strlen(mrz_header);
@@ -1227,12 +1222,12 @@ int main(int argc, char **argv) {
                         bit ^= 1;
                     }
 
-                    gpx.frame_bits[pos] = 0x30 + (hsbit.hb & 1);
+                    bits_set(gpx.frame_bits, pos, hsbit.hb);
 
                     bitpos += 1;
                     pos++;
                 }
-                gpx.frame_bits[pos] = '\0';
+                bits_set(gpx.frame_bits, pos, 0);
 
                 print_frame(&gpx, pos, 1);
                 if (pos < gpx.bitfrm_len) break;
@@ -28,6 +28,8 @@
 
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 
 typedef struct {
@@ -65,8 +67,7 @@ typedef struct {
     float T; float RH;
     int batt;
     char ID[8+4];
-    ui8_t frame_bytes[FRAMELEN+4];
-    char frame_bits[BITFRAMELEN+8];
+    ui8_t frame_bytes[FRAMELEN+4];  // frame bits, packed
     char frm_str[FRAMELEN+4];
     int jsn_freq;   // freq/kHz (SDR)
     option_t option;
@@ -98,34 +99,6 @@ static ui32_t crc16_re(ui8_t bytes[], int len) {
     return re;
 }
 
-static int bits2bytes(char *bitstr, ui8_t *bytes) {
-    int i, bit, d, byteval;
-    int bitpos, bytepos;
-
-    bitpos = 0;
-    bytepos = 0;
-
-    while (bytepos < FRAMELEN) {
-
-        byteval = 0;
-        d = 1;
-        for (i = 0; i < 8; i++) {
-            //bit = bitstr[bitpos+i]; /* little endian */
-            bit = bitstr[bitpos+7-i];  /* big endian */
-            if         (bit == '1')     byteval += d;
-            else /*if ((bit == '0') */  byteval += 0;
-            d <<= 1;
-        }
-        bitpos += 8;
-        bytes[bytepos++] = byteval;
-
-    }
-
-    //while (bytepos < FRAME_LEN) bytes[bytepos++] = 0;
-
-    return 0;
-}
-
 static int fn(gpx_t *gpx, int n) {
     int pos = 0;
     if (n <= 0) return 0;
@@ -154,8 +127,6 @@ static int print_frame(gpx_t *gpx, int pos) {
 
     if (pos/8 < OFS+DATLEN) return -1;
 
-    bits2bytes(gpx->frame_bits, gpx->frame_bytes);
-
     // CRC
     crcdat = (gpx->frame_bytes[OFS+DATLEN+1]<<8) | gpx->frame_bytes[OFS+DATLEN];
     crcval = crc16_re(gpx->frame_bytes+OFS, DATLEN);
@@ -171,7 +142,7 @@ static int print_frame(gpx_t *gpx, int pos) {
         }
         else {
             for (j = 0; j < BITFRAMELEN; j++) {
-                printf("%c", gpx->frame_bits[j]);
+                printf("%d", bits_bit(gpx->frame_bytes, j));
                 if (j % 8 == 7) printf(" ");
             }
         }
@@ -259,6 +230,9 @@ static int print_frame(gpx_t *gpx, int pos) {
                 if (gpx->jsn_freq > 0) {
                     printf(", \"freq\": %d", gpx->jsn_freq);
                 }
+                if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                    printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                }
 
                 // Reference time/position
                 printf(", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec ?
@@ -373,6 +347,11 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
             if (*argv) {
@@ -418,6 +397,8 @@ int main(int argc, char **argv) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) {
             gpx.option.jsn = 1;
         }
@@ -541,6 +522,7 @@ int main(int argc, char **argv) {
         bitofs += shift;
     }
     else {
+        if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
         // init circular header bit buffer
         hdb.hdr = rawheader;
         hdb.len = strlen(rawheader);
@@ -606,12 +588,14 @@ int main(int argc, char **argv) {
                 }
                 if ( bitQ == EOF ) { break; }
 
-                gpx.frame_bits[pos] = 0x30 + bit;
+                bits_set(gpx.frame_bytes, pos, bit);
                 pos++;
                 bitpos += 1;
             }
-            gpx.frame_bits[pos] = '\0';
+            bits_set(gpx.frame_bytes, pos, 0);
+            prf_enter(PRF_OUT);
             print_frame(&gpx, pos);
+            prf_leave();
             if (pos < BITFRAMELEN) break;
 
             header_found = 0;
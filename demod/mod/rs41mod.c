@@ -43,6 +43,8 @@
 //typedef int   i32_t;
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 //#define  INCLUDESTATIC 1
 #ifdef INCLUDESTATIC
@@ -220,18 +222,6 @@ static void Gps2Date(gpx_t *gpx) {
 }
 /* ------------------------------------------------------------------------------------ */
 
-static int bits2byte(char bits[]) {
-    int i, byteval=0, d=1;
-    for (i = 0; i < 8; i++) {     // little endian
-    /* for (i = 7; i >= 0; i--) { // big endian */
-        if      (bits[i] == 1)  byteval += d;
-        else if (bits[i] == 0)  byteval += 0;
-        else return 0x100;
-        d <<= 1;
-    }
-    return byteval;
-}
-
 /* ------------------------------------------------------------------------------------ */
 
 static ui32_t u4(ui8_t *bytes) {  // 32bit unsigned int
@@ -2329,6 +2319,9 @@ static int print_position(gpx_t *gpx, int ec) {
                             if (gpx->freq > 0) fq_kHz = gpx->freq;
                             fprintf(stdout, ", \"freq\": %d", fq_kHz);
                         }
+                        if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                            fprintf(stdout, ", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                        }
                         if (*gpx->rsm) {  // RSM type
                             fprintf(stdout, ", \"rs41_mainboard\": \"%s\"", gpx->rsm);
                         }
@@ -2516,7 +2509,9 @@ static void print_frame(gpx_t *gpx, int len) {
 
 
     if (gpx->option.ecc) {
+        prf_enter(PRF_ECC);
         ec = rs41_ecc(gpx, len);
+        prf_leave();
     }
 
 
@@ -2537,11 +2532,15 @@ static void print_frame(gpx_t *gpx, int len) {
         }
         fprintf(stdout, "\n");
         if (gpx->option.slt /*&& gpx->option.jsn*/) {
+            prf_enter(PRF_OUT);
             print_position(gpx, ec);
+            prf_leave();
         }
     }
     else {
+        prf_enter(PRF_OUT);
         print_position(gpx, ec);
+        prf_leave();
     }
 }
 
@@ -2559,6 +2558,7 @@ int main(int argc, char *argv[]) {
     int option_noLUT = 0;
     int option_bin = 0;
     int option_softin = 0;
+    int option_allofs = 0;
     int option_pcmraw = 0;
     int wavloaded = 0;
     int sel_wavch = 0;     // audio channel: left
@@ -2570,7 +2570,7 @@ int main(int argc, char *argv[]) {
 
     int k;
 
-    char bitbuf[8];
+    ui8_t bitbuf = 0;  // packed
     int bitpos = 0,
         b8pos = 0,
         byte_count = FRAMESTART;
@@ -2590,6 +2590,12 @@ int main(int argc, char *argv[]) {
     int bitofs = 2; // +0 .. +3
     int shift = 0;
 
+    // --allofs: soft bits at bitofs-3 .. bitofs+1, frame decoded at best of bitofs-2 .. bitofs+1
+    static hsbit_t ofs_frm[(FRAME_LEN-FRAMESTART)*BITS][5];
+    double ofs_score[5];
+    int ofs_bits = 0;
+    int ofs_k = 3;
+
     pcm_t pcm = {0};
     dsp_t dsp = {0};  //memset(&dsp, 0, sizeof(dsp));
 
@@ -2614,6 +2620,7 @@ int main(int argc, char *argv[]) {
             fprintf(stderr, "       -v, -vx, -vv  (info, aux, info/conf)\n");
             fprintf(stderr, "       -r, --raw\n");
             fprintf(stderr, "       -i, --invert\n");
+            fprintf(stderr, "       --allofs     (all bit offsets and polarities)\n");
             //fprintf(stderr, "       --crc        (check CRC)\n");
             //fprintf(stderr, "       --ecc2       (Reed-Solomon )\n");
             fprintf(stderr, "       --ths <x>    (peak threshold; default=%.1f)\n", thres);
@@ -2644,9 +2651,15 @@ int main(int argc, char *argv[]) {
         else if   (strcmp(*argv, "--dewp") == 0) { gpx.option.dwp = 1; }
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--auto") == 0) { gpx.option.aut = 1; }
+        else if   (strcmp(*argv, "--allofs") == 0) { option_allofs = 1; gpx.option.aut = 1; }  // parallel bitofs +0..+3, polarity from header
         else if   (strcmp(*argv, "--bin") == 0) { option_bin = 1; }  // bit/byte binary input
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--silent") == 0) { gpx.option.slt = 1; }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
@@ -2693,6 +2706,8 @@ int main(int argc, char *argv[]) {
         else if   (strcmp(*argv, "--min") == 0) {
             option_min = 1;
         }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) {
             gpx.option.jsn = 1;
             gpx.option.ecc = 2;
@@ -2844,6 +2859,7 @@ int main(int argc, char *argv[]) {
         }
         else {
             if (option_bin && option_softin) option_bin = 0;
+            if (option_softin) f32soft_br(BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = rs41_header;
             hdb.len = strlen(rs41_header);
@@ -2883,6 +2899,28 @@ int main(int argc, char *argv[]) {
                 else gpx.option.inv ^= 0x1;
             }
 
+            if (header_found && option_allofs && !option_bin && !option_softin)
+            {
+                // one pass over the frame samples, all offsets;
+                // commit to the offset with the largest soft bit magnitude
+                float bl = -1;
+                if (option_iq > 2) bl = 2.0;
+                for (k = 0; k < 5; k++) ofs_score[k] = 0.0;
+                ofs_bits = 0;
+                while ( ofs_bits < (FRAME_LEN-FRAMESTART)*BITS )
+                {
+                    bitQ = read_softbitN(&dsp, ofs_frm[ofs_bits], 5, 0, bitofs-3, ofs_bits, bl); // symlen=1
+                    if ( bitQ == EOF ) break;
+                    for (k = 1; k < 5; k++) ofs_score[k] += fabs(ofs_frm[ofs_bits][k].sb);
+                    ofs_bits++;
+                }
+                ofs_k = 1;
+                for (k = 2; k < 5; k++) {
+                    if (ofs_score[k] > ofs_score[ofs_k]) ofs_k = k;
+                }
+                if (gpx.option.vbs == 3) fprintf(stderr, "bitofs: %+d\n", bitofs-3+ofs_k);
+            }
+
             if (header_found)
             {
                 byte_count = FRAMESTART;
@@ -2912,8 +2950,17 @@ int main(int argc, char *argv[]) {
                     else {
                         float bl = -1;
                         if (option_iq > 2) bl = 2.0;
-                        //bitQ = read_slbit(&dsp, &bit, 0, bitofs, bitpos, bl, 0); // symlen=1
-                        bitQ = read_softbit2p(&dsp, &hsbit, 0, bitofs, bitpos, bl, 0, &hsbit1); // symlen=1
+                        if (option_allofs) {  // bits already read
+                            bitQ = (bitpos < ofs_bits) ? 0 : EOF;
+                            if (bitQ != EOF) {
+                                hsbit  = ofs_frm[bitpos][ofs_k];
+                                hsbit1 = ofs_frm[bitpos][ofs_k-1];
+                            }
+                        }
+                        else {
+                            //bitQ = read_slbit(&dsp, &bit, 0, bitofs, bitpos, bl, 0); // symlen=1
+                            bitQ = read_softbit2p(&dsp, &hsbit, 0, bitofs, bitpos, bl, 0, &hsbit1); // symlen=1
+                        }
                         bit = hsbit.hb;
                         if (gpx.option.ecc >= 3) bit = (hsbit.sb+hsbit1.sb)>=0;
 
@@ -2932,7 +2979,7 @@ int main(int argc, char *argv[]) {
                     softbits[b8pos] = hsbit.sb;
 
                     bitpos += 1;
-                    bitbuf[b8pos] = bit;
+                    bits_set(&bitbuf, b8pos, bit);
                     b8pos++;
                     if (b8pos == BITS) {
                         int j, j0 = 0;
@@ -2945,7 +2992,7 @@ int main(int argc, char *argv[]) {
                         }
                         gpx.ecdat.frm_bytescore[byte_count] = min_score_byte;
                         b8pos = 0;
-                        byte = bits2byte(bitbuf);
+                        byte = bits_rev8(bitbuf);  // little endian
                         gpx.frame[byte_count] = byte ^ mask[byte_count % MASK_LEN];
                         //gpx.dfrm_shiftsgn[byte_count] = difbyte;
                         gpx.dfrm_bitscore[byte_count] = (1<<j0);
@@ -41,6 +41,8 @@
 //typedef unsigned int   ui32_t;
 
 #include "demod_mod.h"
+#include "fskin_mod.h"
+#include "bits_mod.h"
 
 //#define  INCLUDESTATIC 1
 #ifdef INCLUDESTATIC
@@ -180,21 +182,6 @@ static ui8_t mask[MASK_LEN] = { 0x96, 0x83, 0x3E, 0x51, 0xB1, 0x49, 0x08, 0x98,
 // manchester1 1->10,0->01: 1.bit
 // manchester2 0->10,1->01: 2.bit
 // RS92-SGP: 8N1 manchester2
-static int bits2byte(char bits[]) {
-    int i, byteval=0, d=1;
-
-    //if (bits[0] != 0) return 0x100; // erasure?
-    //if (bits[9] != 1) return 0x100; // erasure?
-
-    for (i = 1; i <= 8; i++) {   // little endian
-    /* for (i = 8; i > 1; i--) { // big endian */
-        if      (bits[i] == 1)  byteval += d;
-        else if (bits[i] == 0)  byteval += 0;
-        d <<= 1;
-    }
-    return byteval;
-}
-
 
 /*
 ui8_t xorbyte(int pos) {
@@ -1518,6 +1505,9 @@ static int print_position(gpx_t *gpx, int ec) {  // GPS-Hoehe ueber Ellipsoid
                     //if (gpx->freq > 0) fq_kHz = gpx->freq; // L-band: option.ngp ?
                     fprintf(stdout, ", \"freq\": %d", fq_kHz );
                 }
+                if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                    fprintf(stdout, ", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                }
 
                 // Include frequency derived from subframe information if available.
                 if (gpx->freq > 0) {
@@ -1550,7 +1540,9 @@ static void print_frame(gpx_t *gpx, int len) {
     gpx->crc = 0;
 
     if (gpx->option.ecc) {
+        prf_enter(PRF_ECC);
         ec = rs92_ecc(gpx, len);
+        prf_leave();
     }
 
     for (i = len; i < FRAME_LEN; i++) {
@@ -1571,7 +1563,11 @@ static void print_frame(gpx_t *gpx, int len) {
         fprintf(stdout, "\n");
         // fprintf(stdout, "\n");
     }
-    else print_position(gpx, ec);
+    else {
+        prf_enter(PRF_OUT);
+        print_position(gpx, ec);
+        prf_leave();
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -1597,7 +1593,7 @@ int main(int argc, char *argv[]) {
     int rawhex = 0;
     int cfreq = -1;
 
-    char bitbuf[BITS];
+    ui8_t bitbuf[2] = {0};  // packed 8N1
     int bitpos = 0,
         b8pos = 0,
         byte_count = FRAMESTART;
@@ -1738,6 +1734,8 @@ int main(int argc, char *argv[]) {
         else if   (strcmp(*argv, "-g1") == 0) { gpx.gps.opt_vergps = 1; }  //  verbose1 GPS
         else if   (strcmp(*argv, "-g2") == 0) { gpx.gps.opt_vergps = 2; }  //  verbose2 GPS (bancroft)
         else if   (strcmp(*argv, "-gg") == 0) { gpx.gps.opt_vergps = 8; }  // vverbose GPS
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
         else if   (strcmp(*argv, "--json") == 0) {
             gpx.option.jsn = 1;
             gpx.option.ecc = 2;
@@ -1755,6 +1753,11 @@ int main(int argc, char *argv[]) {
         else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
         else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
         else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
         else if   (strcmp(*argv, "--ths") == 0) {
             ++argv;
             if (*argv) {
@@ -1957,6 +1960,7 @@ int main(int argc, char *argv[]) {
             bitofs += shift;
         }
         else {
+            if (option_softin) f32soft_br(BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
             // init circular header bit buffer
             hdb.hdr = rs92_rawheader;
             hdb.len = strlen(rs92_rawheader);
@@ -2032,11 +2036,11 @@ int main(int argc, char *argv[]) {
                     if (gpx.option.inv) bit ^= 1;
 
                     bitpos += 1;
-                    bitbuf[b8pos] = bit;
+                    bits_set(bitbuf, b8pos, bit);
                     b8pos++;
                     if (b8pos >= BITS) {
                         b8pos = 0;
-                        byte = bits2byte(bitbuf);
+                        byte = bits_rev8(bits_get(bitbuf, 1, 8));  // little endian
                         gpx.frame[byte_count] = byte;
                         byte_count++;
                     }
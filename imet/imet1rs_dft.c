@@ -2,6 +2,10 @@
 /*
  *  iMet-1-RS / iMet-4
  *  Bell202 8N1
+ *
+ *  files: imet1rs_dft.c, ../demod/mod/dsp_mod.c, dsp_mod.h
+ *  make -C ../demod/mod libdsp.a
+ *  gcc -O3 imet1rs_dft.c ../demod/mod/libdsp.a -lm -o imet1rs_dft
 */
 
 #include <stdio.h>
@@ -10,6 +14,8 @@
 #include <complex.h>
 #include <math.h>
 
+#include "../demod/mod/dsp_mod.h"
+
 // optional JSON "version"
 //  (a) set global
 //      gcc -DVERSION_JSN [-I<inc_dir>] ...
@@ -21,8 +27,6 @@
 //      gcc -DVER_JSN_STR=\"0.0.2\" ...
 
 
-typedef  unsigned char  ui8_t;
-
 int option_verbose = 0,  // ausfuehrliche Anzeige
     option_raw = 0,      // rohe Frames
     option_rawbits = 0,
@@ -32,104 +36,6 @@ int option_verbose = 0,  // ausfuehrliche Anzeige
 
 /* ------------------------------------------------------------------------------------ */
 
-int sample_rate = 0, bits_sample = 0, channels = 0;
-//float samples_per_bit = 0;
-
-int findstr(char *buff, char *str, int pos) {
-    int i;
-    for (i = 0; i < 4; i++) {
-        if (buff[(pos+i)%4] != str[i]) break;
-    }
-    return i;
-}
-
-int read_wav_header(FILE *fp) {
-    char txt[4+1] = "\0\0\0\0";
-    unsigned char dat[4];
-    int byte, p=0;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "RIFF", 4)) return -1;
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    // pos_WAVE = 8L
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "WAVE", 4)) return -1;
-    // pos_fmt = 12L
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "fmt ", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    channels = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    //byte = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    bits_sample = dat[0] + (dat[1] << 8);
-
-    // pos_dat = 36L + info
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "data", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-
-
-    fprintf(stderr, "sample_rate: %d\n", sample_rate);
-    fprintf(stderr, "bits       : %d\n", bits_sample);
-    fprintf(stderr, "channels   : %d\n", channels);
-
-    if ((bits_sample != 8) && (bits_sample != 16) && (bits_sample != 32)) return -1;
-
-    //samples_per_bit = sample_rate/(float)BAUD_RATE;
-    //fprintf(stderr, "samples/bit: %.2f\n", samples_per_bit);
-
-    return 0;
-}
-
-int f32read_sample(FILE *fp, float *s) {
-    int i;
-    unsigned int word = 0;
-    short *b = (short*)&word;
-    float *f = (float*)&word;
-
-    for (i = 0; i < channels; i++) {
-
-        if (fread( &word, bits_sample/8, 1, fp) != 1) return EOF;
-
-        if (i == 0) {  // i = 0: links bzw. mono
-            //if (bits_sample ==  8)  sint = b-128;   // 8bit: 00..FF, centerpoint 0x80=128
-            //if (bits_sample == 16)  sint = (short)b;
-
-            if (bits_sample == 32) {
-                *s = *f;
-            }
-            else {
-                if (bits_sample ==  8) { *b -= 128; }
-                *s = *b/128.0;
-                if (bits_sample == 16) { *s /= 256.0; }
-            }
-        }
-    }
-
-    return 0;
-}
-
-/* ------------------------------------------------------------------------------------ */
-
-
 // Bell202, 1200 baud (1200Hz/2200Hz), 8N1
 #define BAUD_RATE 1200
 
@@ -609,12 +515,14 @@ int print_frame(int len) {
                 {
                     char *ver_jsn = NULL;
                     fprintf(stdout, "{ \"type\": \"%s\"", "IMET");
-                    fprintf(stdout, ", \"frame\": %d, \"id\": \"iMet\", \"datetime\": \"%02d:%02d:%02dZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %d, \"sats\": %d, \"temp\": %.2f, \"humidity\": %.2f, \"pressure\": %.2f, \"batt\": %.1f",
-                            gpx.frame, gpx.hour, gpx.min, gpx.sec, gpx.lat, gpx.lon, gpx.alt, gpx.sats, gpx.temp, gpx.humidity, gpx.pressure, gpx.batt);
+                    fprintf(stdout, ", \"frame\": %d, \"id\": \"iMet\", \"datetime\": \"%02d:%02d:%02dZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %d",
+                            gpx.frame, gpx.hour, gpx.min, gpx.sec, gpx.lat, gpx.lon, gpx.alt);
                     // TODO: TEST eGPS/vel
                     if (0 && gpx.gps_valid == PKT_eGPS) {
                         fprintf(stdout, ", \"vel_h\": %.5f, \"heading\": %.5f, \"vel_v\": %.5f", gpx.vH, gpx.vD, gpx.vV );
                     }
+                    fprintf(stdout, ", \"sats\": %d, \"batt\": %.1f, \"temp\": %.2f, \"humidity\": %.2f, \"pressure\": %.2f",
+                            gpx.sats, gpx.batt, gpx.temp, gpx.humidity, gpx.pressure);
                     if (gpx.xdata[0]) {
                         fprintf(stdout, ", \"aux\": \"%s\"", gpx.xdata );
                     }
@@ -662,8 +570,9 @@ int main(int argc, char *argv[]) {
     double f1, f2;
 
     int n;
-    double t  = 0.0;
-    double tn = 0.0;
+    int k = 0, k0;
+    int L;
+    double complex *ex1 = NULL, *ex2 = NULL;
     double x  = 0.0;
     double x0 = 0.0;
 
@@ -673,10 +582,13 @@ int main(int argc, char *argv[]) {
     double xbit = 0.0;
     float s = 0.0;
 
-    int bitbuf[3];
+    float sbuf[3] = {0};
 
     int cfreq = -1;
 
+    pcm_t pcm = {0};
+    dsp_t dsp = {0};
+
     fpname = argv[0];
     ++argv;
     while ((*argv) && (!wavloaded)) {
@@ -724,14 +636,19 @@ int main(int argc, char *argv[]) {
     gpx.jsn_freq = 0;
     if (cfreq > 0) gpx.jsn_freq = (cfreq+500)/1000;
 
-    i = read_wav_header(fp);
+    i = read_wav_header(&pcm, fp);
     if (i) {
         fclose(fp);
         return -1;
     }
+    dsp.fp = fp;
+    dsp.sr = pcm.sr;
+    dsp.bps = pcm.bps;
+    dsp.nch = pcm.nch;
+    dsp.ch = pcm.sel_ch;
 
 
-    bitlen = sample_rate/(double)BAUD_RATE;
+    bitlen = dsp.sr/(double)BAUD_RATE;
 
     f1 = 2200.0;  // bit0: 2200Hz
     f2 = 1200.0;  // bit1: 1200Hz
@@ -739,31 +656,45 @@ int main(int argc, char *argv[]) {
     N = 2*bitlen + 0.5;
     buffer = calloc( N+1, sizeof(float)); if (buffer == NULL) return -1;
 
+    // exp(-2pi*I*f*t), t=k/sr: f1,f2 multiples of 200Hz, period L=sr/gcd(sr,200)
+    L = dsp.sr;
+    i = 200;
+    while (i) { int r = L % i; L = i; i = r; }
+    L = dsp.sr / L;
+    ex1 = calloc( L+1, sizeof(double complex)); if (ex1 == NULL) return -1;
+    ex2 = calloc( L+1, sizeof(double complex)); if (ex2 == NULL) return -1;
+    for (i = 0; i < L; i++) {
+        ex1[i] = cexp(-i*2*M_PI*f1/(double)dsp.sr*I);
+        ex2[i] = cexp(-i*2*M_PI*f2/(double)dsp.sr*I);
+    }
+
+    n = bitlen;
+    k0 = (L - n % L) % L;  // (sample_count-n) mod L
+
     ptr = -1; sample_count = -1;
 
-    while (f32read_sample(fp, &s) != EOF) {
+    while (f32read_sample(&dsp, &s) != EOF) {
 
         ptr++; sample_count++;
         if (ptr == N) ptr = 0;
         buffer[ptr] = s;
 
-        n = bitlen;
-        t = sample_count / (double)sample_rate;
-        tn = (sample_count-n) / (double)sample_rate;
-
-        x = buffer[sample_count % N];
-        x0 = buffer[(sample_count - n + N) % N];
+        x = buffer[ptr];
+        x0 = buffer[(ptr - n + N) % N];
 
         // f1
-        X0 = x0 * cexp(-tn*2*M_PI*f1*I); // alt
-        X  = x  * cexp(-t *2*M_PI*f1*I); // neu
+        X0 = x0 * ex1[k0]; // alt
+        X  = x  * ex1[k];  // neu
         F1sum +=  X - X0;
 
         // f2
-        X0 = x0 * cexp(-tn*2*M_PI*f2*I); // alt
-        X  = x  * cexp(-t *2*M_PI*f2*I); // neu
+        X0 = x0 * ex2[k0]; // alt
+        X  = x  * ex2[k];  // neu
         F2sum +=  X - X0;
 
+        if (++k  == L) k  = 0;
+        if (++k0 == L) k0 = 0;
+
         xbit = cabs(F2sum) - cabs(F1sum);
 
         s = xbit / bitlen;
@@ -772,14 +703,15 @@ int main(int argc, char *argv[]) {
         if ( s < 0 ) bit = 0;  // 2200Hz
         else         bit = 1;  // 1200Hz
 
-        bitbuf[sample_count % 3] = bit;
+        sbuf[sample_count % 3] = s;
 
         if (header_found && option_b)
         {
             if (sample_count - pos_bit > bitlen+bitlen/5 + 3)
             {
-                int bitsum = bitbuf[0]+bitbuf[1]+bitbuf[2];
-                if (bitsum > 1.5) bit = 1; else bit = 0;
+                // integrate correlator output over 3 samples (instead of majority vote)
+                float ssum = sbuf[0]+sbuf[1]+sbuf[2];
+                if (ssum < 0) bit = 0; else bit = 1;
 
                 bitframe[bitpos] = bit;
                 bitpos++;
@@ -835,6 +767,9 @@ int main(int argc, char *argv[]) {
     fprintf(stdout, "\n");
 
     if (buffer) { free(buffer); buffer = NULL; }
+    if (ex1) { free(ex1); ex1 = NULL; }
+    if (ex2) { free(ex2); ex2 = NULL; }
+    f32read_free(&dsp);
 
     fclose(fp);
 
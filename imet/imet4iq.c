@@ -3,7 +3,8 @@
  *  iMet-4 / iMet-1-RS
  *  Bell202 8N1
  *
-    gcc imet4iq.c -lm -o imet4iq
+    gcc -Ofast -c ../demod/mod/dsp_mod.c
+    gcc imet4iq.c dsp_mod.o -lm -o imet4iq
     ./imet4iq --iq <fq> imet4_iq.wav
     ./imet4iq --imet1 --iq <fq> imet1_iq.wav
     ./imet4iq fm_audio.wav
@@ -21,6 +22,8 @@
 #include <complex.h>
 #include <math.h>
 
+#include "../demod/mod/dsp_mod.h"
+
 // optional JSON "version"
 //  (a) set global
 //      gcc -DVERSION_JSN [-I<inc_dir>] ...
@@ -32,22 +35,6 @@
 //      gcc -DVER_JSN_STR=\"0.0.2\" ...
 
 
-typedef  unsigned char  ui8_t;
-typedef unsigned short ui16_t;
-typedef unsigned int   ui32_t;
-typedef char  i8_t;
-typedef short i16_t;
-typedef int   i32_t;
-
-#ifndef M_PI
-    #define M_PI  (3.1415926535897932384626433832795)
-#endif
-#define _2PI  (6.2831853071795864769252867665590)
-
-#define LP_IQ    1
-#define LP_FM    2
-#define LP_IQFM  4
-
 #define FM_DEC  2
 #define FM_GAIN (0.8)
 
@@ -62,386 +49,9 @@ int option_verbose = 0,  // ausfuehrliche Anzeige
 
 /* ------------------------------------------------------------------------------------ */
 
-typedef struct {
-    int sr;       // sample_rate
-    int bps;      // bits_sample  bits/sample
-    int nch;      // channels
-    int sel_ch;   // select wav channel
-} pcm_t;
-
-
-int findstr(char *buff, char *str, int pos) {
-    int i;
-    for (i = 0; i < 4; i++) {
-        if (buff[(pos+i)%4] != str[i]) break;
-    }
-    return i;
-}
-
-static
-int read_wav_header(pcm_t *pcm, FILE *fp) {
-    char txt[4+1] = "\0\0\0\0";
-    unsigned char dat[4];
-    int byte, p=0;
-    int sample_rate = 0, bits_sample = 0, channels = 0;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "RIFF", 4) && strncmp(txt, "RF64", 4)) return -1;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    // pos_WAVE = 8L
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "WAVE", 4))  return -1;
-
-    // pos_fmt = 12L
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "fmt ", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    channels = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    //byte = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    bits_sample = dat[0] + (dat[1] << 8);
-
-    // pos_dat = 36L + info
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "data", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-
-
-    fprintf(stderr, "sample_rate: %d\n", sample_rate);
-    fprintf(stderr, "bits       : %d\n", bits_sample);
-    fprintf(stderr, "channels   : %d\n", channels);
-
-    if (pcm->sel_ch < 0  ||  pcm->sel_ch >= channels) pcm->sel_ch = 0; // default channel: 0
-    //fprintf(stderr, "channel-In : %d\n", pcm->sel_ch+1); // nur wenn nicht IQ
-
-    if (bits_sample != 8 && bits_sample != 16 && bits_sample != 32) return -1;
-
-    if (sample_rate == 900001) sample_rate -= 1;
-
-    pcm->sr  = sample_rate;
-    pcm->bps = bits_sample;
-    pcm->nch = channels;
-
-    return 0;
-}
-
-
-typedef struct {
-    FILE *fp;
-    //
-    int sr;       // sample_rate
-    int bps;      // bits/sample
-    int nch;      // channels
-    int ch;       // select channel
-    //
-    float sps;    // samples per symbol
-    float br;     // baud rate
-    //
-    ui32_t sample_in;
-    ui32_t sample_fm;
-    ui32_t sc;
-    int M;
-    float *bufs;
-    float mv;
-    ui32_t mv_pos;
-    ui32_t pre_pos;
-    //
-
-    // IQ-data
-    int opt_iq;
-    int opt_iqdc;
-    float complex iqbuf[2]; // float complex *rot_iqbuf;
-
-    // dc offset
-    int opt_dc;
-    int locked;
-    double dc;
-    double Df;
-    double dDf;
-    float xsum;
-
-    // decimate
-    int opt_nolut; // default: LUT
-    int opt_IFmin;
-    int decM;
-    ui32_t sr_base;
-    ui32_t dectaps;
-    ui32_t sample_decX;
-    ui32_t lut_len;
-    ui32_t sample_decM;
-    float complex *decXbuffer;
-    float complex *decMbuf;
-    float complex *ex; // exp_lut
-    double xlt_fq;
-
-    // IF: lowpass
-    int opt_lp;
-    int lpIQ_bw;
-    float lpIQ_fbw;
-    int lpIQtaps; // ui32_t
-    float *ws_lpIQ0;
-    float *ws_lpIQ1;
-    float *ws_lpIQ;
-    float complex *lpIQ_buf;
-
-    // FM: lowpass
-    int lpFM_bw;
-    int lpFMtaps; // ui32_t
-    float *ws_lpFM;
-    float *lpFM_buf;
-
-    int opt_fmdec;
-    int decFM;
-    int sr_fm;
-
-    int opt_imet1;
-
-} dsp_t;
-
-
-static int f32read_sample(dsp_t *dsp, float *s) {
-    int i;
-    unsigned int word = 0;
-    short *b = (short*)&word;
-    float *f = (float*)&word;
-
-    for (i = 0; i < dsp->nch; i++) {
-
-        if (fread( &word, dsp->bps/8, 1, dsp->fp) != 1) return EOF;
-
-        if (i == dsp->ch) {  // i = 0: links bzw. mono
-            //if (bits_sample ==  8)  sint = b-128;   // 8bit: 00..FF, centerpoint 0x80=128
-            //if (bits_sample == 16)  sint = (short)b;
-
-            if (dsp->bps == 32) {
-                *s = *f;
-            }
-            else {
-                if (dsp->bps ==  8) { *b -= 128; }
-                *s = *b/128.0;
-                if (dsp->bps == 16) { *s /= 256.0; }
-            }
-        }
-    }
-
-    return 0;
-}
-
-typedef struct {
-    double sumIQx;
-    double sumIQy;
-    float avgIQx;
-    float avgIQy;
-    float complex avgIQ;
-    ui32_t cnt;
-    ui32_t maxcnt;
-    ui32_t maxlim;
-} iq_dc_t;
-static iq_dc_t IQdc;
-
-static int f32read_csample(dsp_t *dsp, float complex *z) {
-
-    float x, y;
-
-    if (dsp->bps == 32) { //float32
-        float f[2];
-        if (fread( f, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = f[0];
-        y = f[1];
-    }
-    else if (dsp->bps == 16) { //int16
-        short b[2];
-        if (fread( b, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = b[0]/32768.0;
-        y = b[1]/32768.0;
-    }
-    else {  // dsp->bps == 8   //uint8
-        ui8_t u[2];
-        if (fread( u, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = (u[0]-128)/128.0;
-        y = (u[1]-128)/128.0;
-    }
-
-    *z = x + I*y;
-
-    // IQ-dc removal optional
-    if (dsp->opt_iqdc) {
-        *z -= IQdc.avgIQ;
-
-        IQdc.sumIQx += x;
-        IQdc.sumIQy += y;
-        IQdc.cnt += 1;
-        if (IQdc.cnt == IQdc.maxcnt) {
-            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
-            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
-            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
-            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
-            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
-        }
-    }
-
-    return 0;
-}
-
-static int f32read_cblock(dsp_t *dsp) {
-
-    int n;
-    int len;
-    float x, y;
-    ui8_t s[4*2*dsp->decM]; //uin8,int16,float32
-    ui8_t *u = (ui8_t*)s;
-    short *b = (short*)s;
-    float *f = (float*)s;
-
-
-    len = fread( s, dsp->bps/8, 2*dsp->decM, dsp->fp) / 2;
-
-    //for (n = 0; n < len; n++) dsp->decMbuf[n] = (u[2*n]-128)/128.0 + I*(u[2*n+1]-128)/128.0;
-    // u8: 0..255, 128 -> 0V
-    for (n = 0; n < len; n++) {
-        if (dsp->bps == 8) { //uint8
-            x = (u[2*n  ]-128)/128.0;
-            y = (u[2*n+1]-128)/128.0;
-        }
-        else if (dsp->bps == 16) { //int16
-            x = b[2*n  ]/32768.0;
-            y = b[2*n+1]/32768.0;
-        }
-        else { // dsp->bps == 32   //float32
-            x = f[2*n];
-            y = f[2*n+1];
-        }
-
-        // baseband: IQ-dc removal mandatory
-        dsp->decMbuf[n] = (x-IQdc.avgIQx) + I*(y-IQdc.avgIQy);
-
-        IQdc.sumIQx += x;
-        IQdc.sumIQy += y;
-        IQdc.cnt += 1;
-        if (IQdc.cnt == IQdc.maxcnt) {
-            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
-            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
-            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
-            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
-            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
-        }
-    }
-
-    return len;
-}
-
-
 // decimate lowpass
 static float *ws_dec;
 
-static double sinc(double x) {
-    double y;
-    if (x == 0) y = 1;
-    else y = sin(M_PI*x)/(M_PI*x);
-    return y;
-}
-
-static int lowpass_init(float f, int taps, float **pws) {
-    double *h, *w;
-    double norm = 0;
-    int n;
-    float *ws = NULL;
-
-    if (taps % 2 == 0) taps++; // odd/symmetric
-
-    if ( taps < 1 ) taps = 1;
-
-    h = (double*)calloc( taps+1, sizeof(double)); if (h == NULL) return -1;
-    w = (double*)calloc( taps+1, sizeof(double)); if (w == NULL) return -1;
-    ws = (float*)calloc( 2*taps+1, sizeof(float)); if (ws == NULL) return -1;
-
-    for (n = 0; n < taps; n++) {
-        w[n] = 7938/18608.0 - 9240/18608.0*cos(_2PI*n/(taps-1)) + 1430/18608.0*cos(4*M_PI*n/(taps-1)); // Blackmann
-        h[n] = 2*f*sinc(2*f*(n-(taps-1)/2));
-        ws[n] = w[n]*h[n];
-        norm += ws[n]; // 1-norm
-    }
-    for (n = 0; n < taps; n++) {
-        ws[n] /= norm; // 1-norm
-    }
-
-    for (n = 0; n < taps; n++) ws[taps+n] = ws[n]; // duplicate/unwrap
-
-    *pws = ws;
-
-    free(h); h = NULL;
-    free(w); w = NULL;
-
-    return taps;
-}
-
-static float complex lowpass1a(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    double complex w = 0;
-    ui32_t n;
-    ui32_t S = taps-1 + (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S-n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return (float complex)w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-//static __attribute__((optimize("-ffast-math"))) float complex lowpass()
-static float complex lowpass(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;
-    int n; // -Ofast
-    int S = taps - (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-static float complex lowpass2(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;     // -Ofast
-    int n;
-    int s = sample % taps; // lpIQ
-    int S1 = s;
-    int S1N = S1-taps;
-    int n0 = taps-s;
-    for (n = 0; n < n0; n++) {
-        w += buffer[S1+n]*ws[n];
-    }
-    for (n = n0; n < taps; n++) {
-        w += buffer[S1N+n]*ws[n];
-    }
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-
-static float re_lowpass(float buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float w = 0;
-    int n;
-    int S = taps - (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return w;
-}
-
 static
 int f32_sample(dsp_t *dsp, float *out) {
     float s = 0.0;
@@ -592,8 +202,6 @@ static
 int init_buffers(dsp_t *dsp) {
     int i, pos;
     float b0, b1, b2, b;
-    double t;
-    int n, k;
 
 
     // decimate
@@ -646,40 +254,8 @@ int init_buffers(dsp_t *dsp) {
     }
     if (dsp->opt_iq >= 5)
     {
-        if (!dsp->opt_nolut)
-        {
-            // look up table, exp-rotation
-            int W = 2*8; // 16 Hz window
-            int d = 1; // 1..W , groesster Teiler d <= W von sr_base
-            int freq = (int)( dsp->xlt_fq * (double)dsp->sr_base + 0.5);
-            int freq0 = freq; // init
-            double f0 = freq0 / (double)dsp->sr_base; // init
-
-            for (d = W; d > 0; d--) { // groesster Teiler d <= W von sr
-                if (dsp->sr_base % d == 0) break;
-            }
-            if (d == 0) d = 1; // d >= 1 ?
-
-            for (k = 0; k < W/2; k++) {
-                if ((freq+k) % d == 0) {
-                    freq0 = freq + k;
-                    break;
-                }
-                if ((freq-k) % d == 0) {
-                    freq0 = freq - k;
-                    break;
-                }
-            }
-
-            dsp->lut_len = dsp->sr_base / d;
-            f0 = freq0 / (double)dsp->sr_base;
-
-            dsp->ex = calloc(dsp->lut_len+1, sizeof(float complex));
-            if (dsp->ex == NULL) return -1;
-            for (n = 0; n < dsp->lut_len; n++) {
-                t = f0*(double)n;
-                dsp->ex[n] = cexp(t*_2PI*I);
-            }
+        if (!dsp->opt_nolut) {
+            if (exlut_init(dsp) < 0) return -1;
         }
 
         dsp->decXbuffer = calloc( dsp->dectaps+1, sizeof(float complex));
@@ -741,13 +317,7 @@ int init_buffers(dsp_t *dsp) {
     }
 
 
-    memset(&IQdc, 0, sizeof(IQdc));
-    IQdc.maxlim = dsp->sr;
-    IQdc.maxcnt = IQdc.maxlim/32; // 32,16,8,4,2,1
-    if (dsp->decM > 1) {
-        IQdc.maxlim *= dsp->decM;
-        IQdc.maxcnt *= dsp->decM;
-    }
+    iq_dc_init(dsp);
 
 
     dsp->sample_in = 0;
@@ -767,6 +337,8 @@ int init_buffers(dsp_t *dsp) {
 static
 int free_buffers(dsp_t *dsp) {
 
+    f32read_free(dsp);  // input buffer/mapping
+
     if (dsp->bufs)  { free(dsp->bufs);  dsp->bufs  = NULL; }
 
     // decimate
@@ -9,13 +9,8 @@
 
 AudioFile::AudioFile(std::string filename, int baudrate, int* errors) {
     baudRate = baudrate;
-    if (filename == "" || filename == "-")
-        fp = stdin;
-    else
-        fp = fopen(filename.c_str(), "rb");
 
-    if (!fp) {
-        fprintf(stderr, "%s could not be opened.\n", filename.c_str());
+    if (openFile(filename)) {
         *errors = -1;
         return;
     }
@@ -26,6 +21,32 @@ AudioFile::AudioFile(std::string filename, int baudrate, int* errors) {
         return;
     }
 
+    allocBlock();
+    *errors = 0;
+}
+
+AudioFile::AudioFile(std::string filename, int baudrate, int sampleRate, int bitsSample, int numChannels, int* errors) {
+    baudRate = baudrate;
+
+    if (openFile(filename)) {
+        *errors = -1;
+        return;
+    }
+
+    sample_rate = sampleRate;
+    bits_sample = bitsSample;
+    channels = numChannels;
+    if (sample_rate < 1 || (bits_sample != 8 && bits_sample != 16 && bits_sample != 32)) {
+        fprintf(stderr, "- <sr> <bs>\n");
+        *errors = -1;
+        return;
+    }
+
+    samplesPerBit = sample_rate / (double) baudRate;
+
+    fprintf(stderr, "samples/bit: %.2f\n", samplesPerBit);
+
+    allocBlock();
     *errors = 0;
 }
 
@@ -34,6 +55,19 @@ AudioFile::~AudioFile() {
         fclose(fp);
 }
 
+int AudioFile::openFile(std::string filename) {
+    if (filename == "" || filename == "-")
+        fp = stdin;
+    else
+        fp = fopen(filename.c_str(), "rb");
+
+    if (!fp) {
+        fprintf(stderr, "%s could not be opened.\n", filename.c_str());
+        return -1;
+    }
+    return 0;
+}
+
 int AudioFile::read_wav_header() {
     char txt[4 + 1] = "\0\0\0\0";
     unsigned char dat[4];
@@ -84,7 +118,7 @@ int AudioFile::read_wav_header() {
     fprintf(stderr, "bits       : %d\n", bits_sample);
     fprintf(stderr, "channels   : %d\n", channels);
 
-    if ((bits_sample != 8) && (bits_sample != 16))
+    if ((bits_sample != 8) && (bits_sample != 16) && (bits_sample != 32))
         return -1;
 
     samplesPerBit = sample_rate / (double) baudRate;
@@ -102,66 +136,151 @@ int AudioFile::findstr(char* buf, const char* str, int pos) {
     return i;
 }
 
-int AudioFile::readSignedSample() {
-    int byte, i, sample = 0, s = 0; // EOF -> 0x1000000
-
-    for (i = 0; i < channels; i++) {
-        // i = 0: links bzw. mono
-        byte = fgetc(fp);
-        if (byte == EOF)
-            return EOF_INT;
-        if (i == targetedChannel)
-            sample = byte;
-
-        if (bits_sample == 16) {
-            byte = fgetc(fp);
-            if (byte == EOF)
-                return EOF_INT;
-            if (i == targetedChannel)
-                sample += byte << 8;
+int AudioFile::setIQ(double fq, double lpbw) {
+    if (channels != 2) {
+        fprintf(stderr, "error: iq channels != 2\n");
+        return -1;
+    }
+    iqMode = true;
+
+    // S(t) -> S(t)*exp(-fq*2pi*I*t), fq relative to the sample rate
+    xlt = 1;
+    xltStep = std::polar(1.0, -2 * M_PI * fq);
+
+    lpTaps.clear();
+    lpBuf.clear();
+    if (lpbw > 0) {
+        // Blackman windowed sinc, cutoff lpbw/2
+        double f = lpbw / (double) sample_rate / 2.0;
+        int taps = (int) (4.0 / f);
+        if (taps % 2 == 0)
+            taps++;
+        double norm = 0;
+        lpTaps.resize(2 * taps);
+        for (int n = 0; n < taps; n++) {
+            double w = 7938 / 18608.0 - 9240 / 18608.0 * cos(2 * M_PI * n / (taps - 1)) + 1430 / 18608.0 * cos(4 * M_PI * n / (taps - 1));
+            double x = 2 * f * (n - (taps - 1) / 2);
+            double h = 2 * f * (x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x));
+            lpTaps[n] = w * h;
+            norm += lpTaps[n];
+        }
+        for (int n = 0; n < taps; n++) {
+            lpTaps[n] /= norm;
+            lpTaps[taps + n] = lpTaps[n]; // duplicate, no wrap-around in the convolution
         }
+        lpBuf.assign(taps, 0);
+        lpIndex = 0;
+    }
+
+    fprintf(stderr, "IQ         : fq=%+.4f lowpass=%.0fHz\n", fq, lpbw);
+
+    return 0;
+}
+
+// FM-demod of one baseband IQ sample, -pi..pi -> 16 bit
+int AudioFile::demodIQ(float i, float q) {
+    std::complex<float> z(i, q);
 
+    if (xltStep != 1.) {
+        z *= std::complex<float>(xlt);
+        xlt *= xltStep;
+        if (++xltCount % 1024 == 0)
+            xlt /= std::abs(xlt); // keep the rotation on the unit circle
     }
 
-    if (bits_sample == 8) s = sample - 128; // 8bit: 00..FF, centerpoint 0x80=128
-    if (bits_sample == 16) s = (short) sample;
+    if (!lpBuf.empty()) {
+        int taps = lpBuf.size();
+        const float *w = &lpTaps[taps - 1 - lpIndex];
+        std::complex<float> acc = 0;
 
-    return s;
+        lpBuf[lpIndex] = z;
+        for (int k = 0; k < taps; k++)
+            acc += w[k] * lpBuf[k];
+        lpIndex = (lpIndex + 1) % taps;
+        z = acc;
+    }
+
+    float fm = std::arg(z * std::conj(prevIQ)) / M_PI;
+    prevIQ = z;
+
+    return (int) round(fm * 32767.0);
 }
 
-int AudioFile::readSignedSampleAveraged() {
-    return averageSample(readSignedSample());
+/*
+ * Read up to BLOCK_FRAMES frames and convert them in one pass:
+ * 8 bit: centered raw value, 16 bit: signed value, 32 bit float: scaled to 16 bit.
+ * Only whole frames are used, a partial frame at the end counts as EOF.
+ */
+void AudioFile::allocBlock() {
+    rawBuf.resize(BLOCK_FRAMES * channels); // 4 bytes per sample, enough for all formats
+    block.resize(BLOCK_FRAMES);
+    if (channels > 1)
+        frameBuf.resize(BLOCK_FRAMES * channels);
 }
 
-int AudioFile::readSignedSampleNormalized() {
-    return normalizeSample(readSignedSample());
+int AudioFile::fillBlock() {
+    blockPos = 0;
+    blockLen = 0;
+    if (!fp || rawBuf.empty())
+        return 0;
+
+    int n = fread(rawBuf.data(), channels * bits_sample / 8, BLOCK_FRAMES, fp);
+    int ns = n * channels;
+    int *x = channels > 1 ? frameBuf.data() : block.data();
+
+    if (bits_sample == 8) {
+        const unsigned char *u = (const unsigned char *) rawBuf.data();
+        for (int i = 0; i < ns; i++)
+            x[i] = u[i] - 128; // 8bit: 00..FF, centerpoint 0x80=128
+    } else if (bits_sample == 16) {
+        const short *b = (const short *) rawBuf.data();
+        for (int i = 0; i < ns; i++)
+            x[i] = b[i];
+    } else {
+        const float *f = rawBuf.data();
+        for (int i = 0; i < ns; i++)
+            x[i] = (int) (f[i] * 32768.0f);
+    }
+
+    if (iqMode) {
+        for (int i = 0; i < n; i++)
+            block[i] = demodIQ(x[2 * i], x[2 * i + 1]);
+    } else if (channels > 1) {
+        int ch = targetedChannel < channels ? targetedChannel : 0;
+        for (int i = 0; i < n; i++)
+            block[i] = x[i * channels + ch];
+    }
+
+    blockLen = n;
+    return n;
 }
 
-int AudioFile::readSignedSampleAveragedNormalized() {
-    return averageNormalizeSample(readSignedSample());
+int AudioFile::readBlock(const int** samples) {
+    if (blockPos >= blockLen && fillBlock() == 0)
+        return 0;
+    *samples = block.data() + blockPos;
+    return blockLen - blockPos;
 }
 
-int AudioFile::averageSample(int sample) {
-    if (sample == EOF_INT)
+int AudioFile::readSignedSample() {
+    const int *s;
+
+    if (readBlock(&s) == 0)
         return EOF_INT;
-    // Average over the last AVG_NUM samples to comply with a global offset
-    activeSum = (activeSum + (double) sample)*(samplesPerBit * AVG_NUM) / (samplesPerBit * AVG_NUM + 1.);
-    return sample - activeSum / (samplesPerBit * AVG_NUM);
+    consume(1);
+    return s[0];
 }
 
-int AudioFile::normalizeSample(int sample) {
-    if (sample == EOF_INT)
-        return EOF_INT;
-    return sample > 0 ? 1 : -1;
+int AudioFile::readSignedSampleAveraged() {
+    return averageSample(readSignedSample());
 }
 
-int AudioFile::averageNormalizeSample(int sample) {
-    if (sample == EOF_INT)
-        return EOF_INT;
-    // Average over the last AVG_NUM samples to comply with a global offset
-    activeSum = (activeSum + (double) sample)*(samplesPerBit * AVG_NUM) / (samplesPerBit * AVG_NUM + 1.);
-    sample = sample - activeSum / (samplesPerBit * AVG_NUM);
-    return sample > 0 ? 1 : -1;
+int AudioFile::readSignedSampleNormalized() {
+    return normalizeSample(readSignedSample());
+}
+
+int AudioFile::readSignedSampleAveragedNormalized() {
+    return averageNormalizeSample(readSignedSample());
 }
 
 void AudioFile::resetActiveSum() {
@@ -9,28 +9,51 @@
 #define AUDIOFILE_H
 #define EOF_INT  0x1000000
 #define AVG_NUM 5.
+#define BLOCK_FRAMES 8192
 
 #include <stdio.h>
 #include <string>
 #include <cstring>
 #include <cmath>
+#include <complex>
 #include <vector>
 
 class AudioFile {
 public:
     AudioFile(std::string filename, int baudrate, int* errors);
+    // Raw PCM without header (8/16 bit int, 32 bit float)
+    AudioFile(std::string filename, int baudrate, int sampleRate, int bitsSample, int numChannels, int* errors);
     virtual ~AudioFile();
 
     int read_wav_header();
+    int setIQ(double fq, double lpbw);
+
+    // Span of buffered samples of the selected channel (IQ: FM-demodulated),
+    // refilled from the file when all have been consumed. Returns its length, 0 at EOF.
+    int readBlock(const int** samples);
+    // Mark n samples of the last readBlock() as used
+    void consume(int n) { blockPos += n; }
 
     int readSignedSample();
     int readSignedSampleAveraged();
     int readSignedSampleNormalized();
     int readSignedSampleAveragedNormalized();
 
-    int averageSample(int sample);
-    int normalizeSample(int sample);
-    int averageNormalizeSample(int sample);
+    int averageSample(int sample) {
+        if (sample == EOF_INT)
+            return EOF_INT;
+        // Average over the last AVG_NUM samples to comply with a global offset
+        activeSum = (activeSum + (double) sample)*(samplesPerBit * AVG_NUM) / (samplesPerBit * AVG_NUM + 1.);
+        return sample - activeSum / (samplesPerBit * AVG_NUM);
+    }
+    int normalizeSample(int sample) {
+        if (sample == EOF_INT)
+            return EOF_INT;
+        return sample > 0 ? 1 : -1;
+    }
+    int averageNormalizeSample(int sample) {
+        return normalizeSample(averageSample(sample));
+    }
 
     void resetActiveSum();
     
@@ -42,7 +65,11 @@ public:
     void setTargetedChannel(int channel) { targetedChannel = channel; }
     void setBaudRate(int baudv) { baudRate = baudv; }
 private:
+    int openFile(std::string filename);
     int findstr(char* buf, const char* str, int pos);
+    void allocBlock();
+    int fillBlock();
+    int demodIQ(float i, float q);
     
     double activeSum = 0;
     int targetedChannel = 0;
@@ -52,7 +79,24 @@ private:
     int baudRate;
     double samplesPerBit = 0;
 
-    FILE *fp;
+    // Baseband IQ: translate by -fq, optional lowpass, FM-demod
+    bool iqMode = false;
+    std::complex<double> xlt = 1;
+    std::complex<double> xltStep = 1;
+    unsigned int xltCount = 0;
+    std::vector<float> lpTaps;
+    std::vector<std::complex<float> > lpBuf;
+    int lpIndex = 0;
+    std::complex<float> prevIQ = 0;
+
+    // Block reader
+    std::vector<float> rawBuf;
+    std::vector<int> frameBuf;
+    std::vector<int> block;
+    int blockPos = 0;
+    int blockLen = 0;
+
+    FILE *fp = NULL;
 };
 
 #endif /* AUDIOFILE_H */
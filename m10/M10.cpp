@@ -6,10 +6,32 @@
  */
 
 #include <cstdlib>
+#include <new>
 #include "M10Decoder.h"
 
 using namespace std;
 
+#ifdef ALLOC_STATS
+// Count heap allocations, reported with -R (make CFLAGS=-DALLOC_STATS)
+unsigned long allocCount = 0;
+
+void* operator new(std::size_t size) {
+    ++allocCount;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    free(p);
+}
+#endif
+
 /*
  * 
  */
@@ -17,21 +39,28 @@ int main(int argc, char** argv) {
     M10Decoder decoder;
     std::string filename = "";
     char *fpname;
+    double lpbw = 24e3; // IQ lowpass bandwidth
 
     fpname = argv[0];
     ++argv;
     while (*argv) {
         if ((strcmp(*argv, "-h") == 0) || (strcmp(*argv, "--help") == 0)) {
             fprintf(stderr, "%s [options] filename\n", fpname);
+            fprintf(stderr, "%s [options] - <sr> <bs> [filename]\n", fpname);
             fprintf(stderr, "  filename needs to be in wav format and blank or - for stdin\n");
+            fprintf(stderr, "  - <sr> <bs>: raw PCM (IQ: 2 channels), sample rate, bits 8/16/32(float)\n");
             fprintf(stderr, "  options:\n");
             fprintf(stderr, "       -v, --verbose Display even when CRC is wrong\n");
             fprintf(stderr, "       -R Show result at the end decoded/total\n");
             fprintf(stderr, "       -r, --raw Display raw information\n");
             fprintf(stderr, "       -b Try alternative method after main method if it failed\n");
-            fprintf(stderr, "       -b2 Try to repair data with the previous line\n");
-            fprintf(stderr, "       -s Try to repair data with stats if no data has been correctly decoded\n");
+            fprintf(stderr, "       -b2 Try to repair data with the bytes voted by the previous frames\n");
+            fprintf(stderr, "       -s Try to repair data with the votes if no data has been correctly decoded\n");
             fprintf(stderr, "       --ch2 Decode the second channel\n");
+            fprintf(stderr, "       --json JSON output like m10mod (CRC ok frames only)\n");
+            fprintf(stderr, "       --jsn_cfq <freq> Center frequency/Hz in the JSON output\n");
+            fprintf(stderr, "       --IQ <fq> Baseband IQ input, signal at fq (-0.5 < fq < 0.5)\n");
+            fprintf(stderr, "       --lpbw <kHz> IQ lowpass bandwidth (default 24)\n");
             
             return 0;
         } else if ((strcmp(*argv, "-r") == 0) || (strcmp(*argv, "--raw") == 0)) {
@@ -48,12 +77,46 @@ int main(int argc, char** argv) {
             decoder.setDispResult(true);
         } else if (strcmp(*argv, "--ch2") == 0) {
             decoder.setChannel(1); // right channel (default: 0=left)
+        } else if (strcmp(*argv, "--json") == 0) {
+            decoder.setJson(true);
+        } else if (strcmp(*argv, "--jsn_cfq") == 0) {
+            ++argv;
+            if (!*argv)
+                return -1;
+            decoder.setJsonFreq((atoi(*argv) + 500) / 1000);
+        } else if (strcmp(*argv, "--IQ") == 0) {
+            ++argv;
+            if (!*argv)
+                return -1;
+            double fq = atof(*argv);
+            if (fq < -0.5) fq = -0.5;
+            if (fq > 0.5) fq = 0.5;
+            decoder.setIQ(fq);
+        } else if (strcmp(*argv, "--lpbw") == 0) {
+            ++argv;
+            if (!*argv)
+                return -1;
+            double bw = atof(*argv);
+            if (bw > 4.6 && bw < 48.0)
+                lpbw = bw * 1e3;
+        } else if (strcmp(*argv, "--lpIQ") == 0 || strcmp(*argv, "--dc") == 0) {
+            // Accepted for m10mod compatibility: the IQ lowpass is always on
+            // and the FM offset is always averaged out
+        } else if (strcmp(*argv, "-") == 0 && argv[1] && atoi(argv[1]) > 0) {
+            // - <sr> <bs>: raw PCM, otherwise "-" is a wav on stdin
+            int sr = atoi(*++argv);
+            ++argv;
+            if (!*argv)
+                return -1;
+            decoder.setRawInput(sr, atoi(*argv));
         } else {
             filename = *argv;
         }
         ++argv;
     }
 
+    decoder.setLpIQ(lpbw);
+
     return decoder.startDecode(filename);
 }
 
@@ -5,10 +5,16 @@
  * Created on December 12, 2018, 11:31 PM
  */
 
+#include <algorithm>
+#include <cstring>
 #include "M10Decoder.h"
 #include "M10GtopParser.h"
 #include "M10TrimbleParser.h"
 
+#ifdef ALLOC_STATS
+extern unsigned long allocCount; // M10.cpp
+#endif
+
 char M10Decoder::header[] = "10011001100110010100110010011001";
 
 M10Decoder::M10Decoder() {
@@ -16,7 +22,6 @@ M10Decoder::M10Decoder() {
     m10Trimble = new M10TrimbleParser();
     m10Parser = m10Gtop;
     
-    frameSamples = NULL;
     audioFile = NULL;
 }
 
@@ -24,9 +29,6 @@ M10Decoder::~M10Decoder() {
     delete m10Gtop;
     delete m10Trimble;
 
-    if (frameSamples)
-        delete frameSamples;
-
     if (audioFile)
         delete audioFile;
 }
@@ -35,17 +37,28 @@ int M10Decoder::startDecode(std::string fname) {
     filename = fname;
     int error = 0;
 
-    audioFile = new AudioFile(fname, baudRate, &error);
+    if (rawSampleRate > 0)
+        audioFile = new AudioFile(fname, baudRate, rawSampleRate, rawBits, iqMode ? 2 : 1, &error);
+    else
+        audioFile = new AudioFile(fname, baudRate, &error);
 
     if (error) {
         return error;
     }
 
+    audioFile->setTargetedChannel(iqMode ? 0 : targetedChannel);
+    if (iqMode && audioFile->setIQ(iqFreq, lpIQ_bw))
+        return -1;
+
     samplesPerBit = audioFile->getSamplesPerBit();
 
     samplesBufLength = (DATA_LENGTH * 8 + 100) * samplesPerBit * 2;
-    frameSamples = new std::vector<int>(samplesBufLength);
+    frameSamples.assign(samplesBufLength, 0);
+    recentSamples.assign((int) (samplesPerBit * 5.), 0);
 
+#ifdef ALLOC_STATS
+    unsigned long allocStart = allocCount;
+#endif
     double res = 1;
     bool supported = true;
     while (res != EOF_INT) {
@@ -57,8 +70,8 @@ int M10Decoder::startDecode(std::string fname) {
         if (decodeMessage(res) == EOF_INT)
             break;
 
-        long sondeType = ((long) frame_bytes[1] << 8) + (long) frame_bytes[2];
-        frameLength = frame_bytes[0];
+        long sondeType = ((long) (*frame_bytes)[1] << 8) + (long) (*frame_bytes)[2];
+        frameLength = (*frame_bytes)[0];
         supported = true;
         switch (sondeType) {
             case 0xAF02:
@@ -72,25 +85,27 @@ int M10Decoder::startDecode(std::string fname) {
         }
 
         bool correctCRC = checkCRC();
+        if (!correctCRC && supported && (tryRepair || tryStats)) { // Most bytes of a bad frame are right
+            m10Parser->changeData(*frame_bytes, false);
+            m10Parser->addToStats(VOTE_BAD);
+        }
         if (correctCRC || verboseLevel >= 1) {
             if (!supported) {
                 fprintf(stderr, "Not supported : %#06x\n", (unsigned int) sondeType);
                 continue;
             }
+            m10Parser->changeData(*frame_bytes, correctCRC);
             if (correctCRC) {
                 correctFrames++;
-                lastGoodFrame = frame_bytes;
+                if (tryRepair || tryStats)
+                    m10Parser->addToStats(VOTE_GOOD);
+                std::swap(frame_bytes, lastGoodFrame); // The parser keeps viewing it
             }
+            if (!dispJson)
+                m10Parser->printFrame();
+            else if (correctCRC)
+                m10Parser->printJson(jsonFreq);
 
-            m10Parser->changeData(frame_bytes, correctCRC);
-            m10Parser->printFrame();
-
-            if (!correctCRC) {
-                if (correctFrames == 0 && tryStats) // Add the frame to the record
-                    m10Parser->addToStats();
-                else if (tryRepair && correctFrames != 0) // Put the last correct to repair
-                    m10Parser->changeData(lastGoodFrame, correctFrames > 0);
-            }
         }
     }
     if (tryStats && verboseLevel >= 1)
@@ -98,30 +113,47 @@ int M10Decoder::startDecode(std::string fname) {
 
     if (dispResult)
         fprintf(stderr, "Result of %i/%i decoding\n", correctFrames, totalFrames);
+    if (dispResult && (tryRepair || tryStats))
+        fprintf(stderr, "Repaired frames: %i\n", repairedFrames);
+#ifdef ALLOC_STATS
+    if (dispResult)
+        fprintf(stderr, "Heap allocations while decoding: %lu\n", allocCount - allocStart);
+#endif
     return 0;
 }
 
 double M10Decoder::findFrameStart() {
-    int headerLength = strlen(header);
-    double posData[headerLength];
-    char decoded[headerLength];
+    const int headerLength = HEADER_LEN;
+    double posData[HEADER_LEN];
     int currentIndex = 0;
 
+    // Last headerLength decoded bits, newest in bit 0 (headerLength <= 32)
+    unsigned int decoded = 0;
+    unsigned int hdrMask = 0;
+    unsigned int lenMask = headerLength < 32 ? (1u << headerLength) - 1 : ~0u;
     for (int i = 0; i < headerLength; ++i)
-        decoded[i] = '0'; // Fill in decoded to compare later
+        hdrMask = (hdrMask << 1) | (header[i] == '1');
 
     int prevV = 1;
     int len = 0;
     int v;
-    int smallBufLen = (int) (samplesPerBit * 5.);
-    std::vector<int> vals(smallBufLen);
+    int smallBufLen = recentSamples.size();
+    std::vector<int> &vals = recentSamples;
     int valIndex = 0;
     double activeSum = 0;
+    const int *block;
+    int blockLen = 0;
+    int blockPos = 0;
     for (int j = 0; 1; ++j) {
-        v = audioFile->readSignedSample();
+        if (blockPos == blockLen) {
+            audioFile->consume(blockPos);
+            blockLen = audioFile->readBlock(&block);
+            blockPos = 0;
+            if (blockLen == 0)
+                return EOF_INT;
+        }
+        v = block[blockPos++];
         vals[valIndex++ % smallBufLen] = v;
-        if (v == EOF_INT)
-            return EOF_INT;
         // Average over the last 6 samples to comply with a global offset
         activeSum = (activeSum + (double) v)*(samplesPerBit * AVG_NUM) / (samplesPerBit * AVG_NUM + 1.);
         v = v - activeSum / (samplesPerBit * AVG_NUM);
@@ -130,27 +162,16 @@ double M10Decoder::findFrameStart() {
         if (v * prevV > 0) // If the signs are the same
             continue;
 
-        for (int i = 0; i < round((double) len / samplesPerBit); ++i) { // Multiple bits in one detection
-            if (prevV < 0)
-                decoded[currentIndex] = '1';
-            else
-                decoded[currentIndex] = '0';
+        double nbits = round((double) len / samplesPerBit);
+        for (int i = 0; i < nbits; ++i) { // Multiple bits in one detection
+            decoded = ((decoded << 1) | (prevV < 0)) & lenMask;
 
             // Store the position of the start of the bit
-            posData[currentIndex] = (double) j - (1. - (double) i / round((double) len / samplesPerBit))*(double) len;
-
-            char normal = 1;
-            char inv = 1;
-            int headerIndex = 0;
-
-            // Check if the header is correct
-            for (int k = 0; k < headerLength; ++k) {
-                if (decoded[(k + currentIndex + 1) % headerLength] == header[headerIndex])
-                    inv = 0;
-                else
-                    normal = 0;
-                headerIndex++;
-            }
+            posData[currentIndex] = (double) j - (1. - (double) i / nbits)*(double) len;
+
+            // Check if the header is correct, or inverted
+            bool normal = decoded == hdrMask;
+            bool inv = decoded == (~hdrMask & lenMask);
 
             if (normal || inv) {
                 // Calculate the real position of the data averaging over the headerLength samples
@@ -172,10 +193,11 @@ double M10Decoder::findFrameStart() {
                     tmpIndex = valIndex + curIndex - (j - (int) pos);
                     if (tmpIndex < 0)
                         tmpIndex += smallBufLen;
-                    frameSamples->at(curIndex) = vals.at(tmpIndex);
+                    frameSamples[curIndex] = vals[tmpIndex];
                 }
 
                 // Only the weight of the first bit is useful, they are stored already
+                audioFile->consume(blockPos);
                 return pos - (int) pos;
             }
 
@@ -187,13 +209,17 @@ double M10Decoder::findFrameStart() {
 }
 
 int M10Decoder::decodeMessage(double initialPos) {
-    std::array<unsigned char, DATA_LENGTH> frameBackup;
-    int v;
-    for (; curIndex < samplesBufLength; ++curIndex) {
-        v = audioFile->readSignedSample();
-        if (v == EOF_INT)
+    const int *block;
+    int n;
+    while (curIndex < samplesBufLength) {
+        n = audioFile->readBlock(&block);
+        if (n == 0)
             return EOF_INT;
-        frameSamples->at(curIndex) = v;
+        if (n > samplesBufLength - curIndex)
+            n = samplesBufLength - curIndex;
+        std::copy(block, block + n, frameSamples.begin() + curIndex);
+        audioFile->consume(n);
+        curIndex += n;
     }
 
     // Reset the index
@@ -207,13 +233,8 @@ int M10Decoder::decodeMessage(double initialPos) {
     if (ret == EOF_INT)
         return EOF_INT;
 
-    if ((tryRepair && correctFrames != 0) || (correctFrames == 0 && tryStats)) {
-        frameBackup = frame_bytes;
-        frame_bytes = m10Parser->replaceWithPrevious(frame_bytes);
-        if (checkCRC())
-            return 0;
-        frame_bytes = frameBackup;
-    }
+    if (repairFromVotes())
+        return 0;
 
     if (trySign) {
         // Reset the index
@@ -224,18 +245,33 @@ int M10Decoder::decodeMessage(double initialPos) {
         if (ret == EOF_INT)
             return EOF_INT;
 
-        if ((tryRepair && correctFrames != 0) || (correctFrames == 0 && tryStats)) {
-            frameBackup = frame_bytes;
-            frame_bytes = m10Parser->replaceWithPrevious(frame_bytes);
-            if (checkCRC())
-                return 0;
-            frame_bytes = frameBackup;
-        }
+        if (repairFromVotes())
+            return 0;
     }
 
     return 1;
 }
 
+/*
+ * Replace the bytes of a bad frame with the ones voted by the previous frames.
+ * A result equal to the last good frame is a repeat, not a recovered frame.
+ */
+bool M10Decoder::repairFromVotes() {
+    if (!((tryRepair && correctFrames != 0) || (correctFrames == 0 && tryStats)))
+        return false;
+    if (!m10Parser->replaceWithPrevious(*frame_bytes, *repairFrame))
+        return false;
+
+    std::swap(frame_bytes, repairFrame);
+    if (checkCRC() && (correctFrames == 0
+            || memcmp(frame_bytes->data(), lastGoodFrame->data(), frameLength + 1) != 0)) {
+        repairedFrames++;
+        return true;
+    }
+    std::swap(frame_bytes, repairFrame);
+    return false;
+}
+
 int M10Decoder::decodeMethodCompare(double initialPos) {
     char bit0 = 2;
 
@@ -376,7 +412,7 @@ void M10Decoder::setRaw(bool b) {
 
 int M10Decoder::getNextBufferValue() {
     if (curIndex < samplesBufLength)
-        return frameSamples->at(curIndex++);
+        return frameSamples[curIndex++];
     else {
         fprintf(stderr, "Error, end of buffer.\n");
         return EOF_INT;
@@ -386,12 +422,17 @@ int M10Decoder::getNextBufferValue() {
 bool M10Decoder::checkCRC() {
     int i, cs;
 
+    const std::array<unsigned char, DATA_LENGTH> &frame = *frame_bytes;
+
+    if (frameLength < 1 || frameLength >= DATA_LENGTH)
+        return false;
+
     cs = 0;
     for (i = 0; i < frameLength-1; i++) {
-        cs = update_checkM10(cs, frame_bytes[i]);
+        cs = update_checkM10(cs, frame[i]);
     }
 
-    return ((cs & 0xFFFF) != 0) && ((cs & 0xFFFF) == ((frame_bytes[frameLength-1] << 8) | frame_bytes[frameLength]));
+    return ((cs & 0xFFFF) != 0) && ((cs & 0xFFFF) == ((frame[frameLength-1] << 8) | frame[frameLength]));
 }
 
 int M10Decoder::update_checkM10(int c, unsigned short b) {
@@ -439,7 +480,7 @@ void M10Decoder::bits2bytes() {
             d <<= 1;
         }
         bitpos += 8;
-        frame_bytes[bytepos++] = byteval & 0xFF;
+        (*frame_bytes)[bytepos++] = byteval & 0xFF;
 
     }
 }
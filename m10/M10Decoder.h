@@ -16,6 +16,7 @@
 #define pos_Check     (stdFLEN-1)  // 2 byte
 
 #define AVG_NUM 5.
+#define HEADER_LEN 32
 
 #include <string>
 #include <cstring>
@@ -39,12 +40,18 @@ public:
     void setTryMethodRepair(bool b) {tryRepair = b;}
     void setTryStats(bool b) {tryStats = b;}
     void setVerboseLevel(int level) {verboseLevel = level;}
+    void setJson(bool b) {dispJson = b;}
+    void setJsonFreq(int f) {jsonFreq = f;}
+    void setRawInput(int sr, int bits) {rawSampleRate = sr; rawBits = bits;}
+    void setIQ(double fq) {iqMode = true; iqFreq = fq;}
+    void setLpIQ(double bw) {lpIQ_bw = bw;}
     
 protected:
     int decodeMethodCompare(double initialPos);
     int decodeMethodSign(double initialPos);
     int getNextBufferValue();
     bool checkCRC();
+    bool repairFromVotes();
     int update_checkM10(int c, unsigned short b);
     void bits2bytes();
 
@@ -59,6 +66,13 @@ protected:
     bool trySign = false;
     bool tryRepair = false;
     bool tryStats = false;
+    bool dispJson = false;
+    int jsonFreq = 0;
+    int rawSampleRate = 0;
+    int rawBits = 0;
+    bool iqMode = false;
+    double iqFreq = 0;
+    double lpIQ_bw = 0;
     int verboseLevel = 0;
     int targetedChannel = 0;
     double samplesPerBit = 0;
@@ -66,16 +80,21 @@ protected:
     static char header[];
     std::string filename;
     
-    std::vector<int> *frameSamples;
+    std::vector<int> frameSamples;
+    std::vector<int> recentSamples; // findFrameStart() ring buffer
     int curIndex = 0;
     int samplesBufLength = 0;
     int correctFrames = 0;
     int totalFrames = 0;
+    int repairedFrames = 0;
     int frameLength = 0;
     
-    std::array<unsigned char, DATA_LENGTH> frame_bytes;
+    // Frame buffers: the pointers are swapped when a buffer changes role, nothing is copied
+    std::array<unsigned char, DATA_LENGTH> frameBuf[3];
+    std::array<unsigned char, DATA_LENGTH> *frame_bytes = &frameBuf[0];
+    std::array<unsigned char, DATA_LENGTH> *lastGoodFrame = &frameBuf[1];
+    std::array<unsigned char, DATA_LENGTH> *repairFrame = &frameBuf[2];
     std::array<unsigned char, (DATA_LENGTH)*8> frame_bits;
-    std::array<unsigned char, DATA_LENGTH> lastGoodFrame;
 };
 
 #endif /* M10DECODER_H */
@@ -8,6 +8,8 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <cstdio>
+#include <ctime>
 #include "M10GeneralParser.h"
 #include "M10TrimbleParser.h"
 
@@ -17,9 +19,9 @@ M10GeneralParser::M10GeneralParser() {
 M10GeneralParser::~M10GeneralParser() {
 }
 
-void M10GeneralParser::changeData(std::array<unsigned char, DATA_LENGTH> data, bool good) {
+void M10GeneralParser::changeData(const std::array<unsigned char, DATA_LENGTH>& data, bool good) {
     correctCRC = good;
-    frame_bytes = data;
+    frame_bytes = data.data();
     frameLength = frame_bytes[0];
 }
 
@@ -71,37 +73,142 @@ double M10GeneralParser::getDirection() {
     return 0;
 }
 
-std::string M10GeneralParser::getSerialNumber() {
-    return "";
+int M10GeneralParser::getSatellites() {
+    return -1;
 }
 
-std::array<unsigned char, DATA_LENGTH> M10GeneralParser::replaceWithPrevious(std::array<unsigned char, DATA_LENGTH> data) {
-    return data;
+double M10GeneralParser::getTemperature() {
+    return -273.15;
 }
 
-void M10GeneralParser::addToStats() {
-    for (int i = 0; i < DATA_LENGTH; ++i) {
-        ++statValues[i][frame_bytes[i]];
-    }
+double M10GeneralParser::getBatteryLevel() {
+    return 0;
 }
 
-void M10GeneralParser::printStatsFrame() {
-    unsigned short valMax;
-    unsigned short posMax;
+int M10GeneralParser::getUtcOffset() {
+    return 0;
+}
 
+const char* M10GeneralParser::getSerialNumber() {
+    return "";
+}
+
+/*
+ * Same record as m10mod --json, so the output can be fed to auto_rx.
+ * freq: center frequency / kHz, 0 for none
+ */
+void M10GeneralParser::printJson(int freq) {
+    const unsigned char *sn = &frame_bytes[0x5D];
+    const char *ver_jsn = NULL;
+    struct tm t = {};
+    time_t t0, utc;
+    unsigned short b;
+    char id[20];
+
+    // The parsers report GPS time (Trimble) or UTC (Gtop), getUtcOffset() apart
+    t.tm_year = getYear() - 1900;
+    t.tm_mon = getMonth() - 1;
+    t.tm_mday = getDay();
+    t.tm_hour = getHours();
+    t.tm_min = getMinutes();
+    t.tm_sec = getSeconds();
+    t0 = timegm(&t);
+    utc = t0 - getUtcOffset();
+    gmtime_r(&utc, &t);
+
+    b = sn[3] | (sn[4] << 8);
+    snprintf(id, sizeof (id), "M10-%1X%02u-%1X-%1u%04u", (sn[2] >> 4)&0xF, sn[2] & 0xF, sn[0]&0xF, (b >> 13)&0x7, b & 0x1FFF);
+
+    printf("{ \"type\": \"%s\"", "M10");
+    printf(", \"frame\": %lu, ", (unsigned long) (t0 - 315964800)); // GPS seconds
+    printf("\"id\": \"%s\", \"datetime\": \"%04d-%02d-%02dT%02d:%02d:%06.3fZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.5f, \"vel_h\": %.5f, \"heading\": %.5f, \"vel_v\": %.5f",
+            id, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, (double) t.tm_sec,
+            getLatitude(), getLongitude(), getAltitude(), getHorizontalSpeed(), getDirection(), getVerticalSpeed());
+    if (getSatellites() >= 0)
+        printf(", \"sats\": %d", getSatellites());
+    printf(", \"aprsid\": \"ME%02X%1X%02X%02X\"", sn[2], sn[0] & 0xF, sn[4], sn[3]);
+    if (getBatteryLevel() > 0)
+        printf(", \"batt\": %.2f", getBatteryLevel());
+    if (getTemperature() > -273.0)
+        printf(", \"temp\": %.1f", getTemperature());
+    printf(", \"rawid\": \"M10_%02X%02X%02X%02X%02X\"", sn[0], sn[1], sn[2], sn[3], sn[4]);
+    printf(", \"subtype\": \"0x%02X\"", frame_bytes[1]);
+    if (freq > 0)
+        printf(", \"freq\": %d", freq);
+    printf(", \"ref_datetime\": \"%s\"", "UTC");
+    printf(", \"ref_position\": \"%s\"", "GPS");
+    printf(", \"gpsutc_leapsec\": %d", getUtcOffset());
+#ifdef VER_JSN_STR
+    ver_jsn = VER_JSN_STR;
+#endif
+    if (ver_jsn && *ver_jsn != '\0')
+        printf(", \"version\": \"%s\"", ver_jsn);
+    printf(" }\n");
+    fflush(stdout);
+}
+
+bool M10GeneralParser::replaceWithPrevious(const std::array<unsigned char, DATA_LENGTH>& data, std::array<unsigned char, DATA_LENGTH>& repaired) {
+    unsigned char v;
+    int changed = 0;
+
+    repaired = data;
     for (int i = 0; i < FRAME_LEN; ++i) {
-        valMax = 0;
-        posMax = 0;
-        for (unsigned short k = 0; k < 0xFF+1; ++k) { // Find maximum
-            if (statValues[i][k] > valMax) {
-                valMax = statValues[i][k];
-                posMax = k;
-            }
+        if (votedByte(i, &v) && v != data[i]) {
+            repaired[i] = v;
+            changed++;
         }
-        frame_bytes[i] = posMax;
     }
-    
-    changeData(frame_bytes, false);
+    return changed > 0;
+}
+
+void M10GeneralParser::addToStats(int weight) {
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        ByteVotes &bv = votes[i];
+        int k, min = 0;
+
+        for (k = 0; k < VOTE_K; ++k) {
+            if (bv.count[k] > 0 && bv.value[k] == frame_bytes[i])
+                break;
+            if (bv.count[k] < bv.count[min])
+                min = k;
+        }
+        if (k == VOTE_K) { // New value replaces the weakest one
+            k = min;
+            bv.value[k] = frame_bytes[i];
+            bv.count[k] = 0;
+        }
+        bv.count[k] += weight;
+        if (bv.count[k] >= VOTE_MAX) {
+            for (int j = 0; j < VOTE_K; ++j)
+                bv.count[j] >>= 1;
+        }
+    }
+}
+
+/*
+ * The value at pos is trusted if it got at least 2 votes
+ * and 3/4 of the votes at this position.
+ */
+bool M10GeneralParser::votedByte(int pos, unsigned char *value) {
+    const ByteVotes &bv = votes[pos];
+    int best = 0, total = 0;
+
+    for (int k = 0; k < VOTE_K; ++k) {
+        total += bv.count[k];
+        if (bv.count[k] > bv.count[best])
+            best = k;
+    }
+    *value = bv.value[best];
+    return bv.count[best] >= 2 && 4 * bv.count[best] >= 3 * total;
+}
+
+void M10GeneralParser::printStatsFrame() {
+    for (int i = 0; i < FRAME_LEN; ++i)
+        votedByte(i, &statFrame[i]);
+    for (int i = FRAME_LEN; i < DATA_LENGTH; ++i)
+        statFrame[i] = frame_bytes ? frame_bytes[i] : 0;
+
+    changeData(statFrame, false);
     
     printf("Stats frame:\n");
     printFrame();
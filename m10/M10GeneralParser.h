@@ -11,13 +11,20 @@
 #define AUX_LEN         20
 #define DATA_LENGTH     (FRAME_LEN + AUX_LEN + 2)
 
+#define VOTE_K          4   // candidate values kept per byte position
+#define VOTE_MAX        32  // counts are halved at this value, recent frames dominate
+#define VOTE_GOOD       2   // weight of a frame with correct CRC
+#define VOTE_BAD        1   // and with a wrong one
+
 #include <array>
+#include <string>
 
 class M10GeneralParser {
 public:
     M10GeneralParser();
     virtual ~M10GeneralParser();
-    virtual void changeData(std::array<unsigned char, DATA_LENGTH> data, bool good);
+    // The parser keeps a view of data, which has to stay valid until the next changeData()
+    virtual void changeData(const std::array<unsigned char, DATA_LENGTH>& data, bool good);
     void setRaw(bool b) {dispRaw = b;}
     virtual double getLatitude();
     virtual double getLongitude();
@@ -31,17 +38,34 @@ public:
     virtual double getVerticalSpeed();
     virtual double getHorizontalSpeed();
     virtual double getDirection();
-    virtual std::string getSerialNumber();
-    std::array<unsigned char, DATA_LENGTH> getFrameBytes() {return frame_bytes;}
+    virtual int getSatellites();
+    virtual double getTemperature();
+    virtual double getBatteryLevel();
+    virtual int getUtcOffset();
+    virtual const char* getSerialNumber();
+    const unsigned char* getFrameBytes() {return frame_bytes;}
     
-    virtual std::array<unsigned char, DATA_LENGTH> replaceWithPrevious(std::array<unsigned char, DATA_LENGTH> data);
-    virtual void addToStats();
+    // Fill repaired from data and the votes of the previous frames, false if nothing changed
+    virtual bool replaceWithPrevious(const std::array<unsigned char, DATA_LENGTH>& data, std::array<unsigned char, DATA_LENGTH>& repaired);
+    // Vote with the current frame
+    virtual void addToStats(int weight);
     virtual void printStatsFrame();
     
     virtual void printFrame() = 0;
+    void printJson(int freq);
 protected:
-    std::array<unsigned char, DATA_LENGTH> frame_bytes;
-    std::array<std::array<unsigned short, 0xFF+1>, DATA_LENGTH> statValues = {};
+    const unsigned char* frame_bytes = NULL;
+    bool votedByte(int pos, unsigned char *value);
+
+    // Per byte position the VOTE_K most frequent recent values
+    struct ByteVotes {
+        unsigned char value[VOTE_K];
+        unsigned char count[VOTE_K];
+    };
+    std::array<ByteVotes, FRAME_LEN> votes = {};
+    std::array<unsigned char, DATA_LENGTH> statFrame;
+    char serialNumber[18];
+    char dxlSerialNumber[9];
     bool correctCRC;
     bool dispRaw = false;
     int frameLength = 0;
@@ -31,7 +31,7 @@ M10GtopParser::M10GtopParser() {
 M10GtopParser::~M10GtopParser() {
 }
 
-void M10GtopParser::changeData(std::array<unsigned char, DATA_LENGTH> data, bool good) {
+void M10GtopParser::changeData(const std::array<unsigned char, DATA_LENGTH>& data, bool good) {
     M10GeneralParser::changeData(data, good);
 
     int i;
@@ -166,7 +166,7 @@ double M10GtopParser::getDirection() {
 }
 
 double M10GtopParser::getTemperature() {
-    return 0;
+    return -273.15; // Not decoded
 }
 
 double M10GtopParser::getHumidity() {
@@ -177,11 +177,11 @@ double M10GtopParser::getDp() {
     return 0;
 }
 
-std::string M10GtopParser::getSerialNumber() {
+const char* M10GtopParser::getSerialNumber() {
     int i;
     unsigned byte;
     unsigned short sn_bytes[5];
-    char SN[18];
+    char *SN = serialNumber;
 
     for (i = 0; i < 17; i++)
         SN[i] = ' ';
@@ -210,7 +210,7 @@ std::string M10GtopParser::getSerialNumber() {
     return SN;
 }
 
-std::string M10GtopParser::getdxlSerialNumber() {
+const char* M10GtopParser::getdxlSerialNumber() {
     int i;
     unsigned byte;
     unsigned short sn_bytes[5];
@@ -222,7 +222,7 @@ std::string M10GtopParser::getdxlSerialNumber() {
 
     // The way used by dxlARPS used for compatibility.
     uint32_t id;
-    char ids[9];
+    char *ids = dxlSerialNumber;
 
     id = (uint32_t) (((uint32_t) ((uint32_t) (uint8_t)
             sn_bytes[4] + 256UL * (uint32_t) (uint8_t)
@@ -257,7 +257,6 @@ void M10GtopParser::printFrame() {
             printf(" [NO]");
         printf("\n");
     } else {
-        setenv("TZ", "", 1); // Set local timezone to UTC
         time_t frame = 0;
         struct tm timeinfo;
 
@@ -269,7 +268,7 @@ void M10GtopParser::printFrame() {
         timeinfo.tm_year = getYear() - 1900;
         timeinfo.tm_isdst = 0;
 
-        frame = mktime(&timeinfo);
+        frame = timegm(&timeinfo);
 
         printf("{ "
                 "\"sub_type\": \"%s\", "
@@ -286,7 +285,7 @@ void M10GtopParser::printFrame() {
                 //"\"temp\": %.1f "
                 "\"crc\": %d "
                 "}\n",
-                "Gtop", frame, getSerialNumber().c_str(), getdxlSerialNumber().c_str(), getYear(), getMonth(), getDay(), getHours(), getMinutes(), getSeconds(), getLatitude(), getLongitude(),
+                "Gtop", frame, getSerialNumber(), getdxlSerialNumber(), getYear(), getMonth(), getDay(), getHours(), getMinutes(), getSeconds(), getLatitude(), getLongitude(),
                 getAltitude(), getHorizontalSpeed(), getDirection(), getVerticalSpeed()/*, getTemperature()*/, correctCRC);
     }
     fflush(stdout);
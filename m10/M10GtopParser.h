@@ -18,7 +18,7 @@ class M10GtopParser : public M10GeneralParser {
 public:
     M10GtopParser();
     virtual ~M10GtopParser();
-    virtual void changeData(std::array<unsigned char, DATA_LENGTH> data, bool good);
+    virtual void changeData(const std::array<unsigned char, DATA_LENGTH>& data, bool good);
     virtual double getLatitude();
     virtual double getLongitude();
     virtual double getAltitude();
@@ -34,8 +34,8 @@ public:
     virtual double getTemperature();
     virtual double getHumidity();
     virtual double getDp();
-    virtual std::string getSerialNumber();
-    virtual std::string getdxlSerialNumber();
+    virtual const char* getSerialNumber();
+    virtual const char* getdxlSerialNumber();
     
     void printFrame();
 private:
@@ -24,7 +24,6 @@
 #include <sstream>
 #include <iostream>
 
-char M10TrimbleParser::similarData[] = "xxxx----------------------xxxxxxxxxxxxxxxxxxxxxxxxxxx---xxxxxxx--xxxx-----xx----xxxxx------xxxxxxx---";
 char M10TrimbleParser::insertSpaces[] = "---xx-x-x-x---x---x---x---x-----x-x-----------x---x--x--x-----xx-x-x-x-xx-x-x-x-x----x---x-x-x----xxxx-x-------------x";
 
 M10TrimbleParser::M10TrimbleParser() {
@@ -33,7 +32,7 @@ M10TrimbleParser::M10TrimbleParser() {
 M10TrimbleParser::~M10TrimbleParser() {
 }
 
-void M10TrimbleParser::changeData(std::array<unsigned char, DATA_LENGTH> data, bool good) {
+void M10TrimbleParser::changeData(const std::array<unsigned char, DATA_LENGTH>& data, bool good) {
     M10GeneralParser::changeData(data, good);
 
     int i;
@@ -152,6 +151,11 @@ int M10TrimbleParser::getSatellites() {
     return sats;
 }
 
+int M10TrimbleParser::getUtcOffset() {
+    // GPS-UTC leap seconds
+    return frame_bytes[0x1F];
+}
+
 double M10TrimbleParser::getVerticalSpeed() {
     int i;
     unsigned byte;
@@ -313,11 +317,11 @@ double M10TrimbleParser::getBatteryLevel() {
     return (double)batLvl/1000.*6.62;
 }
 
-std::string M10TrimbleParser::getSerialNumber() {
+const char* M10TrimbleParser::getSerialNumber() {
     int i;
     unsigned byte;
     unsigned short sn_bytes[5];
-    char SN[18];
+    char *SN = serialNumber;
 
     for (i = 0; i < 17; i++)
         SN[i] = ' ';
@@ -348,7 +352,7 @@ std::string M10TrimbleParser::getSerialNumber() {
     return SN;
 }
 
-std::string M10TrimbleParser::getdxlSerialNumber() {
+const char* M10TrimbleParser::getdxlSerialNumber() {
     int i;
     unsigned byte;
     unsigned short sn_bytes[5];
@@ -360,7 +364,7 @@ std::string M10TrimbleParser::getdxlSerialNumber() {
 
     // The way used by dxlARPS used for compatibility.
     uint32_t id;
-    char ids[9];
+    char *ids = dxlSerialNumber;
 
     id = (uint32_t) (((uint32_t) ((uint32_t) (uint8_t)
             sn_bytes[4] + 256UL * (uint32_t) (uint8_t)
@@ -384,37 +388,6 @@ std::string M10TrimbleParser::getdxlSerialNumber() {
     return ids;
 }
 
-std::array<unsigned char, DATA_LENGTH> M10TrimbleParser::replaceWithPrevious(std::array<unsigned char, DATA_LENGTH> data) {
-    unsigned short valMax;
-    unsigned short posMax;
-
-    if (!correctCRC) { // Use probabilities
-        int threshold = statValues[0][0x64] / 2; // more than 50%
-        if (threshold > 4) { // Meaning less under 4 values
-            for (int i = 0; i < FRAME_LEN; ++i) {
-                if (similarData[i] == 'x') {
-                    valMax = 0;
-                    posMax = 0;
-                    for (unsigned short k = 0; k < 0xFF + 1; ++k) { // Find maximum
-                        if (statValues[i][k] > valMax) {
-                            valMax = statValues[i][k];
-                            posMax = k;
-                        }
-                    }
-                    data[i] = posMax;
-                }
-            }
-        }
-    } else { // Use correct frame
-        for (int i = 0; i < FRAME_LEN; ++i) {
-            if (similarData[i] == 'x') {
-                data[i] = frame_bytes[i];
-            }
-        }
-    }
-    return data;
-}
-
 void M10TrimbleParser::printFrame() {
     if (dispRaw) {
         for (int i = 0; i < frameLength + 1; ++i) {
@@ -428,7 +401,6 @@ void M10TrimbleParser::printFrame() {
             printf(" [NO]");
         printf("\n");
     } else {
-        setenv("TZ", "", 1); // Set local timezone to UTC
         time_t frame = 0;
         struct tm timeinfo;
 
@@ -440,10 +412,10 @@ void M10TrimbleParser::printFrame() {
         timeinfo.tm_year = getYear() - 1900;
         timeinfo.tm_isdst = 0;
 
-        frame = mktime(&timeinfo);
+        frame = timegm(&timeinfo);
 
         // Aux data tag if the payload lenght is long
-        std::string auxstr = "";
+        const char *auxstr = "";
         if (frame_bytes[0x00] != 0x64) {
             auxstr = "\"aux\": \"not_supported_yet\", ";
         }
@@ -467,8 +439,8 @@ void M10TrimbleParser::printFrame() {
                 "\"battery\": %.2f, "
                 "\"crc\": %d "
                 "}\n",
-                "Trimble", frame, getSerialNumber().c_str(), getdxlSerialNumber().c_str(), getYear(), getMonth(), getDay(), getHours(), getMinutes(), getSeconds(), 
-                auxstr.c_str(), getSatellites(), getLatitude(), getLongitude(),
+                "Trimble", frame, getSerialNumber(), getdxlSerialNumber(), getYear(), getMonth(), getDay(), getHours(), getMinutes(), getSeconds(), 
+                auxstr, getSatellites(), getLatitude(), getLongitude(),
                 getAltitude(), getHorizontalSpeed(), getDirection(), getVerticalSpeed(), getTemperature(), getBatteryLevel(), correctCRC);
     }
     fflush(stdout);
@@ -18,7 +18,7 @@ class M10TrimbleParser : public M10GeneralParser {
 public:
     M10TrimbleParser();
     virtual ~M10TrimbleParser();
-    virtual void changeData(std::array<unsigned char, DATA_LENGTH> data, bool good);
+    virtual void changeData(const std::array<unsigned char, DATA_LENGTH>& data, bool good);
     virtual double getLatitude();
     virtual double getLongitude();
     virtual double getAltitude();
@@ -36,10 +36,10 @@ public:
     virtual double getHumidity();
     virtual double getDp();
     virtual double getBatteryLevel();
-    virtual std::string getSerialNumber();
-    virtual std::string getdxlSerialNumber();
+    virtual int getUtcOffset();
+    virtual const char* getSerialNumber();
+    virtual const char* getdxlSerialNumber();
     
-    virtual std::array<unsigned char, DATA_LENGTH> replaceWithPrevious(std::array<unsigned char, DATA_LENGTH> data);
     
     void printFrame();
 private:
@@ -51,7 +51,6 @@ private:
     int month;
     int day;
     
-    static char similarData[];
     static char insertSpaces[];
 };
 
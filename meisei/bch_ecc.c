@@ -56,6 +56,11 @@ int rs_decode(ui8_t cw[], ui8_t *err_pos, ui8_t *err_val);
 int rs_decode_ErrEra(ui8_t cw[], int nera, ui8_t era_pos[], ui8_t *err_pos, ui8_t *err_val);
 int rs_decode_bch_gf2t2(ui8_t cw[], ui8_t *err_pos, ui8_t *err_val);
 
+int bch63_init(void);
+int bch63_encode(ui64_t *cw);
+int bch63_decode(ui64_t *cw, ui8_t *err_pos);
+int bch63_decode_blocks(ui64_t cw[], int n, int errors[]);
+
 // ---
 
 
@@ -1016,3 +1021,87 @@ int rs_decode_bch_gf2t2(ui8_t cw[], ui8_t *err_pos, ui8_t *err_val) {
     return errors;
 }
 
+
+/* --------------------------------------------------------------------------------------------- */
+/*
+ * bin.BCH(63,51), t=2, bit-packed: bit i of ui64_t = coefficient of X^i,
+ * parity in bits 0..11 (systematic), syndrome = cw mod g(X)
+ *   all 1+63+63*62/2 patterns of weight <= 2 have different syndromes,
+ *   so the syndrome table decodes the same as rs_decode_bch_gf2t2().
+ */
+
+#define BCH63_G     0x1539  // g(X)=X^12+X^10+X^8+X^5+X^4+X^3+1
+#define BCH63_NOCORR 0xFFFF
+
+static ui16_t bch63_red[256];   // (k X^12) mod g(X)
+static ui16_t bch63_err[4096];  // syndrome -> pos1 | pos2<<6 | #errors<<12, BCH63_NOCORR
+
+static ui32_t bch63_syndrome(ui64_t cw) {
+    ui32_t r = 0;
+    int k;
+    for (k = 56; k >= 0; k -= 8) {  // r = (r X^8 + byte) mod g
+        r = (((r & 0xF) << 8) | ((cw >> k) & 0xFF)) ^ bch63_red[r >> 4];
+    }
+    return r;
+}
+
+int bch63_init() {
+    ui32_t r, s, s1[63];
+    int i, j, k;
+
+    for (k = 0; k < 256; k++) {
+        r = (ui32_t)k << 12;
+        for (i = 19; i >= 12; i--) {
+            if (r & (1u << i)) r ^= BCH63_G << (i-12);
+        }
+        bch63_red[k] = r;
+    }
+
+    for (s = 0; s < 4096; s++) bch63_err[s] = BCH63_NOCORR;
+    bch63_err[0] = 0;
+    for (i = 0; i < 63; i++) {
+        s1[i] = bch63_syndrome(1ULL << i);
+        bch63_err[s1[i]] = i | (1 << 12);
+    }
+    for (i = 0; i < 63; i++) {
+        for (j = i+1; j < 63; j++) {
+            s = s1[i] ^ s1[j];
+            if (bch63_err[s] != BCH63_NOCORR) return -1;
+            bch63_err[s] = i | (j << 6) | (2 << 12);
+        }
+    }
+
+    return 0;
+}
+
+int bch63_encode(ui64_t *cw) {
+    *cw &= ~0xFFFULL;
+    *cw |= bch63_syndrome(*cw);
+    return 0;
+}
+
+// errors: 0..2 corrected, -1 uncorrectable
+int bch63_decode(ui64_t *cw, ui8_t *err_pos) {
+    ui32_t e = bch63_err[bch63_syndrome(*cw)];
+    int errors;
+
+    if (e == BCH63_NOCORR) return -1;
+
+    errors = e >> 12;
+    if (errors > 0) { err_pos[0] = e & 0x3F;        *cw ^= 1ULL << err_pos[0]; }
+    if (errors > 1) { err_pos[1] = (e >> 6) & 0x3F; *cw ^= 1ULL << err_pos[1]; }
+
+    return errors;
+}
+
+// decode n codewords in place, returns the number of uncorrectable blocks
+int bch63_decode_blocks(ui64_t cw[], int n, int errors[]) {
+    ui8_t err_pos[2];
+    int i, fails = 0;
+
+    for (i = 0; i < n; i++) {
+        errors[i] = bch63_decode(cw+i, err_pos);
+        fails += (errors[i] < 0);
+    }
+    return fails;
+}
@@ -88,6 +88,7 @@ e.g.
 typedef unsigned char  ui8_t;
 typedef unsigned short ui16_t;
 typedef unsigned int   ui32_t;
+typedef unsigned long long ui64_t;
 typedef short i16_t;
 
 typedef struct {
@@ -117,9 +118,8 @@ float baudrate = -1;
 #include "bch_ecc.c"
 
 int   errors;
-ui8_t cw[63+1],  // BCH(63,51), t=2
-      err_pos[4],
-      err_val[4];
+ui64_t cw[6];  // BCH(63,51), t=2
+int   blk_errors[6];
 ui8_t block_err[6];
 int block, check_err;
 
@@ -522,7 +522,7 @@ int main(int argc, char **argv) {
     }
 
     if (option_ecc) {
-        rs_init_BCH64();
+        bch63_init();
     }
 
 
@@ -583,28 +583,32 @@ int main(int argc, char **argv) {
                     biphi_s(frame_rawbits, frame_bits+HEADLEN);
 
                     if (option_ecc) {
+                        // prepare block-codewords
                         for (block = 0; block < 6; block++) {
+                            cw[block] = 0;
+                            for (j = 0; j < 46; j++) cw[block] |= (ui64_t)(frame_bits[HEADLEN + block*46+j] & 1) << (45-j);
+                        }
+
+                        bch63_decode_blocks(cw, 6, blk_errors);
 
-                            // prepare block-codeword
-                            for (j =  0; j < 46; j++) cw[45-j] = frame_bits[HEADLEN + block*46+j];
-                            for (j = 46; j < 63; j++) cw[j] = 0;
+                        for (block = 0; block < 6; block++) {
 
-                            errors = rs_decode_bch_gf2t2(cw, err_pos, err_val);
+                            errors = blk_errors[block];
 
                             // check parity,padding
                             if (errors >= 0) {
                                 check_err = 0;
-                                for (j = 46; j < 63; j++) { if (cw[j] != 0) check_err = 0x1; }
+                                if (cw[block] >> 46) check_err = 0x1;
                                 par = 1;
-                                for (j = 13; j < 13+16; j++) par ^= cw[j];
-                                if (cw[12] != par) check_err |= 0x100;
+                                for (j = 13; j < 13+16; j++) par ^= (cw[block] >> j) & 1;
+                                if (((cw[block] >> 12) & 1) != par) check_err |= 0x100;
                                 par = 1;
-                                for (j = 30; j < 30+16; j++) par ^= cw[j];
-                                if (cw[29] != par) check_err |= 0x10;
+                                for (j = 30; j < 30+16; j++) par ^= (cw[block] >> j) & 1;
+                                if (((cw[block] >> 29) & 1) != par) check_err |= 0x10;
                                 if (check_err) errors = -3;
                             }
                             if (errors >= 0) {
-                                for (j = 0; j < 46; j++) frame_bits[HEADLEN + block*46+j] = cw[45-j];
+                                for (j = 0; j < 46; j++) frame_bits[HEADLEN + block*46+j] = (cw[block] >> (45-j)) & 1;
                             }
 
                             if (errors < 0) block_err[block] = 0xE;
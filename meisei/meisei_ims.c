@@ -75,8 +75,14 @@ dass 1 ist, wenn die Anzahl 1en in den 16 bit davor gerade ist, und sonst 0.
 
 /*
 2 "raw" symbols -> 1 biphase-symbol (bit): 2400 (raw) baud
-ecc: option_b, exact symbol rate; if necessary, adjust --br <baud>
-e.g. -b --br 2398
+ecc: exact symbol rate; if necessary, adjust --br <baud>
+e.g. --br 2398
+*/
+
+/*
+files: meisei_ims.c, bch_ecc.c, ../demod/mod/demod_mod.c, demod_mod.h, dsp_mod.c, dsp_mod.h
+make -C ../demod/mod libdemod.a
+gcc -O3 meisei_ims.c ../demod/mod/libdemod.a -lm -o meisei_ims
 */
 
 
@@ -89,10 +95,21 @@ e.g. -b --br 2398
   #include <io.h>
 #endif
 
-typedef unsigned char  ui8_t;
-typedef unsigned short ui16_t;
-typedef unsigned int   ui32_t;
-typedef short i16_t;
+// optional JSON "version"
+//  (a) set global
+//      gcc -DVERSION_JSN [-I<inc_dir>] ...
+#ifdef VERSION_JSN
+  #include "version_jsn.h"
+#endif
+// or
+//  (b) set local compiler option, e.g.
+//      gcc -DVER_JSN_STR=\"0.0.2\" ...
+
+
+#include "../demod/mod/demod_mod.h"
+#include "../demod/mod/bits_mod.h"
+#include "../demod/mod/fskin_mod.h"
+
 
 typedef struct {
     int frnr;
@@ -105,6 +122,7 @@ typedef struct {
     ui32_t _sn;
     float sn; //  0 mod 16
     float fq; // 15 mod 64
+    int jsn_freq;   // freq/kHz (SDR)
 } gpx_t;
 
 gpx_t gpx;
@@ -112,11 +130,8 @@ gpx_t gpx;
 
 int option_verbose = 0,  // ausfuehrliche Anzeige
     option_raw = 0,      // rohe Frames
-    option_inv = 0,      // invertiert Signal
-    option_res = 0,      // genauere Bitmessung
     option1 = 0,
     option2 = 0,
-    option_b = 0,
     option_ecc = 0,      // BCH(63,51)
     option_jsn = 0,      // JSON output (auto_rx)
     wavloaded = 0;
@@ -129,9 +144,8 @@ float baudrate = -1;
 #include "bch_ecc.c"
 
 int   errors;
-ui8_t cw[63+1],  // BCH(63,51), t=2
-      err_pos[4],
-      err_val[4];
+ui64_t cw[6];  // BCH(63,51), t=2
+int   blk_errors[6];
 ui8_t block_err[6];
 int block, check_err;
 
@@ -139,179 +153,12 @@ int block, check_err;
 
 #define BAUD_RATE 2400  // raw symbol rate; bit=biphase_symbol, bitrate=1200
 
-int sample_rate = 0, bits_sample = 0, channels = 0;
-float samples_per_bit = 0;
-
-int findstr(char *buff, char *str, int pos) {
-    int i;
-    for (i = 0; i < 4; i++) {
-        if (buff[(pos+i)%4] != str[i]) break;
-    }
-    return i;
-}
-
-int read_wav_header(FILE *fp) {
-    char txt[4+1] = "\0\0\0\0";
-    unsigned char dat[4];
-    int byte, p=0;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "RIFF", 4)) return -1;
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    // pos_WAVE = 8L
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "WAVE", 4)) return -1;
-    // pos_fmt = 12L
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "fmt ", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    channels = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    //byte = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    bits_sample = dat[0] + (dat[1] << 8);
-
-    // pos_dat = 36L + info
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "data", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-
-
-    fprintf(stderr, "sample_rate: %d\n", sample_rate);
-    fprintf(stderr, "bits       : %d\n", bits_sample);
-    fprintf(stderr, "channels   : %d\n", channels);
-
-    if ((bits_sample != 8) && (bits_sample != 16)) return -1;
-
-    samples_per_bit = sample_rate/(float)BAUD_RATE;
-
-    fprintf(stderr, "samples/bit: %.2f\n", samples_per_bit);
-
-    return 0;
-}
-
-
-#define EOF_INT  0x1000000
-unsigned long sample_count = 0;
-
-int read_signed_sample(FILE *fp) {  // int = i32_t
-    int byte, i, ret;         //  EOF -> 0x1000000
-
-    for (i = 0; i < channels; i++) {
-                           // i = 0: links bzw. mono
-        byte = fgetc(fp);
-        if (byte == EOF) return EOF_INT;
-        if (i == 0) ret = byte;
-
-        if (bits_sample == 16) {
-            byte = fgetc(fp);
-            if (byte == EOF) return EOF_INT;
-            if (i == 0) ret +=  byte << 8;
-        }
-
-    }
-
-    sample_count++;
-
-    if (bits_sample ==  8) return ret-128;   // 8bit: 00..FF, centerpoint 0x80=128
-    if (bits_sample == 16) return (short)ret;
-
-    return ret;
-}
-
-int par=1, par_alt=1;
-
-int read_bits_fsk(FILE *fp, int *bit, int *len) {
-    int n, sample, y0;
-    float l, x1;
-    static float x0;
-
-    n = 0;
-    do{
-        y0 = sample;
-        sample = read_signed_sample(fp);
-        if (sample == EOF_INT) return EOF;
-        //sample_count++; // in read_signed_sample()
-        par_alt = par;
-        par =  (sample > 0) ? 1 : -1;
-        n++;
-    } while (par*par_alt > 0);
-
-    if (!option_res) l = (float)n / samples_per_bit;
-    else {                                 // genauere Bitlaengen-Messung
-        x1 = sample/(float)(sample-y0);    // hilft bei niedriger sample rate
-        l = (n+x0-x1) / samples_per_bit;   // meist mehr frames (nicht immer)
-        x0 = x1;
-    }
-
-    *len = (int)(l+0.5);
-
-    if (!option_inv) *bit = (1+par_alt)/2;  // oben 1, unten -1
-    else             *bit = (1-par_alt)/2;  // sdr#<rev1381?, invers: unten 1, oben -1
-
-    /* Y-offset ? */
-
-    return 0;
-}
-
-int bitstart = 0;
-double bitgrenze = 0;
-/*unsigned*/ long scount = 0;
-int read_rawbit(FILE *fp, int *bit) {
-    int sample;
-    int sum;
-
-    sum = 0;
-
-    if (bitstart) {
-        scount = 0;    // eigentlich scount = 1
-        bitgrenze = 0; //   oder bitgrenze = -1
-        bitstart = 0;
-    }
-    bitgrenze += samples_per_bit;
-
-    do {
-        sample = read_signed_sample(fp);
-        if (sample == EOF_INT) return EOF;
-        //sample_count++; // in read_signed_sample()
-        //par =  (sample >= 0) ? 1 : -1;    // 8bit: 0..127,128..255 (-128..-1,0..127)
-        sum += sample;
-        scount++;
-    } while (scount < bitgrenze);  // n < samples_per_bit
-
-    if (sum >= 0) *bit = 1;
-    else          *bit = 0;
-
-    if (option_inv) *bit ^= 1;
-
-    return 0;
-}
-
-/* ------------------------------------------------------------------------------------ */
-
 #define BITFRAME_LEN    1200
 #define RAWBITFRAME_LEN (BITFRAME_LEN*2)
 
-char frame_rawbits[RAWBITFRAME_LEN+10];  // braucht eigentlich nur 1/2 (vormals 1/4)
-ui8_t frame_bits[BITFRAME_LEN+10];
-ui8_t *subframe_bits;
+ui64_t frame_rawbits[RAWBITFRAME_LEN/64+2];  // packed raw chips; braucht eigentlich nur 1/2 (vormals 1/4)
+ui8_t frame_bits[BITFRAME_LEN/8+8];          // packed bits
+int subframe_pos;
 
 #define HEADLEN 24
 #define RAWHEADLEN (2*HEADLEN)
@@ -325,89 +172,6 @@ char header0xFB6230[] =                             // 0xFB6230 =
 char header0xFB6230bits[] = "111110110110001000110000";
                                                     // 0x049DCE ^ 0xFB6230 = 0xFFFFFE
 
-char buf[RAWHEADLEN+1] = "xxxxxxxxxx\0";
-int  bufpos = 0;
-
-/* -------------------------------------------------------------------------- */
-
-void inc_bufpos() {
-  bufpos = (bufpos+1) % RAWHEADLEN;
-}
-
-
-char cb_inv(char c) {
-    if (c == '0') return '1';
-    if (c == '1') return '0';
-    return c;
-}
-
-int compare_subheader() {
-    int i, j;
-
-    i = 0;
-    j = bufpos;
-    while (i < RAWHEADLEN) {
-        if (j < 0) j = RAWHEADLEN-1;
-        if (buf[j] != header0x049DCE[RAWHEADLEN-1-i]) break;
-        j--;
-        i++;
-    }
-    if (i == RAWHEADLEN) return 1;
-
-    i = 0;
-    j = bufpos;
-    while (i < RAWHEADLEN) {
-        if (j < 0) j = RAWHEADLEN-1;
-        if (buf[j] != cb_inv(header0x049DCE[RAWHEADLEN-1-i])) break;
-        j--;
-        i++;
-    }
-    if (i == RAWHEADLEN) return 3;
-
-    i = 0;
-    j = bufpos;
-    while (i < RAWHEADLEN) {
-        if (j < 0) j = RAWHEADLEN-1;
-        if (buf[j] != header0xFB6230[RAWHEADLEN-1-i]) break;
-        j--;
-        i++;
-    }
-    if (i == RAWHEADLEN) return 2;
-
-    i = 0;
-    j = bufpos;
-    while (i < RAWHEADLEN) {
-        if (j < 0) j = RAWHEADLEN-1;
-        if (buf[j] != cb_inv(header0xFB6230[RAWHEADLEN-1-i])) break;
-        j--;
-        i++;
-    }
-    if (i == RAWHEADLEN) return 4;
-
-    return 0;
-
-}
-
-
-/* -------------------------------------------------------------------------- */
-
-int biphi_s(char* frame_rawbits, ui8_t *frame_bits) {
-    int j = 0;
-    int byt;
-
-    j = 0;
-    while ((byt = frame_rawbits[2*j]) && frame_rawbits[2*j+1]) {
-        if ((byt < 0x30) || (byt > 0x31)) break;
-
-        if ( frame_rawbits[2*j] == frame_rawbits[2*j+1] ) { byt = 1; }
-        else                                              { byt = 0; }
-
-        frame_bits[j] = byt;
-        j++;
-    }
-    frame_bits[j] = 0;
-    return j;
-}
 
 /* -------------------------------------------------------------------------- */
 /*
@@ -425,18 +189,9 @@ ui32_t bitstr2val(char *bits, int len) {
     return val;
 }
 */
-ui32_t bits2val(ui8_t bits[], int len) {
-    int j;
-    ui8_t bit;
-    ui32_t val;
+ui32_t bits2val(ui8_t *bits, int pos, int len) {  // big endian
     if ((len < 0) || (len > 32)) return -1;
-    val = 0;
-    for (j = 0; j < len; j++) {
-                bit = bits[j];
-                val |= (bit << (len-1-j)); // big endian
-                //val |= (bit << j);      // little endian
-    }
-    return val;
+    return bits_get(bits, pos, len);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -444,14 +199,26 @@ ui32_t bits2val(ui8_t bits[], int len) {
 
 int main(int argc, char **argv) {
 
-    FILE *fp;
-    char *fpname;
-    int i, j;
+    int option_min = 0;
+    int option_iq = 0;
+    int option_iqdc = 0;
+    int option_lp = 0;
+    int option_dc = 0;
+    int option_noLUT = 0;
+    int option_softin = 0;
+    int option_pcmraw = 0;
+    int sel_wavch = 0;     // audio channel: left
+    int cfreq = -1;
+
+    FILE *fp = NULL;
+    char *fpname = NULL;
+    int i, j, k;
     int bit_count = 0,
         header_found = 0,
-        bit, len;
+        bit, bitQ;
     int subframe = 0;
     int err_frm = 0;
+    int par;
 
     int counter;
     ui32_t val;
@@ -469,6 +236,21 @@ int main(int argc, char **argv) {
     float sn = -1;
     float fq = -1;
 
+    float thres = 0.7;
+    float _mv = 0.0;
+
+    float lpIQ_bw = 16e3;
+
+    int symlen = 1;
+    int bitofs = 0;
+    int shift = 0;
+    hsbit_t hsbit, hsbit1;
+
+    pcm_t pcm = {0};
+    dsp_t dsp = {0};  //memset(&dsp, 0, sizeof(dsp));
+
+    hdb_t hdb = {0};
+
 
 #ifdef CYGWIN
     _setmode(fileno(stdin), _O_BINARY);  // _setmode(_fileno(stdin), _O_BINARY);
@@ -486,12 +268,17 @@ int main(int argc, char **argv) {
             fprintf(stderr, "  options:\n");
             //fprintf(stderr, "       -v, --verbose\n");
             fprintf(stderr, "       -r, --raw\n");
+            fprintf(stderr, "       --ecc, --json\n");
+            fprintf(stderr, "       --softin     (float32 soft symbols)\n");
+            fprintf(stderr, "       --iq0,2,3    (IQ data)\n");
+            fprintf(stderr, "       --IQ <fq>    (baseband IQ at fq)\n");
+            fprintf(stderr, "       --lpIQ, --lpbw <kHz>, --lpFM, --dc\n");
             return 0;
         }
         else if ( (strcmp(*argv, "-r") == 0) ) { option_raw = 1; }
-        else if   (strcmp(*argv, "--res") == 0) { option_res = 1; }
+        else if   (strcmp(*argv, "--res") == 0) { }  // bit integration: always (read_softbit2p)
         else if ( (strcmp(*argv, "-i") == 0) || (strcmp(*argv, "--invert") == 0) ) {
-            option_inv = 1;  // nicht noetig
+            // nicht noetig (biphase-S)
         }
         else if ( (strcmp(*argv, "-2") == 0) ) {
             option2 = 1;
@@ -499,7 +286,7 @@ int main(int argc, char **argv) {
         else if ( (strcmp(*argv, "-1") == 0) ) {
             option1 = 1;
         }
-        else if   (strcmp(*argv, "-b") == 0) { option_b = 1; }
+        else if   (strcmp(*argv, "-b") == 0) { }  // bit integration: always (read_softbit2p)
         else if   (strcmp(*argv, "--ecc") == 0) { option_ecc = 1; }
         else if ( (strcmp(*argv, "-v") == 0) ) { option_verbose = 1; }
         else if ( (strcmp(*argv, "--br") == 0) ) {
@@ -510,10 +297,86 @@ int main(int argc, char **argv) {
             }
             else return -1;
         }
+        else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
+        else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
+        else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
+        else if   (strcmp(*argv, "--ths") == 0) {
+            ++argv;
+            if (*argv) {
+                thres = atof(*argv);
+            }
+            else return -1;
+        }
+        else if ( (strcmp(*argv, "-d") == 0) ) {
+            ++argv;
+            if (*argv) {
+                shift = atoi(*argv);
+                if (shift >  4) shift =  4;
+                if (shift < -4) shift = -4;
+            }
+            else return -1;
+        }
+        else if   (strcmp(*argv, "--iq0") == 0) { option_iq = 1; }  // differential/FM-demod
+        else if   (strcmp(*argv, "--iq2") == 0) { option_iq = 2; }
+        else if   (strcmp(*argv, "--iq3") == 0) { option_iq = 3; }  // iq2==iq3
+        else if   (strcmp(*argv, "--iqdc") == 0) { option_iqdc = 1; }  // iq-dc removal (iq0,2,3)
+        else if   (strcmp(*argv, "--IQ") == 0) { // fq baseband -> IF (rotate from and decimate)
+            double fq = 0.0;                     // --IQ <fq> , -0.5 < fq < 0.5
+            ++argv;
+            if (*argv) fq = atof(*argv);
+            else return -1;
+            if (fq < -0.5) fq = -0.5;
+            if (fq >  0.5) fq =  0.5;
+            dsp.xlt_fq = -fq; // S(t) -> S(t)*exp(-f*2pi*I*t)
+            option_iq = 5;
+        }
+        else if   (strcmp(*argv, "--lpIQ") == 0) { option_lp |= LP_IQ; }  // IQ/IF lowpass
+        else if   (strcmp(*argv, "--lpbw") == 0) {  // IQ lowpass BW / kHz
+            double bw = 0.0;
+            ++argv;
+            if (*argv) bw = atof(*argv);
+            else return -1;
+            if (bw > 4.6 && bw < 32.0) lpIQ_bw = bw*1e3;
+            option_lp |= LP_IQ;
+        }
+        else if   (strcmp(*argv, "--lpFM") == 0) { option_lp |= LP_FM; }  // FM lowpass
+        else if   (strcmp(*argv, "--dc") == 0) { option_dc = 1; }
+        else if   (strcmp(*argv, "--noLUT") == 0) { option_noLUT = 1; }
+        else if   (strcmp(*argv, "--min") == 0) {
+            option_min = 1;
+        }
         else if   (strcmp(*argv, "--json") == 0) {
             option_jsn = 1;
             option_ecc = 1;
         }
+        else if   (strcmp(*argv, "--jsn_cfq") == 0) {
+            int frq = -1;  // center frequency / Hz
+            ++argv;
+            if (*argv) frq = atoi(*argv); else return -1;
+            if (frq < 300000000) frq = -1;
+            cfreq = frq;
+        }
+        else if (strcmp(*argv, "-") == 0) {
+            int sample_rate = 0, bits_sample = 0, channels = 0;
+            ++argv;
+            if (*argv) sample_rate = atoi(*argv); else return -1;
+            ++argv;
+            if (*argv) bits_sample = atoi(*argv); else return -1;
+            channels = 2;
+            if (sample_rate < 1 || (bits_sample != 8 && bits_sample != 16 && bits_sample != 32)) {
+                fprintf(stderr, "- <sr> <bs>\n");
+                return -1;
+            }
+            pcm.sr  = sample_rate;
+            pcm.bps = bits_sample;
+            pcm.nch = channels;
+            option_pcmraw = 1;
+        }
         else {
             if (option1 == 1 && option2 == 1) goto help_out;
             if (!option_raw && option1 == 0 && option2 == 0) option2 = 1;
@@ -528,359 +391,449 @@ int main(int argc, char **argv) {
     }
     if (!wavloaded) fp = stdin;
 
+    if (option_iq == 5 && option_dc) option_lp |= LP_FM;
+
+    // LUT faster for decM, however frequency correction after decimation
+    // LUT recommended if decM > 2
+    //
+    if (option_noLUT && option_iq == 5) dsp.opt_nolut = 1; else dsp.opt_nolut = 0;
+
+
+    if (!option_softin) {
+
+        if (option_iq == 0 && option_pcmraw) {
+            fclose(fp);
+            fprintf(stderr, "error: raw data not IQ\n");
+            return -1;
+        }
+        if (option_iq) sel_wavch = 0;
+
+        pcm.sel_ch = sel_wavch;
+        if (option_pcmraw == 0) {
+            k = read_wav_header(&pcm, fp);
+            if ( k < 0 ) {
+                fclose(fp);
+                fprintf(stderr, "error: wav header\n");
+                return -1;
+            }
+        }
+
+        if (cfreq > 0) {
+            int fq_kHz = (cfreq - dsp.xlt_fq*pcm.sr + 500)/1e3;
+            gpx.jsn_freq = fq_kHz;
+        }
+
+        symlen = 1;
+
+        // init dsp
+        //
+        dsp.fp = fp;
+        dsp.sr = pcm.sr;
+        dsp.bps = pcm.bps;
+        dsp.nch = pcm.nch;
+        dsp.ch = pcm.sel_ch;
+        dsp.br = (float)BAUD_RATE;
+        dsp.sps = (float)dsp.sr/dsp.br;
+        dsp.symlen = symlen;
+        dsp.symhd = 1;
+        dsp._spb = dsp.sps*symlen;
+        dsp.hdr = header0x049DCE;
+        dsp.hdrlen = strlen(header0x049DCE);
+        dsp.BT = 1.2; // bw/time (ISI) // 1.0..2.0
+        dsp.h = 2.4;  // 2.8
+        dsp.opt_iq = option_iq;
+        dsp.opt_iqdc = option_iqdc;
+        dsp.opt_lp = option_lp;
+        dsp.lpIQ_bw = lpIQ_bw; //16e3; // IF lowpass bandwidth
+        dsp.lpFM_bw = 4e3; // FM audio lowpass
+        dsp.opt_dc = option_dc;
+        dsp.opt_IFmin = option_min;
+
+        if ( dsp.sps < 8 ) {
+            fprintf(stderr, "note: sample rate low (%.1f sps)\n", dsp.sps);
+        }
+
+        if (baudrate > 0) {
+            dsp.br = (float)baudrate; // default baudrate: 2400
+            dsp.sps = (float)dsp.sr/dsp.br;
+            fprintf(stderr, "sps corr: %.4f\n", dsp.sps);
+        }
 
-    i = read_wav_header(fp);
-    if (i) {
-        fclose(fp);
-        return -1;
+
+        k = init_buffers(&dsp);
+        if ( k < 0 ) {
+            fprintf(stderr, "error: init buffers\n");
+            return -1;
+        }
+
+        bitofs += shift;
     }
-    if (baudrate > 0) {
-        samples_per_bit = sample_rate/baudrate; // default baudrate: 2400
-        fprintf(stderr, "sps corr: %.4f\n", samples_per_bit);
+    else {
+        if (cfreq > 0) gpx.jsn_freq = (cfreq+500)/1000;
+
+        if (option_softin) f32soft_br(baudrate > 0 ? baudrate : BAUD_RATE);  // check fsk_demod -F / --fsk symbol rate
+
+        // init circular header bit buffer
+        hdb.hdr = header0x049DCE;
+        hdb.len = strlen(header0x049DCE);
+        hdb.bufpos = -1;
+        hdb.buf = NULL;
+        hdb.ths = 0.8; // caution/test false positive
+        hdb.sbuf = calloc(hdb.len, sizeof(float));
+        if (hdb.sbuf == NULL) {
+            fprintf(stderr, "error: malloc\n");
+            return -1;
+        }
     }
 
     if (option_ecc) {
-        rs_init_BCH64();
+        bch63_init();
     }
 
 
-    bufpos = 0;
-    bit_count = 0;
-
-    while (!read_bits_fsk(fp, &bit, &len)) {
-
-        if (len == 0) { // reset_frame();
-/*
-            if (byte_count > FRAME_LEN-20) {
-                print_frame(byte_count);
-                bit_count = 0;
-                byte_count = FRAMESTART;
-                header_found = 0;
-            }
-*/
-            //inc_bufpos();
-            //buf[bufpos] = 'x';
-            continue;   // ...
+    while ( 1 )
+    {
+        if (option_softin) {
+            header_found = find_softbinhead(fp, &hdb, &_mv, option_softin == 2);
+        }
+        else {                                                              // FM-audio:
+            header_found = find_header(&dsp, thres, 1, bitofs, dsp.opt_dc); // optional 2nd pass: dc=0
+            _mv = dsp.mv;
         }
 
-        for (i = 0; i < len; i++) {
+        if (header_found == EOF) break;
 
-            inc_bufpos();
-            buf[bufpos] = 0x30 + bit;  // Ascii
+        // biphase-S: polarity irrelevant
+        if (header_found) {
 
-            if (!header_found) {
-                header_found = compare_subheader();
+            header_found = 1; // header0x049DCE
+            bits_put(frame_bits, 0, HEADLEN, 0x049DCE);  // header0x049DCEbits
 
-/*              //type 1: detect GPS position in FB6230 first
-                if ( header_found % 2 == 0 && !option2     //header0xFB6230
-                  || header_found % 2 == 1 &&  option2 ) { //header0x049DCE
-*/
-                if (header_found % 2 == 1) { //header0x049DCE
-                    bit_count = 0;
-                    for (j = 0; j < HEADLEN; j++) {
-                        if (header_found % 2 == 1) frame_bits[j] = header0x049DCEbits[j] - 0x30;
-                        else                       frame_bits[j] = header0xFB6230bits[j] - 0x30;
-                    }
+            bit_count = 0;
+            while (bit_count < RAWBITFRAME_LEN/2-RAWHEADLEN) {  // 2*600-48
+                if (option_softin) {
+                    float s = 0.0;
+                    bitQ = f32soft_read(fp, &s, option_softin == 2);
+                    if (bitQ != EOF) bit = (s>=0.0);
                 }
-                else header_found = 0;
+                else {
+                    float bl = -1;
+                    if (option_iq > 2) bl = 2.0;
+                    bitQ = read_softbit2p(&dsp, &hsbit, 0, bitofs, bit_count, bl, 0, &hsbit1); // symlen=1
+                    bit = hsbit.hb;
+                }
+                if (bitQ == EOF) break;
 
-            }
-            else {
-                frame_rawbits[bit_count] = 0x30 + bit;
+                chips_put(frame_rawbits, bit_count, bit);
                 bit_count++;
+            }
 
-                if (option_b) {
-                    while (++i < len) {
-                        frame_rawbits[bit_count] = 0x30 + bit;
-                        bit_count++;
-                    }
-                    bitstart = 1;
-                    while (bit_count < RAWBITFRAME_LEN/2-RAWHEADLEN) {  // 2*600-48
-                        if (read_rawbit(fp, &bit) == EOF) break;
-                        frame_rawbits[bit_count] = 0x30 + bit;
-                        bit_count++;
-                    }
-                }
+            if (bit_count >= RAWBITFRAME_LEN/2-RAWHEADLEN) {  // 2*600-48
+                biphase_s_dec(frame_rawbits, bit_count, frame_bits, HEADLEN);  // biphase-S: 64 chips -> 32 bits
 
-                if (bit_count >= RAWBITFRAME_LEN/2-RAWHEADLEN) {  // 2*600-48
-                    frame_rawbits[bit_count] = '\0';
+                err_frm = 0;
+                for (subframe = 0; subframe < 2; subframe++)
+                {                                                       // option2:
+                    subframe_pos = 0;                                   // subframe 0: 049DCE
+                    if (subframe > 0) subframe_pos += BITFRAME_LEN/4;   // subframe 1: FB6230
 
-                    biphi_s(frame_rawbits, frame_bits+HEADLEN);
+                    if (option_ecc) {
+                        // prepare block-codewords
+                        for (block = 0; block < 6; block++) {
+                            cw[block] = bits_get(frame_bits, subframe_pos+HEADLEN + block*46, 46);
+                        }
 
-                    err_frm = 0;
+                        bch63_decode_blocks(cw, 6, blk_errors);
 
-                    for (subframe = 0; subframe < 2; subframe++)
-                    {                                                       // option2:
-                        subframe_bits = frame_bits;                         // subframe 0: 049DCE
-                        if (subframe > 0) subframe_bits += BITFRAME_LEN/4;  // subframe 1: FB6230
+                        for (block = 0; block < 6; block++) {
 
-                        if (option_ecc) {
-                            for (block = 0; block < 6; block++) {
+                            errors = blk_errors[block];
 
-                                // prepare block-codeword
-                                for (j =  0; j < 46; j++) cw[45-j] = subframe_bits[HEADLEN + block*46+j];
-                                for (j = 46; j < 63; j++) cw[j] = 0;
+                            // check parity,padding
+                            if (errors >= 0) {
+                                check_err = 0;
+                                if (cw[block] >> 46) check_err = 0x1;
+                                par = 1;
+                                for (j = 13; j < 13+16; j++) par ^= (cw[block] >> j) & 1;
+                                if (((cw[block] >> 12) & 1) != par) check_err |= 0x100;
+                                par = 1;
+                                for (j = 30; j < 30+16; j++) par ^= (cw[block] >> j) & 1;
+                                if (((cw[block] >> 29) & 1) != par) check_err |= 0x10;
+                                if (check_err) errors = -3;
+                            }
+                            if (errors >= 0) // errors > 0
+                            {
+                                bits_put(frame_bits, subframe_pos+HEADLEN + block*46, 46, cw[block]);
+                            }
 
-                                errors = rs_decode_bch_gf2t2(cw, err_pos, err_val);
+                            if (errors < 0) {
+                                if (errors == -3) block_err[block] = 0xF;
+                                else              block_err[block] = 0xE;
+                                err_frm += 1;
+                            }
+                            else  block_err[block] = errors;
 
-                                // check parity,padding
-                                if (errors >= 0) {
-                                    check_err = 0;
-                                    for (j = 46; j < 63; j++) { if (cw[j] != 0) check_err = 0x1; }
-                                    par = 1;
-                                    for (j = 13; j < 13+16; j++) par ^= cw[j];
-                                    if (cw[12] != par) check_err |= 0x100;
-                                    par = 1;
-                                    for (j = 30; j < 30+16; j++) par ^= cw[j];
-                                    if (cw[29] != par) check_err |= 0x10;
-                                    if (check_err) errors = -3;
-                                }
-                                if (errors >= 0) // errors > 0
-                                {
-                                    for (j = 0; j < 46; j++) subframe_bits[HEADLEN + block*46+j] = cw[45-j];
-                                }
+                        }
+                    }
 
-                                if (errors < 0) {
-                                    if (errors == -3) block_err[block] = 0xF;
-                                    else              block_err[block] = 0xE;
-                                    err_frm += 1;
-                                }
-                                else  block_err[block] = errors;
+                    if (!option2 && !option_raw) {
+            jmpRS11:
+                        if (header_found % 2 == 1)
+                        {
+                            val = bits2val(frame_bits, subframe_pos+HEADLEN, 16);
+                            counter = val & 0xFFFF;
+                            printf("[%d] ", counter);
+
+                            // 0x30yy, 0x31yy
+                            val = bits2val(frame_bits, subframe_pos+HEADLEN+46*3+17, 16);
+                            if ( (val & 0xFF) >= 0xC0 && err_frm == 0) {
+                                option2 = 1;
+                                printf("\n");
+                                goto jmpIMS;
+                            }
 
+                            if (counter % 2 == 1) {
+                                t2 = bits2val(frame_bits, subframe_pos+HEADLEN+5*46  , 8);  // LSB
+                                t1 = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+8, 8);
+                                ms = (t1 << 8) | t2;
+                                std = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+17, 8);
+                                min = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+25, 8);
+                                printf("  ");
+                                printf("%02d:%02d:%06.3f ", std, min, (double)ms/1000.0);
+                                printf("\n");
                             }
                         }
 
-                        if (!option2 && !option_raw) {
-                jmpRS11:
-                            if (header_found % 2 == 1)
-                            {
-                                val = bits2val(subframe_bits+HEADLEN, 16);
-                                counter = val & 0xFFFF;
-                                printf("[%d] ", counter);
-
-                                // 0x30yy, 0x31yy
-                                val = bits2val(subframe_bits+HEADLEN+46*3+17, 16);
-                                if ( (val & 0xFF) >= 0xC0 && err_frm == 0) {
-                                    option2 = 1;
-                                    printf("\n");
-                                    goto jmpIMS;
-                                }
-
-                                if (counter % 2 == 1) {
-                                    t2 = bits2val(subframe_bits+HEADLEN+5*46  , 8);  // LSB
-                                    t1 = bits2val(subframe_bits+HEADLEN+5*46+8, 8);
-                                    ms = (t1 << 8) | t2;
-                                    std = bits2val(subframe_bits+HEADLEN+5*46+17, 8);
-                                    min = bits2val(subframe_bits+HEADLEN+5*46+25, 8);
-                                    printf("  ");
-                                    printf("%02d:%02d:%06.3f ", std, min, (double)ms/1000.0);
-                                    printf("\n");
-                                }
+                        if (header_found % 2 == 0)
+                        {
+                            if ((counter % 2 == 0)) {
+                                //offset=24+16+1;
+
+                                lat1 = bits2val(frame_bits, subframe_pos+HEADLEN+46*0+17, 16);
+                                lat2 = bits2val(frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                                lon1 = bits2val(frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
+                                lon2 = bits2val(frame_bits, subframe_pos+HEADLEN+46*2   , 16);
+                                alt1 = bits2val(frame_bits, subframe_pos+HEADLEN+46*2+17, 16);
+                                alt2 = bits2val(frame_bits, subframe_pos+HEADLEN+46*3   , 16);
+
+                                lat = (lat1 << 16) | lat2;
+                                lon = (lon1 << 16) | lon2;
+                                alt = (alt1 << 16) | alt2;
+                                //printf("%08X %08X %08X :  ", lat, lon, alt);
+                                printf("  ");
+                                printf("lat: %.5f  lon: %.5f  alt: %.2f", (double)lat/1e7, (double)lon/1e7, (double)alt/1e2);
+                                printf("  ");
+
+                                vH = bits2val(frame_bits, subframe_pos+HEADLEN+46*3+17, 16);
+                                vD = bits2val(frame_bits, subframe_pos+HEADLEN+46*4   , 16);
+                                vU = bits2val(frame_bits, subframe_pos+HEADLEN+46*4+17, 16);
+                                velH = (double)vH/1e2;
+                                velD = (double)vD/1e2;
+                                velU = (double)vU/1e2;
+                                printf(" vH: %.2fm/s  D: %.1f  vV: %.2fm/s", velH, velD, velU);
+                                printf("  ");
+
+                                jj = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+ 8, 8) + 0x0700;
+                                mm = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+17, 8);
+                                tt = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+25, 8);
+                                printf(" %4d-%02d-%02d ", jj, mm, tt);
+                                printf("\n");
                             }
+                        }
 
-                            if (header_found % 2 == 0)
-                            {
-                                if ((counter % 2 == 0)) {
-                                    //offset=24+16+1;
-
-                                    lat1 = bits2val(subframe_bits+HEADLEN+46*0+17, 16);
-                                    lat2 = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                                    lon1 = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
-                                    lon2 = bits2val(subframe_bits+HEADLEN+46*2   , 16);
-                                    alt1 = bits2val(subframe_bits+HEADLEN+46*2+17, 16);
-                                    alt2 = bits2val(subframe_bits+HEADLEN+46*3   , 16);
-
-                                    lat = (lat1 << 16) | lat2;
-                                    lon = (lon1 << 16) | lon2;
-                                    alt = (alt1 << 16) | alt2;
-                                    //printf("%08X %08X %08X :  ", lat, lon, alt);
-                                    printf("  ");
-                                    printf("lat: %.5f  lon: %.5f  alt: %.2f", (double)lat/1e7, (double)lon/1e7, (double)alt/1e2);
-                                    printf("  ");
-
-                                    vH = bits2val(subframe_bits+HEADLEN+46*3+17, 16);
-                                    vD = bits2val(subframe_bits+HEADLEN+46*4   , 16);
-                                    vU = bits2val(subframe_bits+HEADLEN+46*4+17, 16);
-                                    velH = (double)vH/1e2;
-                                    velD = (double)vD/1e2;
-                                    velU = (double)vU/1e2;
-                                    printf(" vH: %.2fm/s  D: %.1f  vV: %.2fm/s", velH, velD, velU);
-                                    printf("  ");
-
-                                    jj = bits2val(subframe_bits+HEADLEN+5*46+ 8, 8) + 0x0700;
-                                    mm = bits2val(subframe_bits+HEADLEN+5*46+17, 8);
-                                    tt = bits2val(subframe_bits+HEADLEN+5*46+25, 8);
-                                    printf(" %4d-%02d-%02d ", jj, mm, tt);
-                                    printf("\n");
-                                }
+                    }
+                    else if (option2 && !option_raw) { // iMS-100
+            jmpIMS:
+                        if (header_found % 2 == 1) { // 049DCE
+                            ui16_t w16[2];
+                            ui32_t w32;
+                            float *fcfg = (float *)&w32;
+
+                            // 0x30C1, 0x31C1
+                            val = bits2val(frame_bits, subframe_pos+HEADLEN+46*3+17, 16);
+                            if ( (val & 0xFF) < 0xC0 && err_frm == 0) {
+                                option2 = 0;
+                                printf("\n");
+                                goto jmpRS11;
                             }
 
-                        }
-                        else if (option2 && !option_raw) { // iMS-100
-                jmpIMS:
-                            if (header_found % 2 == 1) { // 049DCE
-                                ui16_t w16[2];
-                                ui32_t w32;
-                                float *fcfg = (float *)&w32;
-
-                                // 0x30C1, 0x31C1
-                                val = bits2val(subframe_bits+HEADLEN+46*3+17, 16);
-                                if ( (val & 0xFF) < 0xC0 && err_frm == 0) {
-                                    option2 = 0;
-                                    printf("\n");
-                                    goto jmpRS11;
-                                }
+                            val = bits2val(frame_bits, subframe_pos+HEADLEN, 16);
+                            counter = val & 0xFFFF;
 
-                                val = bits2val(subframe_bits+HEADLEN, 16);
-                                counter = val & 0xFFFF;
+                            if (counter % 2 == 0) printf("[%d] ", counter);
 
-                                if (counter % 2 == 0) printf("[%d] ", counter);
+                            w16[0] = bits2val(frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                            w16[1] = bits2val(frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
+                            w32 = (w16[1]<<16) | w16[0];
 
-                                w16[0] = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                                w16[1] = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
-                                w32 = (w16[1]<<16) | w16[0];
+                            if (err_frm == 0) // oder kleineren subblock pruefen
+                            {
+                                gpx.cfg[counter%64] = *fcfg;
 
-                                if (err_frm == 0) // oder kleineren subblock pruefen
-                                {
-                                    gpx.cfg[counter%64] = *fcfg;
+                                // (main?) SN
+                                if (counter % 0x10 == 0) { sn = *fcfg; gpx.sn = sn; gpx._sn = w32; }
+                                // freq
+                                if (counter % 64 == 15) { fq = 400e3+(*fcfg)*100.0; gpx.fq = fq; }
+                            }
 
-                                    // (main?) SN
-                                    if (counter % 0x10 == 0) { sn = *fcfg; gpx.sn = sn; gpx._sn = w32; }
-                                    // freq
-                                    if (counter % 64 == 15) { fq = 400e3+(*fcfg)*100.0; gpx.fq = fq; }
-                                }
+                            if (counter % 2 == 0) {
+                                gpx.frnr = counter;
+                                t1 = bits2val(frame_bits, subframe_pos+HEADLEN+5*46  , 8);  // MSB
+                                t2 = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+8, 8);
+                                ms = (t1 << 8) | t2;
+                                std = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+17, 8);
+                                min = bits2val(frame_bits, subframe_pos+HEADLEN+5*46+25, 8);
+                                gpx.sek = (float)ms/1000.0;
+                                gpx.std = std;
+                                gpx.min = min;
+                                printf("  ");
+                                printf("%02d:%02d:%06.3f ", gpx.std, gpx.min, gpx.sek);
+                                printf("  ");
+                            }
+                        }
 
-                                if (counter % 2 == 0) {
-                                    gpx.frnr = counter;
-                                    t1 = bits2val(subframe_bits+HEADLEN+5*46  , 8);  // MSB
-                                    t2 = bits2val(subframe_bits+HEADLEN+5*46+8, 8);
-                                    ms = (t1 << 8) | t2;
-                                    std = bits2val(subframe_bits+HEADLEN+5*46+17, 8);
-                                    min = bits2val(subframe_bits+HEADLEN+5*46+25, 8);
-                                    gpx.sek = (float)ms/1000.0;
-                                    gpx.std = std;
-                                    gpx.min = min;
-                                    printf("  ");
-                                    printf("%02d:%02d:%06.3f ", gpx.std, gpx.min, gpx.sek);
-                                    printf("  ");
-                                }
+                        if (header_found % 2 == 0) // FB6230
+                        {
+                            if ((counter % 2 == 0)) {
+                                //offset=24+16+1;
+
+                                dat2 = bits2val(frame_bits, subframe_pos+HEADLEN, 16);
+                                gpx.tag = dat2/1000;
+                                gpx.monat = (dat2/10)%100;
+                                gpx.jahr = 2000 + (dat2%10)+10;
+                                //if (option_verbose) printf("%05u  ", dat2);
+                                //printf("(%02d-%02d-%02d) ", gpx.tag, gpx.monat, gpx.jahr%100); // 2020: +20 ?
+                                printf("(%04d-%02d-%02d) ", gpx.jahr, gpx.monat, gpx.tag); // 2020: +20 ?
+
+                                lat1 = bits2val(frame_bits, subframe_pos+HEADLEN+46*0+17, 16);
+                                lat2 = bits2val(frame_bits, subframe_pos+HEADLEN+46*1   , 16);
+                                lon1 = bits2val(frame_bits, subframe_pos+HEADLEN+46*1+17, 16);
+                                lon2 = bits2val(frame_bits, subframe_pos+HEADLEN+46*2   , 16);
+                                alt1 = bits2val(frame_bits, subframe_pos+HEADLEN+46*2+17, 16);
+                                alt2 = bits2val(frame_bits, subframe_pos+HEADLEN+46*3   ,  8);
+
+                                // NMEA?
+                                lat = (lat1 << 16) | lat2;
+                                lon = (lon1 << 16) | lon2;
+                                alt = (alt1 <<  8) | alt2;
+                                latdeg = (int)lat / 1e6;
+                                latmin = (double)(lat/1e6-latdeg)*100/60.0;
+                                londeg = (int)lon / 1e6;
+                                lonmin = (double)(lon/1e6-londeg)*100/60.0;
+                                gpx.lat = (double)latdeg+latmin;
+                                gpx.lon = (double)londeg+lonmin;
+                                gpx.alt = (double)alt/1e2;
+
+                                printf("  ");
+                                printf("lat: %.5f  lon: %.5f  alt: %.2f", gpx.lat, gpx.lon, gpx.alt);
+                                printf("  ");
+
+                                vD = bits2val(frame_bits, subframe_pos+HEADLEN+46*4+17, 16);
+                                vH = bits2val(frame_bits, subframe_pos+HEADLEN+46*5   , 16);
+                                velD = (double)vD/1e2;       // course, true
+                                velH = (double)vH/1.94384e2; // knots -> m/s
+                                gpx.vH = velH;
+                                gpx.vD = velD;
+
+                                printf(" (vH: %.1fm/s  D: %.2f)", gpx.vH, gpx.vD);
+                                printf("  ");
                             }
 
-                            if (header_found % 2 == 0) // FB6230
-                            {
-                                if ((counter % 2 == 0)) {
-                                    //offset=24+16+1;
-
-                                    dat2 = bits2val(subframe_bits+HEADLEN, 16);
-                                    gpx.tag = dat2/1000;
-                                    gpx.monat = (dat2/10)%100;
-                                    gpx.jahr = 2000 + (dat2%10)+10;
-                                    //if (option_verbose) printf("%05u  ", dat2);
-                                    //printf("(%02d-%02d-%02d) ", gpx.tag, gpx.monat, gpx.jahr%100); // 2020: +20 ?
-                                    printf("(%04d-%02d-%02d) ", gpx.jahr, gpx.monat, gpx.tag); // 2020: +20 ?
-
-                                    lat1 = bits2val(subframe_bits+HEADLEN+46*0+17, 16);
-                                    lat2 = bits2val(subframe_bits+HEADLEN+46*1   , 16);
-                                    lon1 = bits2val(subframe_bits+HEADLEN+46*1+17, 16);
-                                    lon2 = bits2val(subframe_bits+HEADLEN+46*2   , 16);
-                                    alt1 = bits2val(subframe_bits+HEADLEN+46*2+17, 16);
-                                    alt2 = bits2val(subframe_bits+HEADLEN+46*3   ,  8);
-
-                                    // NMEA?
-                                    lat = (lat1 << 16) | lat2;
-                                    lon = (lon1 << 16) | lon2;
-                                    alt = (alt1 <<  8) | alt2;
-                                    latdeg = (int)lat / 1e6;
-                                    latmin = (double)(lat/1e6-latdeg)*100/60.0;
-                                    londeg = (int)lon / 1e6;
-                                    lonmin = (double)(lon/1e6-londeg)*100/60.0;
-                                    gpx.lat = (double)latdeg+latmin;
-                                    gpx.lon = (double)londeg+lonmin;
-                                    gpx.alt = (double)alt/1e2;
-
-                                    printf("  ");
-                                    printf("lat: %.5f  lon: %.5f  alt: %.2f", gpx.lat, gpx.lon, gpx.alt);
-                                    printf("  ");
-
-                                    vD = bits2val(subframe_bits+HEADLEN+46*4+17, 16);
-                                    vH = bits2val(subframe_bits+HEADLEN+46*5   , 16);
-                                    velD = (double)vD/1e2;       // course, true
-                                    velH = (double)vH/1.94384e2; // knots -> m/s
-                                    gpx.vH = velH;
-                                    gpx.vD = velD;
-
-                                    printf(" (vH: %.1fm/s  D: %.2f)", gpx.vH, gpx.vD);
-                                    printf("  ");
+                            if (counter % 2 == 0) {
+                                if (option_ecc) {
+                                printf(" ");
+                                    if (err_frm) printf("[NO]"); else printf("[OK]");
                                 }
-
-                                if (counter % 2 == 0) {
-                                    if (option_ecc) {
-                                    printf(" ");
-                                        if (err_frm) printf("[NO]"); else printf("[OK]");
+                                if (option_verbose) {
+                                    if (sn > 0) {
+                                        printf(" : sn %.0f", sn);
+                                        sn = -1;
                                     }
-                                    if (option_verbose) {
-                                        if (sn > 0) {
-                                            printf(" : sn %.0f", sn);
-                                            sn = -1;
-                                        }
-                                        if (fq > 0) {
-                                            printf(" : fq %.1f MHz", fq/1e3);
-                                            fq = -1;
-                                        }
+                                    if (fq > 0) {
+                                        printf(" : fq %.1f MHz", fq/1e3);
+                                        fq = -1;
                                     }
-                                    printf("\n");
-
-                                    if (option_jsn && err_frm==0) {
-                                        printf("{ \"frame\": %d, \"id\": \"IMS100-%.0f\", \"datetime\": \"%04d-%02d-%02dT%02d:%02d:%06.3fZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.5f, \"vel_h\": %.5f, \"heading\": %.5f }\n",
-                                               gpx.frnr, gpx.sn, gpx.jahr, gpx.monat, gpx.tag, gpx.std, gpx.min, gpx.sek, gpx.lat, gpx.lon, gpx.alt, gpx.vH, gpx.vD );
-                                        printf("\n");
+                                }
+                                printf("\n");
+
+                                if (option_jsn && err_frm==0) {
+                                    char *ver_jsn = NULL;
+                                    printf("{ \"type\": \"%s\"", "MEISEI");
+                                    printf(", \"frame\": %d, \"id\": \"IMS100-%.0f\", \"datetime\": \"%04d-%02d-%02dT%02d:%02d:%06.3fZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.5f, \"vel_h\": %.5f, \"heading\": %.5f",
+                                           gpx.frnr, gpx.sn, gpx.jahr, gpx.monat, gpx.tag, gpx.std, gpx.min, gpx.sek, gpx.lat, gpx.lon, gpx.alt, gpx.vH, gpx.vD );
+                                    printf(", \"subtype\": \"IMS100\"");
+                                    if (gpx.jsn_freq > 0) {
+                                        printf(", \"freq\": %d", gpx.jsn_freq);
                                     }
+                                    if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                                        printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
+                                    }
+                                    if (gpx.fq > 0) { // tx frequency from subframe cfg[15]
+                                        printf(", \"tx_frequency\": %.0f", gpx.fq);
+                                    }
+
+                                    // Reference time/position
+                                    printf(", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
+                                    printf(", \"ref_position\": \"%s\"", "MSL" ); // {"GPS", "MSL"} GPS=ellipsoid , MSL=geoid
 
+                                    #ifdef VER_JSN_STR
+                                        ver_jsn = VER_JSN_STR;
+                                    #endif
+                                    if (ver_jsn && *ver_jsn != '\0') printf(", \"version\": \"%s\"", ver_jsn);
+                                    printf(" }\n");
+                                    printf("\n");
                                 }
-                            }
 
+                            }
                         }
-                        else { // raw
 
-                            val = bits2val(subframe_bits, HEADLEN);
+                    }
+                    else { // raw
 
-                            printf("%06X ", val & 0xFFFFFF);
-                            //printf("  ");
-                            for (i = 0; i < 6; i++) {
+                        val = bits2val(frame_bits, subframe_pos, HEADLEN);
 
-                                val = bits2val(subframe_bits+HEADLEN+46*i   , 16);
-                                printf("%04X ", val & 0xFFFF);
+                        printf("%06X ", val & 0xFFFFFF);
+                        //printf("  ");
+                        for (i = 0; i < 6; i++) {
 
-                                val = bits2val(subframe_bits+HEADLEN+46*i+17, 16);
-                                printf("%04X ", val & 0xFFFF);
+                            val = bits2val(frame_bits, subframe_pos+HEADLEN+46*i   , 16);
+                            printf("%04X ", val & 0xFFFF);
 
-                                //val = bits2val(subframe_bits+HEADLEN+46*i+34, 12);
-                                //printf("%03X ", val & 0xFFF);
-                                //printf(" ");
-                            }
+                            val = bits2val(frame_bits, subframe_pos+HEADLEN+46*i+17, 16);
+                            printf("%04X ", val & 0xFFFF);
 
-                            if (option_ecc && option_verbose) {
-                                printf("#");
-                                for (block = 0; block < 6; block++) printf("%X", block_err[block]);
-                                printf("#  ");
-                            }
+                            //val = bits2val(frame_bits, subframe_pos+HEADLEN+46*i+34, 12);
+                            //printf("%03X ", val & 0xFFF);
+                            //printf(" ");
+                        }
 
-                            if (subframe > 0) printf("\n");
+                        if (option_ecc && option_verbose) {
+                            printf("#");
+                            for (block = 0; block < 6; block++) printf("%X", block_err[block]);
+                            printf("#  ");
                         }
 
-                        bit_count = 0;
-                        header_found += 1;
+                        if (subframe > 0) printf("\n");
                     }
-                    header_found = 0;
+
+                    bit_count = 0;
+                    header_found += 1;
                 }
             }
+            else break; // EOF
+
+            header_found = 0;
         }
     }
 
     printf("\n");
 
+    if (!option_softin) free_buffers(&dsp);
+    else {
+        if (hdb.sbuf) { free(hdb.sbuf); hdb.sbuf = NULL; }
+    }
+
     fclose(fp);
 
     return 0;
 }
-
@@ -3,7 +3,8 @@
    Sippican MkIIa
    LMS-6 (1680 MHz)
         (modulation index h = 10..10.5 (deviation +/- 50kHz))
-        gcc -Ofast mk2a1680mod.c -lm -o mk2mod
+        gcc -Ofast -c ../demod/mod/dsp_mod.c
+        gcc -Ofast mk2a1680mod.c dsp_mod.o -lm -o mk2mod
         ./mk2mod -v --iq <fq> --lpIQ --lpFM --crc iq_base.wav
         # default IQ lowpass 180k
         # sr=375k: lpbw=145k..165k
@@ -41,151 +42,7 @@
 // -------------------------------------------------------------------------------------------------
 //#include "demod_mod_Lband.h"
 
-#ifndef M_PI
-    #define M_PI  (3.1415926535897932384626433832795)
-#endif
-#define _2PI  (6.2831853071795864769252867665590)
-
-#define LP_IQ    1
-#define LP_FM    2
-#define LP_IQFM  4
-
-
-typedef unsigned char  ui8_t;
-typedef unsigned short ui16_t;
-typedef unsigned int   ui32_t;
-typedef char  i8_t;
-typedef short i16_t;
-typedef int   i32_t;
-
-
-typedef struct {
-    int sr;       // sample_rate
-    int LOG2N;
-    int N;
-    int N2;
-    float *xn;
-    float complex  *ew;
-    float complex  *Fm;
-    float complex  *X;
-    float complex  *Z;
-    float complex  *cx;
-    float complex  *win; // float real
-} dft_t;
-
-
-typedef struct {
-    FILE *fp;
-    //
-    int sr;       // sample_rate
-    int bps;      // bits/sample
-    int nch;      // channels
-    int ch;       // select channel
-    //
-    int symlen;
-    int symhd;
-    float sps;    // samples per symbol
-    float _spb;   // samples per bit
-    float br;     // baud rate
-    //
-    ui32_t sample_in;
-    ui32_t sample_out;
-    ui32_t sample_fm;
-    ui32_t delay;
-    ui32_t sc;
-    int buffered;
-    int L;
-    int M;
-    int K;
-    float *match;
-    float *bufs;
-    float mv;
-    ui32_t mv_pos;
-    //
-    float mv2;
-    ui32_t mv2_pos;
-
-    // IQ-data
-    int opt_iq;
-    int opt_iqdc;
-    int N_IQBUF;
-    float complex *rot_iqbuf;
-    float complex F1sum;
-    float complex F2sum;
-    //
-    double complex iw1;
-    double complex iw2;
-
-    //
-    char *rawbits;
-    char *hdr;
-    int hdrlen;
-
-    //
-    float BT; // bw/time (ISI)
-    float h;  // modulation index
-
-    // DFT
-    dft_t DFT;
-
-    // dc offset
-    int opt_dc;
-    int locked;
-    double dc;
-    double Df;
-    double dDf;
-
-
-    // decimate
-    int opt_nolut; // default: LUT
-    int opt_IFmin;
-    int decM;
-    ui32_t sr_base;
-    ui32_t dectaps;
-    ui32_t sample_decX;
-    ui32_t lut_len;
-    ui32_t sample_decM;
-    float complex *decXbuffer;
-    float complex *decMbuf;
-    float complex *ex; // exp_lut
-    double xlt_fq;
-
-    // IF: lowpass
-    int opt_lp;
-    int lpIQ_bw;
-    float lpIQ_fbw;
-    int lpIQtaps; // ui32_t
-    float *ws_lpIQ0;
-    float *ws_lpIQ1;
-    float *ws_lpIQ;
-    float complex *lpIQ_buf;
-
-    // FM: lowpass
-    int lpFM_bw;
-    int lpFMtaps; // ui32_t
-    float *ws_lpFM;
-    float *lpFM_buf;
-    float *fm_buffer;
-
-    // IQFM: lowpass
-    int lpIQFM_bw;
-    int lpIQFMtaps; // ui32_t
-    float *ws_lpIQFM;
-    float *lpIQFM_buf;
-
-    int opt_fmdec;
-    int decFM;
-
-} dsp_t;
-
-
-typedef struct {
-    int sr;       // sample_rate
-    int bps;      // bits_sample  bits/sample
-    int nch;      // channels
-    int sel_ch;   // select wav channel
-} pcm_t;
-
+#include "../demod/mod/dsp_mod.h"
 
 typedef struct {
     ui8_t hb;
@@ -209,62 +66,6 @@ typedef struct {
 #define FM_DEC  4     // 2, 4
 #define FM_GAIN (0.8)
 
-static void raw_dft(dft_t *dft, float complex *Z) {
-    int s, l, l2, i, j, k;
-    float complex  w1, w2, T;
-
-    j = 1;
-    for (i = 1; i < dft->N; i++) {
-        if (i < j) {
-            T = Z[j-1];
-            Z[j-1] = Z[i-1];
-            Z[i-1] = T;
-        }
-        k = dft->N/2;
-        while (k < j) {
-            j = j - k;
-            k = k/2;
-        }
-        j = j + k;
-    }
-
-    for (s = 0; s < dft->LOG2N; s++) {
-        l2 = 1 << s;
-        l  = l2 << 1;
-        w1 = (float complex)1.0;
-        w2 = dft->ew[s]; // cexp(-I*M_PI/(float)l2)
-        for (j = 1; j <= l2; j++) {
-            for (i = j; i <= dft->N; i += l) {
-                k = i + l2;
-                T = Z[k-1] * w1;
-                Z[k-1] = Z[i-1] - T;
-                Z[i-1] = Z[i-1] + T;
-            }
-            w1 = w1 * w2;
-        }
-    }
-}
-
-static void cdft(dft_t *dft, float complex *z, float complex *Z) {
-    int i;
-    for (i = 0; i < dft->N; i++)  Z[i] = z[i];
-    raw_dft(dft, Z);
-}
-
-static void rdft(dft_t *dft, float *x, float complex *Z) {
-    int i;
-    for (i = 0; i < dft->N; i++)  Z[i] = (float complex)x[i];
-    raw_dft(dft, Z);
-}
-
-static void Nidft(dft_t *dft, float complex *Z, float complex *z) {
-    int i;
-    for (i = 0; i < dft->N; i++)  z[i] = conj(Z[i]);
-    raw_dft(dft, z);
-    // idft():
-    // for (i = 0; i < dft->N; i++)  z[i] = conj(z[i])/(float)dft->N; // hier: z reell
-}
-
 static float bin2freq0(dft_t *dft, int k) {
     float fq = dft->sr * k / /*(float)*/dft->N;
     if (fq >= dft->sr/2.0) fq -= dft->sr;
@@ -296,35 +97,6 @@ static int max_bin(dft_t *dft, float complex *Z) {
     return kmax;
 }
 
-static int dft_window(dft_t *dft, int w) {
-    int n;
-
-    if (w < 0 || w > 3) return -1;
-
-    for (n = 0; n < dft->N2; n++) {
-        switch (w)
-        {
-            case 0: // (boxcar)
-                    dft->win[n] = 1.0;
-                    break;
-            case 1: // Hann
-                    dft->win[n] = 0.5 * ( 1.0 - cos(_2PI*n/(float)(dft->N2-1)) );
-                    break ;
-            case 2: // Hamming
-                    dft->win[n] = 25/46.0 - (1.0 - 25/46.0)*cos(_2PI*n / (float)(dft->N2-1));
-                    break ;
-            case 3: // Blackmann
-                    dft->win[n] =  7938/18608.0
-                                 - 9240/18608.0*cos(_2PI*n / (float)(dft->N2-1))
-                                 + 1430/18608.0*cos(4*M_PI*n / (float)(dft->N2-1));
-                    break ;
-        }
-    }
-    while (n < dft->N) dft->win[n++] = 0.0;
-
-    return 0;
-}
-
 
 /* ------------------------------------------------------------------------------------ */
 
@@ -481,305 +253,10 @@ static int getCorrDFT(dsp_t *dsp) {
 
 /* ------------------------------------------------------------------------------------ */
 
-static int findstr(char *buff, char *str, int pos) {
-    int i;
-    for (i = 0; i < 4; i++) {
-        if (buff[(pos+i)%4] != str[i]) break;
-    }
-    return i;
-}
-
-static
-int read_wav_header(pcm_t *pcm, FILE *fp) {
-    char txt[4+1] = "\0\0\0\0";
-    unsigned char dat[4];
-    int byte, p=0;
-    int sample_rate = 0, bits_sample = 0, channels = 0;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "RIFF", 4) && strncmp(txt, "RF64", 4)) return -1;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    // pos_WAVE = 8L
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "WAVE", 4))  return -1;
-
-    // pos_fmt = 12L
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "fmt ", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    channels = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    //byte = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    bits_sample = dat[0] + (dat[1] << 8);
-
-    // pos_dat = 36L + info
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "data", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-
-
-    fprintf(stderr, "sample_rate: %d\n", sample_rate);
-    fprintf(stderr, "bits       : %d\n", bits_sample);
-    fprintf(stderr, "channels   : %d\n", channels);
-
-    if (pcm->sel_ch < 0  ||  pcm->sel_ch >= channels) pcm->sel_ch = 0; // default channel: 0
-    //fprintf(stderr, "channel-In : %d\n", pcm->sel_ch+1); // nur wenn nicht IQ
-
-    if (bits_sample != 8 && bits_sample != 16 && bits_sample != 32) return -1;
-
-    if (sample_rate == 900001) sample_rate -= 1;
-
-    pcm->sr  = sample_rate;
-    pcm->bps = bits_sample;
-    pcm->nch = channels;
-
-    return 0;
-}
-
-
-static int f32read_sample(dsp_t *dsp, float *s) {
-    int i;
-    unsigned int word = 0;
-    short *b = (short*)&word;
-    float *f = (float*)&word;
-
-    for (i = 0; i < dsp->nch; i++) {
-
-        if (fread( &word, dsp->bps/8, 1, dsp->fp) != 1) return EOF;
-
-        if (i == dsp->ch) {  // i = 0: links bzw. mono
-            //if (bits_sample ==  8)  sint = b-128;   // 8bit: 00..FF, centerpoint 0x80=128
-            //if (bits_sample == 16)  sint = (short)b;
-
-            if (dsp->bps == 32) {
-                *s = *f;
-            }
-            else {
-                if (dsp->bps ==  8) { *b -= 128; }
-                *s = *b/128.0;
-                if (dsp->bps == 16) { *s /= 256.0; }
-            }
-        }
-    }
-
-    return 0;
-}
-
-typedef struct {
-    double sumIQx;
-    double sumIQy;
-    float avgIQx;
-    float avgIQy;
-    float complex avgIQ;
-    ui32_t cnt;
-    ui32_t maxcnt;
-    ui32_t maxlim;
-} iq_dc_t;
-static iq_dc_t IQdc;
-
-static int f32read_csample(dsp_t *dsp, float complex *z) {
-
-    float x, y;
-
-    if (dsp->bps == 32) { //float32
-        float f[2];
-        if (fread( f, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = f[0];
-        y = f[1];
-    }
-    else if (dsp->bps == 16) { //int16
-        short b[2];
-        if (fread( b, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = b[0]/32768.0;
-        y = b[1]/32768.0;
-    }
-    else {  // dsp->bps == 8   //uint8
-        ui8_t u[2];
-        if (fread( u, dsp->bps/8, 2, dsp->fp) != 2) return EOF;
-        x = (u[0]-128)/128.0;
-        y = (u[1]-128)/128.0;
-    }
-
-    *z = x + I*y;
-
-    // IQ-dc removal optional
-    if (dsp->opt_iqdc) {
-        *z -= IQdc.avgIQ;
-
-        IQdc.sumIQx += x;
-        IQdc.sumIQy += y;
-        IQdc.cnt += 1;
-        if (IQdc.cnt == IQdc.maxcnt) {
-            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
-            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
-            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
-            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
-            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
-        }
-    }
-
-    return 0;
-}
-
-static int f32read_cblock(dsp_t *dsp) {
-
-    int n;
-    int len;
-    float x, y;
-    ui8_t s[4*2*dsp->decM]; //uin8,int16,float32
-    ui8_t *u = (ui8_t*)s;
-    short *b = (short*)s;
-    float *f = (float*)s;
-
-
-    len = fread( s, dsp->bps/8, 2*dsp->decM, dsp->fp) / 2;
-
-    //for (n = 0; n < len; n++) dsp->decMbuf[n] = (u[2*n]-128)/128.0 + I*(u[2*n+1]-128)/128.0;
-    // u8: 0..255, 128 -> 0V
-    for (n = 0; n < len; n++) {
-        if (dsp->bps == 8) { //uint8
-            x = (u[2*n  ]-128)/128.0;
-            y = (u[2*n+1]-128)/128.0;
-        }
-        else if (dsp->bps == 16) { //int16
-            x = b[2*n  ]/32768.0;
-            y = b[2*n+1]/32768.0;
-        }
-        else { // dsp->bps == 32   //float32
-            x = f[2*n];
-            y = f[2*n+1];
-        }
-
-        // baseband: IQ-dc removal mandatory
-        dsp->decMbuf[n] = (x-IQdc.avgIQx) + I*(y-IQdc.avgIQy);
-
-        IQdc.sumIQx += x;
-        IQdc.sumIQy += y;
-        IQdc.cnt += 1;
-        if (IQdc.cnt == IQdc.maxcnt) {
-            IQdc.avgIQx = IQdc.sumIQx/(float)IQdc.maxcnt;
-            IQdc.avgIQy = IQdc.sumIQy/(float)IQdc.maxcnt;
-            IQdc.avgIQ  = IQdc.avgIQx + I*IQdc.avgIQy;
-            IQdc.sumIQx = 0; IQdc.sumIQy = 0; IQdc.cnt = 0;
-            if (IQdc.maxcnt < IQdc.maxlim) IQdc.maxcnt *= 2;
-        }
-    }
-
-    return len;
-}
-
 
 // decimate lowpass
 static float *ws_dec;
 
-static double sinc(double x) {
-    double y;
-    if (x == 0) y = 1;
-    else y = sin(M_PI*x)/(M_PI*x);
-    return y;
-}
-
-static int lowpass_init(float f, int taps, float **pws) {
-    double *h, *w;
-    double norm = 0;
-    int n;
-    float *ws = NULL;
-
-    if (taps % 2 == 0) taps++; // odd/symmetric
-
-    if ( taps < 1 ) taps = 1;
-
-    h = (double*)calloc( taps+1, sizeof(double)); if (h == NULL) return -1;
-    w = (double*)calloc( taps+1, sizeof(double)); if (w == NULL) return -1;
-    ws = (float*)calloc( 2*taps+1, sizeof(float)); if (ws == NULL) return -1;
-
-    for (n = 0; n < taps; n++) {
-        w[n] = 7938/18608.0 - 9240/18608.0*cos(_2PI*n/(taps-1)) + 1430/18608.0*cos(4*M_PI*n/(taps-1)); // Blackmann
-        h[n] = 2*f*sinc(2*f*(n-(taps-1)/2));
-        ws[n] = w[n]*h[n];
-        norm += ws[n]; // 1-norm
-    }
-    for (n = 0; n < taps; n++) {
-        ws[n] /= norm; // 1-norm
-    }
-
-    for (n = 0; n < taps; n++) ws[taps+n] = ws[n]; // duplicate/unwrap
-
-    *pws = ws;
-
-    free(h); h = NULL;
-    free(w); w = NULL;
-
-    return taps;
-}
-
-static float complex lowpass1a(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    double complex w = 0;
-    ui32_t n;
-    ui32_t S = taps-1 + (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S-n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return (float complex)w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-//static __attribute__((optimize("-ffast-math"))) float complex lowpass()
-static float complex lowpass(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;
-    int n; // -Ofast
-    int S = taps - (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-static float complex lowpass2(float complex buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float complex w = 0;
-    int n;
-    int s = sample % taps;
-    int S1 = s;
-    int S1N = S1-taps;
-    int n0 = taps-s;
-    for (n = 0; n < n0; n++) {
-        w += buffer[S1+n]*ws[n];
-    }
-    for (n = n0; n < taps; n++) {
-        w += buffer[S1N+n]*ws[n];
-    }
-    return w;
-// symmetry: ws[n] == ws[taps-1-n]
-}
-
-static float re_lowpass(float buffer[], ui32_t sample, ui32_t taps, float *ws) {
-    float w = 0;
-    int n;
-    int S = taps - (sample % taps);
-    for (n = 0; n < taps; n++) {
-        w += buffer[n]*ws[S+n]; // ws[taps+s-n] = ws[(taps+sample-n)%taps]
-    }
-    return w;
-}
-
 
 static
 int f32buf_sample(dsp_t *dsp, int inv) {
@@ -1194,40 +671,8 @@ int init_buffers_Lband(dsp_t *dsp) {
     }
     if (dsp->opt_iq >= 5)
     {
-        if (!dsp->opt_nolut)
-        {
-            // look up table, exp-rotation
-            int W = 2*8; // 16 Hz window
-            int d = 1; // 1..W , groesster Teiler d <= W von sr_base
-            int freq = (int)( dsp->xlt_fq * (double)dsp->sr_base + 0.5);
-            int freq0 = freq; // init
-            double f0 = freq0 / (double)dsp->sr_base; // init
-
-            for (d = W; d > 0; d--) { // groesster Teiler d <= W von sr
-                if (dsp->sr_base % d == 0) break;
-            }
-            if (d == 0) d = 1; // d >= 1 ?
-
-            for (k = 0; k < W/2; k++) {
-                if ((freq+k) % d == 0) {
-                    freq0 = freq + k;
-                    break;
-                }
-                if ((freq-k) % d == 0) {
-                    freq0 = freq - k;
-                    break;
-                }
-            }
-
-            dsp->lut_len = dsp->sr_base / d;
-            f0 = freq0 / (double)dsp->sr_base;
-
-            dsp->ex = calloc(dsp->lut_len+1, sizeof(float complex));
-            if (dsp->ex == NULL) return -1;
-            for (n = 0; n < dsp->lut_len; n++) {
-                t = f0*(double)n;
-                dsp->ex[n] = cexp(t*_2PI*I);
-            }
+        if (!dsp->opt_nolut) {
+            if (exlut_init(dsp) < 0) return -1;
         }
 
         dsp->decXbuffer = calloc( dsp->dectaps+1, sizeof(float complex));
@@ -1317,13 +762,7 @@ int init_buffers_Lband(dsp_t *dsp) {
         if (dsp->lpIQFM_buf == NULL) return -1;
     }
 
-    memset(&IQdc, 0, sizeof(IQdc));
-    IQdc.maxlim = dsp->sr;
-    IQdc.maxcnt = IQdc.maxlim/32; // 32,16,8,4,2,1
-    if (dsp->decM > 1) {
-        IQdc.maxlim *= dsp->decM;
-        IQdc.maxcnt *= dsp->decM;
-    }
+    iq_dc_init(dsp);
 
 
     // FM dec: sps = sps_if / FM_DEC
@@ -1444,6 +883,8 @@ int init_buffers_Lband(dsp_t *dsp) {
 static
 int free_buffers(dsp_t *dsp) {
 
+    f32read_free(dsp);  // input buffer/mapping
+
     if (dsp->match) { free(dsp->match); dsp->match = NULL; }
     if (dsp->bufs)  { free(dsp->bufs);  dsp->bufs  = NULL; }
     if (dsp->rawbits) { free(dsp->rawbits); dsp->rawbits = NULL; }
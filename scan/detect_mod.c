@@ -0,0 +1,1366 @@
+
+/*
+ *  radiosonde detection: header correlation (DFT/matched filter)
+ *  re-entrant: all state in dft_detect_t
+ *  DFT, FIR lowpass: ../demod/mod/dsp_mod.c
+ *  compile:
+ *      gcc -c detect_mod.c
+ *  speedup:
+ *      gcc -Ofast -c detect_mod.c
+ *
+ *  author: zilog80
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "detect_mod.h"
+
+
+//int  dfm_sps = 2500;
+static char dfm_header[] = "10011010100110010101101001010101"; // DFM-09
+                        // "01100101011001101010010110101010"; // DFM-06
+//int  vai_sps = 4800;
+static char rs41_header[] = "00001000011011010101001110001000"
+                            "01000100011010010100100000011111";
+static char rs92_header[] = //"10100110011001101001"
+                            //"10100110011001101001"
+                            "10100110011001101001"
+                            "10100110011001101001"
+                            "1010011001100110100110101010100110101001";
+
+//int  lms_sps = 4800;  // lms6_403MHz
+static char lms6_header[] = "0101011000001000""0001110010010111"
+                            "0001101010100111""0011110100111110";
+
+//int  mk2a_sps = 9600;  // lms6_1680MHz
+static char mk2a_header[] = "0010100111""0010100111""0001001001""0010010101";
+
+//int  m10_sps = 9600;
+static char m10_header[] = //"10011001100110010100110010011001";
+                                 "1001100110010100110010011001""1010"; // ofs=4/2 in frm_M10()
+// frame byte[0..1]: byte[0]=framelen-1, byte[1]=type(8F=M2K2,9F=M10,AF=M10+,20=M20)
+// M2K2   : 64 8F : 01100100 10001111
+// M10    : 64 9F : 01100100 10011111  (framelen 0x64+1) (baud=9616)
+// M10-aux: 76 9F : 01110110 10011111  (framelen 0x76+1)
+// M10+   : 64 AF : 01100100 10101111  (w/ gtop-GPS)
+// M20    : 45 20 : 01000101 00100000  (framelen 0x45+1) (baud=9600)
+
+//int  meisei_sps = 2400;   // 0xFB6230 =
+static char meisei_header[] = "110011001101001101001101010100101010110010101010"; // 11111011 01100010 00110000
+
+//int  mrz_sps = 2400;
+static char mrz_header[] = "1001100110011001""1001101010101010"; // 0xAA 0xBF
+
+//int  imet54_sps = 4800;
+static char imet54_header[] = "0000000001""0101010101""0001001001""0001001001"; // 0x00 0xAA 0x24 0x24
+
+// Meteosis MTS01 1200 baud
+// Lmax
+// len(AA AA B4 2B)=32 -> L=1280 // more accurate, +19% slower
+// len(AA B4 2B)=24 -> L=960 // same L as meisei, +7% slower
+static char mts01_header[] = "10101010""10101010"  // preamble: AA AA
+                             "10110100""00101011"; // 10000000: B4 2B //80
+
+
+// imet_9600 / 1200 Hz;
+static char imet_preamble[] = //"11110000111100001111000011110000"
+                              //"11110000111100001111000011110000"
+                              "11110000111100001111000011110000"
+                              "11110000111100001111000011110000"; // 1200 Hz 0xAA 0xAA preamble
+
+//int  imet1ab_sps = 9600; // 1200 bits/sec  // AFSK 1200/2400
+static char imet1ab_header[] = "0000""11110000111100001111000011110000""1111"   // idle
+                             //"0000""10101100110010101100101010101100""1111"
+                               "0000""10101100110010101100101010101100""1111";  // 0x96
+
+// 11110000:1 , 001100110:0 // 11/4=2.1818..
+static char imet1rs_header[] =
+    "0000""1111""0000""1111""0000""1111"   // preamble
+    "0000""1111";
+
+// imet1rs/imet4 1200Hz preamble , lead_out , 8N1 byte: lead-in 8bits lead-out , ...
+// 1:1200Hz/0:2200Hz tones, bit-duration 1/1200 sec, phase ...
+// bits: 1111111111111111111 10 10000000 10 ..;
+
+
+// C34/C50: 2400 baud, 1:2900Hz/0:4800Hz
+static char c34_preheader[] =
+    "01010101010101010101010101010101";   // 2900 Hz tone
+    // dft, dB-max(1000Hz..5000Hz) = 2900Hz ?
+
+
+static char weathex_header[] =
+    "10101010""10101010""10101010"       // AA AA AA (preamble)
+    "00101101""11010100"; //"10101010";  // 2D D4 55/AA
+
+static char wxr2pn9_header[] =
+    "10101010""10101010""10101010"  // AA AA AA (preamble)
+    "11000001""10010100"; //"11000001";  // C1 94 C1
+
+
+static float lpFM_bw[2] = { 4e3, 10e3 };  // FM-audio lowpass bandwidth
+static float lpIQ_bw[N_bwIQ] = { 6e3, 12e3, 22e3, 200e3 };  // IF iq lowpass bandwidth
+static float lpIQ_bw_L[N_bwIQ] = { 20e3, 32e3, 200e3, 400e3 };  // L-band 1680kHz (IQ: decimation not limited)
+
+#define tn_DFM        2
+#define tn_RS41       3
+#define tn_RS92       4
+#define tn_M10        5
+#define tn_M20        6
+#define tn_LMS6       8
+#define tn_MEISEI     9
+#define tn_MRZ       12
+#define tn_MTS01     13
+#define tn_C34C50    15
+#define tn_WXR301    16
+#define tn_WXRpn9    17
+#define tn_MK2LMS    18
+#define tn_IMET5     24
+#define tn_IMETa     25
+#define tn_IMET4     26
+#define tn_IMET1rs   28
+#define tn_IMET1ab   29
+
+#define idxIMETafsk  14
+#define idxRS        15
+#define idxI4        16
+static rsheader_t rs_hdr0[Nrs] = {
+    { 2500, 0, 0, dfm_header,     1.0, 0.0, 0.65, 2, NULL, "DFM9",     tn_DFM,     0, 1, 0.0, 0.0}, // DFM6: -2 ?
+    { 4800, 0, 0, rs41_header,    0.5, 0.0, 0.70, 2, NULL, "RS41",     tn_RS41,    0, 1, 0.0, 0.0},
+    { 4800, 0, 0, rs92_header,    0.5, 0.0, 0.70, 3, NULL, "RS92",     tn_RS92,    0, 1, 0.0, 0.0}, // RS92NGP: 1680/400=4.2
+    { 4800, 0, 0, lms6_header,    1.0, 0.0, 0.60, 8, NULL, "LMS6",     tn_LMS6,    0, 1, 0.0, 0.0}, // lmsX: 7?
+    { 4800, 0, 0, imet54_header,  0.5, 0.0, 0.80, 2, NULL, "IMET5",    tn_IMET5,   0, 1, 0.0, 0.0}, // (rs_hdr[idxI5])
+    { 9616, 0, 0, mk2a_header,    1.0, 0.0, 0.70, 2, NULL, "MK2LMS",   tn_MK2LMS,  1, 2, 0.0, 0.0}, // Mk2a/LMS6-1680 , --IQ: decimate > 170kHz ...
+    { 9608, 0, 0, m10_header,     1.0, 0.0, 0.76, 2, NULL, "M10",      tn_M10,     1, 2, 0.0, 0.0}, // M10.tn=5 (baud=9616) , M20.tn=6 (baud=9600)
+    { 2400, 0, 0, meisei_header,  1.0, 0.0, 0.70, 2, NULL, "MEISEI",   tn_MEISEI,  0, 2, 0.0, 0.0},
+    { 2400, 0, 0, mrz_header,     1.5, 0.0, 0.80, 2, NULL, "MRZ",      tn_MRZ,     0, 1, 0.0, 0.0},
+    { 1200, 0, 0, mts01_header,   1.0, 0.0, 0.65, 2, NULL, "MTS01",    tn_MTS01,   0, 0, 0.0, 0.0},
+    { 5800, 0, 0, c34_preheader,  1.5, 0.0, 0.80, 2, NULL, "C34C50",   tn_C34C50,  0, 2, 0.0, 0.0}, // C34/C50 2900 Hz tone
+    { 4800, 0, 0, weathex_header, 1.0, 0.0, 0.65, 2, NULL, "WXR301",   tn_WXR301,  0, 3, 0.0, 0.0},
+    { 5000, 0, 0, wxr2pn9_header, 1.0, 0.0, 0.65, 2, NULL, "WXRPN9",   tn_WXRpn9,  0, 3, 0.0, 0.0},
+    { 9600, 0, 0, imet1ab_header, 1.0, 0.0, 0.80, 2, NULL, "IMET1AB",  tn_IMET1ab, 1, 3, 0.0, 0.0}, // (rs_hdr[idxAB])
+    { 9600, 0, 0, imet_preamble,  0.5, 0.0, 0.80, 4, NULL, "IMETafsk", tn_IMETa  , 1, 1, 0.0, 0.0}, // IMET1AB, IMET1RS (IQ)IMET4
+    { 9600, 0, 0, imet1rs_header, 0.5, 0.0, 0.80, 2, NULL, "IMET1RS",  tn_IMET1rs, 0, 3, 0.0, 0.0}, // (rs_hdr[idxRS]) IMET4: lpIQ=0 ...
+    { 9600, 0, 0, imet1rs_header, 0.5, 0.0, 0.80, 2, NULL, "IMET4",    tn_IMET4,   1, 1, 0.0, 0.0}, // (rs_hdr[idxI4])
+};
+
+
+static int rs_d2(dft_detect_t *det) {
+    int tn = 0;
+    for (tn = 0; tn < Nrs; tn++) {
+        if ( det->rs_detect2[tn] > 1 ) break;
+    }
+    return tn;
+}
+
+
+// sequential detection (--seq <conf>):
+// per header type accumulate log-likelihood ratio  H_j:sonde j  vs.  H_0:noise
+// over all DFT windows; P_j = exp(llr_j) / (1 + sum_k exp(llr_k))
+// decide j if P_j > conf, stop if all llr_j at lower bound ln((1-conf)/conf)
+//
+#define SEQ_PFA       1e-4  // q0: P(header found | noise) per window
+#define SEQ_LLR_WEAK  1.0   // correlation above SEQ_WEAK*thres and header (almost) matches
+#define SEQ_WEAK      0.7
+#define SEQ_FRAMESEC  1.0   // frame period ~1s (RS41, RS92, DFM, M10, ...)
+
+static void seq_init(dft_detect_t *det) {
+    int n;
+    double q1 = det->K/(double)det->sr / SEQ_FRAMESEC;  // P(frame header in window | sonde)
+    if (q1 > 0.9) q1 = 0.9;
+    if (det->seq_conf < 0.5) det->seq_conf = 0.5;
+    if (det->seq_conf > 0.9999) det->seq_conf = 0.9999;
+    det->seq_llr_hit = log(q1/SEQ_PFA);
+    det->seq_llr_miss = log(1.0-q1);
+    det->seq_lo = log((1.0-det->seq_conf)/det->seq_conf);
+    for (n = 0; n < Nrs; n++) {
+        det->seq_llr[n] = 0.0;
+        det->seq_mv[n] = 0.0;
+        det->seq_df[n] = 0.0;
+        det->seq_skip[n] = (n == det->idx_MTS01 || n == det->idx_C34C50 || n == det->idx_WXR301
+                            || n == det->idx_WXRPN9 || n == det->idx_IMET1AB);
+        det->seq_hit[n] = 0;
+    }
+    det->seq_j = -1;
+}
+
+static void seq_add(dft_detect_t *det, int j, double llr, float mv) {
+    det->seq_llr[j] += llr;
+    if (det->seq_llr[j] < det->seq_lo) det->seq_llr[j] = det->seq_lo;
+    if (fabs(mv) > fabs(det->seq_mv[j])) {
+        det->seq_mv[j] = mv;
+        det->seq_df[j] = det->rs_hdr[j].df;
+    }
+}
+
+static double seq_post(dft_detect_t *det, int j) {
+    int n;
+    double sum = 1.0;  // H_0
+    for (n = 0; n < Nrs; n++) {
+        if (!det->seq_skip[n]) sum += exp(det->seq_llr[n]);
+    }
+    return exp(det->seq_llr[j]) / sum;
+}
+
+// return: j>=0 decided, -1 continue, -2 all ruled out
+static int seq_decide(dft_detect_t *det) {
+    int n;
+    int n_max = 0;
+    int out = 1;
+    for (n = 0; n < Nrs; n++) {
+        if (det->seq_skip[n]) continue;
+        if (det->seq_llr[n] > det->seq_llr[n_max]) n_max = n;
+        if (det->seq_llr[n] > det->seq_lo) out = 0;
+    }
+    if (seq_post(det, n_max) > det->seq_conf) return n_max;
+    if (out) return -2;
+    return -1;
+}
+
+int dft_detect_report(dft_detect_t *det, FILE *fo) {
+    int n;
+    int j = det->seq_j;
+    if (!det->opt_seq) return -1;
+    fprintf(fo, "seq: %s after %.3f sec\n", j >= 0 ? det->rs_hdr[j].type : (j == -2 ? "none" : "undecided"),
+                                            det->sample_in/(float)det->sr);
+    for (n = 0; n < Nrs; n++) {
+        if (det->seq_skip[n]) continue;
+        fprintf(fo, "  %-8s  llr: %+7.2f  p: %.4f  mv: %+.4f\n", det->rs_hdr[n].type, det->seq_llr[n],
+                                                                seq_post(det, n), det->seq_mv[n]);
+    }
+    return 0;
+}
+
+
+/*
+// m10-false-positive:
+// m10-preamble similar to rs41-preamble, parts of rs92/imet1ab, imet1ab; diffs:
+// - iq: - modulation-index rs41 < rs92 < m10,
+//       - power level / frame < 1s, noise
+// - fm: - frame duration <-> noise (variance/standard deviation)
+//       - pulse-shaping
+//           m10: 00110011 at 9600 sps
+//           rs41: 0 1 0 1 at 4800 sps
+// - after header, m10-baudrate < rs41-baudrate
+// - m10 top-carrier, fm-mean/average
+// - m10-header ..110(1)0110011()011.. bit shuffle
+// - m10 frame byte[1]=type(M2K2,M10,M10+)
+*/
+
+/*
+// rs92
+// imet1ab-false-positive
+// ...
+*/
+
+#define FM_GAIN (0.8)
+
+/* ------------------------------------------------------------------------------------ */
+
+static float freq2bin(dft_detect_t *det, int f) {
+    return  f * det->DFT.N / (float)det->sr;
+}
+
+static float bin2freq(dft_detect_t *det, int k) {
+    float fq = k / (float)det->DFT.N;
+    if ( fq >= 0.5) fq -= 1.0;
+    return fq*det->sr;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+static int getCorrDFT(dft_detect_t *det, int K, unsigned int pos, float *maxv, unsigned int *maxvpos, rsheader_t *rshd) {
+    int i;
+    int mp = -1;
+    float mx = 0.0;
+    float mx2 = 0.0;
+    float re_cx = 0.0;
+    double xnorm = 1.0;
+    unsigned int mpos = 0;
+    int M = det->M;
+    int N_DFT = det->DFT.N;
+    float *bufs = NULL;
+    float *xn = det->DFT.xn;
+    float complex *X = det->DFT.X;
+    float complex *Z = det->DFT.Z;
+    float complex *cx = det->DFT.cx;
+
+    float dc = 0.0;
+    rshd->dc = 0.0;
+
+    if (K + rshd->L > N_DFT) return -1;
+//    if (sample_out < rshd->L) return -2; // nur falls K-4 < L
+
+    if (pos == 0) pos = det->sample_out;
+
+    bufs = det->buf_fm[rshd->lpIQ];
+
+    for (i = 0; i < K+rshd->L; i++) xn[i] = bufs[(pos+M -(K+rshd->L-1) + i) % M];
+    while (i < N_DFT) xn[i++] = 0.0;
+
+    rdft(&det->DFT, xn, X);
+
+
+    //dc = get_bufmu(pos-sample_out); //oder: dc = creal(X[0])/(K+rshd->L) = avg(xn) // zu lang (M10)
+
+    dc = 0.0;
+    if (det->opt_dc) {
+        //X[0] = 0; // all samples in window
+        // L < K
+        for (i=K-rshd->L; i<K+rshd->L;i++) dc += xn[i]; // only last 2L samples (avoid M10 carrier offset)
+        dc /= 2.0*(float)rshd->L;
+        X[0] -= N_DFT*dc  * 0.98;
+    }
+    rshd->dc = dc;
+
+    if (det->opt_iq) {
+        // FM-lowpass(xn)
+        for (i = 0; i < N_DFT; i++) X[i] *= det->WS[rshd->lpFM][i];
+    }
+
+    if (det->opt_dc || det->opt_iq) { // mx = mx(xn[]), xn(lowpass, dc)
+        Nidft(&det->DFT, X, cx);
+        for (i = 0; i < N_DFT; i++) xn[i] = creal(cx[i])/(float)N_DFT;
+    }
+    for (i = 0; i < N_DFT; i++) Z[i] = X[i] * rshd->Fm[i];
+    Nidft(&det->DFT, Z, cx);
+
+
+    // relativ Peak - Normierung erst zum Schluss;
+    // dann jedoch nicht zwingend corr-Max wenn FM-Amplitude bzw. norm(x) nicht konstant
+    // (z.B. rs41 Signal-Pausen). Moeglicherweise wird dann wahres corr-Max in dem
+    //  K-Fenster nicht erkannt, deshalb K nicht zu gross waehlen.
+    //
+    mx2 = 0.0;                                 // t = L-1
+    for (i = rshd->L-1; i < K+rshd->L; i++) {  // i=t .. i=t+K < t+1+K
+        re_cx = creal(cx[i]);  // imag(cx)=0
+        //if (fabs(re_cx) > fabs(mx)) {
+        if (re_cx*re_cx > mx2) {
+            mx = re_cx;
+            mx2 = mx*mx;
+            mp = i;
+        }
+    }
+    if (mp == rshd->L-1 || mp == K+rshd->L-1) return -4; // Randwert
+    //  mp == t            mp == K+t
+
+    mpos = pos - (K + rshd->L-1) + mp; // t = L-1
+
+    xnorm = 0.0;
+    for (i = 0; i < rshd->L; i++) xnorm += xn[mp-i]*xn[mp-i];
+    xnorm = sqrt(xnorm);
+
+    mx /= xnorm*N_DFT;
+
+    if (det->opt_iq) mpos -= det->lpFMtaps/2;  // lowpass delay
+
+    *maxv = mx;
+    *maxvpos = mpos;
+
+    if (det->opt_dc) {
+        rshd->df = rshd->dc / (2.0*FM_GAIN*det->decM);  // freq offset estimate
+    }
+
+    return mp;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+// IQ-dc
+static float complex iq_dc(dft_detect_t *det, float x, float y) {
+    float complex z = (x - det->avgIQx) + I*(y - det->avgIQy);
+
+    det->sumIQx += x;
+    det->sumIQy += y;
+    det->IQcnt += 1;
+    if (det->IQcnt == det->IQmaxcnt) {
+        det->avgIQx = det->sumIQx/(float)det->IQmaxcnt;
+        det->avgIQy = det->sumIQy/(float)det->IQmaxcnt;
+        det->sumIQx = 0; det->sumIQy = 0; det->IQcnt = 0;
+    }
+
+    return z;
+}
+
+// IF-lowpass
+// a) detect signal bandwidth/center-fq (not reliable), or
+// b) N_bwIQ FM-streams
+//
+// IF filter bank: halfband stages decimate sr -> sr/2 -> sr/4 ...;
+// narrow IF lowpass j and its FM-demod run at sr/decIQ[j],
+// FM-output interpolated (linear) back to sr
+//
+static void iq_bank(dft_detect_t *det, float complex z, float *s) {
+    float complex x[N_stgIQ+1];
+    float complex z_fm, w;
+    double gain = FM_GAIN;
+    int st, nv = 0;
+    int j, D, taps;
+
+    x[0] = z;
+    for (st = 0; st < det->N_stg; st++) {
+        taps = det->stg_taps[st];
+        det->stg_buf[st][det->stg_cnt[st] % taps] = x[st];
+        det->stg_cnt[st] += 1;
+        if (det->stg_cnt[st] % 2) break;  // 2:1
+        x[st+1] = lowpass(det->stg_buf[st], det->stg_cnt[st], taps, det->ws_stg[st]);
+        nv = st+1;
+    }
+
+    for (j = 0; j < N_bwIQ-1; j++) {
+
+        if (det->opt_singleLpIQ && j > 0) {
+            s[j] = s[0];
+            continue;
+        }
+
+        D = det->decIQ[j];
+        if (det->stgIQ[j] <= nv) {
+            taps = det->lpIQtaps[j];
+            det->lpIQ_buf[j][det->lpIQ_cnt[j] % taps] = x[det->stgIQ[j]];
+            det->lpIQ_cnt[j] += 1;
+            z_fm = lowpass(det->lpIQ_buf[j], det->lpIQ_cnt[j], taps, det->ws_lpIQ[j]);
+
+            // IQ: different modulation indices h=h(rs) -> FM-demod
+            w = z_fm * conj(det->z0_fm[j]);
+            det->z0_fm[j] = z_fm;
+            det->s_fm[j][0] = det->s_fm[j][1];
+            det->s_fm[j][1] = gain * carg(w)/M_PI;
+            if (D > 1) det->s_fm[j][1] /= (float)D;  // dphi at sr
+            det->phIQ[j] = 0;
+        }
+
+        if (D > 1) {
+            s[j] = det->s_fm[j][0] + (det->s_fm[j][1] - det->s_fm[j][0]) * det->phIQ[j] / (float)D;
+            det->phIQ[j] += 1;
+        }
+        else s[j] = det->s_fm[j][1];
+    }
+}
+
+// IF sample z (iq) or audio sample _s -> buf_fm[]
+static int f32buf_sample(dft_detect_t *det, float complex z, float _s) {
+    float s[N_bwIQ];
+    float complex w;
+    double gain = FM_GAIN;
+    int i;
+
+    if (det->opt_iq)
+    {
+        iq_bank(det, z, s);
+
+        w = z * conj(det->z0_fm[N_bwIQ-1]);
+        s[N_bwIQ-1] = gain * carg(w)/M_PI;
+        det->z0_fm[N_bwIQ-1] = z;
+    }
+    else
+    {
+        for (i = 0; i < N_bwIQ; i++) s[i] = _s;
+    }
+
+    for (i = 0; i < N_bwIQ; i++) {
+        if (det->opt_inv) s[i]= -s[i];
+        det->buf_fm[i][(det->sample_in + det->M - det->dlyIQ[i]) % det->M] = s[i];
+    }
+
+
+    det->sample_out = det->sample_in - det->delay;
+
+    det->sample_in += 1;
+
+    return 0;
+}
+
+static int read_bufbit(dft_detect_t *det, int symlen, char *bits, unsigned int mvp, int reset, float dc, rsheader_t *rshd) {
+// symlen==2: manchester2 0->10,1->01->1: 2.bit
+
+    int M = det->M;
+    float *bufs = det->buf_fm[rshd->lpIQ];
+
+    double sum = 0.0;
+
+    if (reset) {
+        det->rcount = 0;
+        det->rbitgrenze = 0;
+    }
+
+    // bei symlen=2 (Manchester) kein dc noetig,
+    // allerdings M10-header mit symlen=1
+
+    det->rbitgrenze += rshd->spb;
+    do {
+        sum += bufs[(det->rcount + mvp + M) % M] - dc;
+        det->rcount++;
+    } while (det->rcount < det->rbitgrenze);  // n < spb
+
+    if (symlen == 2) {
+        det->rbitgrenze += rshd->spb;
+        do {
+            sum -= bufs[(det->rcount + mvp + M) % M] - dc;
+            det->rcount++;
+        } while (det->rcount < det->rbitgrenze);  // n < spb
+    }
+
+
+    if (symlen != 2) {
+        if (sum >= 0) *bits = '1';
+        else          *bits = '0';
+    }
+    else {
+        if (sum >= 0) strncpy(bits, "10", 2);
+        else          strncpy(bits, "01", 2);
+    }
+
+    return 0;
+}
+
+static int headcmp(dft_detect_t *det, int symlen, unsigned int mvp, int inv, rsheader_t *rshd) {
+    int errs = 0;
+    int pos;
+    int step = 1;
+    int len = 0;
+    char sign = 0;
+    float dc = 0.0;
+
+    if (det->opt_dc)
+    {
+        dc = rshd->dc;
+    }
+
+    if (symlen != 1) step = 2;
+    if (inv) sign=1;
+
+    len = rshd->hLen;
+    for (pos = 0; pos < len; pos += step) {
+        read_bufbit(det, symlen, det->rawbits+pos, mvp+1-(int)(rshd->hLen*rshd->spb), pos==0, dc, rshd);
+    }
+    det->rawbits[pos] = '\0';
+
+    while (len > 0) {
+        if ((det->rawbits[len-1]^sign) != rshd->header[len-1]) errs += 1;
+        len--;
+    }
+
+    return errs;
+}
+
+
+static ui8_t bits2byte(char *bitstr) {
+    int i, bit, d, byteval;
+    int bitpos;
+
+    bitpos = 0;
+    byteval = 0;
+    d = 1;
+    for (i = 0; i < 8; i++) {
+        //bit=*(bitstr+bitpos+i); /* little endian */
+        bit=*(bitstr+bitpos+7-i);  /* big endian */
+        if         (bit == '1')    byteval += d;
+        else /*if ((bit == '0')*/  byteval += 0;
+        d <<= 1;
+    }
+
+    return byteval & 0xFF;
+}
+
+static int hw(ui8_t byte) {
+    int i;
+    int d = 0;
+    for (i = 0; i < 8; i++) {
+        d += (byte & 1);
+        byte >>= 1;
+    }
+    return d;
+}
+
+static ui32_t frm_M10(dft_detect_t *det, unsigned int mvp, int inv, rsheader_t *rshd) {
+    float dc = 0.0;
+    int pos2;
+    char bit0 = '0';
+    char mb[2];
+    char frmbit[16+1];
+    ui8_t b[2];
+    ui32_t bytes;
+
+    int ofs = (strlen(rshd->header) - 28)/2;
+
+    if (ofs < 0 || ofs > 8) ofs = 0;
+
+    if (det->opt_dc) dc = rshd->dc;
+
+    bit0 = 0x30 + (inv > 0);
+    for (pos2 = 0; pos2 < 16; pos2 += 1) {
+        if (pos2 < ofs) {
+            mb[0] = rshd->header[28+2*pos2] ^ (inv>0);
+        }
+        else {
+            read_bufbit(det, 2, mb, mvp, pos2==ofs, dc, rshd);
+        }
+        frmbit[pos2] = 0x31 ^ (bit0 ^ mb[0]);
+        bit0 = mb[0];
+    }
+    frmbit[pos2] = '\0';
+
+    b[0] = bits2byte(frmbit);
+    b[1] = bits2byte(frmbit+8);
+    bytes = (b[0]<<8) | b[1];
+
+    return bytes;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#define IF_SAMPLE_RATE      48000
+#define IF_SAMPLE_RATE_MIN  32000
+
+#define IF_TRANSITION_BW (4e3)  // 4kHz transition width
+
+#define SQRT2 1.4142135624   // sqrt(2)
+// sigma = sqrt(log(2)) / (2*PI*BT):
+//#define SIGMA 0.2650103635   // BT=0.5: 0.2650103635 , BT=0.3: 0.4416839392
+
+// Gaussian FM-pulse
+static double Q(double x) {
+    return 0.5 - 0.5*erf(x/SQRT2);
+}
+static double pulse(double t, double sigma) {
+    return Q((t-0.5)/sigma) - Q((t+0.5)/sigma);
+}
+
+
+static double norm2_match(float *match, int n) {
+    int i;
+    double x, y = 0.0;
+    for (i = 0; i < n; i++) {
+        x = match[i];
+        y += x*x;
+    }
+    return y;
+}
+
+int dft_detect_init(dft_detect_t *det) {
+
+    int i, j, pos;
+    double t;
+    double b0, b1, b2, b;
+    float normMatch;
+
+    int p2 = 1;
+    int K, L, M;
+    int n, k;
+    float *match = NULL;
+    float *m = NULL;
+
+    double BT = 0.5;
+    double sigma = sqrt(log(2)) / (2*M_PI*BT);
+
+    char *bits = NULL;
+    float spb = 0.0;
+
+    int hLen = 0;
+    int Lmax = 0;
+
+    float set_lpIQ = det->set_lpIQ;
+    int sample_rate = det->sr;
+
+    if (det->opt_iq && det->nch < 2) return -1;
+    if (det->ch < 0 || det->ch >= det->nch) det->ch = 0;
+
+    for (j = 0; j < Nrs; j++) {
+        det->rs_hdr[j] = rs_hdr0[j];
+        if (det->thres > 0) det->rs_hdr[j].thres = det->thres;
+    }
+    for (j = 0; j < 2; j++) det->lpFM_bw[j] = lpFM_bw[j];
+    for (j = 0; j < N_bwIQ; j++) det->lpIQ_bw[j] = det->opt_Lband ? lpIQ_bw_L[j] : lpIQ_bw[j];
+    for (j = 0; j < N_bwIQ; j++) det->dlyIQ[j] = 0;
+
+    det->idx_MTS01 = -1;
+    det->idx_C34C50 = -1;
+    det->idx_WXR301 = -1;
+    det->idx_WXRPN9 = -1;
+    det->idx_IMET1AB = -1;
+
+    det->sr_base = sample_rate;
+    det->sr_if = sample_rate;
+    det->decM = 1;
+
+
+    if (det->opt_iq == 5)
+    {
+        int IF_sr = IF_SAMPLE_RATE; // designated IF sample rate
+        int decM = 1; // decimate M:1
+        int sr_base = sample_rate;
+        float f_lp; // dec_lowpass: lowpass_bw/2
+        float t_bw; // dec_lowpass: transition_bw
+        int taps; // dec_lowpass: taps
+        int wideIF = 0;
+
+        if (set_lpIQ > IF_sr) IF_sr = set_lpIQ;
+
+        wideIF = IF_sr > 60e3;
+
+        if (det->opt_min) IF_sr = IF_SAMPLE_RATE_MIN;
+        if (IF_sr > sr_base) IF_sr = sr_base;
+        if (IF_sr < sr_base) {
+            while (sr_base % IF_sr) IF_sr += 1;
+            decM = sr_base / IF_sr;
+        }
+
+        f_lp = (IF_sr+20e3)/(4.0*sr_base);    // IF=48k
+        t_bw = (IF_sr-20e3)/*/2.0*/;
+        if (wideIF) {                         // IF=96k
+            f_lp = (IF_sr+60e3)/(4.0*sr_base);
+            t_bw = (IF_sr-60e3)/*/2.0*/;
+        }
+        else
+        if (det->opt_min) {
+            t_bw = (IF_sr-12e3);
+        }
+        if (t_bw < 0) t_bw = 10e3;
+        t_bw /= sr_base;
+        taps = 4.0/t_bw; if (taps%2==0) taps++;
+
+        taps = lowpass_init(f_lp, taps, &det->ws_dec);
+        if (taps < 0) return -1;
+        det->dectaps = taps;
+
+        det->sr_base = sr_base;
+        sample_rate = IF_sr; // sr_base/decM
+        det->decM = decM;
+
+        det->sr_if = IF_sr;
+
+        fprintf(stderr, "IF: %d\n", IF_sr);
+        fprintf(stderr, "dec: %d\n", decM);
+    }
+    if (det->opt_iq == 5)
+    {
+        // look up table, exp-rotation
+        int W = 2*8; // 16 Hz window
+        int d = 1; // 1..W , groesster Teiler d <= W von sr_base
+        int freq = (int)( det->xlt_fq * (double)det->sr_base + 0.5);
+        int freq0 = freq; // init
+        double f0 = freq0 / (double)det->sr_base; // init
+
+        for (d = W; d > 0; d--) { // groesster Teiler d <= W von sr
+            if (det->sr_base % d == 0) break;
+        }
+        if (d == 0) d = 1; // d >= 1 ?
+
+        for (k = 0; k < W/2; k++) {
+            if ((freq+k) % d == 0) {
+                freq0 = freq + k;
+                break;
+            }
+            if ((freq-k) % d == 0) {
+                freq0 = freq - k;
+                break;
+            }
+        }
+
+        det->lut_len = det->sr_base / d;
+        f0 = freq0 / (double)det->sr_base;
+
+        det->ex = calloc(det->lut_len+1, sizeof(float complex));
+        if (det->ex == NULL) return -1;
+        for (n = 0; n < det->lut_len; n++) {
+            t = f0*(double)n;
+            det->ex[n] = cexp(t*2*M_PI*I);
+        }
+
+
+        det->decXbuffer = calloc( det->dectaps+1, sizeof(float complex));
+        if (det->decXbuffer == NULL) return -1;
+    }
+
+
+    if (det->opt_iq)
+    {
+        float f_lp; // lowpass_bw
+        int taps; // lowpass taps: 4*sr/transition_bw
+
+        // FM lowpass -> xn[] in getCorrDFT()
+        taps = 4*sample_rate/2e3; if (taps%2==0) taps++; // 2kHz transition
+        //
+        f_lp = det->lpFM_bw[0]/(float)sample_rate;  // RS41,DFM: 4kHz (FM-audio)
+        taps = lowpass_init(f_lp, taps, &det->ws_lpFM[0]); if (taps < 0) return -1;
+        //
+        f_lp = det->lpFM_bw[1]/(float)sample_rate;  // M10: 10kHz (FM-audio)
+        taps = lowpass_init(f_lp, taps, &det->ws_lpFM[1]); if (taps < 0) return -1;
+        //
+        det->lpFMtaps = taps;
+
+        // IF lowpass
+        if (set_lpIQ > 100.0) { // set_lpIQ > 100Hz: overwrite lpIQ_bw[]
+            det->lpIQ_bw[0] = set_lpIQ;
+            det->lpIQ_bw[1] = set_lpIQ;
+            det->lpIQ_bw[2] = set_lpIQ;
+            det->opt_singleLpIQ = 1;
+        }
+        // lpIQ_bw[0]: MTS01: 6kHz (IF/IQ)
+        // lpIQ_bw[1]: RS41,DFM: 12kHz (IF/IQ)
+        // lpIQ_bw[2]: M10: 22kHz (IF/IQ)
+        det->N_stg = 0;
+        for (j = 0; j < N_bwIQ-1; j++) {
+            float sr_j;
+            int st = 0;
+            int rs_max = 0;
+            // FM-demod at sr_j and linear interpolation: sr_j >= 4*baud of the headers on branch j
+            for (k = 0; k < Nrs; k++) {
+                if ((det->opt_singleLpIQ || det->rs_hdr[k].lpIQ == j) && det->rs_hdr[k].sps > rs_max) rs_max = det->rs_hdr[k].sps;
+            }
+            // decimate as long as sr_j >= bw + 2*transition
+            while ( !det->opt_1rate && st < N_stgIQ
+                    && sample_rate/(float)(2<<st) >= det->lpIQ_bw[j] + 2*IF_TRANSITION_BW
+                    && sample_rate/(float)(2<<st) >= 4*rs_max ) st++;
+            if (det->opt_singleLpIQ && j > 0) st = 0;
+            det->stgIQ[j] = st;
+            det->decIQ[j] = 1 << st;
+            if (st > det->N_stg) det->N_stg = st;
+
+            sr_j = sample_rate/(float)det->decIQ[j];
+            taps = 4*sr_j/IF_TRANSITION_BW; if (taps%2==0) taps++;
+            f_lp = det->lpIQ_bw[j]/sr_j/2.0;
+            taps = lowpass_init(f_lp, taps, &det->ws_lpIQ[j]); if (taps < 0) return -1;
+            det->lpIQtaps[j] = taps;
+            det->lpIQ_buf[j] = calloc( taps+3, sizeof(float complex));
+            if (det->lpIQ_buf[j] == NULL) return -1;
+        }
+        // halfband stages: cutoff sr_out/2, alias-free up to max(lpIQ_bw)/2 + transition/2
+        for (j = 0; j < det->N_stg; j++) {
+            float sr_in = sample_rate/(float)(1<<j);
+            float bw = 0.0, t_bw;
+            for (k = 0; k < N_bwIQ-1; k++) {
+                if (det->stgIQ[k] > j && det->lpIQ_bw[k] > bw) bw = det->lpIQ_bw[k];
+            }
+            t_bw = sr_in/2.0 - bw - IF_TRANSITION_BW;
+            if (t_bw < IF_TRANSITION_BW) t_bw = IF_TRANSITION_BW;
+            taps = 6*sr_in/t_bw; if (taps%2==0) taps++; // Blackman: transition ~5.5*sr/taps
+            taps = lowpass_init(0.25, taps, &det->ws_stg[j]); if (taps < 0) return -1;
+            det->stg_taps[j] = taps;
+            det->stg_buf[j] = calloc( taps+3, sizeof(float complex));
+            if (det->stg_buf[j] == NULL) return -1;
+        }
+        // align branch j with the single-rate lowpass (delay (taps-1)/2, taps = 4*sr/transition):
+        // halfband stages + lowpass at sr/D + FM-demod over D samples + linear interpolation (D)
+        for (j = 0; j < N_bwIQ-1; j++) {
+            int D = det->decIQ[j];
+            float dly;
+            taps = 4*sample_rate/IF_TRANSITION_BW; if (taps%2==0) taps++;
+            dly = -(taps-1)/2;
+            for (k = 0; k < det->stgIQ[j]; k++) dly += (det->stg_taps[k]-1)/2 * (1<<k);
+            dly += (det->lpIQtaps[j]-1)/2 * D;
+            if (D > 1) dly += (D-1)/2.0 + D;
+            det->dlyIQ[j] = dly > 0 ? dly + 0.5 : 0;
+            if (det->opt_singleLpIQ && j > 0) det->dlyIQ[j] = det->dlyIQ[0];  // s[j] = s[0]
+        }
+    }
+
+    det->sumIQx = 0; det->sumIQy = 0;
+    det->avgIQx = 0; det->avgIQy = 0;
+    det->IQcnt = 0;
+    det->IQmaxcnt = sample_rate/32;
+    if (det->decM > 1) det->IQmaxcnt *= det->decM;
+
+
+    for (j = 0; j < Nrs; j++) {
+        #ifdef NOMTS01
+        if ( strncmp(det->rs_hdr[j].type, "MTS01", 5) == 0 ) det->idx_MTS01 = j;
+        #endif
+        #ifdef NOC34C50
+        if ( strncmp(det->rs_hdr[j].type, "C34C50", 6) == 0 ) det->idx_C34C50 = j;
+        #endif
+        #ifdef NOWXR301
+        if ( strncmp(det->rs_hdr[j].type, "WXR301", 5) == 0 ) det->idx_WXR301 = j;
+        if ( strncmp(det->rs_hdr[j].type, "WXRPN9", 5) == 0 ) det->idx_WXRPN9 = j;
+        #endif
+        #ifdef NOIMET1AB
+        if ( strncmp(det->rs_hdr[j].type, "IMET1AB", 7) == 0 ) det->idx_IMET1AB = j;
+        #endif
+    }
+
+    for (j = 0; j < Nrs; j++) {
+        rsheader_t *rshd = det->rs_hdr+j;
+        rshd->spb = sample_rate/(float)rshd->sps;
+        rshd->hLen = strlen(rshd->header);
+        rshd->L = rshd->hLen * rshd->spb + 0.5;
+        if (j != det->idx_MTS01 && j != det->idx_C34C50 && j != det->idx_WXR301 && j != det->idx_WXRPN9 && j != det->idx_IMET1AB) {
+            if (rshd->hLen > hLen) hLen = rshd->hLen;
+            if (rshd->L > Lmax) Lmax = rshd->L;
+        }
+    }
+
+    // L = hLen * sample_rate/2500.0 + 0.5; // max(hLen*spb)
+    L = 2*Lmax;
+
+    M = 3*L;
+    //if (samples_per_bit < 6) M = 6*N;
+
+    det->sample_in = 0;
+
+    p2 = 1;
+    while (p2 < M) p2 <<= 1;
+    while (p2 < 0x2000) p2 <<= 1;  // or 0x4000, if sample not too short
+    det->DFT.sr = det->sr;
+    det->DFT.N = p2;
+    K = det->DFT.N - L;
+    det->DFT.LOG2N = log(det->DFT.N)/log(2)+0.1; // 32bit cpu ... intermediate floating-point precision
+    //while ((1 << LOG2N) < N_DFT) LOG2N++;  // better N_DFT = (1 << LOG2N) ...
+
+    det->delay = L/16;
+    det->M = det->DFT.N + det->delay + 8; // L+K < M
+    for (j = 0; j < N_bwIQ; j++) {
+        if (det->dlyIQ[j] > det->delay) det->dlyIQ[j] = det->delay; // buf_fm[] complete up to sample_out
+    }
+    det->K = K;
+    det->sr = sample_rate;
+
+
+    det->rawbits = (char *)calloc( hLen+1, sizeof(char)); if (det->rawbits == NULL) return -100;
+    for (j = 0; j < N_bwIQ; j++) {
+        det->buf_fm[j]  = (float *)calloc( det->M+1, sizeof(float)); if (det->buf_fm[j]  == NULL) return -100;
+    }
+    det->bufs = det->buf_fm[N_bwIQ-1];
+
+
+    det->DFT.xn = calloc(det->DFT.N+1, sizeof(float));  if (det->DFT.xn == NULL) return -1;
+    det->db = calloc(det->DFT.N+1, sizeof(float));  if (det->db == NULL) return -1;
+
+    det->DFT.ew = calloc(det->DFT.LOG2N+1, sizeof(float complex));  if (det->DFT.ew == NULL) return -1;
+    det->DFT.X  = calloc(det->DFT.N+1, sizeof(float complex));  if (det->DFT.X  == NULL) return -1;
+    det->DFT.Z  = calloc(det->DFT.N+1, sizeof(float complex));  if (det->DFT.Z  == NULL) return -1;
+    det->DFT.cx = calloc(det->DFT.N+1, sizeof(float complex));  if (det->DFT.cx == NULL) return -1;
+
+    for (n = 0; n < det->DFT.LOG2N; n++) {
+        k = 1 << n;
+        det->DFT.ew[n] = cexp(-I*M_PI/(float)k);
+    }
+
+    match = (float *)calloc( L+1, sizeof(float)); if (match == NULL) return -1;
+    m = (float *)calloc(det->DFT.N+1, sizeof(float));  if (m  == NULL) return -1;
+
+
+    for (j = 0; j < idxRS; j++)
+    {
+        rsheader_t *rshd = det->rs_hdr+j;
+        rshd->Fm = (float complex *)calloc(det->DFT.N+1, sizeof(float complex));  if (rshd->Fm == NULL) return -1;
+        bits = rshd->header;
+        spb = rshd->spb;
+        sigma = sqrt(log(2)) / (2*M_PI*rshd->BT);
+
+        for (i = 0; i < rshd->L; i++) {
+
+            pos = i/spb;
+            t = (i - pos*spb)/spb - 0.5;
+
+            b1 = ((bits[pos] & 0x1) - 0.5)*2.0;
+            b = b1*pulse(t, sigma);
+
+            if (pos > 0) {
+                b0 = ((bits[pos-1] & 0x1) - 0.5)*2.0;
+                b += b0*pulse(t+1, sigma);
+            }
+
+            if (pos < hLen-1) {
+                b2 = ((bits[pos+1] & 0x1) - 0.5)*2.0;
+                b += b2*pulse(t-1, sigma);
+            }
+
+            match[i] = b;
+        }
+
+        normMatch = sqrt(norm2_match(match, rshd->L));
+        for (i = 0; i < rshd->L; i++) {
+            match[i] /= normMatch;
+        }
+
+        for (i = 0; i < rshd->L; i++) m[rshd->L-1 - i] = match[i]; // t = L-1
+        while (i < det->DFT.N) m[i++] = 0.0;
+        rdft(&det->DFT, m, rshd->Fm);
+
+    }
+
+
+    if (det->opt_iq)
+    {
+        for (j = 0; j < 2; j++) {
+            det->WS[j] = (float complex *)calloc(det->DFT.N+1, sizeof(float complex));  if (det->WS[j] == NULL) return -1;
+            for (i = 0; i < det->lpFMtaps; i++) m[i] = det->ws_lpFM[j][i];
+            while (i < det->DFT.N) m[i++] = 0.0;
+            rdft(&det->DFT, m, det->WS[j]);
+        }
+    }
+
+
+    free(match); match = NULL;
+    free(m); m = NULL;
+
+
+    for (j = 0; j < Nrs; j++) {
+        det->mv[j] = 0.0;
+        det->mv_pos[j] = 0;
+        det->mv0_pos[j] = 0;
+        det->mp[j] = 0;
+        det->rs_detect2[j] = 0;
+    }
+    det->d2_tn = Nrs;
+    det->j_max = 0;
+    det->mv_max = 0.0;
+    det->k = 0;
+    det->n_hits = 0;
+    det->header_found = 0;
+    det->imet_j = -1;
+    det->done = 0;
+
+    if (det->opt_d2) det->opt_cont = 0;
+    if (det->opt_seq) {
+        det->opt_cont = 0;
+        det->opt_d2 = 0;
+        seq_init(det);
+    }
+
+    return K;
+}
+
+int dft_detect_free(dft_detect_t *det) {
+    int j;
+
+    for (j = 0; j < N_bwIQ; j++) {
+        if (det->buf_fm[j])  { free(det->buf_fm[j]);  det->buf_fm[j]  = NULL; }
+    }
+
+    if (det->rawbits) { free(det->rawbits); det->rawbits = NULL; }
+
+    if (det->DFT.xn) { free(det->DFT.xn); det->DFT.xn = NULL; }
+    if (det->db) { free(det->db); det->db = NULL; }
+    if (det->DFT.ew) { free(det->DFT.ew); det->DFT.ew = NULL; }
+    if (det->DFT.X)  { free(det->DFT.X);  det->DFT.X  = NULL; }
+    if (det->DFT.Z)  { free(det->DFT.Z);  det->DFT.Z  = NULL; }
+    if (det->DFT.cx) { free(det->DFT.cx); det->DFT.cx = NULL; }
+
+    for (j = 0; j < idxRS; j++) {
+        if (det->rs_hdr[j].Fm) { free(det->rs_hdr[j].Fm); det->rs_hdr[j].Fm = NULL; }
+    }
+
+
+    // iq buffers
+
+    if (det->ws_dec) { free(det->ws_dec); det->ws_dec = NULL; }
+    if (det->decXbuffer) { free(det->decXbuffer); det->decXbuffer = NULL; }
+    if (det->ex) { free(det->ex); det->ex = NULL; }
+
+    for (j = 0; j < 2; j++) {
+        if (det->ws_lpFM[j]) { free(det->ws_lpFM[j]); det->ws_lpFM[j] = NULL; }
+        if (det->WS[j]) { free(det->WS[j]); det->WS[j] = NULL; }
+    }
+
+    for (j = 0; j < N_bwIQ-1; j++) {
+        if (det->ws_lpIQ[j]) { free(det->ws_lpIQ[j]); det->ws_lpIQ[j] = NULL; }
+        if (det->lpIQ_buf[j]) { free(det->lpIQ_buf[j]); det->lpIQ_buf[j] = NULL; }
+    }
+    for (j = 0; j < N_stgIQ; j++) {
+        if (det->ws_stg[j]) { free(det->ws_stg[j]); det->ws_stg[j] = NULL; }
+        if (det->stg_buf[j]) { free(det->stg_buf[j]); det->stg_buf[j] = NULL; }
+    }
+
+
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------ */
+
+// header j found (after type checks)
+static void header_hit(dft_detect_t *det, int j) {
+    rsheader_t *rshd = det->rs_hdr+j;
+    float mv = det->mv[j];
+
+    if (det->opt_seq) {
+        seq_add(det, j, det->seq_llr_hit*fabs(mv)/rshd->thres, mv);
+        det->seq_hit[j] = 1;
+        return;
+    }
+
+    if (!det->opt_silent && (mv > rshd->thres || mv < -rshd->thres)) {
+        if (det->opt_d2) {
+            det->rs_detect2[j] += 1;
+            det->d2_tn = rs_d2(det);
+            if ( det->d2_tn == Nrs ) det->header_found = 0;
+        }
+        if ( !det->opt_d2 || j == det->d2_tn ) {
+            dft_hit_t *hit = det->hits + det->n_hits;
+            hit->j = j;
+            hit->type = rshd->type;
+            hit->tn = rshd->tn;
+            hit->mv = mv;
+            hit->pos = det->mv_pos[j];
+            hit->df = rshd->df;
+            det->n_hits += 1;
+        }
+    }
+    // if ((j < 3) && mv < 0) header_found = -1;
+
+    if ( fabs(det->mv_max) < fabs(mv) ) { // j-weights?
+        det->mv_max = mv;
+        det->j_max = j;
+    }
+}
+
+// IMETafsk: tone analysis over 1 sec after preamble
+static int imet_afsk(dft_detect_t *det) {
+    int n, m;
+    int j = det->imet_j;
+    int N_DFT = det->DFT.N;
+    float df;
+    float pow2200, pow2400;
+    int bin2200, bin2400;
+    float *db = det->db;
+
+    det->imet_j = -1;
+
+    df = bin2freq(det, 1);
+    m = 50.0/df;
+    if (m < 1) m = 1;
+    if (freq2bin(det, 2500) > N_DFT/2) {
+        det->done = 1;
+        return -1;
+    }
+
+    bin2200 = freq2bin(det, 2200);
+    pow2200 = 0.0;
+    for (n = 0; n < m; n++) pow2200 += db[ bin2200 - m/4 + n ];
+
+    bin2400 = freq2bin(det, 2400);
+    pow2400 = 0.0;
+    for (n = 0; n < m; n++) pow2400 += db[ bin2400 - m/4 + n ];
+
+
+    det->mv[j] = fabs(det->mv[j]);
+
+    if (pow2200 > pow2400) {  // IMET1RS: peak1: 1200Hz > peak2: 2200Hz > pow(800Hz)
+        int bin800 = freq2bin(det, 800);
+        float pow800 = 0.0;
+        for (n = 0; n < m; n++) pow800 += db[ bin800 - m/4 + n ];
+        if (pow2200 > pow800) { // IMET -> IMET1RS/IMET4
+            int _j0 = j;
+            if (det->opt_iq && det->set_lpIQ > 50e3) j = idxRS; else j = idxI4;
+            det->mv[j] = det->mv[_j0];
+            det->mv_pos[j] = det->mv_pos[_j0];
+            det->rs_hdr[j].dc = det->rs_hdr[_j0].dc;
+            det->rs_hdr[j].df = det->rs_hdr[_j0].df;
+            det->mv[_j0] = 0.0;
+            det->header_found = 1;
+            header_hit(det, j);
+        }
+        else det->mv[j] = 0.0;
+    }
+    else { // IMET -> IMET1AB ?
+        // IMET1AB post-processing might block MRZ detection
+        // skip after number of tries or detect imet1ab directly
+        //
+        det->mv[j] = 0.0;
+    }
+
+    return 0;
+}
+
+static void imet_sample(dft_detect_t *det) {
+    int m;
+    int D = det->DFT.N/2 - 3;
+
+    det->DFT.xn[det->imet_n % D] = det->buf_fm[det->rs_hdr[det->imet_j].lpIQ][det->sample_out % det->M];
+    det->imet_n++;
+
+    if (det->imet_n % D == 0) {
+        rdft(&det->DFT, det->DFT.xn, det->DFT.X);
+        for (m = 0; m < det->DFT.N; m++) det->db[m] += cabs(det->DFT.X[m]);
+    }
+}
+
+static void window_end(dft_detect_t *det) {
+    int j;
+
+    if (det->opt_seq) {
+        for (j = 0; j < Nrs; j++) {
+            if (!det->seq_skip[j] && !det->seq_hit[j]) seq_add(det, j, det->seq_llr_miss, 0.0);
+        }
+        det->seq_j = seq_decide(det);
+        if (det->seq_j != -1) det->done = 1;
+        det->header_found = 0;
+    }
+
+    if (det->header_found && !det->opt_cont || det->d2_tn < Nrs) det->done = 1;
+    det->header_found = 0;
+    for (j = 0; j < Nrs; j++) det->mv[j] = 0.0;
+}
+
+static void window(dft_detect_t *det) {
+    int j;
+    int herrs;
+    float *mv = det->mv;
+    rsheader_t *rs_hdr = det->rs_hdr;
+
+    for (j = 0; j <= idxIMETafsk; j++) { // incl. IMET-preamble
+
+        if ( j == det->idx_MTS01 ) continue;   // only ifdef NOMTS01
+        if ( j == det->idx_C34C50 ) continue;  // only ifdef NOC34C50
+        if ( j == det->idx_WXR301 ) continue;  // only ifdef NOWXR301
+        if ( j == det->idx_WXRPN9 ) continue;  // only ifdef NOWXR301
+        if ( j == det->idx_IMET1AB ) continue; // only ifdef NOIMET1AB
+
+        det->mv0_pos[j] = det->mv_pos[j];
+        det->mp[j] = getCorrDFT(det, det->K, 0, mv+j, det->mv_pos+j, rs_hdr+j);
+    }
+
+    if (det->opt_seq) {
+        for (j = 0; j < Nrs; j++) det->seq_hit[j] = 0;
+    }
+
+    det->header_found = 0;
+    for (j = 0; j <= idxIMETafsk; j++) // incl. IMET-preamble
+    {
+        if (det->opt_seq && det->mp[j] > 0 && det->mv_pos[j] > det->mv0_pos[j]
+            && fabs(mv[j]) > SEQ_WEAK*rs_hdr[j].thres && fabs(mv[j]) <= rs_hdr[j].thres)
+        {
+            herrs = headcmp(det, 1, det->mv_pos[j], mv[j]<0, rs_hdr+j);
+            if (herrs < 2*rs_hdr[j].herrs) {
+                seq_add(det, j, SEQ_LLR_WEAK, mv[j]);
+                det->seq_hit[j] = 1;
+            }
+        }
+        else
+        if (det->mp[j] > 0 && (mv[j] > rs_hdr[j].thres || mv[j] < -rs_hdr[j].thres)) {
+            if (det->mv_pos[j] > det->mv0_pos[j]) {
+
+                herrs = headcmp(det, 1, det->mv_pos[j], mv[j]<0, rs_hdr+j);
+                if (herrs < rs_hdr[j].herrs)    // max bit-errors in header
+                {
+                    if ( strncmp(rs_hdr[j].type, "M10", 3) == 0 || strncmp(rs_hdr[j].type, "M20", 3) == 0)
+                    {
+                        ui32_t bytes = frm_M10(det, det->mv_pos[j], mv[j]<0, rs_hdr+j);
+                        int len = (bytes >> 8) & 0xFF;
+                        int h = hw(bytes & 0x0F); // type byte xF or x0 ?
+                        if (h < 2 || h == 2 && (bytes&0xF0) == 0x20) {
+                            rs_hdr[j].type = "M20";
+                            rs_hdr[j].tn = tn_M20;  // M20: 45 20
+                        }
+                        else {
+                            rs_hdr[j].type = "M10";
+                            rs_hdr[j].tn = tn_M10;  // M10: 64 9F , M10+: 64 AF , M10-dop: 64 49  (len > 0x60)
+                        }
+                    }
+
+                    if ( strncmp(rs_hdr[j].type, "IMETafsk", 8) == 0 ) // ? j == idxIMETafsk
+                    {
+                        int n;
+                        for (n = 0; n < det->DFT.N; n++) {
+                            det->DFT.xn[n] = 0.0;
+                            det->db[n] = 0.0;
+                        }
+                        det->imet_j = j;
+                        det->imet_n = 0;
+                        return; // j == idxIMETafsk: last in window
+                    }
+                    else { // if not IMET
+                        det->header_found = 1;
+                        header_hit(det, j);
+                    }
+                }
+            }
+        }
+    }
+
+    window_end(det);
+}
+
+// x: nch interleaved float samples per frame; n=0: end of input
+int dft_detect_feed(dft_detect_t *det, float *x, int n) {
+    int i;
+    float complex z = 0;
+    float s = 0.0;
+
+    det->n_hits = 0;
+
+    if (n <= 0) {
+        if (det->imet_j >= 0 && !det->done) {  // EOF: finish IMET with samples so far
+            imet_afsk(det);
+            window_end(det);
+        }
+        det->done = 1;
+        return 0;
+    }
+
+    for (i = 0; i < n && !det->done; i++) {
+
+        float *f = x + i*det->nch;
+
+        if (det->opt_iq)
+        {
+            z = iq_dc(det, f[0], f[1]);
+            if (det->opt_iq == 5) { // baseband decimation
+                det->decXbuffer[det->sample_decX] = z * det->ex[det->sample_decM];
+                det->sample_decM += 1; if (det->sample_decM >= det->lut_len) det->sample_decM = 0;
+                det->sample_decX += 1; if (det->sample_decX >= det->dectaps) det->sample_decX = 0;
+                det->decMcnt += 1;
+                if (det->decMcnt < det->decM) continue;
+                det->decMcnt = 0;
+                z = lowpass(det->decXbuffer, det->sample_decX, det->dectaps, det->ws_dec);
+            }
+        }
+        else s = f[det->ch];
+
+        f32buf_sample(det, z, s);
+
+        if (det->imet_j >= 0) {
+            if (det->imet_n < det->sr) imet_sample(det);
+            if (det->imet_n >= det->sr) {
+                imet_afsk(det);
+                if (!det->done) window_end(det);
+                if (det->n_hits > 0) { i++; break; }
+            }
+            continue;
+        }
+
+        if (det->tl > 0 && det->sample_in > (det->tl+1)*det->sr) {  // (int)sample_out < 0
+            det->done = 1;
+            i++;
+            break;
+        }
+
+        det->k += 1;
+
+        if (det->k >= det->K-4) {
+            det->k = 0;
+            window(det);
+            if (det->n_hits > 0) { i++; break; }
+        }
+    }
+
+    return i;
+}
+
+int dft_detect_result(dft_detect_t *det) {
+    int header_found = 0;
+    int j_max = det->j_max;
+    float mv_max = det->mv_max;
+
+    if (det->opt_seq) {
+        if (det->seq_j >= 0) {
+            j_max = det->seq_j;
+            mv_max = det->seq_mv[j_max];
+        }
+        else mv_max = 0.0;
+    }
+
+    // return only best result
+    // latest: j
+    if (mv_max) {
+        if (mv_max < 0 && j_max < 3) header_found = -1;
+        else header_found = 1;
+    }
+    else header_found = 0;
+
+    return (header_found * det->rs_hdr[j_max].tn);
+}
+
@@ -0,0 +1,175 @@
+#include <math.h>
+#include <complex.h>
+
+#include "../demod/mod/dsp_mod.h"
+
+
+#define N_bwIQ  4
+#define N_stgIQ 4  // IF filter bank: max decimation 1<<N_stgIQ
+#define Nrs    17
+
+
+typedef struct {
+    int sps;  // header: symbol rate, baud
+    int hLen;
+    int L;
+    char *header;
+    float BT;
+    float spb;
+    float thres;
+    int herrs;
+    float complex *Fm;
+    char *type;
+    int tn;
+    int lpFM;
+    int lpIQ;
+    float dc;
+    float df; // Df = df*sr_base;
+} rsheader_t;
+
+
+// detection: rs_hdr[j] found in window
+typedef struct {
+    int j;
+    char *type;
+    int tn;
+    float mv;
+    ui32_t pos;
+    float df; // freq offset estimate, rel. to sr_base
+} dft_hit_t;
+
+
+typedef struct {
+    // input
+    int sr;       // sample_rate (after init: IF sample rate)
+    int nch;      // channels (interleaved float frames)
+    int ch;       // select audio channel
+    //
+    int opt_iq;   // 1: IF iq-data, 5: baseband IQ at xlt_fq
+    int opt_dc;
+    int opt_min;  // IF_SAMPLE_RATE_MIN
+    int opt_inv;
+    int opt_Lband;
+    int opt_cont;
+    int opt_d2;
+    int opt_silent;
+    int opt_1rate;  // IF lowpass/FM-demod at full IF rate (no filter bank)
+    int opt_seq;  // sequential detection
+    float seq_conf;
+    float tl;     // time limit (sec)
+    float thres;  // > 0: overwrite rs_hdr[].thres
+    float set_lpIQ;
+    double xlt_fq;
+
+    // headers
+    rsheader_t rs_hdr[Nrs];
+    int idx_MTS01;
+    int idx_C34C50;
+    int idx_WXR301;
+    int idx_WXRPN9;
+    int idx_IMET1AB;
+
+    // buffers
+    int sr_base;
+    int sr_if;
+    ui32_t sample_in;
+    ui32_t sample_out;
+    ui32_t delay;
+    int M;
+    int K;
+    int k;
+    float *buf_fm[N_bwIQ];
+    float *bufs;
+    char *rawbits;
+    ui32_t rcount;
+    float rbitgrenze;
+
+    // DFT
+    dft_t DFT;
+    float *db;
+
+    // IQ-dc
+    double sumIQx;
+    double sumIQy;
+    float avgIQx;
+    float avgIQy;
+    ui32_t IQcnt;
+    ui32_t IQmaxcnt;
+
+    // decimation
+    int decM;
+    ui32_t dectaps;
+    ui32_t sample_decX;
+    ui32_t sample_decM;
+    ui32_t lut_len;
+    int decMcnt;
+    float *ws_dec;
+    float complex *decXbuffer;
+    float complex *ex; // exp_lut
+
+    // FM: lowpass
+    float lpFM_bw[2];
+    float *ws_lpFM[2];
+    int lpFMtaps; // ui32_t
+    float complex *WS[2];
+    // IF: lowpass
+    float lpIQ_bw[N_bwIQ];
+    int opt_singleLpIQ;
+    float *ws_lpIQ[N_bwIQ]; // only N_bwIQ-1 used
+    int lpIQtaps[N_bwIQ]; // ui32_t
+    ui32_t lpIQ_cnt[N_bwIQ];
+    float complex *lpIQ_buf[N_bwIQ];
+    float complex z0_fm[N_bwIQ];
+    // IF: multi-rate filter bank
+    // halfband stages sr -> sr/2 -> sr/4 ..., IF lowpass j and FM-demod at sr/decIQ[j]
+    int decIQ[N_bwIQ];
+    int stgIQ[N_bwIQ];    // decIQ[j] = 1<<stgIQ[j]
+    int phIQ[N_bwIQ];
+    float s_fm[N_bwIQ][2];
+    int dlyIQ[N_bwIQ];    // extra delay of branch j vs. single-rate lowpass, buf_fm[j] written back by dlyIQ[j]
+    int N_stg;
+    int stg_taps[N_stgIQ];
+    ui32_t stg_cnt[N_stgIQ];
+    float *ws_stg[N_stgIQ];
+    float complex *stg_buf[N_stgIQ];
+
+    // window results
+    float mv[Nrs];
+    ui32_t mv_pos[Nrs];
+    ui32_t mv0_pos[Nrs];
+    int mp[Nrs];
+    int header_found;
+    int n_hits;
+    dft_hit_t hits[Nrs];
+    int j_max;
+    float mv_max;
+    int done;
+
+    // IMETafsk: 1 sec tone analysis
+    int imet_j;
+    int imet_n;
+
+    // -d2
+    int rs_detect2[Nrs];
+    int d2_tn;
+
+    // --seq
+    double seq_llr[Nrs];
+    float seq_mv[Nrs];
+    float seq_df[Nrs];
+    char seq_skip[Nrs];
+    char seq_hit[Nrs];
+    double seq_llr_hit;
+    double seq_llr_miss;
+    double seq_lo;
+    int seq_j;
+
+} dft_detect_t;
+
+
+int dft_detect_init(dft_detect_t *);
+int dft_detect_feed(dft_detect_t *, float *, int);
+int dft_detect_result(dft_detect_t *);
+int dft_detect_report(dft_detect_t *, FILE *);
+int dft_detect_free(dft_detect_t *);
+
@@ -68,6 +68,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 
 #include "fsk.h"
@@ -165,8 +166,17 @@ struct FSK * fsk_create_core(int Fs, int Rs, int M, int P, int Nsym, int tx_f1,
     fsk->f_dc = (COMP*)malloc(M*fsk->Nmem*sizeof(COMP)); assert(fsk->f_dc != NULL);
     for(i=0; i<M*fsk->Nmem; i++)
         fsk->f_dc[i] = comp0();
+    fsk->f_dc_cs = (double*)malloc(2*M*(fsk->Nmem+1)*sizeof(double)); assert(fsk->f_dc_cs != NULL);
+    fsk->f_int = (COMP*)malloc(M*(fsk->Nsym+1)*fsk->P*sizeof(COMP)); assert(fsk->f_int != NULL);
         
     fsk->fft_cfg = kiss_fft_alloc(Ndft,0,NULL,NULL); assert(fsk->fft_cfg != NULL);    
+    fsk->fftr_cfg = kiss_fftr_alloc(Ndft,0,NULL,NULL); assert(fsk->fftr_cfg != NULL);
+    fsk->fft_in  = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*Ndft); assert(fsk->fft_in != NULL);
+    fsk->fft_out = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*Ndft); assert(fsk->fft_out != NULL);
+    fsk->fft_rin = (float*)malloc(sizeof(float)*Ndft); assert(fsk->fft_rin != NULL);
+    fsk->Sf_pk = (float*)malloc(sizeof(float)*Ndft); assert(fsk->Sf_pk != NULL);
+    fsk->real_input = 0;
+    fsk->fft_shared = 0;
     fsk->Sf = (float*)malloc(sizeof(float)*fsk->Ndft); assert(fsk->Sf != NULL);
     
     #ifdef USE_HANN_TABLE
@@ -179,6 +189,17 @@ struct FSK * fsk_create_core(int Fs, int Rs, int M, int P, int Nsym, int tx_f1,
     #endif
     
     for(i=0;i<Ndft;i++)fsk->Sf[i] = 0;
+
+    /* tone mask for freq est method 2, 3 bins at each tone spacing */
+    fsk->mask = (float*)malloc(sizeof(float)*Ndft); assert(fsk->mask != NULL);
+    for(i=0; i<Ndft; i++) fsk->mask[i] = 0.0;
+    for(i=0; i<3; i++) fsk->mask[i] = 1.0;
+    int bin = 0;
+    for(int m=1; m<=M-1; m++) {
+        bin = round((float)m*fsk->fs_tx*Ndft/Fs)-1;
+        for(i=bin; i<=bin+2; i++) if (i >= 0 && i < Ndft) fsk->mask[i] = 1.0;
+    }
+    fsk->len_mask = bin+2+1;
     
     fsk->norm_rx_timing = 0;
     
@@ -248,9 +269,20 @@ struct FSK * fsk_create_hbr(int Fs, int Rs, int M, int P, int Nsym, int tx_f1, i
 
 void fsk_destroy(struct FSK *fsk){
     free(fsk->f_dc);
-    free(fsk->fft_cfg);
+    free(fsk->f_dc_cs);
+    free(fsk->f_int);
+    if (!fsk->fft_shared) {
+        free(fsk->fft_cfg);
+        free(fsk->fftr_cfg);
+        free(fsk->fft_in);
+        free(fsk->fft_out);
+        free(fsk->fft_rin);
+        free(fsk->Sf_pk);
+        free(fsk->mask);
+        free(fsk->hann_table);
+    }
     free(fsk->stats);
-    free(fsk->hann_table);
+    free(fsk->Sf);
     free(fsk);
 }
 
@@ -447,14 +479,13 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
     int freqi[M];
     int st,en,f_zero;
     
-    /* Array to do complex FFT from using kiss_fft */
-    #ifdef DEMOD_ALLOC_STACK
-    kiss_fft_cpx *fftin  = (kiss_fft_cpx*)alloca(sizeof(kiss_fft_cpx)*Ndft);
-    kiss_fft_cpx *fftout = (kiss_fft_cpx*)alloca(sizeof(kiss_fft_cpx)*Ndft);
-    #else
-    kiss_fft_cpx *fftin  = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*Ndft);
-    kiss_fft_cpx *fftout = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*Ndft);
-    #endif
+    /* FFT buffers are allocated once in fsk_create_core */
+    kiss_fft_cpx *fftin  = fsk->fft_in;
+    kiss_fft_cpx *fftout = fsk->fft_out;
+    float *rin = fsk->fft_rin;
+    float *Sf = fsk->Sf;
+    float *Sf_pk = fsk->Sf_pk;
+    float tc = fsk->tc;
     
     st = (fsk->est_min*Ndft)/Fs + Ndft/2; if (st < 0) st = 0;
     en = (fsk->est_max*Ndft)/Fs + Ndft/2; if (en > Ndft) en = Ndft;
@@ -462,10 +493,41 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
     
     f_zero = (fsk->est_space*Ndft)/Fs;
 
+    /* The overlapping blocks are transformed one at a time: kiss_fft has no
+       batched transform, so batching only saves the Sf update per block,
+       and the Nblocks*Ndft buffers cost more in cache than that saves. */
     int numffts = floor((float)nin/(Ndft/2)) - 1;
     for(j=0; j<numffts; j++){
         int a = j*Ndft/2;
         //fprintf(stderr, "numffts: %d j: %d a: %d\n", numffts, (int)j, a);
+
+        if (fsk->real_input) {
+            /* Real input: Ndft-point real FFT gives bins 0..Ndft/2,
+               the negative freqs are the mirror image */
+            for(i=0; i<Ndft; i++){
+                #ifdef USE_HANN_TABLE
+                hann = fsk->hann_table[i];
+                #else
+                hann = 0.5 - 0.5 * cosf(2.0 * M_PI * (float)i / (float) (fft_samps-1));
+                #endif
+                rin[i] = hann*fsk_in[i+a].real;
+            }
+
+            kiss_fftr(fsk->fftr_cfg,rin,fftout);
+
+            /* DC bin at Ndft/2: Sf[Ndft/2+k] = Sf[Ndft/2-k] = |X[k]| */
+            for(i=0; i<=Ndft/2; i++) {
+                fftout[i].r = sqrtf((fftout[i].r*fftout[i].r) + (fftout[i].i*fftout[i].i));
+            }
+            for(i=0; i<Ndft/2; i++) {
+                Sf[Ndft/2+i] = (Sf[Ndft/2+i]*(1-tc)) + (fftout[i].r*tc);
+            }
+            for(i=1; i<=Ndft/2; i++) {
+                Sf[Ndft/2-i] = (Sf[Ndft/2-i]*(1-tc)) + (fftout[i].r*tc);
+            }
+            continue;
+        }
+
         /* Copy FSK buffer into reals of FFT buffer and apply a hann window */
         for(i=0; i<Ndft; i++){
             #ifdef USE_HANN_TABLE
@@ -480,29 +542,18 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
         /* Do the FFT */
         kiss_fft(fft_cfg,fftin,fftout);
 
-        /* FFT shift to put DC bin at Ndft/2 */
-        kiss_fft_cpx tmp;
-        for(i=0; i<Ndft/2; i++) {
-            tmp = fftout[i];
-            fftout[i] = fftout[i+Ndft/2];
-            fftout[i+Ndft/2] = tmp;
-        }
-        
-        /* Find the magnitude^2 of each freq slot */
+        /* Find the magnitude of each freq slot and mix back in with the
+           previous fft block, FFT shift to put DC bin at Ndft/2 */
         for(i=0; i<Ndft; i++) {
-            fftout[i].r = (fftout[i].r*fftout[i].r) + (fftout[i].i*fftout[i].i) ;
-        }
-        
-        /* Mix back in with the previous fft block */
-        /* Copy new fft est into imag of fftout for frequency divination below */
-        float tc = fsk->tc;
-        for(i=0; i<Ndft; i++){
-            fsk->Sf[i] = (fsk->Sf[i]*(1-tc)) + (sqrtf(fftout[i].r)*tc);
-            fftout[i].i = fsk->Sf[i];
+            kiss_fft_cpx X = fftout[(i+Ndft/2) & (Ndft-1)];
+            Sf[i] = (Sf[i]*(1-tc)) + (sqrtf((X.r*X.r) + (X.i*X.i))*tc);
         }
     }
     
     modem_probe_samp_f("t_Sf",fsk->Sf,Ndft);
+
+    /* Copy fft est for frequency divination below */
+    memcpy(Sf_pk, Sf, sizeof(float)*Ndft);
     
     max = 0;
     /* Find the M frequency peaks here */
@@ -510,8 +561,8 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
         imax = 0;
         max = 0;
         for(j=st;j<en;j++){
-            if(fftout[j].i > max){
-                max = fftout[j].i;
+            if(Sf_pk[j] > max){
+                max = Sf_pk[j];
                 imax = j;
             }
         }
@@ -522,7 +573,7 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
         f_max = imax + f_zero;
         f_max = f_max > Ndft ? Ndft : f_max;
         for(j=f_min; j<f_max; j++)
-            fftout[j].i = 0;
+            Sf_pk[j] = 0;
         
         /* Stick the freq index on the list */
         freqi[i] = imax - Ndft/2;
@@ -548,16 +599,9 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
 
     /* Search for each tone method 2 - correlate with mask with non-zero entries at tone spacings ----- */
 
-    /* construct mask */
-    float mask[Ndft];
-    for(i=0; i<Ndft; i++) mask[i] = 0.0;
-    for(i=0;i<3; i++) mask[i] = 1.0;
-    int bin=0;
-    for(int m=1; m<=M-1; m++) {
-        bin = round((float)m*fsk->fs_tx*Ndft/Fs)-1;
-        for(i=bin; i<=bin+2; i++) mask[i] = 1.0;
-    }
-    int len_mask = bin+2+1;
+    /* mask constructed in fsk_create_core */
+    float *mask = fsk->mask;
+    int len_mask = fsk->len_mask;
 
     #ifdef MODEMPROBE_ENABLE
     modem_probe_samp_f("t_mask",mask,len_mask);
@@ -565,7 +609,6 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
 
     /* drag mask over Sf, looking for peak in correlation */
     int b_max = st; float corr_max = 0.0;
-    float *Sf = fsk->Sf;
     for (int b=st; b<en-len_mask; b++) {
         float corr = 0.0;
         for(i=0; i<len_mask; i++)
@@ -582,11 +625,6 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[], float *freqs, int M) {
     #ifdef MODEMPROBE_ENABLE
     modem_probe_samp_f("t_f2_est",fsk->f2_est,M);
     #endif
-
-    #ifndef DEMOD_ALLOC_STACK
-    free(fftin);
-    free(fftout);
-    #endif
 }
 
 /* core demodulator function */
@@ -655,22 +693,34 @@ void fsk_demod_core(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_
         #endif
     }
 
-    /* integrate over symbol period at a variety of offsets */
-    COMP f_int[M][(nsym+1)*P];
-    for(i=0; i<(nsym+1)*P; i++) {
-        int st = i*Ts/P;
-        int en = st+Ts-1;
-        for(m=0; m<M; m++) {
-            f_int[m][i] = comp0();
-            for(j=st; j<=en; j++)
-                f_int[m][i] = cadd(f_int[m][i], f_dc[m*Nmem+j]);
+    /* integrate over symbol period at a variety of offsets:
+       running sum cs[k] = f_dc[0]+..+f_dc[k-1] (double, no drift over Nmem),
+       f_int[i] = f_dc[st]+..+f_dc[st+Ts-1] = cs[st+Ts]-cs[st] */
+    int Nint = (nsym+1)*P;
+    COMP *f_int = fsk->f_int;
+    double *cs = fsk->f_dc_cs;
+    for(m=0; m<M; m++) {
+        double *cs_m = &cs[2*m*(Nmem+1)];
+        double re = 0, im = 0;
+        cs_m[0] = 0;
+        cs_m[1] = 0;
+        for(j=0; j<Nmem; j++) {
+            re += f_dc[m*Nmem+j].real;
+            im += f_dc[m*Nmem+j].imag;
+            cs_m[2*(j+1)  ] = re;
+            cs_m[2*(j+1)+1] = im;
+        }
+        for(i=0; i<Nint; i++) {
+            int st = i*Ts/P;
+            f_int[m*Nint+i].real = cs_m[2*(st+Ts)  ] - cs_m[2*st  ];
+            f_int[m*Nint+i].imag = cs_m[2*(st+Ts)+1] - cs_m[2*st+1];
         }
     }
 
     #ifdef MODEMPROBE_ENABLE
     for(m=0; m<M; m++) {
         snprintf(mp_name_tmp,NMP_NAME,"t_f%zd_int",m+1);
-        modem_probe_samp_c(mp_name_tmp,&f_int[m][0],(nsym+1)*P);
+        modem_probe_samp_c(mp_name_tmp,&f_int[m*Nint],Nint);
     }    
     #endif                       
         
@@ -687,7 +737,7 @@ void fsk_demod_core(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_
         /* Get abs^2 of fx_int[i], and add 'em */
         ft1 = 0;
         for( m=0; m<M; m++){
-            ft1 += (f_int[m][i].real*f_int[m][i].real) + (f_int[m][i].imag*f_int[m][i].imag);
+            ft1 += (f_int[m*Nint+i].real*f_int[m*Nint+i].real) + (f_int[m*Nint+i].imag*f_int[m*Nint+i].imag);
         }
         
         /* Down shift and accumulate magic line */
@@ -751,8 +801,8 @@ void fsk_demod_core(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_
     for(i=0; i<nsym; i++){
         int st = (i+1)*P;
         for( m=0; m<M; m++){
-            t[m] =           fcmult(1-fract,f_int[m][st+ low_sample]);
-            t[m] = cadd(t[m],fcmult(  fract,f_int[m][st+high_sample]));
+            t[m] =           fcmult(1-fract,f_int[m*Nint+st+ low_sample]);
+            t[m] = cadd(t[m],fcmult(  fract,f_int[m*Nint+st+high_sample]));
             /* Figure mag^2 of each resampled fx_int */
             tmax[m] = (t[m].real*t[m].real) + (t[m].imag*t[m].imag);
         }
@@ -884,7 +934,8 @@ void fsk_demod_core(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_
                ind = 2*P*i + neyeoffset + j*neyesamp_dec;
                assert((i*M+m) < MODEM_STATS_ET_MAX);
                assert(ind < (nsym+1)*P);
-               fsk->stats->rx_eye[i*M+m][j] = cabsolute(f_int[m][ind]);
+               if (ind < 0) ind = 0;  /* timing at -1: first integrated sample */
+               fsk->stats->rx_eye[i*M+m][j] = cabsolute(f_int[m*Nint+ind]);
             }
         }
     }
@@ -1033,6 +1084,38 @@ void fsk_set_freq_est_alg(struct FSK *fsk, int est_type) {
     fsk->freq_est_type = est_type;
 }
 
+void fsk_set_real_input(struct FSK *fsk, int real_input) {
+    assert(fsk != NULL);
+    fsk->real_input = real_input;
+}
+
+void fsk_share_fft(struct FSK *fsk, struct FSK *src) {
+    assert(fsk != NULL && src != NULL && fsk != src);
+    assert(fsk->Ndft == src->Ndft && fsk->Fs == src->Fs);
+    assert(fsk->mode == src->mode && fsk->fs_tx == src->fs_tx);
+
+    if (!fsk->fft_shared) {
+        free(fsk->fft_cfg);
+        free(fsk->fftr_cfg);
+        free(fsk->fft_in);
+        free(fsk->fft_out);
+        free(fsk->fft_rin);
+        free(fsk->Sf_pk);
+        free(fsk->mask);
+        free(fsk->hann_table);
+    }
+    fsk->fft_cfg = src->fft_cfg;
+    fsk->fftr_cfg = src->fftr_cfg;
+    fsk->fft_in = src->fft_in;
+    fsk->fft_out = src->fft_out;
+    fsk->fft_rin = src->fft_rin;
+    fsk->Sf_pk = src->Sf_pk;
+    fsk->mask = src->mask;
+    fsk->len_mask = src->len_mask;
+    fsk->hann_table = src->hann_table;
+    fsk->fft_shared = 1;
+}
+
 
 
 
@@ -69,8 +69,19 @@ struct FSK {
     float* Sf;	            /* Average of magnitude spectrum */
     COMP phi_c[MODE_M_MAX]; /* phase of each demod local oscillator */
     COMP *f_dc;             /* down converted samples               */
+    double *f_dc_cs;        /* running sum of f_dc (re,im), M*(Nmem+1) */
+    COMP *f_int;            /* integrated symbols, M*(Nsym+1)*P     */
     
     kiss_fft_cfg fft_cfg;   /* Config for KISS FFT, used in freq est */
+    kiss_fftr_cfg fftr_cfg; /* real FFT config, freq est with real input */
+    kiss_fft_cpx *fft_in;   /* freq est FFT buffers, Ndft               */
+    kiss_fft_cpx *fft_out;
+    float *fft_rin;         /* windowed real input, Ndft                */
+    float *Sf_pk;           /* copy of Sf for peak search, Ndft         */
+    float *mask;            /* tone mask for freq est (mask method)     */
+    int len_mask;
+    int real_input;         /* input has zero imag part, use real FFT   */
+    int fft_shared;         /* FFT plans/tables/scratch owned by another FSK */
     float norm_rx_timing;   /* Normalized RX timing */
         
     
@@ -204,4 +215,17 @@ void fsk_enable_burst_mode(struct FSK *fsk);
 /* Set freq est algorithm 0: peak 1:mask */
 void fsk_set_freq_est_alg(struct FSK *fsk, int est_type);
 
+/*
+ * Input samples are real (imag = 0): the freq. estimator uses a real FFT
+ * and mirrors the spectrum.
+ */
+void fsk_set_real_input(struct FSK *fsk, int real_input);
+
+/*
+ * Use the freq. estimator FFT plans, window, mask and FFT scratch buffers
+ * of src (same Fs, Rs, M and tone spacing), e.g. several channels
+ * demodulated in turn by one thread. src must be destroyed last.
+ */
+void fsk_share_fft(struct FSK *fsk, struct FSK *src);
+
 #endif
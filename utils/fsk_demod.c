@@ -28,6 +28,7 @@
 */
 
 #define TEST_FRAME_SIZE 100  /* must match fsk_get_test_bits.c */
+#define MAX_CHANNELS 32      /* --channels */
 
 #include <assert.h>
 #include <stdio.h>
@@ -36,10 +37,13 @@
 #include <time.h>
 #include <signal.h>
 #include <unistd.h>
+#include <string.h>
 
 #include "fsk.h"
 #include "codec2_fdmdv.h"
 #include "modem_stats.h"
+#include "softhdr.h"
+#include "fsk_stats.h"
 
 /* cleanly exit when we get a SIGTERM */
 
@@ -51,18 +55,19 @@ void sig_handler(int signo)
 }
 
 int main(int argc,char *argv[]){
-    struct FSK *fsk;
-    struct MODEM_STATS stats;
-    int Fs,Rs,M,P,stats_ctr,stats_loop;
-    long sample_count;
+    struct FSK *fsk[MAX_CHANNELS];
+    int Fs,Rs,M,P,stats_ctr[MAX_CHANNELS],stats_loop;
+    long sample_count[MAX_CHANNELS];
     float loop_time;
     int enable_stats = 0;
-    FILE *fin,*fout;
+    FILE *fin,*fout[MAX_CHANNELS];
     uint8_t *bitbuf = NULL;
     int16_t *rawbuf;
-    COMP *modbuf;
+    COMP *modbuf[MAX_CHANNELS];
+    int nbuf[MAX_CHANNELS];
+    int nch = 1, ch, Nmax;
     float *sdbuf = NULL;
-    int i,j,Ndft;
+    int i,j;
     int soft_dec_mode = 0;
     stats_loop = 0;
     int complex_input = 1, bytes_per_sample = 2;
@@ -78,6 +83,12 @@ int main(int argc,char *argv[]){
     int mask = 0;
     int tx_tone_separation = 100;
     int softinv = 0;
+    int framed = 0;
+    int stats_bin = 0;
+    int stats_eye = -1;     /* eye diagram: every n-th trace, 0: none, -1: default (JSON 1, binary 0) */
+    int stats_fft = 1;      /* samp_fft: max over n bins */
+    uint8_t *statsbuf = NULL;
+    softhdr_t shdr[MAX_CHANNELS];
 
     int o = 0;
     int opt_idx = 0;
@@ -95,10 +106,15 @@ int main(int argc,char *argv[]){
             {"testframes",no_argument,        0, 'f'},
             {"nsym",      required_argument,  0, 'n'},
             {"mask",      required_argument,  0, 'm'},
+            {"framed",    no_argument,        0, 'F'},
+            {"channels",  required_argument,  0, 'C'},
+            {"stats-bin", no_argument,        0, 'B'},
+            {"stats-eye", required_argument,  0, 'E'},
+            {"stats-fft", required_argument,  0, 'A'},
             {0, 0, 0, 0}
         };
 
-        o = getopt_long(argc,argv,"fhilp:cdt::sb:u:m",long_opts,&opt_idx);
+        o = getopt_long(argc,argv,"fhilp:cdt::sb:u:mFC:",long_opts,&opt_idx);
 
         switch(o){
         case 'c':
@@ -127,6 +143,24 @@ int main(int argc,char *argv[]){
         case 's':
             soft_dec_mode = 1;
             break;
+        case 'F':
+            soft_dec_mode = 1;
+            framed = 1;
+            break;
+        case 'C':
+            nch = atoi(optarg);
+            break;
+        case 'B':
+            stats_bin = 1;
+            break;
+        case 'E':
+            stats_eye = atoi(optarg);
+            if (stats_eye < 0) stats_eye = 0;
+            break;
+        case 'A':
+            stats_fft = atoi(optarg);
+            if (stats_fft < 1) stats_fft = 1;
+            break;
         case 'p':
             P = atoi(optarg);
             break;
@@ -177,6 +211,8 @@ int main(int argc,char *argv[]){
         fprintf(stderr,"                    r, if provided, sets the number of modem frames between statistic printouts.\n");
         fprintf(stderr," -s --soft-dec      The output file will be in a soft-decision format, with one 32-bit float per bit.\n");
         fprintf(stderr,"                    If -s is not used, the output will be in a 1 byte-per-bit format.\n");
+        fprintf(stderr," -F --framed        Soft-decision output (implies -s), each modem frame preceded by a 32 byte\n");
+        fprintf(stderr,"                    header with symbol rate, Eb/No, ppm, freq offset and timing estimates.\n");
         fprintf(stderr," -p P               The demod internals operate at a rate of Fs/P, default %d\n", FSK_DEFAULT_P);
         fprintf(stderr,"                    P must be divisible by the symbol rate. Smaller P values will result in faster\n");
         fprintf(stderr,"                    processing but lower demodulation performance. Default %d\n", FSK_DEFAULT_P);
@@ -184,6 +220,12 @@ int main(int argc,char *argv[]){
         fprintf(stderr," --fsk_upper freq   upper limit of freq estimator (default Fs/2)\n");
         fprintf(stderr," --nsym Nsym        number of symbols used for estimators. Default %d\n", FSK_DEFAULT_NSYM);
         fprintf(stderr," --mask TxFreqSpace Use \"mask\" freq estimator (default is \"peak\" estimator)\n");
+        fprintf(stderr," -C --channels N    Input is N interleaved channels (sample by sample, same format and rate),\n");
+        fprintf(stderr,"                    demodulated in one process. OutputFile must contain %%d (channel number),\n");
+        fprintf(stderr,"                    the --stats JSON gets a \"channel\" field.\n");
+        fprintf(stderr," --stats-bin        Modem statistics as compact binary records instead of JSON (to stderr).\n");
+        fprintf(stderr," --stats-eye n      Eye diagram: every n-th trace, 0: no eye diagram (default 1, binary: 0).\n");
+        fprintf(stderr," --stats-fft n      samp_fft: peak over n bins (default 1).\n");
         exit(1);
     }
 
@@ -197,6 +239,27 @@ int main(int argc,char *argv[]){
         goto helpmsg;
     }
 
+    if (nch < 1 || nch > MAX_CHANNELS) {
+        fprintf(stderr,"Channels must be 1..%d.\n",MAX_CHANNELS);
+        goto helpmsg;
+    }
+    if (nch > 1 && testframe_mode) {
+        fprintf(stderr,"Testframe mode needs a single channel.\n");
+        exit(1);
+    }
+    if (stats_bin && testframe_mode) {
+        fprintf(stderr,"Testframe mode has JSON stats only.\n");
+        stats_bin = 0;
+    }
+    if (stats_eye < 0) {
+        /* no --stats-eye: binary records without eye diagram */
+        stats_eye = stats_bin ? 0 : 1;
+    }
+    if (nch > 1 && strstr(argv[dx + 4],"%d") == NULL) {
+        fprintf(stderr,"Multi-channel: OutputFile must contain %%d (channel number).\n");
+        exit(1);
+    }
+
     /* Open files */
     if(strcmp(argv[dx + 3],"-")==0){
         fin = stdin;
@@ -204,15 +267,30 @@ int main(int argc,char *argv[]){
         fin = fopen(argv[dx + 3],"r");
     }
 
-    if(strcmp(argv[dx + 4],"-")==0){
-        fout = stdout;
-    }else{
-        fout = fopen(argv[dx + 4],"w");
+    for(ch=0; ch<nch; ch++){
+        if (nch > 1) {
+            /* substitute the first %d, the path is not a format string */
+            char fname[1024];
+            const char *d = strstr(argv[dx + 4],"%d");
+            int n = snprintf(fname,sizeof(fname),"%.*s%d%s",(int)(d - argv[dx + 4]),argv[dx + 4],ch,d+2);
+            if (n < 0 || n >= (int)sizeof(fname)) {
+                fprintf(stderr,"OutputFile name too long.\n");
+                exit(1);
+            }
+            fout[ch] = fopen(fname,"w");
+        }else if(strcmp(argv[dx + 4],"-")==0){
+            fout[ch] = stdout;
+        }else{
+            fout[ch] = fopen(argv[dx + 4],"w");
+        }
+        if(fout[ch]==NULL){
+            fprintf(stderr,"Couldn't open files\n");
+            exit(1);
+        }
     }
 
     /* set up FSK */
     #define UNUSED 1000
-    fsk = fsk_create_hbr(Fs,Rs,M,P,nsym,UNUSED,tx_tone_separation);
 
     /* set freq estimator limits */
     if (!user_fsk_lower) {
@@ -225,11 +303,24 @@ int main(int argc,char *argv[]){
         fsk_upper = Fs/2;
     }
     fprintf(stderr,"Setting estimator limits to %d to %d Hz.\n", fsk_lower, fsk_upper);
-    fsk_set_freq_est_limits(fsk,fsk_lower,fsk_upper);
 
-    fsk_set_freq_est_alg(fsk, mask);
+    for(ch=0; ch<nch; ch++){
+        fsk[ch] = fsk_create_hbr(Fs,Rs,M,P,nsym,UNUSED,tx_tone_separation);
+        if(fsk[ch]==NULL){
+            fprintf(stderr,"Couldn't create modem\n");
+            exit(1);
+        }
+        fsk_set_freq_est_limits(fsk[ch],fsk_lower,fsk_upper);
+        fsk_set_freq_est_alg(fsk[ch], mask);
+
+        /* real s16 input: imag = 0, real FFT in the freq estimator */
+        if (complex_input == 1) fsk_set_real_input(fsk[ch], 1);
 
-    if(fin==NULL || fout==NULL || fsk==NULL){
+        /* channels share FFT plans, window, mask and FFT scratch buffers */
+        if (ch > 0) fsk_share_fft(fsk[ch], fsk[0]);
+    }
+
+    if(fin==NULL){
         fprintf(stderr,"Couldn't open files\n");
         exit(1);
     }
@@ -255,20 +346,44 @@ int main(int argc,char *argv[]){
         biterr = 0;
     }
 
+    if(enable_stats && stats_bin){
+        assert(sizeof(struct statshdr) == STATSBIN_HDR_LEN);
+        statsbuf = (uint8_t*)malloc(STATSBIN_MAX(fsk[0]));
+        assert(statsbuf != NULL);
+    }
+
     if(enable_stats){
-        loop_time = ((float)fsk_nin(fsk))/((float)Fs);
+        loop_time = ((float)fsk_nin(fsk[0]))/((float)Fs);
         stats_loop = (int)(1/(stats_rate*loop_time));
-        stats_ctr = 0;
+        for(ch=0; ch<nch; ch++) stats_ctr[ch] = 0;
+    }
+
+    if (framed) {
+        assert(sizeof(softhdr_t) == SOFTHDR_LEN);
+        for(ch=0; ch<nch; ch++){
+            memset(&shdr[ch], 0, sizeof(softhdr_t));
+            memcpy(shdr[ch].magic, SOFTHDR_MAGIC, 4);
+            shdr[ch].ver = SOFTHDR_VER;
+            shdr[ch].len = SOFTHDR_LEN;
+            shdr[ch].nsym = fsk[0]->Nbits;
+            shdr[ch].rs = Rs;
+        }
     }
 
     /* allocate buffers for processing */
+    Nmax = fsk[0]->N+fsk[0]->Ts*2;
     if(soft_dec_mode){
-        sdbuf = (float*)malloc(sizeof(float)*fsk->Nbits); assert(sdbuf != NULL);
+        sdbuf = (float*)malloc(sizeof(float)*fsk[0]->Nbits); assert(sdbuf != NULL);
     }else{
-        bitbuf = (uint8_t*)malloc(sizeof(uint8_t)*fsk->Nbits); assert(bitbuf != NULL);
+        bitbuf = (uint8_t*)malloc(sizeof(uint8_t)*fsk[0]->Nbits); assert(bitbuf != NULL);
+    }
+    rawbuf = (int16_t*)malloc(bytes_per_sample*Nmax*complex_input*nch); assert(rawbuf != NULL);
+    for(ch=0; ch<nch; ch++){
+        /* per channel input fifo, the demod consumes fsk_nin() samples per frame */
+        modbuf[ch] = (COMP*)malloc(sizeof(COMP)*2*Nmax); assert(modbuf[ch] != NULL);
+        nbuf[ch] = 0;
+        sample_count[ch] = 0;
     }
-    rawbuf = (int16_t*)malloc(bytes_per_sample*(fsk->N+fsk->Ts*2)*complex_input);
-    modbuf = (COMP*)malloc(sizeof(COMP)*(fsk->N+fsk->Ts*2));
 
     /* set up signal handler so we can terminate gracefully */
 
@@ -278,162 +393,161 @@ int main(int argc,char *argv[]){
 
     /* Demodulate! */
 
-    while( fread(rawbuf,bytes_per_sample*complex_input,fsk_nin(fsk),fin) == fsk_nin(fsk) ){
-        /* convert input to a buffer of floats.  Note scaling isn't really necessary for FSK */
-
-        if (complex_input == 1) {
-            /* S16 real input */
-            for(i=0;i<fsk_nin(fsk);i++){
-                modbuf[i].real = ((float)rawbuf[i])/FDMDV_SCALE;
-                modbuf[i].imag = 0.0;
-                sample_count++;
-            }
+    for(;;){
+        /* read as many frames as the hungriest channel needs;
+           every channel is drained below its fsk_nin() <= N+Ts/2 after demod,
+           so nbuf + nread < 2*(N+Ts/2) <= 2*Nmax, whatever the symbol clocks do */
+        int nread = 0, eof = 0;
+        for(ch=0; ch<nch; ch++){
+            int need = fsk_nin(fsk[ch]) - nbuf[ch];
+            if (need > nread) nread = need;
         }
-        else {
-            if (bytes_per_sample == 1) {
-                /* U8 complex */
-                uint8_t *rawbuf_u8 = (uint8_t*)rawbuf;
-                for(i=0;i<fsk_nin(fsk);i++){
-                    modbuf[i].real = ((float)rawbuf_u8[2*i]-127.0)/128.0;
-                    modbuf[i].imag = ((float)rawbuf_u8[2*i+1]-127.0)/128.0;
-                    sample_count++;
-                }
-            }
-            else {
-                /* S16 complex */
-                for(i=0;i<fsk_nin(fsk);i++){
-                    modbuf[i].real = ((float)rawbuf[2*i])/FDMDV_SCALE;
-                    modbuf[i].imag = ((float)rawbuf[2*i+1]/FDMDV_SCALE);
-                    sample_count++;
-                }
-            }
+        if (nread > 0) {
+            /* EOF: the last frames can still complete a frame of a less hungry channel */
+            int len = fread(rawbuf,bytes_per_sample*complex_input*nch,nread,fin);
+            if (len != nread) { nread = len; eof = 1; }
         }
 
-        if(soft_dec_mode){
-            fsk_demod_sd(fsk,sdbuf,modbuf);
-        }else{
-            fsk_demod(fsk,bitbuf,modbuf);
-        }
-
-        testframe_detected = 0;
-        if (testframe_mode) {
-            /* attempt to find a testframe and update stats */
-            /* update silding window of input bits */
+        /* convert input to a buffer of floats.  Note scaling isn't really necessary for FSK */
 
-            int errs;
-            for(j=0; j<fsk->Nbits; j++) {
-                for(i=0; i<TEST_FRAME_SIZE-1; i++) {
-                    bitbuf_rx[i] = bitbuf_rx[i+1];
+        for(ch=0; ch<nch; ch++){
+            COMP *in = modbuf[ch] + nbuf[ch];
+            assert(nbuf[ch] + nread <= 2*Nmax);
+            if (complex_input == 1) {
+                /* S16 real input */
+                for(i=0;i<nread;i++){
+                    in[i].real = ((float)rawbuf[i*nch+ch])/FDMDV_SCALE;
+                    in[i].imag = 0.0;
                 }
-                if (soft_dec_mode == 1) {
-                    bitbuf_rx[TEST_FRAME_SIZE-1] = sdbuf[j] < 0.0;
+            }
+            else {
+                if (bytes_per_sample == 1) {
+                    /* U8 complex */
+                    uint8_t *rawbuf_u8 = (uint8_t*)rawbuf;
+                    for(i=0;i<nread;i++){
+                        in[i].real = ((float)rawbuf_u8[2*(i*nch+ch)]-127.0)/128.0;
+                        in[i].imag = ((float)rawbuf_u8[2*(i*nch+ch)+1]-127.0)/128.0;
+                    }
                 }
                 else {
-                    bitbuf_rx[TEST_FRAME_SIZE-1] = bitbuf[j];
+                    /* S16 complex */
+                    for(i=0;i<nread;i++){
+                        in[i].real = ((float)rawbuf[2*(i*nch+ch)])/FDMDV_SCALE;
+                        in[i].imag = ((float)rawbuf[2*(i*nch+ch)+1]/FDMDV_SCALE);
+                    }
                 }
+            }
+            nbuf[ch] += nread;
+            sample_count[ch] += nread;
+        }
 
-                /* compare to know tx frame.  If they are time aligned, there
-                   will be a fairly low bit error rate */
+        /* demod each channel, channel after channel, until it has less than a frame left */
+        for(ch=0; ch<nch; ch++){
+            while (nbuf[ch] >= (int)fsk_nin(fsk[ch])) {
+                int nin = fsk_nin(fsk[ch]);
 
-                errs = 0;
-                for(i=0; i<TEST_FRAME_SIZE; i++) {
-                    if (bitbuf_rx[i] != bitbuf_tx[i]) {
-                        errs++;
-                    }
+                if(soft_dec_mode){
+                    fsk_demod_sd(fsk[ch],sdbuf,modbuf[ch]);
+                }else{
+                    fsk_demod(fsk[ch],bitbuf,modbuf[ch]);
                 }
 
-                if (errs < 0.1*TEST_FRAME_SIZE) {
-                    /* OK, we have a valid test frame sync, so lets count errors */
-                    testframe_detected = 1;
-                    testframecnt++;
-                    bitcnt += TEST_FRAME_SIZE;
-                    biterr += errs;
-                    if (enable_stats == 0) {
-                        fprintf(stderr,"errs: %d FSK BER %f, bits tested %d, bit errors %d\n",
-                                errs, ((float)biterr/(float)bitcnt),bitcnt,biterr);
-                    }
-                }
-            }
-        } /* if (testframe_mode) ... */
+                nbuf[ch] -= nin;
+                if (nbuf[ch] > 0) memmove(modbuf[ch], modbuf[ch]+nin, sizeof(COMP)*nbuf[ch]);
 
-        if (enable_stats) {
-            if ((stats_ctr < 0) || testframe_detected) {
-                fsk_get_demod_stats(fsk,&stats);
+                testframe_detected = 0;
+                if (testframe_mode) {
+                    /* attempt to find a testframe and update stats */
+                    /* update silding window of input bits */
 
-                /* Print standard 2FSK stats */
+                    int errs;
+                    for(j=0; j<fsk[ch]->Nbits; j++) {
+                        for(i=0; i<TEST_FRAME_SIZE-1; i++) {
+                            bitbuf_rx[i] = bitbuf_rx[i+1];
+                        }
+                        if (soft_dec_mode == 1) {
+                            bitbuf_rx[TEST_FRAME_SIZE-1] = sdbuf[j] < 0.0;
+                        }
+                        else {
+                            bitbuf_rx[TEST_FRAME_SIZE-1] = bitbuf[j];
+                        }
 
-                fprintf(stderr,"{");
-                time_t seconds  = time(NULL);
+                        /* compare to know tx frame.  If they are time aligned, there
+                           will be a fairly low bit error rate */
 
-                fprintf(stderr,"\"secs\": %ld, \"samples\": %ld, \"EbNodB\": %5.1f, \"ppm\": %4d,",seconds, sample_count, stats.snr_est, (int)fsk->ppm);
-                float *f_est;
-                if (fsk->freq_est_type)
-                    f_est = fsk->f2_est;
-                else
-                    f_est = fsk->f_est;
-                fprintf(stderr," \"f1_est\":%.1f, \"f2_est\":%.1f",f_est[0],f_est[1]);
+                        errs = 0;
+                        for(i=0; i<TEST_FRAME_SIZE; i++) {
+                            if (bitbuf_rx[i] != bitbuf_tx[i]) {
+                                errs++;
+                            }
+                        }
 
-                /* Print 4FSK stats if in 4FSK mode */
+                        if (errs < 0.1*TEST_FRAME_SIZE) {
+                            /* OK, we have a valid test frame sync, so lets count errors */
+                            testframe_detected = 1;
+                            testframecnt++;
+                            bitcnt += TEST_FRAME_SIZE;
+                            biterr += errs;
+                            if (enable_stats == 0) {
+                                fprintf(stderr,"errs: %d FSK BER %f, bits tested %d, bit errors %d\n",
+                                        errs, ((float)biterr/(float)bitcnt),bitcnt,biterr);
+                            }
+                        }
+                    }
+                } /* if (testframe_mode) ... */
 
-                if(fsk->mode == 4){
-                    fprintf(stderr,", \"f3_est\":%.1f, \"f4_est\":%.1f",f_est[2],f_est[3]);
-                }
+                if (enable_stats) {
+                    if ((stats_ctr[ch] < 0) || testframe_detected) {
+                        struct FSK_STATS_CFG cfg = { stats_bin, stats_eye, stats_fft };
 
-                if (testframe_mode == 0) {
-                    /* Print the eye diagram */
+                        if (stats_bin) {
+                            fsk_stats_bin(stderr,fsk[ch],&cfg,ch,sample_count[ch],statsbuf);
+                        }
+                        else if (testframe_mode) {
+                            char tail[80];
+                            snprintf(tail,sizeof(tail),", \"frames\":%d, \"bits\":%d, \"errs\":%d",testframecnt,bitcnt,biterr);
+                            fsk_stats_json(stderr,fsk[ch],&cfg,nch > 1 ? ch : -1,sample_count[ch],tail);
+                        }
+                        else {
+                            fsk_stats_json(stderr,fsk[ch],&cfg,nch > 1 ? ch : -1,sample_count[ch],NULL);
+                        }
 
-                    fprintf(stderr,",\t\"eye_diagram\":[");
-                    for(i=0;i<stats.neyetr;i++){
-                        fprintf(stderr,"[");
-                        for(j=0;j<stats.neyesamp;j++){
-                            fprintf(stderr,"%f ",stats.rx_eye[i][j]);
-                            if(j<stats.neyesamp-1) fprintf(stderr,",");
+                        if (stats_ctr[ch] < 0) {
+                            stats_ctr[ch] = stats_loop;
                         }
-                        fprintf(stderr,"]");
-                        if(i<stats.neyetr-1) fprintf(stderr,",");
                     }
-                    fprintf(stderr,"],");
-
-                    /* Print a sample of the FFT from the freq estimator */
-                    fprintf(stderr,"\"samp_fft\":[");
-                    Ndft = fsk->Ndft/2;
-                    for(i=0; i<Ndft; i++){
-                        fprintf(stderr,"%f ",(fsk->Sf)[i]);
-                        if(i<Ndft-1) fprintf(stderr,",");
+                    if (testframe_mode == 0) {
+                        stats_ctr[ch]--;
                     }
-                    fprintf(stderr,"]");
-                }
-
-                if (testframe_mode) {
-                    fprintf(stderr,", \"frames\":%d, \"bits\":%d, \"errs\":%d",testframecnt,bitcnt,biterr);
                 }
 
-                fprintf(stderr,"}\n");
-
-                if (stats_ctr < 0) {
-                    stats_ctr = stats_loop;
-                }
-            }
-            if (testframe_mode == 0) {
-                stats_ctr--;
-            }
-        }
+                if(soft_dec_mode){
+                    // Invert soft decision polarity.
+                    if(softinv){
+                        for(j=0; j<fsk[ch]->Nbits; j++) {
+                            sdbuf[j] = sdbuf[j]*-1.0;
+                        }
+                    }
 
-        if(soft_dec_mode){
-            // Invert soft decision polarity.
-            if(softinv){
-                for(j=0; j<fsk->Nbits; j++) {
-                    sdbuf[j] = sdbuf[j]*-1.0;
+                    if (framed) {
+                        float *f_est = fsk[ch]->freq_est_type ? fsk[ch]->f2_est : fsk[ch]->f_est;
+                        shdr[ch].snr = fsk[ch]->stats->snr_est;
+                        shdr[ch].ppm = fsk[ch]->ppm;
+                        shdr[ch].foff = 0.5*(f_est[0]+f_est[M-1]);
+                        shdr[ch].timing = fsk[ch]->stats->rx_timing;
+                        fwrite(&shdr[ch],SOFTHDR_LEN,1,fout[ch]);
+                        shdr[ch].seq++;
+                    }
+                    fwrite(sdbuf,sizeof(float),fsk[ch]->Nbits,fout[ch]);
+                }else{
+                    fwrite(bitbuf,sizeof(uint8_t),fsk[ch]->Nbits,fout[ch]);
                 }
-            }
 
-            fwrite(sdbuf,sizeof(float),fsk->Nbits,fout);
-        }else{
-            fwrite(bitbuf,sizeof(uint8_t),fsk->Nbits,fout);
-        }
-
-        if (fout == stdout) fflush(stdout);
-    } /* while(fread ...... */
+                if (fout[ch] == stdout) fflush(stdout);
+            } /* while(nbuf ...... */
+        } /* for(ch ...... */
+        if (eof) break;
+    } /* for(;;) ...... */
 
     if (testframe_mode) {
         free(bitbuf_tx);
@@ -447,11 +561,14 @@ int main(int argc,char *argv[]){
     }
 
     free(rawbuf);
-    free(modbuf);
+    free(statsbuf);
 
     fclose(fin);
-    fclose(fout);
-    fsk_destroy(fsk);
+    for(ch=nch-1; ch>=0; ch--){
+        free(modbuf[ch]);
+        fclose(fout[ch]);
+        fsk_destroy(fsk[ch]);
+    }
 
     return 0;
 }
@@ -0,0 +1,119 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: fsk_stats.c
+
+  Modem statistics records of the FSK demod, JSON lines (--stats) or
+  binary records (--stats-bin), see fsk_stats.h.
+
+\*---------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <time.h>
+
+#include "fsk_stats.h"
+
+void fsk_stats_json(FILE *fp, struct FSK *fsk, struct FSK_STATS_CFG *cfg, int ch, long samples, const char *tail) {
+    struct MODEM_STATS stats;
+    float *f_est = fsk->freq_est_type ? fsk->f2_est : fsk->f_est;
+    int i, j, Ndft;
+
+    fsk_get_demod_stats(fsk, &stats);
+
+    /* Print standard 2FSK stats */
+
+    fprintf(fp,"{");
+    if (ch >= 0) fprintf(fp,"\"channel\": %d, ", ch);
+    fprintf(fp,"\"secs\": %ld, \"samples\": %ld, \"EbNodB\": %5.1f, \"ppm\": %4d,",(long)time(NULL), samples, stats.snr_est, (int)fsk->ppm);
+    fprintf(fp," \"f1_est\":%.1f, \"f2_est\":%.1f",f_est[0],f_est[1]);
+
+    /* Print 4FSK stats if in 4FSK mode */
+
+    if(fsk->mode == 4){
+        fprintf(fp,", \"f3_est\":%.1f, \"f4_est\":%.1f",f_est[2],f_est[3]);
+    }
+
+    if (tail == NULL) {
+        /* Print the eye diagram */
+
+        fprintf(fp,",\t\"eye_diagram\":[");
+        for(i=0;i<stats.neyetr && cfg->eye>0;i+=cfg->eye){
+            fprintf(fp,"[");
+            for(j=0;j<stats.neyesamp;j++){
+                fprintf(fp,"%f ",stats.rx_eye[i][j]);
+                if(j<stats.neyesamp-1) fprintf(fp,",");
+            }
+            fprintf(fp,"]");
+            if(i+cfg->eye<stats.neyetr) fprintf(fp,",");
+        }
+        fprintf(fp,"],");
+
+        /* Print a sample of the FFT from the freq estimator */
+        fprintf(fp,"\"samp_fft\":[");
+        Ndft = fsk->Ndft/2;
+        for(i=0; i<Ndft; i+=cfg->fft){
+            float mx = 0;
+            for(j=i; j<i+cfg->fft && j<Ndft; j++){
+                if ((fsk->Sf)[j] > mx) mx = (fsk->Sf)[j];
+            }
+            fprintf(fp,"%f ",mx);
+            if(i+cfg->fft<Ndft) fprintf(fp,",");
+        }
+        fprintf(fp,"]");
+    }
+    else {
+        fprintf(fp,"%s",tail);
+    }
+
+    fprintf(fp,"}\n");
+}
+
+void fsk_stats_bin(FILE *fp, struct FSK *fsk, struct FSK_STATS_CFG *cfg, int ch, long samples, uint8_t *buf) {
+    struct MODEM_STATS stats;
+    struct statshdr *sh = (struct statshdr*)buf;
+    float *f_est = fsk->freq_est_type ? fsk->f2_est : fsk->f_est;
+    float *fft = (float*)(buf + STATSBIN_HDR_LEN);
+    uint8_t *eye;
+    int i, j, k, len, nfft = (fsk->Ndft/2 + cfg->fft-1)/cfg->fft;
+
+    fsk_get_demod_stats(fsk, &stats);
+
+    memset(sh, 0, STATSBIN_HDR_LEN);
+    memcpy(sh->magic, "FSKT", 4);
+    sh->ver = 1;
+    sh->channel = ch < 0 ? 0 : ch;
+    sh->secs = time(NULL);
+    sh->samples = samples;
+    sh->snr = stats.snr_est;
+    sh->ppm = fsk->ppm;
+    for(i=0; i<fsk->mode; i++) sh->f_est[i] = f_est[i];
+    sh->M = fsk->mode;
+    sh->fft_dec = cfg->fft;
+    sh->nfft = nfft;
+
+    for(i=0; i<nfft; i++){
+        float mx = 0;
+        for(k=i*cfg->fft; k<(i+1)*cfg->fft && k<fsk->Ndft/2; k++){
+            if ((fsk->Sf)[k] > mx) mx = (fsk->Sf)[k];
+        }
+        fft[i] = mx;
+    }
+
+    eye = (uint8_t*)(fft + nfft);
+    if (cfg->eye > 0) {
+        sh->neyesamp = stats.neyesamp;
+        for(i=0; i<stats.neyetr; i+=cfg->eye){
+            for(j=0; j<stats.neyesamp; j++){
+                float e = stats.rx_eye[i][j];
+                if (e < 0) e = 0; else if (e > 1) e = 1;
+                *eye++ = (uint8_t)(255*e + 0.5);
+            }
+            sh->neyetr++;
+        }
+    }
+
+    len = eye - buf;
+    while (len & 3) buf[len++] = 0;
+    sh->len = len;
+    fwrite(buf,1,len,fp);
+    fflush(fp);
+}
@@ -0,0 +1,69 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: fsk_stats.h
+
+  Modem statistics records of the FSK demod, JSON lines (--stats) or
+  binary records (--stats-bin), shared by utils/fsk_demod.c and the
+  in-process modem of the demod/mod decoders (--fsk).
+
+\*---------------------------------------------------------------------------*/
+
+#ifndef __FSK_STATS_H
+#define __FSK_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "fsk.h"
+#include "modem_stats.h"
+
+/* Binary modem stats (--stats-bin), one record per stats interval instead
+   of a JSON line, little endian (host order), 4 byte aligned:
+     "FSKT", u8 version, u8 channel, u16 record length,
+     u32 secs, u32 samples, float Eb/No dB, float ppm, float f_est[4],
+     u8 M, u8 eye traces, u8 eye samples, u8 fft decimation,
+     u16 fft bins, u16 reserved                               (48 bytes)
+     float samp_fft[fft bins]
+     u8 eye[traces][samples] (normalised eye 0..1 -> 0..255), zero padding
+   see read_stats_records() in auto_rx/autorx/fsk_demod.py */
+
+#define STATSBIN_HDR_LEN 48
+
+struct statshdr {
+    char     magic[4];
+    uint8_t  ver;
+    uint8_t  channel;
+    uint16_t len;
+    uint32_t secs;
+    uint32_t samples;
+    float    snr;
+    float    ppm;
+    float    f_est[4];
+    uint8_t  M;
+    uint8_t  neyetr;
+    uint8_t  neyesamp;
+    uint8_t  fft_dec;
+    uint16_t nfft;
+    uint16_t res;
+};
+
+/* size of the record buffer for fsk_stats_bin() */
+#define STATSBIN_MAX(fsk) (STATSBIN_HDR_LEN + sizeof(float)*(fsk)->Ndft/2 \
+                           + MODEM_STATS_ET_MAX*MODEM_STATS_EYE_IND_MAX + 4)
+
+/* stats writer settings: eye: every eye-th eye trace, 0: no eye diagram;
+   fft: samp_fft is the peak over fft bins */
+struct FSK_STATS_CFG {
+    int bin;        /* binary records instead of JSON */
+    int eye;
+    int fft;
+};
+
+/* JSON line. ch < 0: no "channel" field. tail != NULL: testframe mode,
+   no eye_diagram/samp_fft, tail is added to the fields. */
+void fsk_stats_json(FILE *fp, struct FSK *fsk, struct FSK_STATS_CFG *cfg, int ch, long samples, const char *tail);
+
+/* binary record, buf: STATSBIN_MAX(fsk) bytes */
+void fsk_stats_bin(FILE *fp, struct FSK *fsk, struct FSK_STATS_CFG *cfg, int ch, long samples, uint8_t *buf);
+
+#endif
@@ -0,0 +1,36 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: softhdr.h
+
+  Frame header of the framed soft-decision stream (fsk_demod -F), shared by
+  utils/fsk_demod.c (writer) and demod/mod/demod_mod.c (reader).
+
+\*---------------------------------------------------------------------------*/
+
+#ifndef __SOFTHDR_H
+#define __SOFTHDR_H
+
+#include <stdint.h>
+
+/* Each modem frame of nsym float32 soft decisions is preceded by a
+   SOFTHDR_LEN byte header, host byte order. A reader skips len-SOFTHDR_LEN
+   bytes of a newer (longer) header. */
+
+#define SOFTHDR_MAGIC  "SFSK"
+#define SOFTHDR_VER    1
+#define SOFTHDR_LEN    32
+
+typedef struct softhdr {
+    char     magic[4];  /* "SFSK"                      */
+    uint8_t  ver;       /* SOFTHDR_VER                 */
+    uint8_t  len;       /* header length               */
+    uint16_t nsym;      /* soft decisions in the frame */
+    uint32_t rs;        /* symbol rate                 */
+    float    snr;       /* Eb/No dB                    */
+    float    ppm;       /* clock offset                */
+    float    foff;      /* freq offset Hz              */
+    float    timing;    /* rx timing                   */
+    uint32_t seq;       /* frame counter               */
+} softhdr_t;
+
+#endif
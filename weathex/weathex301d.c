@@ -1,14 +1,23 @@
-
 /*
     Weathex WxR-301D (64kHz wide)
     UAII2022 Lindenberg: w/ PN9, 5000 baud
     Malaysia: w/o PN9, 4800 baud
+
+    files: weathex301d.c, ../demod/mod/demod_mod.c, demod_mod.h, dsp_mod.c, dsp_mod.h
+    make -C ../demod/mod libdemod.a
+    gcc -O3 weathex301d.c ../demod/mod/libdemod.a -lm -o weathex301d
+
+    input: FM audio (wav), IQ (--iq0, --iq2, --IQ <fq>) or float32 soft symbols (--softin)
 */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef CYGWIN
+  #include <fcntl.h>  // cygwin: _setmode()
+  #include <io.h>
+#endif
 
 // optional JSON "version"
 //  (a) set global
@@ -21,22 +30,19 @@
 //      gcc -DVER_JSN_STR=\"0.0.2\" ...
 
 
-typedef unsigned char ui8_t;
-typedef short i16_t;
-typedef unsigned int ui32_t;
+#include "../demod/mod/demod_mod.h"
+#include "../demod/mod/fskin_mod.h"
 
 
-int option_verbose = 0,
-    option_raw = 0,
-    option_inv = 0,
-    option_b = 0,
-    option_json = 0,
-    option_timestamp = 0,
-    option_softin = 0,
-    wavloaded = 0;
-int wav_channel = 0;     // audio channel: left
+typedef struct {
+    i8_t vbs;  // verbose output
+    i8_t raw;  // raw frames
+    i8_t inv;
+    i8_t jsn;  // JSON output (auto_rx)
+    i8_t pn9;  // PN9 whitening, 5000 baud
+    i8_t tim;  // timestamp
+} option_t;
 
-int option_pn9 = 0;
 
 #define BAUD_RATE      4800.0
 #define BAUD_RATE_PN9  5000.0 //(4997.2) // 5000
@@ -45,231 +51,45 @@ int option_pn9 = 0;
 #define BITFRAMELEN (8*FRAMELEN)
 
 #define HEADLEN 40
-#define HEADOFS 0
-char header_pn9[] = "10101010""10101010""10101010"//"10101010"      // AA AA AA  (preamble)
-                    "11000001""10010100"; //"11000001""11000110";   // C1 94 (C1 C6)
-
-char header[] = "10101010""10101010""10101010"       // AA AA AA (preamble)
-                "00101101""11010100"; //"10101010";  // 2D D4 (55/AA)
-
-char buf[HEADLEN+1] = "xxxxxxxxxx\0";
-int bufpos = 0;
-
-char frame_bits[BITFRAMELEN+1];
-ui8_t frame_bytes[FRAMELEN+1];
-ui8_t xframe[FRAMELEN+1];
-
-float baudrate = BAUD_RATE;
-
-/* ------------------------------------------------------------------------------------ */
-
-int sample_rate = 0, bits_sample = 0, channels = 0;
-float samples_per_bit = 0;
-
-int findstr(char *buff, char *str, int pos) {
-    int i;
-    for (i = 0; i < 4; i++) {
-        if (buff[(pos+i)%4] != str[i]) break;
-    }
-    return i;
-}
-
-int read_wav_header(FILE *fp) {
-    char txt[4+1] = "\0\0\0\0";
-    unsigned char dat[4];
-    int byte, p=0;
-
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "RIFF", 4) && strncmp(txt, "RF64", 4)) return -1;
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    // pos_WAVE = 8L
-    if (fread(txt, 1, 4, fp) < 4) return -1;
-    if (strncmp(txt, "WAVE", 4)) return -1;
-    // pos_fmt = 12L
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "fmt ", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    channels = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    memcpy(&sample_rate, dat, 4); //sample_rate = dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
-
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    //byte = dat[0] + (dat[1] << 8);
-
-    if (fread(dat, 1, 2, fp) < 2) return -1;
-    bits_sample = dat[0] + (dat[1] << 8);
-
-    // pos_dat = 36L + info
-    for ( ; ; ) {
-        if ( (byte=fgetc(fp)) == EOF ) return -1;
-        txt[p % 4] = byte;
-        p++; if (p==4) p=0;
-        if (findstr(txt, "data", p) == 4) break;
-    }
-    if (fread(dat, 1, 4, fp) < 4) return -1;
-
-
-    fprintf(stderr, "sample_rate: %d\n", sample_rate);
-    fprintf(stderr, "bits       : %d\n", bits_sample);
-    fprintf(stderr, "channels   : %d\n", channels);
-
-    if (bits_sample != 8 && bits_sample != 16 && bits_sample != 32) return -1;
-
-    if (sample_rate == 900001) sample_rate -= 1;
-
-    samples_per_bit = sample_rate/(float)baudrate;
-
-    fprintf(stderr, "samples/bit: %.2f\n", samples_per_bit);
-
-    return 0;
-}
-
-unsigned long sample_count = 0;
-double bitgrenze = 0;
-
-int f32read_signed_sample(FILE *fp, float *s) {
-    int i;
-    unsigned int word = 0;
-    short *b = (short*)&word;
-    float *f = (float*)&word;
-
-    for (i = 0; i < channels; i++) {
-
-        if (fread( &word, bits_sample/8, 1, fp) != 1) return EOF;
-
-        if (i == wav_channel) {  // i = 0: links bzw. mono
-            //if (bits_sample ==  8)  sint = b-128;   // 8bit: 00..FF, centerpoint 0x80=128
-            //if (bits_sample == 16)  sint = (short)b;
-
-            if (bits_sample == 32) {
-                *s = *f;
-            }
-            else {
-                if (bits_sample ==  8) { *b -= 128; }
-                *s = *b/128.0;
-                if (bits_sample == 16) { *s /= 256.0; }
-            }
-        }
-    }
-
-    sample_count++;
-
-    return 0;
-}
-
-int par=1, par_alt=1;
-
-int read_bits_fsk(FILE *fp, int *bit, int *len) {
-    int n;
-    float s;
-    float l;
-
-    n = 0;
-    do {
-        if (f32read_signed_sample(fp, &s) == EOF) return EOF;
-        //sample_count++; // in f32read_signed_sample()
-        par_alt = par;
-        par =  (s >= 0) ? 1 : -1;
-        n++;
-    } while (par*par_alt > 0);
-
-    l = (float)n / samples_per_bit;
-
-    *len = (int)(l+0.5);
-
-    if (!option_inv) *bit = (1+par_alt)/2;  // oben 1, unten -1
-    else             *bit = (1-par_alt)/2;  // sdr#<rev1381?, invers: unten 1, oben -1
-// *bit = (1+inv*par_alt)/2; // ausser inv=0
-
-    /* Y-offset ? */
+static char header_pn9[] = "10101010""10101010""10101010"//"10101010"      // AA AA AA  (preamble)
+                           "11000001""10010100"; //"11000001""11000110";   // C1 94 (C1 C6)
 
-    return 0;
-}
-
-int bitstart = 0;
-unsigned long scount = 0;
-int read_rawbit(FILE *fp, int *bit) {
-    float s;
-    float sum;
-
-    sum = 0;
-
-    if (bitstart) {
-        scount = 0;    // eigentlich scount = 1
-        bitgrenze = 0; //   oder bitgrenze = -1
-        bitstart = 0;
-    }
-    bitgrenze += samples_per_bit;
-
-    do {
-        if (f32read_signed_sample(fp, &s) == EOF) return EOF;
-        //sample_count++; // in f32read_signed_sample()
-        sum += s;
-        scount++;
-    } while (scount < bitgrenze);  // n < samples_per_bit
-
-    if (sum >= 0) *bit = 1;
-    else          *bit = 0;
-
-    if (option_inv) *bit ^= 1;
-
-    return 0;
-}
-
-
-int f32soft_read(FILE *fp, float *s) {
-    unsigned int word = 0;
-    short *b = (short*)&word;
-    float *f = (float*)&word;
-    int bps = 32;
+static char header[] = "10101010""10101010""10101010"       // AA AA AA (preamble)
+                       "00101101""11010100"; //"10101010";  // 2D D4 (55/AA)
 
-    if (fread( &word, bps/8, 1, fp) != 1) return EOF;
 
-    if (bps == 32) {
-        *s = *f;
-    }
-    else {
-        if (bps ==  8) { *b -= 128; }
-        *s = *b/128.0;
-        if (bps == 16) { *s /= 256.0; }
-    }
-
-    return 0;
-}
+// xPN9: OFS=8, 5000 baud ; w/o PN9: OFS=6, 4800 baud
+#define OFS      6
+#define OFS_PN9  8
 
 
-int compare(char *hdr) {
-    int i=0;
-    while ((i < HEADLEN) && (buf[(bufpos+i) % HEADLEN] == hdr[HEADLEN+HEADOFS-1-i])) {
-        i++;
-    }
-    return i;
-}
+typedef struct {
+    ui32_t sn1;
+    ui32_t cnt1;
+    int chk1ok;
+    //
+    ui32_t sn2;
+    ui32_t cnt2;
+    int chk2ok; // GPS subframe
+    ui8_t hrs;
+    ui8_t min;
+    ui8_t sec;
+    float lat;
+    float lon;
+    float alt;
+    //
+    int ofs;
+    char frame_bits[BITFRAMELEN+1];
+    ui8_t frame_bytes[FRAMELEN+1];
+    ui8_t xframe[FRAMELEN+1];
+    int jsn_freq;   // freq/kHz (SDR)
+    option_t option;
+} gpx_t;
 
-char inv(char c) {
-    if (c == '0') return '1';
-    if (c == '1') return '0';
-    return c;
-}
 
-int compare2(char *hdr) {
-    int i=0;
-    while ((i < HEADLEN) && (buf[(bufpos+i) % HEADLEN] == inv(hdr[HEADLEN+HEADOFS-1-i]))) {
-        i++;
-    }
-    return i;
-}
+/* ------------------------------------------------------------------------------------ */
 
-int bits2bytes(char *bitstr, ui8_t *bytes) {
+static int bits2bytes(char *bitstr, ui8_t *bytes) {
     int i, bit, d, byteval;
     int bitpos, bytepos;
 
@@ -305,17 +125,17 @@ int bits2bytes(char *bitstr, ui8_t *bytes) {
 // counter low byte: frame[ofs+4] XOR 0xCC
 // zero bytes, frame[ofs+30]: 0C CA C9 FB 49 37 E5 A8
 //
-ui8_t  PN9b[64] = { 0xFF, 0x87, 0xB8, 0x59, 0xB7, 0xA1, 0xCC, 0x24,
-                    0x57, 0x5E, 0x4B, 0x9C, 0x0E, 0xE9, 0xEA, 0x50,
-                    0x2A, 0xBE, 0xB4, 0x1B, 0xB6, 0xB0, 0x5D, 0xF1,
-                    0xE6, 0x9A, 0xE3, 0x45, 0xFD, 0x2C, 0x53, 0x18,
-                    0x0C, 0xCA, 0xC9, 0xFB, 0x49, 0x37, 0xE5, 0xA8,
-                    0x51, 0x3B, 0x2F, 0x61, 0xAA, 0x72, 0x18, 0x84,
-                    0x02, 0x23, 0x23, 0xAB, 0x63, 0x89, 0x51, 0xB3,
-                    0xE7, 0x8B, 0x72, 0x90, 0x4C, 0xE8, 0xFb, 0xC1};
+static ui8_t  PN9b[64] = { 0xFF, 0x87, 0xB8, 0x59, 0xB7, 0xA1, 0xCC, 0x24,
+                           0x57, 0x5E, 0x4B, 0x9C, 0x0E, 0xE9, 0xEA, 0x50,
+                           0x2A, 0xBE, 0xB4, 0x1B, 0xB6, 0xB0, 0x5D, 0xF1,
+                           0xE6, 0x9A, 0xE3, 0x45, 0xFD, 0x2C, 0x53, 0x18,
+                           0x0C, 0xCA, 0xC9, 0xFB, 0x49, 0x37, 0xE5, 0xA8,
+                           0x51, 0x3B, 0x2F, 0x61, 0xAA, 0x72, 0x18, 0x84,
+                           0x02, 0x23, 0x23, 0xAB, 0x63, 0x89, 0x51, 0xB3,
+                           0xE7, 0x8B, 0x72, 0x90, 0x4C, 0xE8, 0xFb, 0xC1};
 
 
-ui32_t xor8sum(ui8_t bytes[], int len) {
+static ui32_t xor8sum(ui8_t bytes[], int len) {
     int j;
     ui8_t xor8 = 0;
     ui8_t sum8 = 0;
@@ -330,41 +150,19 @@ ui32_t xor8sum(ui8_t bytes[], int len) {
 }
 
 
-typedef struct {
-    ui32_t sn1;
-    ui32_t cnt1;
-    int chk1ok;
-    //
-    ui32_t sn2;
-    ui32_t cnt2;
-    int chk2ok; // GPS subframe
-    ui8_t hrs;
-    ui8_t min;
-    ui8_t sec;
-    float lat;
-    float lon;
-    float alt;
-    //
-    int jsn_freq;   // freq/kHz (SDR)
-} gpx_t;
-
-gpx_t gpx;
-
-
-// xPN9: OFS=8, 5000 baud ; w/o PN9: OFS=6, 4800 baud
-#define OFS      6
-#define OFS_PN9  8
-int ofs = OFS;
-
-int print_frame() {
+static int print_frame(gpx_t *gpx, int pos) {
     int j;
     int chkdat, chkval, chk_ok;
+    int ofs = gpx->ofs;
+    ui8_t *xframe = gpx->xframe;
+
+    if (pos < BITFRAMELEN) return -1;
 
-    bits2bytes(frame_bits, frame_bytes);
+    bits2bytes(gpx->frame_bits, gpx->frame_bytes);
 
     for (j = 0; j < FRAMELEN; j++) {
-        ui8_t b = frame_bytes[j];
-        if (option_pn9) {
+        ui8_t b = gpx->frame_bytes[j];
+        if (gpx->option.pn9) {
             if (j >= 6) b ^= PN9b[(j-6)%64];
         }
         xframe[j] = b;
@@ -374,18 +172,18 @@ int print_frame() {
     chkdat = (xframe[ofs+53]<<8) | xframe[ofs+53+1];
     chk_ok = (chkdat == chkval);
 
-    if (option_raw) {
-        if (option_raw == 1) {
+    if (gpx->option.raw) {
+        if (gpx->option.raw == 1) {
             for (j = 0; j < FRAMELEN; j++) {
-                //printf("%02X ", frame_bytes[j]);
+                //printf("%02X ", gpx->frame_bytes[j]);
                 printf("%02X ", xframe[j]);
             }
             printf(" #  %s", chk_ok ? "[OK]" : "[NO]");
-            if (option_verbose) printf(" # [%04X:%04X]", chkdat, chkval);
+            if (gpx->option.vbs) printf(" # [%04X:%04X]", chkdat, chkval);
         }
         else {
             for (j = 0; j < BITFRAMELEN; j++) {
-                printf("%c", frame_bits[j]);
+                printf("%c", gpx->frame_bits[j]);
                 //if (j % 8 == 7) printf(" ");
             }
         }
@@ -407,26 +205,26 @@ int print_frame() {
 
         if (frid == 1)
         {
-            gpx.chk1ok = chk_ok;
-            gpx.sn1    = sn;
-            gpx.cnt1   = cnt;
+            gpx->chk1ok = chk_ok;
+            gpx->sn1    = sn;
+            gpx->cnt1   = cnt;
 
-            if (option_verbose) {
+            if (gpx->option.vbs) {
 
                 printf(" (%u) ", sn);  //printf(" (0x%08X) ", sn);
                 printf(" [%5d] ", cnt);
 
                 printf("  %s", chk_ok ? "[OK]" : "[NO]");
-                if (option_verbose) printf(" # [%04X:%04X]", chkdat, chkval);
+                if (gpx->option.vbs) printf(" # [%04X:%04X]", chkdat, chkval);
 
                 printf("\n");
             }
         }
         else if (frid == 2)
         {
-            gpx.chk2ok = chk_ok;
-            gpx.sn2    = sn;
-            gpx.cnt2   = cnt;
+            gpx->chk2ok = chk_ok;
+            gpx->sn2    = sn;
+            gpx->cnt2   = cnt;
 
             // SN
             printf(" (%u) ", sn);  //printf(" (0x%08X) ", sn);
@@ -443,9 +241,9 @@ int print_frame() {
             ui8_t m = (hms % 10000) / 100;
             ui8_t s =  hms % 100;
             printf(" %02d:%02d:%02d ", h, m, s);  // UTC
-            gpx.hrs = h;
-            gpx.min = m;
-            gpx.sec = s;
+            gpx->hrs = h;
+            gpx->min = m;
+            gpx->sec = s;
 
             // alt
             val = xframe[ofs+13] | (xframe[ofs+14]<<8) | (xframe[ofs+15]<<16);
@@ -454,7 +252,7 @@ int print_frame() {
             //if (val & 0x40000) val -= 0x80000; ?? or sign bit ?
             float alt = val / 10.0f;
             printf(" alt: %.1f ", alt);  // MSL
-            gpx.alt = alt;
+            gpx->alt = alt;
             int val_alt = val;
 
             // lat
@@ -464,7 +262,7 @@ int print_frame() {
             //if (val & 0x1000000) val -= 0x2000000; // sign bit ?  (or 90 -> -90 wrap ?)
             float lat = val / 1e5f;
             printf(" lat: %.4f ", lat);
-            gpx.lat = lat;
+            gpx->lat = lat;
             int val_lat = val;
 
             // lon
@@ -473,50 +271,51 @@ int print_frame() {
             //if (val & 0x2000000) val -= 0x4000000; // or sign bit ?  (or 180 -> -180 wrap ?)
             float lon = val / 1e5f;
             printf(" lon: %.4f ", lon);
-            gpx.lon = lon;
+            gpx->lon = lon;
             int val_lon = val;
 
             int zero_pos = val_alt == 0 && val_lat == 0 && val_lon == 0;
 
             // checksum
             printf("  %s", chk_ok ? "[OK]" : "[NO]");
-            if (option_verbose) printf(" # [%04X:%04X]", chkdat, chkval);
+            if (gpx->option.vbs) printf(" # [%04X:%04X]", chkdat, chkval);
 
             printf("\n");
 
             // JSON
-            if (option_json && gpx.chk2ok && !zero_pos) {
-                if (gpx.chk1ok && gpx.sn2 == gpx.sn1 && gpx.cnt2 == gpx.cnt1) // double check, unreliable checksums
+            if (gpx->option.jsn && gpx->chk2ok && !zero_pos) {
+                if (gpx->chk1ok && gpx->sn2 == gpx->sn1 && gpx->cnt2 == gpx->cnt1) // double check, unreliable checksums
                 {
                     char *ver_jsn = NULL;
-                    fprintf(stdout, "{ \"type\": \"%s\"", "WXR301");
-                    fprintf(stdout, ", \"frame\": %u", gpx.cnt2);
-                    fprintf(stdout, ", \"id\": \"WXR-%u\"", gpx.sn2);
-                    fprintf(stdout, ", \"datetime\": \"%02d:%02d:%02dZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.2f",
-                                    gpx.hrs, gpx.min, gpx.sec, gpx.lat, gpx.lon, gpx.alt);
+                    printf("{ \"type\": \"%s\"", "WXR301");
+                    printf(", \"frame\": %u", gpx->cnt2);
+                    printf(", \"id\": \"WXR-%u\"", gpx->sn2);
+                    printf(", \"datetime\": \"%02d:%02d:%02dZ\", \"lat\": %.5f, \"lon\": %.5f, \"alt\": %.2f",
+                           gpx->hrs, gpx->min, gpx->sec, gpx->lat, gpx->lon, gpx->alt);
 
                     // if data from subframe1,
-                    // check  gpx.chk1ok && gpx.sn1==gpx.sn2 && gpx.cnt1==gpx.cnt2
+                    // check  gpx->chk1ok && gpx->sn1==gpx->sn2 && gpx->cnt1==gpx->cnt2
 
-                    if (option_pn9) {
-                        fprintf(stdout, ", \"subtype\": \"WXR_PN9\"");
-                    }
+                    printf(", \"subtype\": \"%s\"", gpx->option.pn9 ? "WXR_PN9" : "WXR301");
 
-                    if (gpx.jsn_freq > 0) {
-                        fprintf(stdout, ", \"freq\": %d", gpx.jsn_freq );
+                    if (gpx->jsn_freq > 0) {
+                        printf(", \"freq\": %d", gpx->jsn_freq);
+                    }
+                    if (f32soft_hdr()) {  // framed soft input (fsk_demod -F) / --fsk: modem SNR, freq offset
+                        printf(", \"snr\": %.1f, \"foff\": %.1f", f32soft_hdr()->snr, f32soft_hdr()->foff);
                     }
 
                     // Reference time/position
                     // (WxR-301D PN9)
-                    fprintf(stdout, ", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
-                    fprintf(stdout, ", \"ref_position\": \"%s\"", "MSL" ); // {"GPS", "MSL"} GPS=ellipsoid , MSL=geoid
+                    printf(", \"ref_datetime\": \"%s\"", "UTC" ); // {"GPS", "UTC"} GPS-UTC=leap_sec
+                    printf(", \"ref_position\": \"%s\"", "MSL" ); // {"GPS", "MSL"} GPS=ellipsoid , MSL=geoid
 
                     #ifdef VER_JSN_STR
                         ver_jsn = VER_JSN_STR;
                     #endif
-                    if (ver_jsn && *ver_jsn != '\0') fprintf(stdout, ", \"version\": \"%s\"", ver_jsn);
-                    fprintf(stdout, " }\n");
-                    fprintf(stdout, "\n");
+                    if (ver_jsn && *ver_jsn != '\0') printf(", \"version\": \"%s\"", ver_jsn);
+                    printf(" }\n");
+                    printf("\n");
                 }
             }
 
@@ -526,58 +325,203 @@ int print_frame() {
     return 0;
 }
 
+/* -------------------------------------------------------------------------- */
+
+
 int main(int argc, char **argv) {
 
-    FILE *fp;
-    char *fpname;
+    int option_min = 0;
+    int option_iq = 0;
+    int option_iqdc = 0;
+    int option_lp = 0;
+    int option_dc = 0;
+    int option_noLUT = 0;
+    int option_softin = 0;
+    int option_pcmraw = 0;
+    int wavloaded = 0;
+    int sel_wavch = 0;     // audio channel: left
+    int spike = 0;
+    int cfreq = -1;
+
+    float baudrate = -1;
+
+    FILE *fp = NULL;
+    char *fpname = NULL;
+
+    int k;
+
+    int bit;
+    int bitpos = 0;
+    int bitQ;
+    int pos;
+    hsbit_t hsbit, hsbit1;
 
-    int i, j, h, bit, len;
-    int bit_count, frames;
     int header_found = 0;
-    int cfreq = -1;
+
+    float thres = 0.7;
+    float _mv = 0.0;
+
+    float lpIQ_bw = 64e3;
+    int IF_sr = 96000;
+
+    int symlen = 1;
+    int bitofs = 0; // 0 .. +2
+    int shift = 0;
+
+    ui32_t sym_count = 0; // --softin: symbols read
 
     char *hdr = header;
 
+    pcm_t pcm = {0};
+    dsp_t dsp = {0};  //memset(&dsp, 0, sizeof(dsp));
+
+    hdb_t hdb = {0};
+
+    gpx_t gpx = {0};
+
+
+#ifdef CYGWIN
+    _setmode(fileno(stdin), _O_BINARY);  // _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    setbuf(stdout, NULL);
+
+
     fpname = argv[0];
     ++argv;
     while ((*argv) && (!wavloaded)) {
         if      ( (strcmp(*argv, "-h") == 0) || (strcmp(*argv, "--help") == 0) ) {
             fprintf(stderr, "%s [options] audio.wav\n", fpname);
             fprintf(stderr, "  options:\n");
-            fprintf(stderr, "       -i\n");
-            fprintf(stderr, "       -b\n");
+            fprintf(stderr, "       -v, --verbose\n");
+            fprintf(stderr, "       -r, --raw\n");
+            fprintf(stderr, "       -i, --invert\n");
+            fprintf(stderr, "       --pn9        (PN9 whitening, 5000 baud)\n");
+            fprintf(stderr, "       --json       (JSON output)\n");
+            fprintf(stderr, "       --softin     (float32 soft symbols)\n");
+            fprintf(stderr, "       --iq0,2,3    (IQ data)\n");
+            fprintf(stderr, "       --IQ <fq>    (baseband IQ at fq)\n");
+            fprintf(stderr, "       --IFbw <kHz> (IF sample rate, default: 96)\n");
+            fprintf(stderr, "       --lpIQ, --lpbw <kHz>, --lpFM, --dc\n");
             return 0;
         }
-        else if   (strcmp(*argv, "--pn9") == 0) { option_pn9 = 1; }
-        else if ( (strcmp(*argv, "-i") == 0) || (strcmp(*argv, "--invert") == 0) ) {
-            option_inv = 1;
-        }
+        else if   (strcmp(*argv, "--pn9") == 0) { gpx.option.pn9 = 1; }
         else if ( (strcmp(*argv, "-v") == 0) || (strcmp(*argv, "--verbose") == 0) ) {
-            option_verbose = 1;
+            gpx.option.vbs = 1;
         }
-        else if   (strcmp(*argv, "--softin") == 0) { option_softin = 1; }  // float32 soft input
-        else if   (strcmp(*argv, "-b" ) == 0) { option_b = 1; }
-        else if   (strcmp(*argv, "-t" ) == 0) { option_timestamp = 1; }
         else if ( (strcmp(*argv, "-r") == 0) || (strcmp(*argv, "--raw") == 0) ) {
-            option_raw = 1;
+            gpx.option.raw = 1;
         }
         else if ( (strcmp(*argv, "-R") == 0) || (strcmp(*argv, "--RAW") == 0) ) {
-            option_raw = 2;
+            gpx.option.raw = 2;
         }
-        else if ( (strcmp(*argv, "--json") == 0) ) {
-            option_json = 1;
+        else if ( (strcmp(*argv, "-i") == 0) || (strcmp(*argv, "--invert") == 0) ) {
+            gpx.option.inv = 1;
         }
-        else if ( (strcmp(*argv, "--jsn_cfq") == 0) ) {
+        else if   (strcmp(*argv, "-b" ) == 0) { }  // bit integration: always (read_softbit2p)
+        else if   (strcmp(*argv, "-t" ) == 0) { gpx.option.tim = 1; }
+        else if ( (strcmp(*argv, "--br") == 0) ) {
+            ++argv;
+            if (*argv) {
+                baudrate = atof(*argv);
+                if (baudrate < 4000 || baudrate > 5400) baudrate = -1; // default: 4800, 5000 (PN9)
+            }
+            else return -1;
+        }
+        else if ( (strcmp(*argv, "--spike") == 0) ) {
+            spike = 1;
+        }
+        else if   (strcmp(*argv, "--ch2") == 0) { sel_wavch = 1; }  // right channel (default: 0=left)
+        else if   (strcmp(*argv, "--softin") == 0)  { option_softin = 1; }  // float32 soft input
+        else if   (strcmp(*argv, "--softinv") == 0) { option_softin = 2; }  // float32 inverted soft input
+        else if   (strcmp(*argv, "--fsk") == 0) {  // codec2 FSK modem in-process: --fsk <Fs>,<Rs>[,<opt>...]
+            ++argv;
+            if (*argv == NULL || fskin_init(*argv) < 0) return -1;
+            if (!option_softin) option_softin = 1;
+        }
+        else if   (strcmp(*argv, "--ths") == 0) {
+            ++argv;
+            if (*argv) {
+                thres = atof(*argv);
+            }
+            else return -1;
+        }
+        else if ( (strcmp(*argv, "-d") == 0) ) {
+            ++argv;
+            if (*argv) {
+                shift = atoi(*argv);
+                if (shift >  4) shift =  4;
+                if (shift < -4) shift = -4;
+            }
+            else return -1;
+        }
+        else if   (strcmp(*argv, "--iq0") == 0) { option_iq = 1; }  // differential/FM-demod
+        else if   (strcmp(*argv, "--iq2") == 0) { option_iq = 2; }
+        else if   (strcmp(*argv, "--iq3") == 0) { option_iq = 3; }  // iq2==iq3
+        else if   (strcmp(*argv, "--iqdc") == 0) { option_iqdc = 1; }  // iq-dc removal (iq0,2,3)
+        else if   (strcmp(*argv, "--IQ") == 0) { // fq baseband -> IF (rotate from and decimate)
+            double fq = 0.0;                     // --IQ <fq> , -0.5 < fq < 0.5
+            ++argv;
+            if (*argv) fq = atof(*argv);
+            else return -1;
+            if (fq < -0.5) fq = -0.5;
+            if (fq >  0.5) fq =  0.5;
+            dsp.xlt_fq = -fq; // S(t) -> S(t)*exp(-f*2pi*I*t)
+            option_iq = 5;
+        }
+        else if   (strcmp(*argv, "--IFbw") == 0) {  // IF sample rate / kHz
+            int ifbw = 0;
+            ++argv;
+            if (*argv) ifbw = atoi(*argv);
+            else return -1;
+            if (ifbw >= 64) IF_sr = ifbw*1000;
+        }
+        else if   (strcmp(*argv, "--lpIQ") == 0) { option_lp |= LP_IQ; }  // IQ/IF lowpass
+        else if   (strcmp(*argv, "--lpbw") == 0) {  // IQ lowpass BW / kHz
+            double bw = 0.0;
+            ++argv;
+            if (*argv) bw = atof(*argv);
+            else return -1;
+            if (bw > 16.0 && bw < 192.0) lpIQ_bw = bw*1e3;
+            option_lp |= LP_IQ;
+        }
+        else if   (strcmp(*argv, "--lpFM") == 0) { option_lp |= LP_FM; }  // FM lowpass
+        else if   (strcmp(*argv, "--dc") == 0) { option_dc = 1; }
+        else if   (strcmp(*argv, "--noLUT") == 0) { option_noLUT = 1; }
+        else if   (strcmp(*argv, "--min") == 0) {
+            option_min = 1;
+        }
+        else if   (strcmp(*argv, "--profile") == 0) { prf_init(0, 0); }  // per-stage timing -> stderr
+        else if   (strcmp(*argv, "--profile=json") == 0) { prf_init(1, 0); }
+        else if   (strcmp(*argv, "--json") == 0) {
+            gpx.option.jsn = 1;
+        }
+        else if   (strcmp(*argv, "--jsn_cfq") == 0) {
             int frq = -1;  // center frequency / Hz
             ++argv;
             if (*argv) frq = atoi(*argv); else return -1;
             if (frq < 300000000) frq = -1;
             cfreq = frq;
         }
+        else if (strcmp(*argv, "-") == 0) {
+            int sample_rate = 0, bits_sample = 0, channels = 0;
+            ++argv;
+            if (*argv) sample_rate = atoi(*argv); else return -1;
+            ++argv;
+            if (*argv) bits_sample = atoi(*argv); else return -1;
+            channels = 2;
+            if (sample_rate < 1 || (bits_sample != 8 && bits_sample != 16 && bits_sample != 32)) {
+                fprintf(stderr, "- <sr> <bs>\n");
+                return -1;
+            }
+            pcm.sr  = sample_rate;
+            pcm.bps = bits_sample;
+            pcm.nch = channels;
+            option_pcmraw = 1;
+        }
         else {
             fp = fopen(*argv, "rb");
             if (fp == NULL) {
-                fprintf(stderr, "%s konnte nicht geoeffnet werden\n", *argv);
+                fprintf(stderr, "error: open %s\n", *argv);
                 return -1;
             }
             wavloaded = 1;
@@ -586,130 +530,169 @@ int main(int argc, char **argv) {
     }
     if (!wavloaded) fp = stdin;
 
-    if (option_pn9) {
-        baudrate = BAUD_RATE_PN9;
+    gpx.ofs = OFS;
+    if (gpx.option.pn9) {
         hdr = header_pn9;
-        ofs = OFS_PN9;
+        gpx.ofs = OFS_PN9;
     }
+    if (baudrate < 0) baudrate = gpx.option.pn9 ? BAUD_RATE_PN9 : BAUD_RATE;
 
-    if ( !option_softin ) {
-        i = read_wav_header(fp);
-        if (i) return -1;
-    }
+    if (option_iq == 5 && option_dc) option_lp |= LP_FM;
 
+    // LUT faster for decM, however frequency correction after decimation
+    // LUT recommended if decM > 2
+    //
+    if (option_noLUT && option_iq == 5) dsp.opt_nolut = 1; else dsp.opt_nolut = 0;
 
     if (cfreq > 0) gpx.jsn_freq = (cfreq+500)/1000;
 
 
-    bit_count = 0;
-    frames = 0;
+    if (!option_softin) {
 
-    if (option_softin)
-    {
-        float s = 0.0f;
-        int bit = 0;
-        sample_rate = baudrate;
-        sample_count = 0;
-
-        while (!f32soft_read(fp, &s)) {
-
-            bit = option_inv ? (s<=0.0f) : (s>=0.0f);  // softbit s: bit=0 <=> s<0 , bit=1 <=> s>=0
-
-            bufpos--;
-            if (bufpos < 0) bufpos = HEADLEN-1;
-            buf[bufpos] = 0x30 + bit;
-
-            if (!header_found)
-            {
-                h = compare(hdr); //h2 = compare2(hdr);
-                if ((h >= HEADLEN)) {
-                    header_found = 1;
-                    fflush(stdout);
-                    if (option_timestamp) printf("<%8.3f> ", sample_count/(double)sample_rate);
-                    strncpy(frame_bits, hdr, HEADLEN);
-                    bit_count += HEADLEN;
-                    frames++;
-                }
-            }
-            else
-            {
-                frame_bits[bit_count] = 0x30 + bit;
-                bit_count += 1;
+        if (option_iq == 0 && option_pcmraw) {
+            fclose(fp);
+            fprintf(stderr, "error: raw data not IQ\n");
+            return -1;
+        }
+        if (option_iq) sel_wavch = 0;
+
+        pcm.sel_ch = sel_wavch;
+        if (option_pcmraw == 0) {
+            k = read_wav_header(&pcm, fp);
+            if ( k < 0 ) {
+                fclose(fp);
+                fprintf(stderr, "error: wav header\n");
+                return -1;
             }
+        }
 
-            if (bit_count >= BITFRAMELEN) {
-                bit_count = 0;
-                header_found = 0;
 
-                print_frame();
-            }
-            sample_count += 1;
+        symlen = 1;
+
+        // init dsp
+        //
+        dsp.fp = fp;
+        dsp.sr = pcm.sr;
+        dsp.bps = pcm.bps;
+        dsp.nch = pcm.nch;
+        dsp.ch = pcm.sel_ch;
+        dsp.br = baudrate;
+        dsp.sps = (float)dsp.sr/dsp.br;
+        dsp.symlen = symlen;
+        dsp.symhd = 1;
+        dsp._spb = dsp.sps*symlen;
+        dsp.hdr = hdr;
+        dsp.hdrlen = strlen(hdr);
+        dsp.BT = 1.0; // bw/time (ISI) // 1.0..2.0  // ?
+        dsp.h = 4.0;  // modulation index  // ? 64kHz wide
+        dsp.opt_iq = option_iq;
+        dsp.opt_iqdc = option_iqdc;
+        dsp.opt_lp = option_lp;
+        dsp.lpIQ_bw = lpIQ_bw; // IF lowpass bandwidth
+        dsp.lpFM_bw = 10e3; // FM audio lowpass
+        dsp.opt_dc = option_dc;
+        dsp.opt_IFmin = option_min;
+        dsp.IF_sr = IF_sr; // --IQ: IF >= signal bandwidth
+
+        if ( dsp.sps < 8 ) {
+            fprintf(stderr, "note: sample rate low (%.1f sps)\n", dsp.sps);
+        }
+
+
+        k = init_buffers(&dsp);
+        if ( k < 0 ) {
+            fprintf(stderr, "error: init buffers\n");
+            return -1;
+        }
+
+        bitofs += shift;
+    }
+    else {
+        if (option_softin) f32soft_br(baudrate);  // check fsk_demod -F / --fsk symbol rate
+        // init circular header bit buffer
+        hdb.hdr = hdr;
+        hdb.len = strlen(hdr);
+        hdb.bufpos = -1;
+        hdb.buf = NULL;
+        hdb.ths = 0.9; // AA-preamble: sidelobes up to 0.7 (1 bit offset)
+        hdb.sbuf = calloc(hdb.len, sizeof(float));
+        if (hdb.sbuf == NULL) {
+            fprintf(stderr, "error: malloc\n");
+            return -1;
         }
     }
-    else
+
+
+    while ( 1 )
     {
-        while (!read_bits_fsk(fp, &bit, &len)) {
+        if (option_softin) {
+            header_found = find_softbinhead(fp, &hdb, &_mv, option_softin == 2);
+        }
+        else {                                                              // FM-audio:
+            header_found = find_header(&dsp, thres, 2, bitofs, dsp.opt_dc); // optional 2nd pass: dc=0
+            _mv = dsp.mv;
+        }
+
+        if (header_found == EOF) break;
+
+        // mv == correlation score
+        if (_mv*(0.5-gpx.option.inv) < 0) {
+            gpx.option.inv ^= 0x1;
+        }
+
+        if (header_found) {
 
-            if (len == 0) {
-                bufpos--;
-                if (bufpos < 0) bufpos = HEADLEN-1;
-                buf[bufpos] = 'x';
-                continue;
+            if (gpx.option.tim) {
+                double t = option_softin ? sym_count/(double)baudrate : dsp.mv_pos/(double)dsp.sr;
+                printf("<%8.3f> ", t);
             }
 
+            strncpy(gpx.frame_bits, hdr, HEADLEN);
+            bitpos = 0;
+            pos = HEADLEN;
 
-            for (j = 0; j < len; j++) {
-                bufpos--;
-                if (bufpos < 0) bufpos = HEADLEN-1;
-                buf[bufpos] = 0x30 + bit;
+            while ( pos < BITFRAMELEN ) {
 
-                if (!header_found)
-                {
-                    h = compare(hdr); //h2 = compare2(hdr);
-                    if ((h >= HEADLEN)) {
-                        header_found = 1;
-                        fflush(stdout);
-                        if (option_timestamp) printf("<%8.3f> ", sample_count/(double)sample_rate);
-                        strncpy(frame_bits, hdr, HEADLEN);
-                        bit_count += HEADLEN;
-                        frames++;
+                if (option_softin) {
+                    float s = 0.0;
+                    bitQ = f32soft_read(fp, &s, option_softin == 2);
+                    if (bitQ != EOF) {
+                        bit = (s>=0.0) ^ gpx.option.inv;
+                        sym_count++;
                     }
                 }
-                else
-                {
-                    frame_bits[bit_count] = 0x30 + bit;
-                    bit_count += 1;
-                }
-
-                if (bit_count >= BITFRAMELEN) {
-                    bit_count = 0;
-                    header_found = 0;
-
-                    print_frame();
+                else {
+                    float bl = -1;
+                    if (option_iq >= 2) spike = 0;
+                    if (option_iq > 2)  bl = 2.0;
+                    bitQ = read_softbit2p(&dsp, &hsbit, 0, bitofs, bitpos, bl, spike, &hsbit1); // symlen=1
+                    bit = hsbit.hb ^ gpx.option.inv;
                 }
+                if ( bitQ == EOF ) { break; }
 
+                gpx.frame_bits[pos] = 0x30 + bit;
+                pos++;
+                bitpos += 1;
             }
-            if (header_found && option_b) {
-                bitstart = 1;
-
-                while ( bit_count < BITFRAMELEN ) {
-                    if (read_rawbit(fp, &bit) == EOF) break;
-                    frame_bits[bit_count] = 0x30 + bit;
-                    bit_count += 1;
-                }
-
-                bit_count = 0;
-                header_found = 0;
+            gpx.frame_bits[pos] = '\0';
+            prf_enter(PRF_OUT);
+            print_frame(&gpx, pos);
+            prf_leave();
+            if (pos < BITFRAMELEN) break;
 
-                print_frame();
-            }
+            header_found = 0;
         }
     }
 
     printf("\n");
 
+    if (!option_softin) free_buffers(&dsp);
+    else {
+        if (hdb.sbuf) { free(hdb.sbuf); hdb.sbuf = NULL; }
+    }
+
+
     fclose(fp);
 
     return 0;
 }
-